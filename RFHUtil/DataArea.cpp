@@ -45,6 +45,7 @@ Jim MacNair - Initial Contribution
 
 // include the copybook utility functions
 #include "copybook.h"
+#include "capfile.h"
 
 #ifdef _DEBUG
 #undef THIS_FILE
@@ -16017,6 +16018,11 @@ void DataArea::loadMsgs(LOADPARMS * parms)
 	unsigned char *		delimPtr=NULL;				// pointer to delimiter between messages
 	unsigned char *		propDelimPtr=NULL;			// pointer to properties delimiter
 	unsigned char *		propPtr=NULL;				// pointer to beginning of properties data
+	unsigned char *		capData=NULL;				// messages expanded from an indexed capture file
+	unsigned int *		capEnds=NULL;				// end of each message in an indexed capture file
+	unsigned int		capCount=0;					// number of messages in an indexed capture file
+	unsigned int		capNext=0;					// next message in an indexed capture file
+	unsigned int		capLen=0;					// length of the expanded indexed capture file
 	CRfhutilApp			*app;						// pointer to MFC application object
 	FILE				*inputFile;					// file
 	BOOL				save_set_all;				// save area for current setting of set all selection on general page
@@ -16192,15 +16198,50 @@ void DataArea::loadMsgs(LOADPARMS * parms)
 					logTraceEntry(traceInfo);
 				}
 
+				// release any messages expanded from the previous file
+				if (capData != NULL)
+				{
+					rfhFree(capData);
+					rfhFree(capEnds);
+					capData = NULL;
+					capEnds = NULL;
+				}
+
+				// check for an indexed capture file written by mqcapture
+				// the index is used to find the messages rather than delimiters
+				if (noErr && (0 == unread) && isCapFile(fData, bytesRead))
+				{
+					capData = expandCapFile(fData, bytesRead, &capLen, &capEnds, &capCount, errtxt);
+					if (NULL == capData)
+					{
+						m_error_msg.Format("%s %.256s", errtxt, newFileName);
+						noErr = false;
+					}
+					else
+					{
+						// the expanded messages replace the file data
+						remaining = capLen;
+						bytesRead = capLen;
+						bytesLeftInBuffer = capLen;
+						capNext = 0;
+					}
+				}
+
 				// only force this once
 				firstTime = false;
 			}
 
 			// initialize some variables before entering the main loop to process the file
 			fileDone = false;
-			msgData = fData;
+			msgData = (capData != NULL) ? capData : fData;
 			msgLen = bytesRead;
 
+			// an indexed capture file may not have any messages in it
+			if ((capData != NULL) && (0 == capCount))
+			{
+				fileDone = true;
+			}
+
 			// process the messages in this file
 			while (!fileDone && noErr)
 			{
@@ -16211,8 +16252,14 @@ void DataArea::loadMsgs(LOADPARMS * parms)
 				//pmo.Options = MQPMO_FAIL_IF_QUIESCING | MQPMO_NO_SYNCPOINT;
 				pmo.Options = MQPMO_FAIL_IF_QUIESCING | MQPMO_SYNCPOINT;
 
-				// check for a delimiter between the messages
-				if (parms->delimLen > 0)
+				// check for an indexed capture file
+				if (capData != NULL)
+				{
+					// the index gives the end of the message
+					delimPtr = NULL;
+					msgLen = capEnds[capNext++] - (msgData - capData);
+				}
+				else if (parms->delimLen > 0)
 				{
 					// scan for a delimiter sequence
 					delimPtr = scanForDelim(msgData, msgLen, parms->delimiter, parms->delimLen);
@@ -16504,7 +16551,7 @@ void DataArea::loadMsgs(LOADPARMS * parms)
 				}
 
 				// check if at end of current file or parms->maxCount messages have been written
-				if ((remaining <= 0) || ((parms->maxCount > 0) && (count >= parms->maxCount)))
+				if ((remaining <= 0) || ((capData != NULL) && (capNext >= capCount)) || ((parms->maxCount > 0) && (count >= parms->maxCount)))
 				{
 					// finished with this file
 					fileDone = true;
@@ -16636,6 +16683,15 @@ void DataArea::loadMsgs(LOADPARMS * parms)
 			inputFile = NULL;									// set the file handle to NULL since the file is now closed
 		}
 
+		// release any messages expanded from an indexed capture file
+		if (capData != NULL)
+		{
+			rfhFree(capData);
+			rfhFree(capEnds);
+			capData = NULL;
+			capEnds = NULL;
+		}
+
 		// update the queue depth
 		getCurrentDepth();
 
@@ -17031,47 +17087,13 @@ int DataArea::getPropType(const char *propPtr, const char * endProp)
 unsigned char * DataArea::scanForDelim(unsigned char *msgData, int msgLen, const char *delimiter, int delimLen)
 
 {
-	int					remaining;
-	unsigned char *		delimPtr=NULL;
-	boolean				notDone=true;
-
 	// check that we have a delimiter and that we have enough characters to check
-	if ((0 == delimLen) || (msgLen < delimLen))
+	if ((delimLen <= 0) || (msgLen < delimLen))
 	{
 		return NULL;
 	}
 
-	// get the maximum number of characters to scan
-	remaining = msgLen - delimLen;
-
-	while ((remaining > 0) && notDone)
-	{
-		if (delimiter[0] != msgData[0])
-		{
-			msgData++;
-			remaining--;
-		}
-		else
-		{
-			// check if the whole delimiter matches
-			if (memcmp(delimiter, msgData, delimLen) == 0)
-			{
-				notDone = false;
-			}
-			else
-			{
-				msgData++;
-				remaining--;
-			}
-		}
-	}
-
-	if (memcmp(delimiter, msgData, delimLen) == 0)
-	{
-		delimPtr = msgData;
-	}
-
-	return delimPtr;
+	return (unsigned char *)searchDelim(msgData, msgLen, (const unsigned char *)delimiter, delimLen);
 }
 
 const char * DataArea::findPropEnd(const char *propPtr, const char *endPtr)
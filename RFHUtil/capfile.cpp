@@ -0,0 +1,312 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+// capfile.cpp: indexed capture file subroutines.
+//
+// mqcapture can store messages in blocks that are compressed
+// in the LZ4 block format, followed by an index of the messages.
+// These routines expand such a file so the messages can be
+// loaded onto a queue.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "string.h"
+#include "comsubs.h"
+#include "capfile.h"
+
+#define CAP_MIN_MATCH		4
+
+///////////////////////////////////////////////////
+//
+// Little endian numbers in the file
+//
+///////////////////////////////////////////////////
+
+static unsigned int get32(const unsigned char *ptr)
+
+{
+	return (unsigned int)ptr[0] | ((unsigned int)ptr[1] << 8) | ((unsigned int)ptr[2] << 16) | ((unsigned int)ptr[3] << 24);
+}
+
+static __int64 get64(const unsigned char *ptr)
+
+{
+	return (__int64)((unsigned __int64)get32(ptr) | ((unsigned __int64)get32(ptr + 4) << 32));
+}
+
+///////////////////////////////////////////////////
+//
+// Routine to check if file data is an indexed
+// capture file
+//
+///////////////////////////////////////////////////
+
+int isCapFile(const unsigned char *data, unsigned int length)
+
+{
+	return (length >= CAP_HEADER_LEN + CAP_FOOTER_LEN) &&
+		   (memcmp(data, CAP_MAGIC, CAP_MAGIC_LEN) == 0) &&
+		   (memcmp(data + length - CAP_MAGIC_LEN, CAP_END_MAGIC, CAP_MAGIC_LEN) == 0);
+}
+
+///////////////////////////////////////////////////
+//
+// Routine to expand a compressed block.  Every
+// length and offset is checked, so a damaged file
+// cannot overlay storage.  The expanded length is
+// returned, or -1 if the data is not valid.
+//
+///////////////////////////////////////////////////
+
+int capDecompress(const unsigned char *in, unsigned int inLen, unsigned char *out, unsigned int outLen)
+
+{
+	unsigned int	ip=0;
+	unsigned int	op=0;
+	unsigned int	len;
+	unsigned int	offset;
+	unsigned char	token;
+	unsigned char	b;
+
+	while (ip < inLen)
+	{
+		token = in[ip++];
+
+		// get the literals
+		len = token >> 4;
+		if (15 == len)
+		{
+			do
+			{
+				if (ip >= inLen)
+				{
+					return -1;
+				}
+
+				b = in[ip++];
+				len += b;
+			} while (255 == b);
+		}
+
+		if ((len > inLen - ip) || (len > outLen - op))
+		{
+			return -1;
+		}
+
+		memcpy(out + op, in + ip, len);
+		ip += len;
+		op += len;
+
+		// the last sequence has no match
+		if (ip >= inLen)
+		{
+			break;
+		}
+
+		// get the match
+		if (inLen - ip < 2)
+		{
+			return -1;
+		}
+
+		offset = in[ip] | (in[ip + 1] << 8);
+		ip += 2;
+		if ((0 == offset) || (offset > op))
+		{
+			return -1;
+		}
+
+		len = token & 15;
+		if (15 == len)
+		{
+			do
+			{
+				if (ip >= inLen)
+				{
+					return -1;
+				}
+
+				b = in[ip++];
+				len += b;
+			} while (255 == b);
+		}
+
+		len += CAP_MIN_MATCH;
+		if (len > outLen - op)
+		{
+			return -1;
+		}
+
+		if (offset >= len)
+		{
+			memcpy(out + op, out + op - offset, len);
+			op += len;
+		}
+		else
+		{
+			// the match overlaps the data being produced
+			while (len-- > 0)
+			{
+				out[op] = out[op - offset];
+				op++;
+			}
+		}
+	}
+
+	return (int)op;
+}
+
+///////////////////////////////////////////////////
+//
+// Routine to expand a whole indexed capture file.
+// The messages are returned one after the other
+// in storage that must be released with rfhFree,
+// along with the offset of the end of each
+// message.  NULL is returned if the file is not
+// valid, with the reason in errmsg.
+//
+///////////////////////////////////////////////////
+
+unsigned char * expandCapFile(const unsigned char *data, unsigned int length, unsigned int *rawLen, unsigned int **msgEnds, unsigned int *msgCount, char *errmsg)
+
+{
+	const unsigned char	*footer;
+	const unsigned char	*table;
+	const unsigned char	*index;
+	const unsigned char	*blockPtr;
+	unsigned char		*raw;
+	unsigned int		*ends;
+	__int64				tableOffset;
+	__int64				indexOffset;
+	__int64				blockCount;
+	__int64				count;
+	__int64				rawLength;
+	__int64				fileOffset;
+	__int64				nextOffset;
+	__int64				offset=0;
+	__int64				i;
+	unsigned int		blockSize;
+	unsigned int		limit;
+	unsigned int		packedLen;
+	unsigned int		blockLen;
+
+	if (!isCapFile(data, length) || (get32(data + 8) != CAP_VERSION))
+	{
+		strcpy(errmsg, "Not a supported indexed capture file");
+		return NULL;
+	}
+
+	// get the footer and check it against the file length
+	footer = data + length - CAP_FOOTER_LEN;
+	tableOffset = get64(footer);
+	blockCount = get64(footer + 8);
+	indexOffset = get64(footer + 16);
+	count = get64(footer + 24);
+	rawLength = get64(footer + 32);
+	blockSize = get32(data + 12);
+	limit = length - CAP_FOOTER_LEN;
+
+	if ((blockSize < CAP_BLOCK_MIN) || (blockSize > CAP_BLOCK_MAX) ||
+		(tableOffset < CAP_HEADER_LEN) || (tableOffset > limit) ||
+		(blockCount < 0) || (blockCount > (limit - tableOffset) / CAP_TABLE_LEN) ||
+		(indexOffset != tableOffset + blockCount * CAP_TABLE_LEN) ||
+		(count < 0) || (count > (limit - indexOffset) / CAP_INDEX_LEN) ||
+		(indexOffset + count * CAP_INDEX_LEN != limit) ||
+		(rawLength < 0) || (rawLength > blockCount * blockSize) || (rawLength > 0x7FFFFFFF))
+	{
+		strcpy(errmsg, "Indexed capture file footer is not valid");
+		return NULL;
+	}
+
+	table = data + tableOffset;
+	index = data + indexOffset;
+
+	raw = (unsigned char *)rfhMalloc((size_t)rawLength + 1, "CAPDATA ");
+	ends = (unsigned int *)rfhMalloc((size_t)(count + 1) * sizeof(unsigned int), "CAPENDS ");
+	if ((NULL == raw) || (NULL == ends))
+	{
+		strcpy(errmsg, "Memory allocation failed for indexed capture file");
+		if (raw != NULL) rfhFree(raw);
+		if (ends != NULL) rfhFree(ends);
+		return NULL;
+	}
+
+	// expand the blocks one after the other
+	// all the blocks are full except the last one
+	for (i = 0; i < blockCount; i++)
+	{
+		fileOffset = get64(table + i * CAP_TABLE_LEN);
+		nextOffset = (i + 1 < blockCount) ? get64(table + (i + 1) * CAP_TABLE_LEN) : tableOffset;
+		if ((fileOffset < CAP_HEADER_LEN) || (nextOffset > tableOffset) || (nextOffset - fileOffset < CAP_BLOCK_HDR_LEN))
+		{
+			break;
+		}
+
+		blockPtr = data + fileOffset;
+		packedLen = get32(blockPtr);
+		blockLen = get32(blockPtr + 4);
+		if ((blockLen > blockSize) || ((i + 1 < blockCount) && (blockLen != blockSize)) || (packedLen > blockLen) ||
+			(packedLen > nextOffset - fileOffset - CAP_BLOCK_HDR_LEN) || (blockLen > rawLength - offset))
+		{
+			break;
+		}
+
+		if (packedLen == blockLen)
+		{
+			// the block was stored as it is
+			memcpy(raw + offset, blockPtr + CAP_BLOCK_HDR_LEN, blockLen);
+		}
+		else if (capDecompress(blockPtr + CAP_BLOCK_HDR_LEN, packedLen, raw + offset, blockLen) != (int)blockLen)
+		{
+			break;
+		}
+
+		offset += blockLen;
+	}
+
+	if (offset != rawLength)
+	{
+		sprintf(errmsg, "Indexed capture file block %d is not valid", (int)i);
+		rfhFree(raw);
+		rfhFree(ends);
+		return NULL;
+	}
+
+	raw[offset] = 0;
+
+	// the messages must follow each other in the expanded data
+	offset = 0;
+	for (i = 0; i < count; i++)
+	{
+		if ((get64(index + i * CAP_INDEX_LEN) != offset) || (get32(index + i * CAP_INDEX_LEN + 8) > rawLength - offset))
+		{
+			sprintf(errmsg, "Indexed capture file index entry %d is not valid", (int)i);
+			rfhFree(raw);
+			rfhFree(ends);
+			return NULL;
+		}
+
+		offset += get32(index + i * CAP_INDEX_LEN + 8);
+		ends[i] = (unsigned int)offset;
+	}
+
+	(*rawLen) = (unsigned int)rawLength;
+	(*msgEnds) = ends;
+	(*msgCount) = (unsigned int)count;
+
+	return raw;
+}
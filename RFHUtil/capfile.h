@@ -0,0 +1,40 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+  Jim MacNair - Initial Contribution
+*/
+
+//
+// capfile.h: indexed capture file subroutines header file
+//
+// Indexed capture files are written by mqcapture with the
+// indexedFile option.  The layout is described in
+// mqperf/CommonSubs/capsubs.h.
+//
+//////////////////////////////////////////////////////////////////////
+
+#define CAP_MAGIC			"MQCAPIX1"
+#define CAP_END_MAGIC		"MQCAPEND"
+#define CAP_MAGIC_LEN		8
+#define CAP_VERSION			1
+#define CAP_HEADER_LEN		32
+#define CAP_BLOCK_HDR_LEN	8
+#define CAP_TABLE_LEN		16
+#define CAP_INDEX_LEN		80
+#define CAP_FOOTER_LEN		48
+#define CAP_BLOCK_MIN		(4 * 1024)
+#define CAP_BLOCK_MAX		(64 * 1024 * 1024)
+
+int isCapFile(const unsigned char *data, unsigned int length);
+int capDecompress(const unsigned char *in, unsigned int inLen, unsigned char *out, unsigned int outLen);
+unsigned char * expandCapFile(const unsigned char *data, unsigned int length, unsigned int *rawLen, unsigned int **msgEnds, unsigned int *msgCount, char *errmsg);
@@ -22,6 +22,18 @@ Jim MacNair - Initial Contribution
 #include "rfhutil.h"
 #include "comsubs.h"
 
+// vector instructions are used on x86 processors that support them
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <immintrin.h>
+#define HAVE_SIMD
+#endif
+
+// levels of vector support found at run time
+#define SIMD_NONE		0
+#define SIMD_SSE41		1
+#define SIMD_AVX2		2
+
 #define DUMP_FILE_NAME "c:\\rfhdump.txt"
 #define NUMERIC_PC		0
 
@@ -154,57 +166,6 @@ char getHexCharValue(unsigned char charIn)
 	return result;
 }
 
-///////////////////////////////////
-//
-// Translate from ASCII to Hex
-//
-///////////////////////////////////
-
-void AsciiToHex(const unsigned char *dati, unsigned int pl, unsigned char *dato)
-
-{
-	unsigned int i;
-	unsigned int buffer;
-	char	ch;
-
-	buffer = 0;
-	i = 0;
-	while (buffer < pl)
-	{
-		ch = (unsigned char) dati[buffer] >> 4;
-		ch = HEX_NUMBERS[ch];
-		dato[i++] = ch;
-
-		ch = (unsigned char) dati[buffer] & 0x0F;
-		ch = HEX_NUMBERS[ch];
-		dato[i++] = ch;
-		buffer++;
-	}
-}
-
-///////////////////////////////////
-//
-// Translate from Hex to ASCII
-//
-///////////////////////////////////
-
-void HexToAscii(unsigned char *dati, unsigned int pl, unsigned char *dato)
-
-{
-	unsigned int i;
-	unsigned int buffer;
-	char	ch;
-
-	buffer = 0;
-	i = 0;
-	while (buffer < pl)
-	{
-		ch = getHexCharValue(dati[i++]) << 4;
-		ch += getHexCharValue(dati[i++]);
-		dato[buffer++] = ch;
-	}
-}
-
 char fromHex(char firstchar, char secondchar)
 
 {
@@ -299,6 +260,70 @@ int64_t my_atoi64(const char * valueptr)
 	return result;
 }
 
+#ifdef HAVE_SIMD
+static volatile int	simdLevel=-1;		// level of vector support - set on first use
+
+//////////////////////////////////////////////////////
+//
+// Find out which vector instructions the processor
+// and the operating system support.  Any thread can
+// call this and they all get the same answer, so no
+// locking is needed.
+//
+//////////////////////////////////////////////////////
+
+static int getSimdLevel()
+
+{
+	int		level=SIMD_NONE;
+	int		info[4];
+	int		maxLeaf;
+
+	__cpuid(info, 0);
+	maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	if (info[2] & (1 << 19))
+	{
+		level = SIMD_SSE41;
+	}
+
+	// AVX2 needs the OS to save the YMM registers (OSXSAVE, AVX and XCR0 bits 1 and 2)
+	if ((maxLeaf >= 7) && (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (6 == (_xgetbv(0) & 6)))
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+		{
+			level = SIMD_AVX2;
+		}
+	}
+
+	simdLevel = level;
+	return level;
+}
+
+#endif
+
+//////////////////////////////////////////////////////
+//
+// Translate data using a 256 byte table.  The input
+// and output can be the same area.  A table lookup
+// can not be done faster with vector shuffles, which
+// need 16 of them for each vector of bytes.
+//
+//////////////////////////////////////////////////////
+
+static void xlateData(unsigned char *dato, const unsigned char *dati, unsigned int pl, const unsigned char *table)
+
+{
+	unsigned int	i;
+
+	for (i = 0; i < pl; i++)
+	{
+		dato[i] = table[dati[i]];
+	}
+}
+
 ///////////////////////////////////
 //
 // Translate from ASCII to EBCDIC
@@ -307,42 +332,790 @@ int64_t my_atoi64(const char * valueptr)
 
 void AsciiToEbcdic(unsigned char *dati, unsigned int pl, unsigned char *dato)
 
+{
+	xlateData(dato, dati, pl, aetab);
+}
+
+///////////////////////////////////////////
+//
+// Translate from ASCII to EBCDIC in place
+//
+///////////////////////////////////////////
+
+void AsciiToEbcdicInPlace(unsigned char *data, unsigned int pl)
+
+{
+	xlateData(data, data, pl, aetab);
+}
+
+void convertEbcdic(char *data, int len)
+
+{
+	if (len > 0)
+	{
+		AsciiToEbcdicInPlace((unsigned char *)data, len);
+	}
+}
+
+///////////////////////////////////
+//
+// Translate from EBCDIC to ASCII
+//
+///////////////////////////////////
+
+void EbcdicToAscii(const unsigned char *dati, unsigned int pl, unsigned char *dato)
+
+{
+	xlateData(dato, dati, pl, eatab);
+}
+
+///////////////////////////////////////////
+//
+// Translate from EBCDIC to ASCII in place
+//
+///////////////////////////////////////////
+
+void EbcdicToAsciiInPlace(unsigned char *data, unsigned int pl)
+
+{
+	xlateData(data, data, pl, eatab);
+}
+
+#ifdef HAVE_SIMD
+//////////////////////////////////////////////////////
+//
+// Convert binary data to hex, 16 bytes at a time.
+// The high and low 4 bits of each byte are used to
+// index a register holding the 16 hex digits with a
+// shuffle and the results are interleaved.  Returns
+// the number of bytes converted, which is a
+// multiple of 16.
+//
+//////////////////////////////////////////////////////
+
+static unsigned int hexEncodeSSE41(unsigned char *dato, const unsigned char *dati, unsigned int pl)
+
 {
 	unsigned int	i;
-	int				asciiCcsid=0;	// ASCII code page to use for EBCDIC to ASCII translations
+	__m128i			digits=_mm_loadu_si128((const __m128i *)HEX_NUMBERS);
+	__m128i			nibble=_mm_set1_epi8(0x0F);
+	__m128i			data;
+	__m128i			hi;
+	__m128i			lo;
 
-	for(i=0; i<pl; i++)
+	for (i = 0; i + 16 <= pl; i += 16)
 	{
-		dato[i] = aetab[dati[i]];
+		data = _mm_loadu_si128((const __m128i *)(dati + i));
+		hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(data, 4), nibble));
+		lo = _mm_shuffle_epi8(digits, _mm_and_si128(data, nibble));
+		_mm_storeu_si128((__m128i *)(dato + 2 * i), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i *)(dato + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
 	}
+
+	return i;
 }
 
-void convertEbcdic(char *data, int len)
+//////////////////////////////////////////////////////
+//
+// Same as hexEncodeSSE41 but 32 bytes at a time.
+// The input is permuted first so the interleave,
+// which works within each 16-byte lane, leaves the
+// characters in order.
+//
+//////////////////////////////////////////////////////
+
+static unsigned int hexEncodeAVX2(unsigned char *dato, const unsigned char *dati, unsigned int pl)
+
+{
+	unsigned int	i;
+	__m256i			digits=_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)HEX_NUMBERS));
+	__m256i			nibble=_mm256_set1_epi8(0x0F);
+	__m256i			data;
+	__m256i			hi;
+	__m256i			lo;
+
+	for (i = 0; i + 32 <= pl; i += 32)
+	{
+		data = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(dati + i)), 0xD8);
+		hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(data, 4), nibble));
+		lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(data, nibble));
+		_mm256_storeu_si256((__m256i *)(dato + 2 * i), _mm256_unpacklo_epi8(hi, lo));
+		_mm256_storeu_si256((__m256i *)(dato + 2 * i + 32), _mm256_unpackhi_epi8(hi, lo));
+	}
+
+	_mm256_zeroupper();
+	return i;
+}
+
+//////////////////////////////////////////////////////
+//
+// Return the value of 16 hex characters.  Characters
+// that are not hex digits are given a value of zero,
+// the same as getHexCharValue, and the mask of valid
+// characters is returned in valid.
+//
+//////////////////////////////////////////////////////
+
+static __m128i hexValueSSE41(__m128i chars, __m128i *valid)
+
+{
+	__m128i	digit;
+	__m128i	alpha;
+	__m128i	isDigit;
+	__m128i	isAlpha;
+
+	// upper and lower case letters are made the same by setting the 0x20 bit
+	digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+	alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+	isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+	*valid = _mm_or_si128(isDigit, isAlpha);
+	return _mm_or_si128(_mm_and_si128(isDigit, digit),
+						_mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+//////////////////////////////////////////////////////
+//
+// Return the number of bits that are set.
+//
+//////////////////////////////////////////////////////
+
+static int countBits(unsigned int mask)
+
+{
+	int		count=0;
+
+	while (mask != 0)
+	{
+		mask &= mask - 1;
+		count++;
+	}
+
+	return count;
+}
+
+//////////////////////////////////////////////////////
+//
+// Convert hex characters to binary, 32 characters
+// at a time.  Each pair of values is combined into
+// a byte with a multiply and add.  The number of
+// characters that were not hex digits is added to
+// invalid.  Returns the number of bytes produced,
+// which is a multiple of 16.
+//
+//////////////////////////////////////////////////////
+
+static unsigned int hexDecodeSSE41(unsigned char *dato, const unsigned char *dati, unsigned int pl, int *invalid)
+
+{
+	unsigned int	i;
+	__m128i			weights=_mm_set1_epi16(0x0110);
+	__m128i			first;
+	__m128i			second;
+	__m128i			valid1;
+	__m128i			valid2;
+
+	for (i = 0; i + 16 <= pl; i += 16)
+	{
+		first = hexValueSSE41(_mm_loadu_si128((const __m128i *)(dati + 2 * i)), &valid1);
+		second = hexValueSSE41(_mm_loadu_si128((const __m128i *)(dati + 2 * i + 16)), &valid2);
+
+		// the first character of each pair is multiplied by 16 and added to the second
+		first = _mm_maddubs_epi16(first, weights);
+		second = _mm_maddubs_epi16(second, weights);
+		_mm_storeu_si128((__m128i *)(dato + i), _mm_packus_epi16(first, second));
+
+		if (_mm_movemask_epi8(_mm_and_si128(valid1, valid2)) != 0xFFFF)
+		{
+			*invalid += countBits(~_mm_movemask_epi8(valid1) & 0xFFFF) + countBits(~_mm_movemask_epi8(valid2) & 0xFFFF);
+		}
+	}
+
+	return i;
+}
+
+//////////////////////////////////////////////////////
+//
+// Same as hexValueSSE41 but for 32 characters.
+//
+//////////////////////////////////////////////////////
+
+static __m256i hexValueAVX2(__m256i chars, __m256i *valid)
+
+{
+	__m256i	digit;
+	__m256i	alpha;
+	__m256i	isDigit;
+	__m256i	isAlpha;
+
+	digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+	alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+	isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+	isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+	*valid = _mm256_or_si256(isDigit, isAlpha);
+	return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+						   _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+//////////////////////////////////////////////////////
+//
+// Same as hexDecodeSSE41 but 64 characters at a
+// time.  The pack works within each 16-byte lane,
+// so the result is permuted to put the bytes back
+// in order.
+//
+//////////////////////////////////////////////////////
+
+static unsigned int hexDecodeAVX2(unsigned char *dato, const unsigned char *dati, unsigned int pl, int *invalid)
+
+{
+	unsigned int	i;
+	__m256i			weights=_mm256_set1_epi16(0x0110);
+	__m256i			first;
+	__m256i			second;
+	__m256i			valid1;
+	__m256i			valid2;
+
+	for (i = 0; i + 32 <= pl; i += 32)
+	{
+		first = hexValueAVX2(_mm256_loadu_si256((const __m256i *)(dati + 2 * i)), &valid1);
+		second = hexValueAVX2(_mm256_loadu_si256((const __m256i *)(dati + 2 * i + 32)), &valid2);
+
+		first = _mm256_maddubs_epi16(first, weights);
+		second = _mm256_maddubs_epi16(second, weights);
+		_mm256_storeu_si256((__m256i *)(dato + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8));
+
+		if ((unsigned int)_mm256_movemask_epi8(_mm256_and_si256(valid1, valid2)) != 0xFFFFFFFF)
+		{
+			*invalid += countBits(~(unsigned int)_mm256_movemask_epi8(valid1)) + countBits(~(unsigned int)_mm256_movemask_epi8(valid2));
+		}
+	}
+
+	_mm256_zeroupper();
+	return i;
+}
+
+//////////////////////////////////////////////////////
+//
+// Build the hex and printable columns of a dump line
+// for 16 bytes of data.  The hex characters are
+// produced as for hexEncodeSSE41 and copied out in
+// groups of 8.  Bytes that are not printable are
+// replaced by periods.
+//
+//////////////////////////////////////////////////////
+
+static void dumpLineSSE41(char *hexCols, char *printCols, const unsigned char *data)
+
+{
+	__m128i	digits=_mm_loadu_si128((const __m128i *)HEX_NUMBERS);
+	__m128i	nibble=_mm_set1_epi8(0x0F);
+	__m128i	bytes;
+	__m128i	hi;
+	__m128i	lo;
+	__m128i	printable;
+	char	hex[32];
+
+	bytes = _mm_loadu_si128((const __m128i *)data);
+	hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+	lo = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, nibble));
+	_mm_storeu_si128((__m128i *)hex, _mm_unpacklo_epi8(hi, lo));
+	_mm_storeu_si128((__m128i *)(hex + 16), _mm_unpackhi_epi8(hi, lo));
+
+	memcpy(hexCols, hex, 8);
+	memcpy(hexCols + 9, hex + 8, 8);
+	memcpy(hexCols + 18, hex + 16, 8);
+	memcpy(hexCols + 27, hex + 24, 8);
+
+	// bytes from 0x80 up are negative, so a signed compare excludes them as well
+	printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x7F)));
+	_mm_storeu_si128((__m128i *)printCols, _mm_blendv_epi8(_mm_set1_epi8('.'), bytes, printable));
+}
+#endif
+
+//////////////////////////////////////////////////////
+//
+// Return the level of vector support, checking the
+// processor the first time.
+//
+//////////////////////////////////////////////////////
+
+static int currentSimdLevel()
 
 {
-	unsigned char tempArea[256];
+#ifdef HAVE_SIMD
+	int		level=simdLevel;
 
-	if (len < sizeof(tempArea))
+	if (level < 0)
 	{
-		memcpy(tempArea, data, len);
-		AsciiToEbcdic(tempArea, len, (unsigned char *)data);
+		level = getSimdLevel();
 	}
+
+	return level;
+#else
+	return SIMD_NONE;
+#endif
 }
 
 ///////////////////////////////////
 //
-// Translate from EBCDIC to ASCII
+// Translate from ASCII to Hex
 //
 ///////////////////////////////////
 
-void EbcdicToAscii(const unsigned char *dati, unsigned int pl, unsigned char *dato)
+void AsciiToHex(const unsigned char *dati, unsigned int pl, unsigned char *dato)
+
+{
+	unsigned int i;
+	unsigned int buffer;
+	char	ch;
+	int		level;
+
+	buffer = 0;
+	level = currentSimdLevel();
+#ifdef HAVE_SIMD
+	if (pl >= 16)
+	{
+		if (SIMD_AVX2 == level)
+		{
+			buffer = hexEncodeAVX2(dato, dati, pl);
+		}
+
+		if ((level >= SIMD_SSE41) && (pl - buffer >= 16))
+		{
+			buffer += hexEncodeSSE41(dato + 2 * buffer, dati + buffer, pl - buffer);
+		}
+	}
+#endif
+
+	i = 2 * buffer;
+	while (buffer < pl)
+	{
+		ch = (unsigned char) dati[buffer] >> 4;
+		ch = HEX_NUMBERS[ch];
+		dato[i++] = ch;
+
+		ch = (unsigned char) dati[buffer] & 0x0F;
+		ch = HEX_NUMBERS[ch];
+		dato[i++] = ch;
+		buffer++;
+	}
+}
+
+///////////////////////////////////
+//
+// Translate from Hex to ASCII.
+// pl is the number of bytes to
+// produce.  Characters that are
+// not hex digits are treated as
+// zero.  Returns the number of
+// characters that were not hex
+// digits.
+//
+///////////////////////////////////
+
+int HexToAscii(unsigned char *dati, unsigned int pl, unsigned char *dato)
 
 {
 	unsigned int i;
-	for(i=0;i<pl;i++)
+	unsigned int buffer;
+	char	ch;
+	int		level;
+	int		invalid=0;
+
+	buffer = 0;
+	level = currentSimdLevel();
+#ifdef HAVE_SIMD
+	if (pl >= 16)
 	{
-		dato[i]=eatab[dati[i]];
+		if (SIMD_AVX2 == level)
+		{
+			buffer = hexDecodeAVX2(dato, dati, pl, &invalid);
+		}
+
+		if ((level >= SIMD_SSE41) && (pl - buffer >= 16))
+		{
+			buffer += hexDecodeSSE41(dato + buffer, dati + 2 * buffer, pl - buffer, &invalid);
+		}
 	}
+#endif
+
+	i = 2 * buffer;
+	while (buffer < pl)
+	{
+		if (!isxdigit(dati[i]))
+		{
+			invalid++;
+		}
+
+		if (!isxdigit(dati[i + 1]))
+		{
+			invalid++;
+		}
+
+		ch = getHexCharValue(dati[i++]) << 4;
+		ch += getHexCharValue(dati[i++]);
+		dato[buffer++] = ch;
+	}
+
+	return invalid;
+}
+
+//////////////////////////////////////////////////////
+//
+// Format up to 16 bytes of data as a dump line.  The
+// line has an 8 digit hex offset, the data in hex in
+// groups of 4 bytes and the data as characters, with
+// periods for bytes that are not printable.  Short
+// lines are padded with blanks so the columns line
+// up.  The line must be at least DUMP_LINE_LENGTH + 1
+// bytes long.  Returns the length of the line.
+//
+//////////////////////////////////////////////////////
+
+int formatDumpLine(char *line, const unsigned char *data, unsigned int count, unsigned int offset)
+
+{
+	unsigned int	i;
+	int				j;
+	char *			hexCols=line + 10;
+	char *			printCols=line + 47;
+
+	if (count > DUMP_BYTES_PER_LINE)
+	{
+		count = DUMP_BYTES_PER_LINE;
+	}
+
+	// the offset, most significant digit first
+	for (j = 7; j >= 0; j--)
+	{
+		line[j] = HEX_NUMBERS[offset & 15];
+		offset >>= 4;
+	}
+
+	memset(line + 8, ' ', DUMP_LINE_LENGTH - 8);
+
+#ifdef HAVE_SIMD
+	if ((DUMP_BYTES_PER_LINE == count) && (currentSimdLevel() >= SIMD_SSE41))
+	{
+		dumpLineSSE41(hexCols, printCols, data);
+		line[DUMP_LINE_LENGTH] = 0;
+		return DUMP_LINE_LENGTH;
+	}
+#endif
+
+	for (i = 0; i < count; i++)
+	{
+		// skip a blank after every 4 bytes
+		j = i * 2 + i / 4;
+		hexCols[j] = HEX_NUMBERS[data[i] >> 4];
+		hexCols[j + 1] = HEX_NUMBERS[data[i] & 15];
+
+		if ((data[i] >= ' ') && (data[i] < 127))
+		{
+			printCols[i] = data[i];
+		}
+		else
+		{
+			printCols[i] = '.';
+		}
+	}
+
+	// short lines are not padded past the last character
+	line[47 + count] = 0;
+	return 47 + count;
+}
+
+//////////////////////////////////////////////////////
+//
+// Delimiter search.  Rather than looking for the
+// first byte of the delimiter, which may be common
+// in the data (e.g. a carriage return), the two
+// least common bytes are looked for and only the
+// places where both are found are compared with the
+// whole delimiter.
+//
+//////////////////////////////////////////////////////
+
+#define DELIM_NOT_FOUND		((size_t)-1)
+
+typedef struct {
+	const unsigned char *	delim;
+	size_t					len;
+	size_t					rare1;			// position of the least common byte
+	size_t					rare2;			// position of the next least common byte
+} DELIMSEARCH;
+
+//////////////////////////////////////////////////////
+//
+// Rough guide to how often a byte appears in message
+// data.  Higher values are more common.
+//
+//////////////////////////////////////////////////////
+
+static int byteRank(unsigned char ch)
+
+{
+	switch (ch)
+	{
+	case ' ':
+	case 0:
+		return 10;
+	case 'e': case 't': case 'a': case 'o': case 'i':
+	case 'n': case 's': case 'r': case 'h':
+		return 9;
+	case '\r':
+	case '\n':
+		return 7;
+	case '\t': case ',': case '.': case '"': case '\'':
+	case ':': case ';': case '<': case '>': case '/':
+	case '=': case '-': case '_':
+		return 5;
+	case 0xFF:
+		return 4;
+	}
+
+	if ((ch >= 'a') && (ch <= 'z'))
+	{
+		return 8;
+	}
+
+	if ((ch >= '0') && (ch <= '9'))
+	{
+		return 7;
+	}
+
+	if ((ch >= 'A') && (ch <= 'Z'))
+	{
+		return 6;
+	}
+
+	if ((ch > ' ') && (ch < 0x7F))
+	{
+		return 3;
+	}
+
+	// other control characters and bytes above 0x7F
+	return 1;
+}
+
+static void initDelimSearch(DELIMSEARCH *search, const unsigned char *delim, size_t delimLen)
+
+{
+	size_t	i;
+	int		rank;
+	int		rank1=11;
+	int		rank2=11;
+
+	search->delim = delim;
+	search->len = delimLen;
+	search->rare1 = 0;
+	search->rare2 = 0;
+
+	// find the two least common bytes - later bytes win ties, since they are less likely to start something else
+	for (i = 0; i < delimLen; i++)
+	{
+		rank = byteRank(delim[i]);
+		if (rank <= rank1)
+		{
+			search->rare2 = search->rare1;
+			rank2 = rank1;
+			search->rare1 = i;
+			rank1 = rank;
+		}
+		else if (rank < rank2)
+		{
+			search->rare2 = i;
+			rank2 = rank;
+		}
+	}
+}
+
+#ifdef HAVE_SIMD
+//////////////////////////////////////////////////////
+//
+// Look for the delimiter 16 positions at a time.
+// The two least common bytes of the delimiter are
+// compared with the data at their offsets and the
+// whole delimiter is only compared where both match.
+// Returns the offset of the delimiter, or
+// DELIM_NOT_FOUND with the offset where the search
+// stopped in next.
+//
+//////////////////////////////////////////////////////
+
+static size_t findDelimSSE41(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start, size_t *next)
+
+{
+	size_t			pos=start;
+	size_t			last;
+	unsigned int	mask;
+	unsigned long	bit;
+	__m128i			byte1=_mm_set1_epi8((char)search->delim[search->rare1]);
+	__m128i			byte2=_mm_set1_epi8((char)search->delim[search->rare2]);
+
+	// the loads must stay within the data
+	last = (search->rare1 > search->rare2) ? search->rare1 : search->rare2;
+
+	while (pos + last + 16 <= len)
+	{
+		mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + pos + search->rare1)), byte1),
+											   _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + pos + search->rare2)), byte2)));
+		while (mask != 0)
+		{
+			_BitScanForward(&bit, mask);
+			if ((pos + bit + search->len <= len) && (0 == memcmp(data + pos + bit, search->delim, search->len)))
+			{
+				return pos + bit;
+			}
+
+			mask &= mask - 1;
+		}
+
+		pos += 16;
+	}
+
+	(*next) = pos;
+	return DELIM_NOT_FOUND;
+}
+
+//////////////////////////////////////////////////////
+//
+// Same as findDelimSSE41 but 32 positions at a time.
+//
+//////////////////////////////////////////////////////
+
+static size_t findDelimAVX2(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start, size_t *next)
+
+{
+	size_t			pos=start;
+	size_t			last;
+	unsigned int	mask;
+	unsigned long	bit;
+	__m256i			byte1=_mm256_set1_epi8((char)search->delim[search->rare1]);
+	__m256i			byte2=_mm256_set1_epi8((char)search->delim[search->rare2]);
+
+	last = (search->rare1 > search->rare2) ? search->rare1 : search->rare2;
+
+	while (pos + last + 32 <= len)
+	{
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + pos + search->rare1)), byte1),
+																   _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + pos + search->rare2)), byte2)));
+		while (mask != 0)
+		{
+			_BitScanForward(&bit, mask);
+			if ((pos + bit + search->len <= len) && (0 == memcmp(data + pos + bit, search->delim, search->len)))
+			{
+				_mm256_zeroupper();
+				return pos + bit;
+			}
+
+			mask &= mask - 1;
+		}
+
+		pos += 32;
+	}
+
+	// avoid the penalty for mixing AVX and SSE instructions
+	_mm256_zeroupper();
+
+	(*next) = pos;
+	return DELIM_NOT_FOUND;
+}
+#endif
+
+//////////////////////////////////////////////////////
+//
+// Find the first delimiter at or after the start
+// offset.  The end of the data is searched with
+// memchr for the least common byte.
+//
+//////////////////////////////////////////////////////
+
+static size_t findDelim(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start)
+
+{
+	size_t					pos=start;
+	size_t					found;
+	const unsigned char *	ptr;
+#ifdef HAVE_SIMD
+	int						level;
+
+	level = simdLevel;
+	if (level < 0)
+	{
+		level = getSimdLevel();
+	}
+
+	if (SIMD_AVX2 == level)
+	{
+		found = findDelimAVX2(search, data, len, pos, &pos);
+		if (found != DELIM_NOT_FOUND)
+		{
+			return found;
+		}
+	}
+
+	if (level >= SIMD_SSE41)
+	{
+		found = findDelimSSE41(search, data, len, pos, &pos);
+		if (found != DELIM_NOT_FOUND)
+		{
+			return found;
+		}
+	}
+#endif
+
+	while (pos + search->len <= len)
+	{
+		ptr = (const unsigned char *)memchr(data + pos + search->rare1, search->delim[search->rare1], len - search->len - pos + 1);
+		if (NULL == ptr)
+		{
+			break;
+		}
+
+		found = ptr - data - search->rare1;
+		if ((data[found + search->rare2] == search->delim[search->rare2]) && (0 == memcmp(data + found, search->delim, search->len)))
+		{
+			return found;
+		}
+
+		pos = found + 1;
+	}
+
+	return DELIM_NOT_FOUND;
+}
+
+//////////////////////////////////////////////////////
+//
+// Return a pointer to the first delimiter in the
+// data, or NULL if the data does not contain the
+// whole delimiter.
+//
+//////////////////////////////////////////////////////
+
+const unsigned char * searchDelim(const unsigned char *data, size_t len, const unsigned char *delim, size_t delimLen)
+
+{
+	size_t		found;
+	DELIMSEARCH	search;
+
+	if ((0 == delimLen) || (len < delimLen))
+	{
+		return NULL;
+	}
+
+	initDelimSearch(&search, delim, delimLen);
+	found = findDelim(&search, data, len, 0);
+
+	if (DELIM_NOT_FOUND == found)
+	{
+		return NULL;
+	}
+
+	return data + found;
 }
 
 ///////////////////////////////////////
@@ -749,94 +1522,12 @@ void dumpStr(const char * str)
 void dumpData(char * data, int len)
 
 {
-	int		i;
-	int		j;
-	int		k;
-	int		remaining;
-	int		location=0;
-	int		count;
-	int		buffer=0;
-	char	*offset;
-	unsigned char	ch;
-	char	*hexStr;
-	char	asciiStr[32];
+	int		offset;
 	char	tempLine[128];
 
-	remaining = len;
-	while (remaining > 0)
+	for (offset = 0; offset < len; offset += DUMP_BYTES_PER_LINE)
 	{
-		if (remaining > 16)
-		{
-			count = 16;
-		}
-		else
-		{
-			count = remaining;
-		} // endif 
-
-		// initialize the output strings and buffer offset 
-		offset = data;
-		i = 9;	// initialize variable offset 
-		j = 0;	// initialize variable offset
-		k = 0;	// initialize counter
-
-		// add the offset to the beginning of the line
-		sprintf(tempLine, "%8.8d", location);
-
-		// initialize the next 19 bytes to blanks
-		memset(tempLine + 8, ' ', 19);
-
-		// calculate the next location
-		location += 16;
-
-		// point to the location for the hex part of the display
-		hexStr = tempLine + 27;
-
-		while (k < count)
-		{
-			// insert the next character into the output buffer
-			// Make sure we have a character that can be displayed
-			ch = (unsigned char) data[buffer];
-			if ((ch > ' ') && (ch < 127))
-			{
-				// use the character, since it is printable
-				tempLine[i++] = ch;
-			}
-			else
-			{
-				// replace with a period
-				tempLine[i++] = '.';
-			}
-
-			// get the first part of the hex value
-			ch >>= 4;
-			hexStr[j++] = HEX_NUMBERS[ch];
-
-			// get the second part of the hex value
-			ch = (unsigned char) data[buffer];
-			ch &= 0x0F;
-			hexStr[j++] = HEX_NUMBERS[ch];
-
-			// Go on to the next character 
-			remaining--;
-			buffer++;
-			k++;   // increment counter 
-
-			// Insert a blank for every fourth character 
-			if ((k%4 == 0) && (k < count))
-			{
-				hexStr[j++] = ' ';
-			} // endif 
-
-			// Insert a blank for every eighth character in ASCII string 
-			if (k%8 == 0)
-			{
-				asciiStr[i++] = ' ';
-			} // endif 
-		} // endwhile 
-
-		// terminate the string
-		hexStr[j] = 0;
+		formatDumpLine(tempLine, (unsigned char *)data + offset, len - offset, offset);
 
 		// write the line to the dump file
 		fprintf(df, "%s\n", tempLine);
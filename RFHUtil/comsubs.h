@@ -31,6 +31,10 @@ typedef unsigned __int64 int64_t;
 
 static const unsigned char HEX_NUMBERS[] = "0123456789ABCDEF";
 
+// bytes of data on each line of a dump and the length of a full line
+#define		DUMP_BYTES_PER_LINE		16
+#define		DUMP_LINE_LENGTH		63
+
 ///////////////////////////////////////////////////////////
 //
 // MY_TIME_T
@@ -190,13 +194,17 @@ double DiffTime(MY_TIME_T start, MY_TIME_T end);
 void formatTimeDiffSecs(char * result, double time);
 char getHexCharValue(unsigned char charIn);
 void AsciiToHex(const unsigned char *dati, unsigned int pl, unsigned char *dato);
-void HexToAscii(unsigned char *dati, unsigned int pl, unsigned char *dato);
+int HexToAscii(unsigned char *dati, unsigned int pl, unsigned char *dato);
+int formatDumpLine(char *line, const unsigned char *data, unsigned int count, unsigned int offset);
 char fromHex(char firstchar, char secondchar);
 int checkIfHex(LPCTSTR dataptr, int datalen);
 int charValue(char input);
 int64_t my_atoi64(const char * valueptr);
 void AsciiToEbcdic(unsigned char *dati, unsigned int pl, unsigned char *dato);
 void EbcdicToAscii(const unsigned char *dati, unsigned int pl, unsigned char *dato);
+void AsciiToEbcdicInPlace(unsigned char *data, unsigned int pl);
+void EbcdicToAsciiInPlace(unsigned char *data, unsigned int pl);
+const unsigned char * searchDelim(const unsigned char *data, size_t len, const unsigned char *delim, size_t delimLen);
 void convertEbcdic(char *data, int len);
 int EbcdicCharToAsciiChar(int asciiCcsid, int ebcdicCcsid, const char * input, char * output);
 const char * skipWhiteSpace(const char *start, const char *end);
@@ -106,9 +106,6 @@ static char THIS_FILE[] = __FILE__;
 #define MQ_SERVER_RELEASE	"MQServerRelease"
 #define MQ_VRMF				"VRMF"
 
-// maximum number of bytes displayed on one line when dumping out data areas to the trace file
-#define		MAX_TRACE_BYTES_PER_LINE		32
-
 	static char compileDate[] = "Compiled (" __DATE__ " at " __TIME__ ")";
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1721,14 +1718,7 @@ BOOL CRfhutilApp::isTraceEnabled()
 void CRfhutilApp::dumpTraceData(const char * label, const unsigned char *data, unsigned int length)
 
 {
-	int						i;
-	int						j;
-	int						k;
-	int						remaining;
-	int						count;
-	int						offset=0;
-	const unsigned char	*	ptr=data;
-	const unsigned char	*	asciiptr=data;
+	unsigned int			offset;
 	char					traceLine[256];
 
 	// check if trace is enabled
@@ -1779,93 +1769,16 @@ void CRfhutilApp::dumpTraceData(const char * label, const unsigned char *data, u
 		}
 	}
 
-	// get the number of bytes to output
-	remaining = length;
-	ptr = data;
-	while (remaining > 0)
+	// write the data 16 bytes to a line
+	for (offset = 0; offset < length; offset += DUMP_BYTES_PER_LINE)
 	{
-		// get the number of bytes to output on this line
-		count = remaining;
-		if (count > MAX_TRACE_BYTES_PER_LINE)
-		{
-			count = 32;
-		}
-
-		// build the ascii part of the line
-		// initialize the line to a 4 character offset plus 37 blanks (32 characters of data plus 5 blank delimiters)
-		sprintf(traceLine, "%4.4X", offset);
-		offset += 32;
-		memset(traceLine + 4, ' ', 37);
-
-		// process the individual characters
-		i = 0;
-		j = 5;
-		k = 0;
-		while (i < count)
-		{
-			if ((asciiptr[0] >= ' ') && (asciiptr[0] < 127))
-			{
-				traceLine[j] = asciiptr[0];
-			}
-			else
-			{
-				traceLine[j] = '.';
-			}
-
-			// move on to the next character
-			i++;
-			j++;
-			asciiptr++;
+		formatDumpLine(traceLine, data + offset, length - offset, offset);
 
-			// check if this is the fourth character
-			k++;
-			if (8 == k)
-			{
-				// reset the counter
-				k = 0;
-
-				// skip a blank character
-				j++;
-			}
-		}
-
-		// build the hex part of the line
-		j = 41;							// pointer to the next character location to be added to the line
-		k = count >> 2;					// get the count of whole 4-byte segments
-		for (i=0; i<k; i++)
-		{
-			traceLine[j++] = ' ';		// insert a blank every 4 bytes to make it easier to read
-
-			// get the next 4 bytes as hex characters
-			AsciiToHex(ptr, 4, (unsigned char *)traceLine + j);
-			j += 8;									// 4 bytes becomes 8 characters
-			ptr += 4;								// advance the input pointer 4 bytes
-		}
-
-		// check if there is an odd number of bytes left
-		k = count % 4;
-		if (k > 0)
-		{
-			traceLine[j++] = ' ';
-			AsciiToHex(ptr, k, (unsigned char *)traceLine + j);
-			j += k * 2;								// each byte becomes two hex characters on output
-			ptr += k;								// advance the input pointer
-		}
-
-		// properly terminate the string
-		traceLine[j] = 0;
-
-		//  write trace line to the trace file directly - no need for timestamps
-		if (traceFile != NULL)
-		{
-			// write the trace entry to the trace file
-			fprintf(traceFile, "%s\n", traceLine);
-			fflush(traceFile);
-		}
-
-		// decrement the remaining bytes
-		remaining -= count;
+		// write trace line to the trace file directly - no need for timestamps
+		fprintf(traceFile, "%s\n", traceLine);
 	}
+
+	fflush(traceFile);
 }
 
 ///////////////////////////////////////////////////////////
@@ -0,0 +1,288 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   batchsubs.c - automatic batch size subroutines                 */
+/*                                                                  */
+/*   The best number of messages in a unit of work depends on the   */
+/*   persistence and size of the messages and on how fast the      */
+/*   queue manager can write its log.  When the autoBatch option    */
+/*   is selected the rate is measured over a window of time and     */
+/*   the batch size is changed after each window, keeping on in     */
+/*   the same direction while the rate improves and turning        */
+/*   around with a smaller step when it does not.  The time spent   */
+/*   in MQCMIT is measured at the same time and logged with each    */
+/*   change.                                                        */
+/*                                                                  */
+/*   The batch size is only changed between units of work, so the   */
+/*   callers must only call adjustBatchSize when no messages are    */
+/*   waiting to be committed.                                       */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "batchsubs.h"
+
+/**************************************************************/
+/*                                                            */
+/* Check the limits and get ready for the first window.       */
+/*                                                            */
+/**************************************************************/
+
+void initBatchTune(BATCHTUNE *tune, PUTPARMS *parms, int *batchSize, const char *label)
+
+{
+	memset(tune, 0, sizeof(BATCHTUNE));
+	tune->label = label;
+
+	if (0 == parms->autoBatch)
+	{
+		return;
+	}
+
+	tune->batchMin = parms->batchMin;
+	tune->batchMax = parms->batchMax;
+	tune->windowMs = parms->batchWindow;
+
+	/* make sure the limits are sensible */
+	if (tune->batchMin < 1)
+	{
+		tune->batchMin = 1;
+	}
+
+	if ((tune->batchMax < 1) || (tune->batchMax > MAX_SYNC_ALLOW))
+	{
+		tune->batchMax = MAX_SYNC_ALLOW;
+	}
+
+	if (tune->batchMax < tune->batchMin)
+	{
+		tune->batchMax = tune->batchMin;
+	}
+
+	if (tune->windowMs < BATCH_WINDOW_MIN)
+	{
+		tune->windowMs = BATCH_WINDOW_MIN;
+	}
+
+	/* start with the batch size parameter */
+	if ((*batchSize) < tune->batchMin)
+	{
+		(*batchSize) = tune->batchMin;
+	}
+
+	if ((*batchSize) > tune->batchMax)
+	{
+		(*batchSize) = tune->batchMax;
+	}
+
+	tune->active = 1;
+	tune->direction = 1;
+	tune->factor = BATCH_FIRST_STEP;
+	tune->bestBatch = (*batchSize);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Commit a unit of work and measure how long it took.        */
+/*                                                            */
+/**************************************************************/
+
+void commitBatch(MQHCONN qm, BATCHTUNE *tune, MQLONG *compcode, MQLONG *reason)
+
+{
+	MY_TIME_T	startTime;
+	MY_TIME_T	endTime;
+
+	if (0 == tune->active)
+	{
+		MQCMIT(qm, compcode, reason);
+		return;
+	}
+
+	GetTime(&startTime);
+	MQCMIT(qm, compcode, reason);
+	GetTime(&endTime);
+
+	tune->commitCount++;
+	tune->commitTime += DiffTimeNs(startTime, endTime);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if the batch size is to be changed.  This is called  */
+/* between units of work with the number of messages          */
+/* processed so far.                                          */
+/*                                                            */
+/**************************************************************/
+
+void adjustBatchSize(BATCHTUNE *tune, int *batchSize, int64_t msgCount)
+
+{
+	int			origBatchSize = (*batchSize);
+	int			newBatchSize;
+	int64_t		elapsed;
+	double		rate;
+	double		avgCommit=0.0;
+	MY_TIME_T	now;
+
+	if (0 == tune->active)
+	{
+		return;
+	}
+
+	GetTime(&now);
+
+	/* check if this is the first time through */
+	if (0 == tune->windowStart)
+	{
+		tune->windowStart = now;
+		tune->startCount = msgCount;
+		return;
+	}
+
+	/* wait for the end of the window */
+	elapsed = DiffTime(tune->windowStart, now);
+	if (elapsed < (int64_t)tune->windowMs * 1000)
+	{
+		return;
+	}
+
+	/* get the rate and the average commit time in microseconds */
+	rate = (double)(msgCount - tune->startCount) * 1000000.0 / (double)elapsed;
+	if (tune->commitCount > 0)
+	{
+		avgCommit = (double)tune->commitTime / (double)tune->commitCount / 1000.0;
+	}
+
+	if (rate > tune->bestRate)
+	{
+		tune->bestRate = rate;
+		tune->bestBatch = origBatchSize;
+	}
+
+	/* if the last change did not help turn around and take a smaller step */
+	if ((tune->lastRate > 0.0) && (rate < tune->lastRate * BATCH_BETTER))
+	{
+		tune->direction = -tune->direction;
+		tune->factor = 1.0 + ((tune->factor - 1.0) / 2.0);
+	}
+
+	/* check if the steps are too small to matter */
+	if (tune->factor < BATCH_LAST_STEP)
+	{
+		tune->active = 0;
+		(*batchSize) = tune->bestBatch;
+		Log("%sbatch size converged on %d after %d changes - rate %.0f average commit %.1f microseconds total " FMTI64,
+				tune->label, tune->bestBatch, tune->changes, tune->bestRate, avgCommit, msgCount);
+		return;
+	}
+
+	/* change the batch size by at least one message */
+	if (tune->direction > 0)
+	{
+		newBatchSize = (int)((double)origBatchSize * tune->factor + 0.5);
+		if (newBatchSize <= origBatchSize)
+		{
+			newBatchSize = origBatchSize + 1;
+		}
+	}
+	else
+	{
+		newBatchSize = (int)((double)origBatchSize / tune->factor + 0.5);
+		if (newBatchSize >= origBatchSize)
+		{
+			newBatchSize = origBatchSize - 1;
+		}
+	}
+
+	/* make sure we are within the allowed limits for the batch size */
+	if (newBatchSize < tune->batchMin)
+	{
+		if (origBatchSize != tune->batchMin)
+		{
+			Log("%sbatch size below minimum (%d) - forced to minimum", tune->label, newBatchSize);
+		}
+
+		newBatchSize = tune->batchMin;
+	}
+
+	if (newBatchSize > tune->batchMax)
+	{
+		if (origBatchSize != tune->batchMax)
+		{
+			Log("%sbatch size above maximum (%d) - forced to maximum", tune->label, newBatchSize);
+		}
+
+		newBatchSize = tune->batchMax;
+	}
+
+	/* tell what we did */
+	if (origBatchSize != newBatchSize)
+	{
+		tune->changes++;
+		Log("%sbatch size changed from %d to %d rate %.0f commits " FMTI64 " average commit %.1f microseconds total " FMTI64,
+				tune->label, origBatchSize, newBatchSize, rate, tune->commitCount, avgCommit, msgCount);
+	}
+
+	(*batchSize) = newBatchSize;
+
+	/* start the next window */
+	tune->lastRate = rate;
+	tune->windowStart = now;
+	tune->startCount = msgCount;
+	tune->commitCount = 0;
+	tune->commitTime = 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write out the batch size that was used at the end.         */
+/*                                                            */
+/**************************************************************/
+
+void reportBatchSize(BATCHTUNE *tune, int batchSize)
+
+{
+	/* check if the batch size was being changed */
+	if (0 == tune->windowMs)
+	{
+		return;
+	}
+
+	if (1 == tune->active)
+	{
+		Log("%sfinal batch size %d (not converged) - best rate %.0f with batch size %d", tune->label, batchSize, tune->bestRate, tune->bestBatch);
+	}
+	else
+	{
+		Log("%sfinal batch size %d - converged after %d changes with a rate of %.0f", tune->label, batchSize, tune->changes, tune->bestRate);
+	}
+}
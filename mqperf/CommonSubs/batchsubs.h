@@ -0,0 +1,60 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   batchsubs.h - header file for batchsubs.c                      */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_batchsubs_h
+#define _CommonSubs_batchsubs_h
+
+#define BATCH_FIRST_STEP	2.0		/* first change is to double the batch size */
+#define BATCH_LAST_STEP		1.05	/* stop when the steps are smaller than 5% */
+#define BATCH_BETTER		1.02	/* rate must improve by 2% to keep going */
+
+/**********************************************************/
+/* State of the batch size search for one connection.     */
+/* The batch size is changed by a factor after each       */
+/* window.  When the rate does not improve the search     */
+/* turns around with a smaller factor, until the steps    */
+/* are too small to matter.                               */
+/**********************************************************/
+typedef struct {
+	int			active;				/* still searching */
+	int			batchMin;
+	int			batchMax;
+	int			windowMs;
+	int			direction;			/* 1 for larger batches, -1 for smaller */
+	int			changes;
+	int			bestBatch;			/* batch size with the highest rate */
+	double		factor;				/* size of the next change */
+	double		lastRate;			/* rate in the previous window */
+	double		bestRate;
+	int64_t		startCount;			/* message count at the start of the window */
+	int64_t		commitCount;		/* commits in the window */
+	int64_t		commitTime;			/* nanoseconds in MQCMIT in the window */
+	MY_TIME_T	windowStart;
+	const char	*label;				/* prefix for log messages */
+} BATCHTUNE;
+
+void initBatchTune(BATCHTUNE *tune, PUTPARMS *parms, int *batchSize, const char *label);
+void commitBatch(MQHCONN qm, BATCHTUNE *tune, MQLONG *compcode, MQLONG *reason);
+void adjustBatchSize(BATCHTUNE *tune, int *batchSize, int64_t msgCount);
+void reportBatchSize(BATCHTUNE *tune, int batchSize);
+#endif
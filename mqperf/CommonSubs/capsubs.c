@@ -0,0 +1,978 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   capsubs.c - indexed capture file subroutines                   */
+/*                                                                  */
+/*   Captured messages are stored in fixed size blocks that are     */
+/*   compressed with a simple LZ77 codec (the LZ4 block format),    */
+/*   followed by an index of the messages.  XML and JSON messages   */
+/*   usually compress to a fraction of their size, and any message  */
+/*   can be read without reading the rest of the file.  The layout  */
+/*   of the file is described in capsubs.h.                         */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "writesubs.h"
+#include "capsubs.h"
+
+#define CAP_HASH_BITS		12
+#define CAP_MIN_MATCH		4
+#define CAP_MAX_OFFSET		65535
+#define CAP_LAST_LITERALS	5			/* the last bytes of a block are always literals */
+#define CAP_MATCH_LIMIT		12			/* no match can start this close to the end */
+
+/**************************************************************/
+/*                                                            */
+/* Little endian numbers in the file.                         */
+/*                                                            */
+/**************************************************************/
+
+static void put32(unsigned char *ptr, unsigned int value)
+
+{
+	ptr[0] = (unsigned char)value;
+	ptr[1] = (unsigned char)(value >> 8);
+	ptr[2] = (unsigned char)(value >> 16);
+	ptr[3] = (unsigned char)(value >> 24);
+}
+
+static void put64(unsigned char *ptr, int64_t value)
+
+{
+	put32(ptr, (unsigned int)value);
+	put32(ptr + 4, (unsigned int)(value >> 32));
+}
+
+static unsigned int get32(const unsigned char *ptr)
+
+{
+	return (unsigned int)ptr[0] | ((unsigned int)ptr[1] << 8) | ((unsigned int)ptr[2] << 16) | ((unsigned int)ptr[3] << 24);
+}
+
+static int64_t get64(const unsigned char *ptr)
+
+{
+	return (int64_t)((uint64_t)get32(ptr) | ((uint64_t)get32(ptr + 4) << 32));
+}
+
+static unsigned int read32(const unsigned char *ptr)
+
+{
+	unsigned int	value;
+
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write a literal or match length that does not fit in the   */
+/* token.  Returns the new output position.                   */
+/*                                                            */
+/**************************************************************/
+
+static size_t putLength(unsigned char *out, size_t op, size_t len)
+
+{
+	while (len >= 255)
+	{
+		out[op++] = 255;
+		len -= 255;
+	}
+
+	out[op++] = (unsigned char)len;
+	return op;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write one sequence - a token, the literals and, unless     */
+/* this is the last sequence, the match.  Returns the new     */
+/* output position or 0 if the output area is too small.      */
+/*                                                            */
+/**************************************************************/
+
+static size_t putSequence(unsigned char *out, size_t op, size_t outMax, const unsigned char *lit, size_t litLen, size_t offset, size_t matchLen)
+
+{
+	unsigned char	token;
+
+	/* make sure the worst case will fit */
+	if (op + litLen + (litLen / 255) + (matchLen / 255) + 8 > outMax)
+	{
+		return 0;
+	}
+
+	token = (unsigned char)(((litLen < 15) ? litLen : 15) << 4);
+	if (matchLen > 0)
+	{
+		token |= (unsigned char)((matchLen - CAP_MIN_MATCH < 15) ? matchLen - CAP_MIN_MATCH : 15);
+	}
+
+	out[op++] = token;
+	if (litLen >= 15)
+	{
+		op = putLength(out, op, litLen - 15);
+	}
+
+	memcpy(out + op, lit, litLen);
+	op += litLen;
+
+	if (matchLen > 0)
+	{
+		out[op++] = (unsigned char)offset;
+		out[op++] = (unsigned char)(offset >> 8);
+
+		if (matchLen - CAP_MIN_MATCH >= 15)
+		{
+			op = putLength(out, op, matchLen - CAP_MIN_MATCH - 15);
+		}
+	}
+
+	return op;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Compress a block.  Returns the compressed length, or 0 if  */
+/* the data does not get any smaller, in which case the block */
+/* should be stored as it is.                                 */
+/*                                                            */
+/**************************************************************/
+
+int capCompress(const unsigned char *in, size_t inLen, unsigned char *out, size_t outMax)
+
+{
+	size_t			ip=0;
+	size_t			anchor=0;
+	size_t			op=0;
+	size_t			ref;
+	size_t			matchLen;
+	size_t			limit;
+	unsigned int	seq;
+	unsigned int	h;
+	unsigned int	table[1 << CAP_HASH_BITS];
+
+	if (inLen < CAP_MIN_MATCH)
+	{
+		return 0;
+	}
+
+	/* do not bother trying to compress anything larger than the raw data */
+	if (outMax >= inLen)
+	{
+		outMax = inLen - 1;
+	}
+
+	if (inLen > CAP_MATCH_LIMIT)
+	{
+		memset(table, 0, sizeof(table));
+		limit = inLen - CAP_MATCH_LIMIT;
+
+		while (ip < limit)
+		{
+			seq = read32(in + ip);
+			h = (seq * 2654435761U) >> (32 - CAP_HASH_BITS);
+			ref = table[h];
+			table[h] = (unsigned int)ip;
+
+			if ((ref >= ip) || (ip - ref > CAP_MAX_OFFSET) || (read32(in + ref) != seq))
+			{
+				/* no match - skip faster through data that does not compress */
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			/* extend the match as far as possible */
+			matchLen = CAP_MIN_MATCH;
+			while ((ip + matchLen < inLen - CAP_LAST_LITERALS) && (in[ref + matchLen] == in[ip + matchLen]))
+			{
+				matchLen++;
+			}
+
+			op = putSequence(out, op, outMax, in + anchor, ip - anchor, ip - ref, matchLen);
+			if (0 == op)
+			{
+				return 0;
+			}
+
+			ip += matchLen;
+			anchor = ip;
+		}
+	}
+
+	/* the rest of the data is literals */
+	op = putSequence(out, op, outMax, in + anchor, inLen - anchor, 0, 0);
+
+	return (int)op;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Expand a compressed block.  Every length and offset is     */
+/* checked, so a damaged file cannot cause a storage          */
+/* overlay.  Returns the expanded length or -1 if the data is */
+/* not valid.                                                 */
+/*                                                            */
+/**************************************************************/
+
+int capDecompress(const unsigned char *in, size_t inLen, unsigned char *out, size_t outLen)
+
+{
+	size_t			ip=0;
+	size_t			op=0;
+	size_t			len;
+	size_t			offset;
+	unsigned char	token;
+	unsigned char	b;
+
+	while (ip < inLen)
+	{
+		token = in[ip++];
+
+		/* get the literals */
+		len = token >> 4;
+		if (15 == len)
+		{
+			do
+			{
+				if (ip >= inLen)
+				{
+					return -1;
+				}
+
+				b = in[ip++];
+				len += b;
+			} while (255 == b);
+		}
+
+		if ((len > inLen - ip) || (len > outLen - op))
+		{
+			return -1;
+		}
+
+		memcpy(out + op, in + ip, len);
+		ip += len;
+		op += len;
+
+		/* the last sequence has no match */
+		if (ip >= inLen)
+		{
+			break;
+		}
+
+		/* get the match */
+		if (inLen - ip < 2)
+		{
+			return -1;
+		}
+
+		offset = in[ip] | (in[ip + 1] << 8);
+		ip += 2;
+		if ((0 == offset) || (offset > op))
+		{
+			return -1;
+		}
+
+		len = token & 15;
+		if (15 == len)
+		{
+			do
+			{
+				if (ip >= inLen)
+				{
+					return -1;
+				}
+
+				b = in[ip++];
+				len += b;
+			} while (255 == b);
+		}
+
+		len += CAP_MIN_MATCH;
+		if (len > outLen - op)
+		{
+			return -1;
+		}
+
+		if (offset >= len)
+		{
+			memcpy(out + op, out + op - offset, len);
+			op += len;
+		}
+		else
+		{
+			/* the match overlaps the data being produced */
+			while (len-- > 0)
+			{
+				out[op] = out[op - offset];
+				op++;
+			}
+		}
+	}
+
+	return (int)op;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Make room for more entries in a growing table.             */
+/*                                                            */
+/**************************************************************/
+
+static int growTable(unsigned char **table, int64_t *size, int64_t needed)
+
+{
+	int64_t			newSize;
+	unsigned char	*ptr;
+
+	if (needed <= *size)
+	{
+		return 0;
+	}
+
+	newSize = (*size > 0) ? *size * 2 : 64 * 1024;
+	while (newSize < needed)
+	{
+		newSize *= 2;
+	}
+
+	ptr = (unsigned char *)realloc(*table, (size_t)newSize);
+	if (NULL == ptr)
+	{
+		Log("Unable to allocate " FMTI64 " bytes for capture file index", newSize);
+		return -1;
+	}
+
+	*table = ptr;
+	*size = newSize;
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Compress the current block and pass it to the writer.      */
+/*                                                            */
+/**************************************************************/
+
+static int writeBlock(CAPFILE *cf)
+
+{
+	int				packedLen;
+	unsigned char	*entry;
+
+	if (0 == cf->blockLen)
+	{
+		return 0;
+	}
+
+	/* remember where the block starts */
+	if (growTable(&cf->table, &cf->tableSize, (cf->blockCount + 1) * CAP_TABLE_LEN) != 0)
+	{
+		return -1;
+	}
+
+	entry = cf->table + cf->blockCount * CAP_TABLE_LEN;
+	put64(entry, cf->fileOffset);
+	put64(entry + 8, cf->rawOffset - (int64_t)cf->blockLen);
+	cf->blockCount++;
+
+	/* store the block as it is if it does not compress */
+	packedLen = capCompress(cf->block, cf->blockLen, cf->packed + CAP_BLOCK_HDR_LEN, CAP_COMPRESS_BOUND(cf->blockSize));
+	if (0 == packedLen)
+	{
+		memcpy(cf->packed + CAP_BLOCK_HDR_LEN, cf->block, cf->blockLen);
+		packedLen = (int)cf->blockLen;
+	}
+
+	put32(cf->packed, (unsigned int)packedLen);
+	put32(cf->packed + 4, (unsigned int)cf->blockLen);
+
+	if (writeCaptureData(cf->cw, cf->packed, CAP_BLOCK_HDR_LEN + packedLen) != 0)
+	{
+		return -1;
+	}
+
+	cf->fileOffset += CAP_BLOCK_HDR_LEN + packedLen;
+	cf->blockLen = 0;
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add data to the raw stream, writing each block as it       */
+/* fills up.                                                  */
+/*                                                            */
+/**************************************************************/
+
+static int addRaw(CAPFILE *cf, const unsigned char *data, size_t len)
+
+{
+	size_t	count;
+
+	while (len > 0)
+	{
+		count = cf->blockSize - cf->blockLen;
+		if (count > len)
+		{
+			count = len;
+		}
+
+		memcpy(cf->block + cf->blockLen, data, count);
+		cf->blockLen += count;
+		cf->rawOffset += count;
+		data += count;
+		len -= count;
+
+		if ((cf->blockLen == cf->blockSize) && (writeBlock(cf) != 0))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start an indexed capture file on a capture file writer.    */
+/* The file must be empty, since an indexed file cannot be    */
+/* appended to.                                               */
+/*                                                            */
+/**************************************************************/
+
+CAPFILE * openCapFile(CAPTUREWRITER *cw, size_t blockSize)
+
+{
+	CAPFILE			*cf;
+	unsigned char	header[CAP_HEADER_LEN];
+
+	if (0 == blockSize)
+	{
+		blockSize = CAP_BLOCK_DEFAULT;
+	}
+
+	cf = (CAPFILE *)malloc(sizeof(CAPFILE));
+	if (NULL == cf)
+	{
+		Log("Unable to allocate capture file control block");
+		return NULL;
+	}
+
+	memset(cf, 0, sizeof(CAPFILE));
+	cf->cw = cw;
+	cf->blockSize = blockSize;
+	cf->block = (unsigned char *)malloc(blockSize);
+	cf->packed = (unsigned char *)malloc(CAP_BLOCK_HDR_LEN + CAP_COMPRESS_BOUND(blockSize));
+
+	if ((NULL == cf->block) || (NULL == cf->packed))
+	{
+		Log("Unable to allocate " FMTI64 " bytes for capture file blocks", (int64_t)blockSize);
+		free(cf->block);
+		free(cf->packed);
+		free(cf);
+		return NULL;
+	}
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, CAP_MAGIC, CAP_MAGIC_LEN);
+	put32(header + 8, CAP_VERSION);
+	put32(header + 12, (unsigned int)blockSize);
+
+	if (writeCaptureData(cw, header, sizeof(header)) != 0)
+	{
+		cf->failed = 1;
+	}
+
+	cf->fileOffset = CAP_HEADER_LEN;
+
+	return cf;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add a message to an indexed capture file.  The MQMD is     */
+/* optional.                                                  */
+/*                                                            */
+/**************************************************************/
+
+int addCapMessage(CAPFILE *cf, const void *mqmd, size_t mqmdLen, const char *data, size_t dataLen)
+
+{
+	unsigned char	*entry;
+	const MQMD		*md=(const MQMD *)mqmd;
+
+	if (cf->failed)
+	{
+		return -1;
+	}
+
+	if (growTable(&cf->index, &cf->indexSize, (cf->msgCount + 1) * CAP_INDEX_LEN) != 0)
+	{
+		cf->failed = 1;
+		return -1;
+	}
+
+	entry = cf->index + cf->msgCount * CAP_INDEX_LEN;
+	memset(entry, 0, CAP_INDEX_LEN);
+	put64(entry, cf->rawOffset);
+	put32(entry + 8, (unsigned int)(mqmdLen + dataLen));
+	put32(entry + 12, (unsigned int)mqmdLen);
+
+	if ((md != NULL) && (mqmdLen >= sizeof(MQMD)))
+	{
+		memcpy(entry + 16, md->PutDate, sizeof(md->PutDate));
+		memcpy(entry + 24, md->PutTime, sizeof(md->PutTime));
+		memcpy(entry + 32, md->MsgId, MQ_MSG_ID_LENGTH);
+		memcpy(entry + 56, md->CorrelId, MQ_CORREL_ID_LENGTH);
+	}
+
+	cf->msgCount++;
+
+	if (((mqmdLen > 0) && (addRaw(cf, (const unsigned char *)mqmd, mqmdLen) != 0)) ||
+		(addRaw(cf, (const unsigned char *)data, dataLen) != 0))
+	{
+		cf->failed = 1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write the last block, the block table, the index and the   */
+/* footer and release the storage.  The capture file writer   */
+/* must still be closed by the caller.                        */
+/*                                                            */
+/**************************************************************/
+
+int closeCapFile(CAPFILE *cf, int64_t *rawBytes, int64_t *fileBytes)
+
+{
+	int				rc=0;
+	int64_t			tableOffset;
+	int64_t			indexOffset;
+	unsigned char	footer[CAP_FOOTER_LEN];
+
+	if ((cf->failed) || (writeBlock(cf) != 0))
+	{
+		rc = -1;
+	}
+	else
+	{
+		tableOffset = cf->fileOffset;
+		indexOffset = tableOffset + cf->blockCount * CAP_TABLE_LEN;
+
+		put64(footer, tableOffset);
+		put64(footer + 8, cf->blockCount);
+		put64(footer + 16, indexOffset);
+		put64(footer + 24, cf->msgCount);
+		put64(footer + 32, cf->rawOffset);
+		memcpy(footer + 40, CAP_END_MAGIC, CAP_MAGIC_LEN);
+
+		if ((writeCaptureData(cf->cw, cf->table, (size_t)(cf->blockCount * CAP_TABLE_LEN)) != 0) ||
+			(writeCaptureData(cf->cw, cf->index, (size_t)(cf->msgCount * CAP_INDEX_LEN)) != 0) ||
+			(writeCaptureData(cf->cw, footer, sizeof(footer)) != 0))
+		{
+			rc = -1;
+		}
+
+		cf->fileOffset = indexOffset + cf->msgCount * CAP_INDEX_LEN + CAP_FOOTER_LEN;
+	}
+
+	if (rawBytes != NULL)
+	{
+		*rawBytes = cf->rawOffset;
+	}
+
+	if (fileBytes != NULL)
+	{
+		*fileBytes = cf->fileOffset;
+	}
+
+	free(cf->block);
+	free(cf->packed);
+	free(cf->table);
+	free(cf->index);
+	free(cf);
+
+	return rc;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if file data is an indexed capture file.             */
+/*                                                            */
+/**************************************************************/
+
+int isCapFile(const char *data, size_t length)
+
+{
+	return (length >= CAP_HEADER_LEN + CAP_FOOTER_LEN) &&
+		   (memcmp(data, CAP_MAGIC, CAP_MAGIC_LEN) == 0) &&
+		   (memcmp(data + length - CAP_MAGIC_LEN, CAP_END_MAGIC, CAP_MAGIC_LEN) == 0);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Open an indexed capture file that is in storage.  The      */
+/* footer, block table and index are checked against the      */
+/* length of the file.                                        */
+/*                                                            */
+/**************************************************************/
+
+CAPREADER * openCapReader(const char *data, size_t length)
+
+{
+	CAPREADER			*cr;
+	const unsigned char	*ptr=(const unsigned char *)data;
+	const unsigned char	*footer;
+	int64_t				tableOffset;
+	int64_t				indexOffset;
+	int64_t				blockCount;
+	int64_t				msgCount;
+	int64_t				rawLength;
+	size_t				blockSize;
+	size_t				limit;
+
+	if (!isCapFile(data, length))
+	{
+		Log("Data is not an indexed capture file");
+		return NULL;
+	}
+
+	if (get32(ptr + 8) != CAP_VERSION)
+	{
+		Log("Unsupported indexed capture file version %u", get32(ptr + 8));
+		return NULL;
+	}
+
+	footer = ptr + length - CAP_FOOTER_LEN;
+	tableOffset = get64(footer);
+	blockCount = get64(footer + 8);
+	indexOffset = get64(footer + 16);
+	msgCount = get64(footer + 24);
+	rawLength = get64(footer + 32);
+	blockSize = get32(ptr + 12);
+	limit = length - CAP_FOOTER_LEN;
+
+	if ((blockSize < CAP_BLOCK_MIN) || (blockSize > CAP_BLOCK_MAX) ||
+		(tableOffset < CAP_HEADER_LEN) || (blockCount < 0) || (msgCount < 0) || (rawLength < 0) ||
+		((uint64_t)tableOffset > limit) || ((uint64_t)blockCount > (limit - tableOffset) / CAP_TABLE_LEN) ||
+		(indexOffset != tableOffset + blockCount * CAP_TABLE_LEN) ||
+		((uint64_t)msgCount > (limit - indexOffset) / CAP_INDEX_LEN) ||
+		(indexOffset + msgCount * CAP_INDEX_LEN != (int64_t)limit) ||
+		((uint64_t)rawLength > (uint64_t)blockCount * blockSize))
+	{
+		Log("Indexed capture file footer is not valid");
+		return NULL;
+	}
+
+	cr = (CAPREADER *)malloc(sizeof(CAPREADER));
+	if (NULL == cr)
+	{
+		Log("Unable to allocate capture file reader");
+		return NULL;
+	}
+
+	memset(cr, 0, sizeof(CAPREADER));
+	cr->data = ptr;
+	cr->length = length;
+	cr->blockSize = blockSize;
+	cr->table = ptr + tableOffset;
+	cr->blockCount = blockCount;
+	cr->index = ptr + indexOffset;
+	cr->msgCount = msgCount;
+	cr->rawLength = rawLength;
+	cr->cacheBlock = -1;
+	cr->cache = (unsigned char *)malloc(blockSize);
+
+	if (NULL == cr->cache)
+	{
+		Log("Unable to allocate " FMTI64 " bytes for capture file block", (int64_t)blockSize);
+		free(cr);
+		return NULL;
+	}
+
+	return cr;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return the index entry for message n (from 0).             */
+/*                                                            */
+/**************************************************************/
+
+int getCapIndex(CAPREADER *cr, int64_t n, CAPINDEX *entry)
+
+{
+	const unsigned char	*ptr;
+
+	if ((n < 0) || (n >= cr->msgCount))
+	{
+		return -1;
+	}
+
+	ptr = cr->index + n * CAP_INDEX_LEN;
+	entry->offset = get64(ptr);
+	entry->length = get32(ptr + 8);
+	entry->mqmdLen = get32(ptr + 12);
+	memcpy(entry->putDate, ptr + 16, sizeof(entry->putDate));
+	memcpy(entry->putTime, ptr + 24, sizeof(entry->putTime));
+	memcpy(entry->msgId, ptr + 32, sizeof(entry->msgId));
+	memcpy(entry->correlId, ptr + 56, sizeof(entry->correlId));
+
+	if ((entry->offset < 0) || (entry->offset > cr->rawLength) ||
+		((int64_t)entry->length > cr->rawLength - entry->offset) || (entry->mqmdLen > entry->length))
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Expand one block into the caller's area, which must be at  */
+/* least the block size.  Returns the raw length of the block */
+/* or -1 if the block is not valid.                           */
+/*                                                            */
+/**************************************************************/
+
+static int expandBlock(const unsigned char *data, size_t length, const unsigned char *table, int64_t blockCount, int64_t block, size_t blockSize, unsigned char *out)
+
+{
+	int64_t				fileOffset;
+	int64_t				nextOffset;
+	size_t				packedLen;
+	size_t				rawLen;
+	const unsigned char	*ptr;
+
+	fileOffset = get64(table + block * CAP_TABLE_LEN);
+	nextOffset = (block + 1 < blockCount) ? get64(table + (block + 1) * CAP_TABLE_LEN) : (int64_t)(table - data);
+
+	if ((fileOffset < CAP_HEADER_LEN) || (nextOffset > (int64_t)length) || (nextOffset - fileOffset < CAP_BLOCK_HDR_LEN))
+	{
+		return -1;
+	}
+
+	ptr = data + fileOffset;
+	packedLen = get32(ptr);
+	rawLen = get32(ptr + 4);
+
+	/* all the blocks are full except the last one */
+	if ((rawLen > blockSize) || ((block + 1 < blockCount) && (rawLen != blockSize)) || (packedLen > rawLen) || ((int64_t)packedLen > nextOffset - fileOffset - CAP_BLOCK_HDR_LEN))
+	{
+		return -1;
+	}
+
+	if (packedLen == rawLen)
+	{
+		/* block was stored as it is */
+		memcpy(out, ptr + CAP_BLOCK_HDR_LEN, rawLen);
+		return (int)rawLen;
+	}
+
+	if (capDecompress(ptr + CAP_BLOCK_HDR_LEN, packedLen, out, rawLen) != (int)rawLen)
+	{
+		return -1;
+	}
+
+	return (int)rawLen;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read message n (from 0) into the caller's buffer.  Only    */
+/* the blocks that contain the message are expanded.  Returns */
+/* the length of the message, including the MQMD, or -1.      */
+/*                                                            */
+/**************************************************************/
+
+int readCapMessage(CAPREADER *cr, int64_t n, char *buffer, size_t bufLen)
+
+{
+	CAPINDEX	entry;
+	int64_t		offset;
+	int64_t		block;
+	size_t		start;
+	size_t		count;
+	size_t		copied=0;
+	int			rawLen;
+
+	if (getCapIndex(cr, n, &entry) != 0)
+	{
+		return -1;
+	}
+
+	if (entry.length > bufLen)
+	{
+		return -1;
+	}
+
+	offset = entry.offset;
+	while (copied < entry.length)
+	{
+		block = offset / cr->blockSize;
+		start = (size_t)(offset % cr->blockSize);
+
+		if (block != cr->cacheBlock)
+		{
+			if (block >= cr->blockCount)
+			{
+				return -1;
+			}
+
+			rawLen = expandBlock(cr->data, cr->length, cr->table, cr->blockCount, block, cr->blockSize, cr->cache);
+			if (rawLen < 0)
+			{
+				cr->cacheBlock = -1;
+				return -1;
+			}
+
+			cr->cacheBlock = block;
+			cr->cacheLen = rawLen;
+		}
+
+		if (start >= cr->cacheLen)
+		{
+			return -1;
+		}
+
+		count = cr->cacheLen - start;
+		if (count > entry.length - copied)
+		{
+			count = entry.length - copied;
+		}
+
+		memcpy(buffer + copied, cr->cache + start, count);
+		copied += count;
+		offset += count;
+	}
+
+	return (int)entry.length;
+}
+
+void closeCapReader(CAPREADER *cr)
+
+{
+	free(cr->cache);
+	free(cr);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Expand a whole indexed capture file.  Returns the raw      */
+/* stream, which the caller must free, and the offset of the  */
+/* end of each message in the stream.                         */
+/*                                                            */
+/**************************************************************/
+
+char * expandCapFile(const char *data, size_t length, size_t *rawLen, size_t **msgEnds, size_t *msgCount)
+
+{
+	CAPREADER	*cr;
+	CAPINDEX	entry;
+	char		*raw;
+	size_t		*ends;
+	int64_t		i;
+	int64_t		offset=0;
+	int			len;
+
+	cr = openCapReader(data, length);
+	if (NULL == cr)
+	{
+		return NULL;
+	}
+
+	raw = (char *)malloc((size_t)cr->rawLength + 1);
+	ends = (size_t *)malloc((size_t)(cr->msgCount + 1) * sizeof(size_t));
+
+	if ((NULL == raw) || (NULL == ends))
+	{
+		Log("Unable to allocate " FMTI64 " bytes to expand capture file", cr->rawLength);
+		free(raw);
+		free(ends);
+		closeCapReader(cr);
+		return NULL;
+	}
+
+	/* expand the blocks one after the other */
+	for (i = 0; i < cr->blockCount; i++)
+	{
+		len = expandBlock(cr->data, cr->length, cr->table, cr->blockCount, i, cr->blockSize, cr->cache);
+		if ((len < 0) || (offset + len > cr->rawLength))
+		{
+			break;
+		}
+
+		memcpy(raw + offset, cr->cache, len);
+		offset += len;
+	}
+
+	if (offset != cr->rawLength)
+	{
+		Log("Indexed capture file block " FMTI64 " is not valid", i);
+		free(raw);
+		free(ends);
+		closeCapReader(cr);
+		return NULL;
+	}
+
+	raw[offset] = 0;
+
+	/* the messages must follow each other in the raw stream */
+	offset = 0;
+	for (i = 0; i < cr->msgCount; i++)
+	{
+		if ((getCapIndex(cr, i, &entry) != 0) || (entry.offset != offset))
+		{
+			Log("Indexed capture file index entry " FMTI64 " is not valid", i);
+			free(raw);
+			free(ends);
+			closeCapReader(cr);
+			return NULL;
+		}
+
+		offset += entry.length;
+		ends[i] = (size_t)offset;
+	}
+
+	*rawLen = (size_t)cr->rawLength;
+	*msgEnds = ends;
+	*msgCount = (size_t)cr->msgCount;
+
+	closeCapReader(cr);
+
+	return raw;
+}
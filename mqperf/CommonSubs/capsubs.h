@@ -0,0 +1,130 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   capsubs.h - header file for capsubs.c                          */
+/*                                                                  */
+/*   Layout of an indexed capture file.  All the numbers are        */
+/*   stored little endian.                                          */
+/*                                                                  */
+/*     header      magic, version and raw block size                */
+/*     blocks      compressed length, raw length, data              */
+/*     block table file offset and raw offset of each block         */
+/*     index       one entry for each message                       */
+/*     footer      offsets and counts, followed by a second magic   */
+/*                                                                  */
+/*   The messages (MQMD followed by the message data) are stored    */
+/*   one after the other in a raw stream, which is cut into fixed   */
+/*   size blocks that are compressed separately.  A message can     */
+/*   be found by reading the footer, the index entry and only the   */
+/*   blocks that contain the message.                               */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_capsubs_h
+#define _CommonSubs_capsubs_h
+
+#include "writesubs.h"
+
+#define CAP_MAGIC			"MQCAPIX1"
+#define CAP_END_MAGIC		"MQCAPEND"
+#define CAP_MAGIC_LEN		8
+#define CAP_VERSION			1
+#define CAP_HEADER_LEN		32
+#define CAP_BLOCK_HDR_LEN	8
+#define CAP_TABLE_LEN		16			/* length of one block table entry */
+#define CAP_INDEX_LEN		80			/* length of one index entry */
+#define CAP_FOOTER_LEN		48
+#define CAP_BLOCK_DEFAULT	(256 * 1024)
+#define CAP_BLOCK_MIN		(4 * 1024)
+#define CAP_BLOCK_MAX		(64 * 1024 * 1024)
+
+/* worst case length of a compressed block */
+#define CAP_COMPRESS_BOUND(len)	((len) + ((len) / 255) + 16)
+
+/**********************************************************/
+/* Index entry for one message.  The offset is the offset */
+/* of the message in the raw stream and the length        */
+/* includes the MQMD.                                     */
+/**********************************************************/
+typedef struct {
+	int64_t			offset;
+	unsigned int	length;
+	unsigned int	mqmdLen;
+	char			putDate[8];
+	char			putTime[8];
+	unsigned char	msgId[24];
+	unsigned char	correlId[24];
+} CAPINDEX;
+
+/**********************************************************/
+/* Indexed capture file being written.  The blocks are    */
+/* passed to a capture file writer and the block table    */
+/* and index are written when the file is closed.         */
+/**********************************************************/
+typedef struct {
+	CAPTUREWRITER	*cw;
+	unsigned char	*block;				/* raw data for the current block */
+	size_t			blockSize;
+	size_t			blockLen;
+	unsigned char	*packed;			/* compressed block */
+	int64_t			rawOffset;			/* bytes added to the raw stream */
+	int64_t			fileOffset;			/* bytes written to the file */
+	unsigned char	*table;				/* encoded block table */
+	int64_t			blockCount;
+	int64_t			tableSize;
+	unsigned char	*index;				/* encoded index */
+	int64_t			msgCount;
+	int64_t			indexSize;
+	int				failed;
+} CAPFILE;
+
+/**********************************************************/
+/* Indexed capture file being read.  The whole file must  */
+/* be in storage or mapped.  The most recently expanded   */
+/* block is kept so reading messages in order only        */
+/* expands each block once.                               */
+/**********************************************************/
+typedef struct {
+	const unsigned char	*data;
+	size_t				length;
+	size_t				blockSize;
+	const unsigned char	*table;
+	int64_t				blockCount;
+	const unsigned char	*index;
+	int64_t				msgCount;
+	int64_t				rawLength;
+	unsigned char		*cache;
+	int64_t				cacheBlock;
+	size_t				cacheLen;
+} CAPREADER;
+
+int capCompress(const unsigned char *in, size_t inLen, unsigned char *out, size_t outMax);
+int capDecompress(const unsigned char *in, size_t inLen, unsigned char *out, size_t outLen);
+
+CAPFILE * openCapFile(CAPTUREWRITER *cw, size_t blockSize);
+int addCapMessage(CAPFILE *cf, const void *mqmd, size_t mqmdLen, const char *data, size_t dataLen);
+int closeCapFile(CAPFILE *cf, int64_t *rawBytes, int64_t *fileBytes);
+
+int isCapFile(const char *data, size_t length);
+CAPREADER * openCapReader(const char *data, size_t length);
+int getCapIndex(CAPREADER *cr, int64_t n, CAPINDEX *entry);
+int readCapMessage(CAPREADER *cr, int64_t n, char *buffer, size_t bufLen);
+void closeCapReader(CAPREADER *cr);
+char * expandCapFile(const char *data, size_t length, size_t *rawLen, size_t **msgEnds, size_t *msgCount);
+#endif
@@ -35,9 +35,27 @@ Jim MacNair - Initial Contribution
 #include "int64defs.h"
 
 #include "comsubs.h"
-
-/* maximum number of bytes displayed on one line when dumping out data areas to the trace file */
-#define		MAX_TRACE_BYTES_PER_LINE		32
+#include "thrdsubs.h"
+
+/* vector instructions are used on x86 processors that support them */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_SIMD
+#if defined(__clang__)
+#define TARGET_SSE41	__attribute__((target("sse4.1")))
+#define TARGET_AVX2		__attribute__((target("avx2")))
+#else
+/* the programs are built without optimization, which makes the vector routines slower than a byte loop */
+#define TARGET_SSE41	__attribute__((target("sse4.1"), optimize("O2")))
+#define TARGET_AVX2		__attribute__((target("avx2"), optimize("O2")))
+#endif
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define HAVE_SIMD
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
 
 static const unsigned char HEX_NUMBERS[] = "0123456789ABCDEF";
 static const unsigned char BASE64ENCODE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -114,6 +132,160 @@ static  const unsigned char eatab[] = {  /***** EBCDIC -----> ASCII *****/
 /* file handle used for logging */
 	FILE *	logFile=NULL;
 
+#ifdef HAVE_SIMD
+/* level of vector support - set on first use */
+static volatile int	simdLevel=-1;
+
+/**************************************************************/
+/*                                                            */
+/* Find out which vector instructions the processor and the   */
+/* operating system support.  Any thread can call this and    */
+/* they all get the same answer, so no locking is needed.     */
+/*                                                            */
+/**************************************************************/
+
+static int getSimdLevel()
+
+{
+	int		level=SIMD_NONE;
+#ifdef _MSC_VER
+	int		info[4];
+	int		maxLeaf;
+
+	__cpuid(info, 0);
+	maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	if (info[2] & (1 << 19))
+	{
+		level = SIMD_SSE41;
+	}
+
+	/* AVX2 needs the OS to save the YMM registers (OSXSAVE, AVX and XCR0 bits 1 and 2) */
+	if ((maxLeaf >= 7) && (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (6 == (_xgetbv(0) & 6)))
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+		{
+			level = SIMD_AVX2;
+		}
+	}
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		level = SIMD_AVX2;
+	}
+	else if (__builtin_cpu_supports("sse4.1"))
+	{
+		level = SIMD_SSE41;
+	}
+#endif
+
+	simdLevel = level;
+	return level;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return the level of vector support, checking the processor */
+/* the first time.                                            */
+/*                                                            */
+/**************************************************************/
+
+static int currentSimdLevel()
+
+{
+	int		level=simdLevel;
+
+	if (level < 0)
+	{
+		level = getSimdLevel();
+	}
+
+	return level;
+}
+
+#endif
+
+/**************************************************************/
+/*                                                            */
+/* Translate data using a 256 byte table.  The input and     */
+/* output can be the same area.  A table lookup can not be    */
+/* done faster with vector shuffles, which need 16 of them    */
+/* for each vector of bytes.                                  */
+/*                                                            */
+/**************************************************************/
+
+static void xlateData(unsigned char *dato, const unsigned char *dati, size_t pl, const unsigned char *table)
+
+{
+	size_t	i;
+
+	for (i = 0; i < pl; i++)
+	{
+		dato[i] = table[dati[i]];
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Limit the vector instructions that are used, for example   */
+/* to compare the results or the speed with the byte at a     */
+/* time routines.  Returns the level that will be used.       */
+/*                                                            */
+/**************************************************************/
+
+int limitSimdLevel(int maxLevel)
+
+{
+#ifdef HAVE_SIMD
+	int		level;
+
+	level = getSimdLevel();
+	if (maxLevel < level)
+	{
+		level = maxLevel;
+	}
+
+	simdLevel = level;
+	return level;
+#else
+	return SIMD_NONE;
+#endif
+}
+
+/* asynchronous log ring - must be a power of 2 */
+#define		LOG_RING_SIZE		4096
+#define		LOG_LINE_SIZE		1024
+#define		LOG_IDLE_WAIT		10			/* milliseconds */
+
+/**************************************************************/
+/*                                                            */
+/* Entry in the asynchronous log ring.  The seq field tells   */
+/* who owns the entry.  It is equal to the position of the    */
+/* next record to be stored in the entry while the entry is   */
+/* free, and one more than that once the record is complete.  */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	volatile int64_t	seq;
+	time_t				logTime;
+	int					addCRLF;
+	char				*bigLine;			/* lines that do not fit in text */
+	char				text[LOG_LINE_SIZE];
+} LOGRECORD;
+
+static LOGRECORD *		logRing=NULL;
+static volatile int64_t	logHead=0;			/* next position to be claimed */
+static int64_t			logTail=0;			/* next position to be written */
+static volatile int		logActive=0;
+static volatile int64_t	logInFlight=0;		/* threads in queueLog */
+static volatile int		logStopping=0;
+static int				logFlushSecs=0;		/* 0 = flush every line */
+static THREAD_T			logWriter;
+
 /**************************************************************/
 /*                                                            */
 /* This routine writes information to a log.  If no log       */
@@ -122,10 +294,9 @@ static  const unsigned char eatab[] = {  /***** EBCDIC -----> ASCII *****/
 /*                                                            */
 /**************************************************************/
 
-void writeLog(const int addCRLF, const char * templine)
+static void writeLogLine(const int addCRLF, const char * templine, time_t ltime)
 
 {
-	time_t	ltime;					/* number of seconds since 1/1/70     */
 	struct	tm *today;				/* today's date as a structure        */
 	char	todaysDate[32];
 
@@ -143,109 +314,702 @@ void writeLog(const int addCRLF, const char * templine)
 	{
 		/* get a time stamp as well */
 		memset(todaysDate, 0, sizeof(todaysDate));
-		time(&ltime);
 		today = localtime(&ltime);
 		strftime(todaysDate, sizeof(todaysDate) - 1, "%H.%M.%S", today);
 
-		/* write to the file */
-		if (1 == addCRLF)
-		{
-			fprintf(logFile, "%s %s\n", todaysDate, templine);
-		}
-		else
+		/* write to the file */
+		if (1 == addCRLF)
+		{
+			fprintf(logFile, "%s %s\n", todaysDate, templine);
+		}
+		else
+		{
+			fprintf(logFile, "%s %s", todaysDate, templine);
+		}
+	}
+}
+
+void writeLog(const int addCRLF, const char * templine)
+
+{
+	time_t	ltime;					/* number of seconds since 1/1/70     */
+
+	time(&ltime);
+	writeLogLine(addCRLF, templine, ltime);
+
+	if (logFile != NULL)
+	{
+		/* force the output to the disk */
+		fflush(logFile);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Flush the log output.                                      */
+/*                                                            */
+/**************************************************************/
+
+static void flushLog()
+
+{
+	fflush(stdout);
+
+	if (logFile != NULL)
+	{
+		fflush(logFile);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Log writer thread.  Writes the records in the log ring in  */
+/* the order they were claimed, and flushes the output after  */
+/* each line or at most once every logFlushSecs seconds.      */
+/*                                                            */
+/**************************************************************/
+
+static void logWriterThread(void * arg)
+
+{
+	int			pending=0;
+	time_t		now;
+	time_t		lastFlush;
+	LOGRECORD	*rec;
+
+	time(&lastFlush);
+	for (;;)
+	{
+		rec = logRing + (logTail & (LOG_RING_SIZE - 1));
+		if (rec->seq == logTail + 1)
+		{
+			/* the barrier makes sure the record is complete before it is read */
+			MEMORY_BARRIER();
+			if (rec->bigLine != NULL)
+			{
+				writeLogLine(rec->addCRLF, rec->bigLine, rec->logTime);
+				free(rec->bigLine);
+				rec->bigLine = NULL;
+			}
+			else
+			{
+				writeLogLine(rec->addCRLF, rec->text, rec->logTime);
+			}
+
+			/* give the entry back for the next pass around the ring */
+			MEMORY_BARRIER();
+			rec->seq = logTail + LOG_RING_SIZE;
+			logTail++;
+			pending = 1;
+
+			if (0 == logFlushSecs)
+			{
+				flushLog();
+				pending = 0;
+			}
+			else
+			{
+				/* flush periodically even if the ring never empties */
+				time(&now);
+				if (now - lastFlush >= logFlushSecs)
+				{
+					flushLog();
+					lastFlush = now;
+					pending = 0;
+				}
+			}
+
+			continue;
+		}
+
+		/* the ring is empty or the next record is not complete yet */
+		if (1 == pending)
+		{
+			time(&now);
+			if (now - lastFlush >= logFlushSecs)
+			{
+				flushLog();
+				lastFlush = now;
+				pending = 0;
+			}
+		}
+
+		/* end once every claimed record has been written */
+		if ((1 == logStopping) && (logTail == logHead))
+		{
+			break;
+		}
+
+		sleepThread(LOG_IDLE_WAIT);
+	}
+
+	flushLog();
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add a line to the asynchronous log ring.  Any number of    */
+/* threads can add lines without a lock.  The caller only     */
+/* waits if the writer has fallen a whole ring behind.        */
+/* Returns 1 if the ring has been stopped, in which case the  */
+/* caller must write the line itself.                         */
+/*                                                            */
+/**************************************************************/
+
+static int queueLog(const int addCRLF, const char * szFormat, va_list list)
+
+{
+	int			len;
+	int64_t		pos;
+	va_list		copy;
+	LOGRECORD	*rec;
+
+	/* stopAsyncLog waits until no thread is using the ring */
+	atomicAdd64(&logInFlight, 1);
+	if (0 == logActive)
+	{
+		atomicAdd64(&logInFlight, -1);
+		return 1;
+	}
+
+	/* claim the next position in the ring */
+	pos = atomicAdd64(&logHead, 1) - 1;
+	rec = logRing + (pos & (LOG_RING_SIZE - 1));
+
+	/* wait for the writer to release the entry */
+	while (rec->seq != pos)
+	{
+		sleepThread(1);
+	}
+
+	/* create the line to be logged */
+	va_copy(copy, list);
+	len = vsnprintf(rec->text, sizeof(rec->text), szFormat, list);
+	if (len >= (int)sizeof(rec->text))
+	{
+		/* too long for the entry - keep a copy of the whole line */
+		rec->bigLine = (char *)malloc(len + 1);
+		if (rec->bigLine != NULL)
+		{
+			vsnprintf(rec->bigLine, len + 1, szFormat, copy);
+		}
+	}
+
+	va_end(copy);
+
+	time(&(rec->logTime));
+	rec->addCRLF = addCRLF;
+
+	/* make sure the record is complete before the writer can see it */
+	MEMORY_BARRIER();
+	rec->seq = pos + 1;
+
+	atomicAdd64(&logInFlight, -1);
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Format and write a line on the calling thread.             */
+/*                                                            */
+/**************************************************************/
+
+static void logLine(const int addCRLF, const char * szFormat, va_list list)
+
+{
+	char	templine[32768];		/* hopefully long enough */
+
+	/* create the line to be logged */
+	vsprintf(templine, szFormat, list);
+
+	writeLog(addCRLF, templine);
+}
+
+void Log(const char * szFormat, ...)
+
+{
+	va_list	list;
+
+	va_start(list, szFormat);
+
+	if ((0 == logActive) || (queueLog(1, szFormat, list) != 0))
+	{
+		logLine(1, szFormat, list);
+	}
+
+	va_end(list);
+}
+
+void LogNoCRLF(const char *szFormat, ...)
+
+{
+	va_list	list;
+
+	va_start(list, szFormat);
+
+	if ((0 == logActive) || (queueLog(0, szFormat, list) != 0))
+	{
+		logLine(0, szFormat, list);
+	}
+
+	va_end(list);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start writing log lines on a separate thread.  Lines are   */
+/* flushed after every line if flushSecs is zero, and at      */
+/* most every flushSecs seconds otherwise.  The ring is       */
+/* drained when the program ends.                             */
+/*                                                            */
+/**************************************************************/
+
+int startAsyncLog(int flushSecs)
+
+{
+	int		i;
+
+	/* check if the writer is already running */
+	if (1 == logActive)
+	{
+		return 1;
+	}
+
+	logRing = (LOGRECORD *)malloc(LOG_RING_SIZE * sizeof(LOGRECORD));
+	if (NULL == logRing)
+	{
+		Log("***** unable to allocate storage for log ring");
+		return 2;
+	}
+
+	/* each entry is free for the first pass around the ring */
+	for (i = 0; i < LOG_RING_SIZE; i++)
+	{
+		logRing[i].seq = i;
+		logRing[i].bigLine = NULL;
+	}
+
+	logHead = 0;
+	logTail = 0;
+	logStopping = 0;
+	logFlushSecs = flushSecs;
+
+	if (startThread(&logWriter, logWriterThread, NULL) != 0)
+	{
+		free(logRing);
+		logRing = NULL;
+		return 3;
+	}
+
+	/* make sure the ring is drained however the program ends */
+	atexit(stopAsyncLog);
+
+	MEMORY_BARRIER();
+	logActive = 1;
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write any lines still in the ring and stop the writer.     */
+/* Lines logged after this are written by the caller.         */
+/*                                                            */
+/**************************************************************/
+
+void stopAsyncLog()
+
+{
+	if (0 == logActive)
+	{
+		return;
+	}
+
+	/* send new lines directly to the output */
+	logActive = 0;
+	MEMORY_BARRIER();
+
+	/* wait for threads that are still adding lines - the writer */
+	/* keeps running, so a thread waiting for a full ring can    */
+	/* finish, and the ring is not freed while it is in use      */
+	while (logInFlight != 0)
+	{
+		sleepThread(1);
+	}
+
+	/* tell the writer to finish and wait for it */
+	logStopping = 1;
+	MEMORY_BARRIER();
+	waitThread(logWriter);
+
+	free(logRing);
+	logRing = NULL;
+}
+
+int openLog(const char * fileName)
+
+{
+	int	rc=0;
+
+	/* check if the file is open */
+	if (NULL == logFile)
+	{
+		logFile = fopen(fileName, "a");
+
+		/* check if it worked */
+		if (logFile != NULL)
+		{
+			/* write a line to indicate the start of the log */
+			Log("Log file opened");
+		}
+		else
+		{
+			/* unable to open the file */
+			rc = 2;
+		}
+	}
+	else
+	{
+		/* already open - treat as error */
+		rc = 1;
+	}
+
+	return rc;
+}
+
+void closeLog()
+
+{
+	/* write any lines that are still queued */
+	stopAsyncLog();
+
+	if (logFile != NULL)
+	{
+		fclose(logFile);
+		logFile = NULL;
+	}
+}
+
+#ifdef HAVE_SIMD
+/**************************************************************/
+/*                                                            */
+/* Convert binary data to hex, 16 bytes at a time.  The high  */
+/* and low 4 bits of each byte are used to index a register   */
+/* holding the 16 hex digits with a shuffle and the results   */
+/* are interleaved.  Returns the number of bytes converted,   */
+/* which is a multiple of 16.                                 */
+/*                                                            */
+/**************************************************************/
+
+TARGET_SSE41 static size_t hexEncodeSSE41(unsigned char *dato, const unsigned char *dati, size_t pl)
+
+{
+	size_t	i;
+	__m128i	digits=_mm_loadu_si128((const __m128i *)HEX_NUMBERS);
+	__m128i	nibble=_mm_set1_epi8(0x0F);
+	__m128i	data;
+	__m128i	hi;
+	__m128i	lo;
+
+	for (i = 0; i + 16 <= pl; i += 16)
+	{
+		data = _mm_loadu_si128((const __m128i *)(dati + i));
+		hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(data, 4), nibble));
+		lo = _mm_shuffle_epi8(digits, _mm_and_si128(data, nibble));
+		_mm_storeu_si128((__m128i *)(dato + 2 * i), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i *)(dato + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+
+	return i;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Same as hexEncodeSSE41 but 32 bytes at a time.  The input  */
+/* is permuted first so the interleave, which works within    */
+/* each 16-byte lane, leaves the characters in order.         */
+/*                                                            */
+/**************************************************************/
+
+TARGET_AVX2 static size_t hexEncodeAVX2(unsigned char *dato, const unsigned char *dati, size_t pl)
+
+{
+	size_t	i;
+	__m256i	digits=_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)HEX_NUMBERS));
+	__m256i	nibble=_mm256_set1_epi8(0x0F);
+	__m256i	data;
+	__m256i	hi;
+	__m256i	lo;
+
+	for (i = 0; i + 32 <= pl; i += 32)
+	{
+		data = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(dati + i)), 0xD8);
+		hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(data, 4), nibble));
+		lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(data, nibble));
+		_mm256_storeu_si256((__m256i *)(dato + 2 * i), _mm256_unpacklo_epi8(hi, lo));
+		_mm256_storeu_si256((__m256i *)(dato + 2 * i + 32), _mm256_unpackhi_epi8(hi, lo));
+	}
+
+	return i;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return the value of 16 hex characters.  Characters that    */
+/* are not hex digits are given a value of zero, the same as  */
+/* getHexCharValue, and the mask of valid characters is       */
+/* returned in valid.                                         */
+/*                                                            */
+/**************************************************************/
+
+TARGET_SSE41 static __m128i hexValueSSE41(__m128i chars, __m128i *valid)
+
+{
+	__m128i	digit;
+	__m128i	alpha;
+	__m128i	isDigit;
+	__m128i	isAlpha;
+
+	/* upper and lower case letters are made the same by setting the 0x20 bit */
+	digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+	alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+	isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+	*valid = _mm_or_si128(isDigit, isAlpha);
+	return _mm_or_si128(_mm_and_si128(isDigit, digit),
+						_mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return the number of bits that are set.                    */
+/*                                                            */
+/**************************************************************/
+
+static int countBits(unsigned int mask)
+
+{
+	int		count=0;
+
+	while (mask != 0)
+	{
+		mask &= mask - 1;
+		count++;
+	}
+
+	return count;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Convert hex characters to binary, 32 characters at a time. */
+/* Each pair of values is combined into a byte with a         */
+/* multiply and add.  The number of characters that were not  */
+/* hex digits is added to invalid.  Returns the number of     */
+/* characters converted, which is a multiple of 32.           */
+/*                                                            */
+/**************************************************************/
+
+TARGET_SSE41 static size_t hexDecodeSSE41(unsigned char *dato, const unsigned char *dati, size_t pl, int *invalid)
+
+{
+	size_t	i;
+	__m128i	weights=_mm_set1_epi16(0x0110);
+	__m128i	first;
+	__m128i	second;
+	__m128i	valid1;
+	__m128i	valid2;
+	int		mask;
+
+	for (i = 0; i + 32 <= pl; i += 32)
+	{
+		first = hexValueSSE41(_mm_loadu_si128((const __m128i *)(dati + i)), &valid1);
+		second = hexValueSSE41(_mm_loadu_si128((const __m128i *)(dati + i + 16)), &valid2);
+
+		/* the first character of each pair is multiplied by 16 and added to the second */
+		first = _mm_maddubs_epi16(first, weights);
+		second = _mm_maddubs_epi16(second, weights);
+		_mm_storeu_si128((__m128i *)(dato + i / 2), _mm_packus_epi16(first, second));
+
+		mask = _mm_movemask_epi8(_mm_and_si128(valid1, valid2));
+		if (mask != 0xFFFF)
 		{
-			fprintf(logFile, "%s %s", todaysDate, templine);
+			*invalid += countBits(~_mm_movemask_epi8(valid1) & 0xFFFF) + countBits(~_mm_movemask_epi8(valid2) & 0xFFFF);
 		}
-
-		/* force the output to the disk */
-		fflush(logFile);
 	}
+
+	return i;
 }
 
-void Log(const char * szFormat, ...)
+/**************************************************************/
+/*                                                            */
+/* Same as hexValueSSE41 but for 32 characters.               */
+/*                                                            */
+/**************************************************************/
+
+TARGET_AVX2 static __m256i hexValueAVX2(__m256i chars, __m256i *valid)
 
 {
-	va_list	list;
-	char	templine[32768];		/* hopefully long enough */
+	__m256i	digit;
+	__m256i	alpha;
+	__m256i	isDigit;
+	__m256i	isAlpha;
+
+	digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+	alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+	isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+	isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+	*valid = _mm256_or_si256(isDigit, isAlpha);
+	return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+						   _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
 
-	va_start(list, szFormat);
+/**************************************************************/
+/*                                                            */
+/* Same as hexDecodeSSE41 but 64 characters at a time.  The   */
+/* pack works within each 16-byte lane, so the result is      */
+/* permuted to put the bytes back in order.                   */
+/*                                                            */
+/**************************************************************/
 
-	/* create the line to be logged */
-	vsprintf(templine, szFormat, list);
+TARGET_AVX2 static size_t hexDecodeAVX2(unsigned char *dato, const unsigned char *dati, size_t pl, int *invalid)
 
-	writeLog(1, templine);
+{
+	size_t	i;
+	__m256i	weights=_mm256_set1_epi16(0x0110);
+	__m256i	first;
+	__m256i	second;
+	__m256i	valid1;
+	__m256i	valid2;
 
-	va_end(list);
-}
+	for (i = 0; i + 64 <= pl; i += 64)
+	{
+		first = hexValueAVX2(_mm256_loadu_si256((const __m256i *)(dati + i)), &valid1);
+		second = hexValueAVX2(_mm256_loadu_si256((const __m256i *)(dati + i + 32)), &valid2);
 
-void LogNoCRLF(const char *szFormat, ...)
+		first = _mm256_maddubs_epi16(first, weights);
+		second = _mm256_maddubs_epi16(second, weights);
+		_mm256_storeu_si256((__m256i *)(dato + i / 2), _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8));
 
-{
-	va_list	list;
-	char	templine[32768];		/* hopefully long enough */
+		if ((unsigned int)_mm256_movemask_epi8(_mm256_and_si256(valid1, valid2)) != 0xFFFFFFFF)
+		{
+			*invalid += countBits(~(unsigned int)_mm256_movemask_epi8(valid1)) + countBits(~(unsigned int)_mm256_movemask_epi8(valid2));
+		}
+	}
 
-	va_start(list, szFormat);
+	return i;
+}
 
-	/* create the line to be logged */
-	vsprintf(templine, szFormat, list);
+/**************************************************************/
+/*                                                            */
+/* Build the hex and printable columns of a dump line for 16  */
+/* bytes of data.  The hex characters are produced as for     */
+/* hexEncodeSSE41 and copied out in groups of 8.  Bytes that  */
+/* are not printable are replaced by periods.                 */
+/*                                                            */
+/**************************************************************/
 
-	writeLog(0, templine);
+TARGET_SSE41 static void dumpLineSSE41(char *hexCols, char *printCols, const unsigned char *data)
 
-	va_end(list);
+{
+	__m128i	digits=_mm_loadu_si128((const __m128i *)HEX_NUMBERS);
+	__m128i	nibble=_mm_set1_epi8(0x0F);
+	__m128i	bytes;
+	__m128i	hi;
+	__m128i	lo;
+	__m128i	printable;
+	char	hex[32];
+
+	bytes = _mm_loadu_si128((const __m128i *)data);
+	hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+	lo = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, nibble));
+	_mm_storeu_si128((__m128i *)hex, _mm_unpacklo_epi8(hi, lo));
+	_mm_storeu_si128((__m128i *)(hex + 16), _mm_unpackhi_epi8(hi, lo));
+
+	memcpy(hexCols, hex, 8);
+	memcpy(hexCols + 9, hex + 8, 8);
+	memcpy(hexCols + 18, hex + 16, 8);
+	memcpy(hexCols + 27, hex + 24, 8);
+
+	/* bytes from 0x80 up are negative, so a signed compare excludes them as well */
+	printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x7F)));
+	_mm_storeu_si128((__m128i *)printCols, _mm_blendv_epi8(_mm_set1_epi8('.'), bytes, printable));
 }
+#endif
 
-int openLog(const char * fileName)
+/**************************************************************/
+/*                                                            */
+/* Format up to 16 bytes of data as a dump line.  The line    */
+/* has an 8 digit hex offset, the data in hex in groups of 4  */
+/* bytes and the data as characters, with periods for bytes   */
+/* that are not printable.  Short lines are padded with       */
+/* blanks so the columns line up.  The line must be at least  */
+/* DUMP_LINE_LENGTH + 1 bytes long.  Returns the length of    */
+/* the line.                                                  */
+/*                                                            */
+/**************************************************************/
+
+int formatDumpLine(char *line, const unsigned char *data, size_t count, size_t offset)
 
 {
-	int	rc=0;
+	size_t	i;
+	int		j;
+	char *	hexCols=line + 10;
+	char *	printCols=line + 47;
 
-	/* check if the file is open */
-	if (NULL == logFile)
+	if (count > DUMP_BYTES_PER_LINE)
 	{
-		logFile = fopen(fileName, "a");
-
-		/* check if it worked */
-		if (logFile != NULL)
-		{
-			/* write a line to indicate the start of the log */
-			Log("Log file opened");
-		}
-		else
-		{
-			/* unable to open the file */
-			rc = 2;
-		}
+		count = DUMP_BYTES_PER_LINE;
 	}
-	else
+
+	/* the offset, most significant digit first */
+	for (j = 7; j >= 0; j--)
 	{
-		/* already open - treat as error */
-		rc = 1;
+		line[j] = HEX_NUMBERS[offset & 15];
+		offset >>= 4;
 	}
 
-	return rc;
-}
+	memset(line + 8, ' ', DUMP_LINE_LENGTH - 8);
 
-void closeLog()
+#ifdef HAVE_SIMD
+	if ((DUMP_BYTES_PER_LINE == count) && (currentSimdLevel() >= SIMD_SSE41))
+	{
+		dumpLineSSE41(hexCols, printCols, data);
+		line[DUMP_LINE_LENGTH] = 0;
+		return DUMP_LINE_LENGTH;
+	}
+#endif
 
-{
-	if (logFile != NULL)
+	for (i = 0; i < count; i++)
 	{
-		fclose(logFile);
-		logFile = NULL;
+		/* skip a blank after every 4 bytes */
+		j = (int)(i * 2 + i / 4);
+		hexCols[j] = HEX_NUMBERS[data[i] >> 4];
+		hexCols[j + 1] = HEX_NUMBERS[data[i] & 15];
+
+		if ((data[i] >= ' ') && (data[i] < 127))
+		{
+			printCols[i] = data[i];
+		}
+		else
+		{
+			printCols[i] = '.';
+		}
 	}
+
+	/* short lines are not padded past the last character */
+	line[47 + count] = 0;
+	return (int)(47 + count);
 }
 
 void dumpTraceData(const char * label, const unsigned char *data, unsigned int length)
 
 {
-	int						i;
-	int						j;
-	int						k;
-	int						remaining;
-	int						count;
-	int						offset=0;
-	const unsigned char	*	ptr=data;
-	const unsigned char	*	asciiptr=data;
+	unsigned int			offset;
+	unsigned int			count;
 	char					traceLine[256];
 
 
@@ -285,87 +1049,19 @@ void dumpTraceData(const char * label, const unsigned char *data, unsigned int l
 		length = 32 * 1024;
 	}
 
-	/* get the number of bytes to output */
-	remaining = length;
-	ptr = data;
-	while (remaining > 0)
+	/* write the data 16 bytes to a line */
+	for (offset = 0; offset < length; offset += DUMP_BYTES_PER_LINE)
 	{
-		/* get the number of bytes to output on this line */
-		count = remaining;
-		if (count > MAX_TRACE_BYTES_PER_LINE)
-		{
-			count = 32;
-		}
-
-		/* build the ascii part of the line */
-		/* initialize the line to a 4 character offset plus 37 blanks (32 characters of data plus 5 blank delimiters) */
-		sprintf(traceLine, "%4.4X", offset);
-		offset += 32;
-		memset(traceLine + 4, ' ', 37);
-
-		/* process the individual characters */
-		i = 0;
-		j = 5;
-		k = 0;
-		while (i < count)
-		{
-			if ((asciiptr[0] >= ' ') && (asciiptr[0] < 127))
-			{
-				traceLine[j] = asciiptr[0];
-			}
-			else
-			{
-				traceLine[j] = '.';
-			}
-
-			/* move on to the next character */
-			i++;
-			j++;
-			asciiptr++;
-
-			/* check if this is the fourth character */
-			k++;
-			if (8 == k)
-			{
-				/* reset the counter */
-				k = 0;
-
-				/* skip a blank character */
-				j++;
-			}
-		}
-
-		/* build the hex part of the line */
-		j = 41;							/* pointer to the next character location to be added to the line */
-		k = count >> 2;					/* get the count of whole 4-byte segments */
-		for (i=0; i<k; i++)
-		{
-			traceLine[j++] = ' ';		/* insert a blank every 4 bytes to make it easier to read */
-
-			/* get the next 4 bytes as hex characters */
-			AsciiToHex((unsigned char *)traceLine + j, ptr, 4);
-			j += 8;									/* 4 bytes becomes 8 characters */
-			ptr += 4;								/* advance the input pointer 4 bytes */
-		}
-
-		/* check if there is an odd number of bytes left */
-		k = count % 4;
-		if (k > 0)
+		count = length - offset;
+		if (count > DUMP_BYTES_PER_LINE)
 		{
-			traceLine[j++] = ' ';
-			AsciiToHex((unsigned char *)traceLine + j, ptr, k);
-			j += k * 2;								/* each byte becomes two hex characters on output */
-			ptr += k;								/* advance the input pointer */
+			count = DUMP_BYTES_PER_LINE;
 		}
 
-		/* properly terminate the string */
-		traceLine[j] = 0;
+		formatDumpLine(traceLine, data + offset, count, offset);
 
 		/* write the trace entry to the console */
 		Log("%s", traceLine);
-
-		/* decrement the remaining bytes */
-		remaining -= count;
 	}
 }
 
@@ -488,114 +1184,414 @@ int64_t reverseBytes8(int64_t in)
 
 void AsciiToEbcdic(unsigned char *dato, const unsigned char *dati, size_t pl)
 
+{
+	xlateData(dato, dati, pl, aetab);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Translate from ASCII to EBCDIC in place                    */
+/*                                                            */
+/**************************************************************/
+
+void AsciiToEbcdicInPlace(unsigned char *data, size_t pl)
+
+{
+	xlateData(data, data, pl, aetab);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Translate from EBCDIC to ASCII                             */
+/*                                                            */
+/**************************************************************/
+
+void EbcdicToAscii(const unsigned char *dati, size_t pl, unsigned char *dato)
+
+{
+	xlateData(dato, dati, pl, eatab);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Translate from EBCDIC to ASCII in place                    */
+/*                                                            */
+/**************************************************************/
+
+void EbcdicToAsciiInPlace(unsigned char *data, size_t pl)
+
+{
+	xlateData(data, data, pl, eatab);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return the value of an individual                          */
+/* hexadecimal character                                      */
+/* the returned value should be                               */
+/* between 0 and 15 inclusive.                                */
+/*                                                            */
+/**************************************************************/
+
+char getHexCharValue(unsigned char charIn)
+
+{
+	char	ch;
+	char	result=0;
+
+	if ((charIn > '0') && (charIn <= '9'))
+	{
+		result = charIn & 15;
+	}
+	else
+	{
+		ch = toupper(charIn);
+		if ((ch >= 'A') && (ch <= 'F'))
+		{
+			result = ch - 'A' + 10;
+		}
+	}
+
+	return result;
+}
+
+/**************************************************************/
+/*                                                            */
+/*Translate from ASCII to Hex                                 */
+/*                                                            */
+/**************************************************************/
+
+
+void AsciiToHex(unsigned char *dato, const unsigned char *dati, const unsigned int pl)
+
+{
+	unsigned int i;
+	unsigned int buffer;
+	char	ch;
+#ifdef HAVE_SIMD
+	int		level;
+#endif
+
+	buffer = 0;
+#ifdef HAVE_SIMD
+	if (pl >= 16)
+	{
+		level = currentSimdLevel();
+		if (SIMD_AVX2 == level)
+		{
+			buffer = (unsigned int)hexEncodeAVX2(dato, dati, pl);
+		}
+
+		if ((level >= SIMD_SSE41) && (pl - buffer >= 16))
+		{
+			buffer += (unsigned int)hexEncodeSSE41(dato + 2 * buffer, dati + buffer, pl - buffer);
+		}
+	}
+#endif
+
+	i = 2 * buffer;
+	while (buffer < pl)
+	{
+		ch = (unsigned char) dati[buffer] >> 4;
+		ch = HEX_NUMBERS[ch];
+		dato[i++] = ch;
+
+		ch = (unsigned char) dati[buffer] & 0x0F;
+		ch = HEX_NUMBERS[ch];
+		dato[i++] = ch;
+		buffer++;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Translate from Hex to ASCII.  Characters that are not hex  */
+/* digits are treated as zero.  If there is an odd number of  */
+/* characters the last one becomes the high 4 bits of the     */
+/* last byte.  Returns the number of characters that were not */
+/* hex digits.                                                */
+/*                                                            */
+/**************************************************************/
+
+int HexToAscii(char *dati, size_t pl, char *dato)
+
 {
 	size_t	i;
+	size_t	buffer;
+	char	ch;
+	int		invalid=0;
+#ifdef HAVE_SIMD
+	int		level;
+#endif
+
+	i = 0;
+#ifdef HAVE_SIMD
+	if (pl >= 32)
+	{
+		level = currentSimdLevel();
+		if (SIMD_AVX2 == level)
+		{
+			i = hexDecodeAVX2((unsigned char *)dato, (const unsigned char *)dati, pl, &invalid);
+		}
 
-	for(i=0; i<pl; i++)
+		if ((level >= SIMD_SSE41) && (pl - i >= 32))
+		{
+			i += hexDecodeSSE41((unsigned char *)dato + i / 2, (const unsigned char *)dati + i, pl - i, &invalid);
+		}
+	}
+#endif
+
+	buffer = i / 2;
+	while (i < pl)
 	{
-		dato[i] = aetab[dati[i]];
+		if (!isxdigit((unsigned char) dati[i]))
+		{
+			invalid++;
+		}
+
+		ch = getHexCharValue((unsigned char) dati[i++]) << 4;
+		if (i < pl)
+		{
+			if (!isxdigit((unsigned char) dati[i]))
+			{
+				invalid++;
+			}
+
+			ch += getHexCharValue((unsigned char) dati[i++]);
+		}
+
+		dato[buffer++] = ch;
 	}
+
+	return invalid;
 }
 
+#ifdef HAVE_SIMD
 /**************************************************************/
 /*                                                            */
-/* Translate from EBCDIC to ASCII                             */
+/* Convert binary data to base 64, 12 bytes at a time.  Each  */
+/* group of 3 bytes is shuffled into a 32-bit word and the    */
+/* four 6-bit values are moved into separate bytes with       */
+/* multiplies.  The values are then turned into characters by */
+/* adding an offset for each range (A-Z, a-z, 0-9, + and /).  */
+/* Reads 16 bytes and writes 16 characters at a time, so      */
+/* stops when there is less than that left.  Returns the      */
+/* number of input bytes used, which is a multiple of 12.     */
 /*                                                            */
 /**************************************************************/
 
-void EbcdicToAscii(const unsigned char *dati, size_t pl, unsigned char *dato)
+TARGET_SSE41 static size_t encode64SSE41(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen)
+
+{
+	size_t	i=0;
+	size_t	o=0;
+	__m128i	shuffle=_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	__m128i	offsets=_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+								  '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	__m128i	data;
+	__m128i	values;
+	__m128i	range;
+
+	while ((i + 16 <= len) && (o + 16 <= maxLen))
+	{
+		data = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(input + i)), shuffle);
+
+		/* split each 24 bits into four bytes of 6 bits */
+		values = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(data, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040)),
+							  _mm_mullo_epi16(_mm_and_si128(data, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010)));
 
-{
-	size_t	i;
+		/* 0-25 becomes 13, 26-51 becomes 0, 52-61 become 1-10, 62 is 11 and 63 is 12 */
+		range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+		range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
 
-	for(i=0;i<pl;i++)
-	{
-		dato[i]=eatab[dati[i]];
+		_mm_storeu_si128((__m128i *)(output + o), _mm_add_epi8(values, _mm_shuffle_epi8(offsets, range)));
+		i += 12;
+		o += 16;
 	}
+
+	return i;
 }
 
 /**************************************************************/
 /*                                                            */
-/* Return the value of an individual                          */
-/* hexadecimal character                                      */
-/* the returned value should be                               */
-/* between 0 and 15 inclusive.                                */
+/* Same as encode64SSE41 but 24 bytes at a time.              */
 /*                                                            */
 /**************************************************************/
 
-char getHexCharValue(unsigned char charIn)
+TARGET_AVX2 static size_t encode64AVX2(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen)
 
 {
-	char	ch;
-	char	result=0;
-
-	if ((charIn > '0') && (charIn <= '9'))
-	{
-		result = charIn & 15;
-	}
-	else
+	size_t	i=0;
+	size_t	o=0;
+	__m256i	shuffle=_mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+									 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	__m256i	offsets=_mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+									 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+									 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+									 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	__m256i	data;
+	__m256i	values;
+	__m256i	range;
+
+	/* the second 12 bytes go in the upper half of the register */
+	while ((i + 28 <= len) && (o + 32 <= maxLen))
 	{
-		ch = toupper(charIn);
-		if ((ch >= 'A') && (ch <= 'F'))
-		{
-			result = ch - 'A' + 10;
-		}
+		data = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(input + i))),
+									   _mm_loadu_si128((const __m128i *)(input + i + 12)), 1);
+		data = _mm256_shuffle_epi8(data, shuffle);
+
+		values = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(data, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040)),
+								 _mm256_mullo_epi16(_mm256_and_si256(data, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010)));
+
+		range = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+		range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), values), _mm256_set1_epi8(13)));
+
+		_mm256_storeu_si256((__m256i *)(output + o), _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, range)));
+		i += 24;
+		o += 32;
 	}
 
-	return result;
+	return i;
 }
 
 /**************************************************************/
 /*                                                            */
-/*Translate from ASCII to Hex                                 */
+/* Convert base 64 to binary data, 16 characters at a time.   */
+/* Each character is turned into its 6-bit value by adding an */
+/* offset for its range.  Characters that are not base 64 get */
+/* a value of zero, the same as GetBase64Value.  The values   */
+/* are packed into 3 bytes for every 4 characters with        */
+/* multiply-add instructions.  Stops at a padding character   */
+/* so the byte at a time code can handle the end of the data. */
+/* Writes 16 bytes at a time, so stops when there is less     */
+/* than that left in the output area.  Returns the number of  */
+/* characters used, which is a multiple of 16.                */
 /*                                                            */
 /**************************************************************/
 
-
-void AsciiToHex(unsigned char *dato, const unsigned char *dati, const unsigned int pl)
+TARGET_SSE41 static size_t decode64SSE41(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen)
 
 {
-	unsigned int i;
-	unsigned int buffer;
-	char	ch;
-
-	buffer = 0;
-	i = 0;
-	while (buffer < pl)
+	size_t	i=0;
+	size_t	o=0;
+	__m128i	pack=_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	__m128i	data;
+	__m128i	temp;
+	__m128i	mask;
+	__m128i	valid;
+	__m128i	adjust;
+
+	while ((i + 16 <= len) && (o + 16 <= maxLen))
 	{
-		ch = (unsigned char) dati[buffer] >> 4;
-		ch = HEX_NUMBERS[ch];
-		dato[i++] = ch;
+		data = _mm_loadu_si128((const __m128i *)(input + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8('='))) != 0)
+		{
+			break;
+		}
 
-		ch = (unsigned char) dati[buffer] & 0x0F;
-		ch = HEX_NUMBERS[ch];
-		dato[i++] = ch;
-		buffer++;
+		/* A-Z */
+		temp = _mm_sub_epi8(data, _mm_set1_epi8('A'));
+		valid = _mm_cmpeq_epi8(_mm_min_epu8(temp, _mm_set1_epi8(25)), temp);
+		adjust = _mm_and_si128(valid, _mm_set1_epi8(-'A'));
+
+		/* a-z */
+		temp = _mm_sub_epi8(data, _mm_set1_epi8('a'));
+		mask = _mm_cmpeq_epi8(_mm_min_epu8(temp, _mm_set1_epi8(25)), temp);
+		adjust = _mm_or_si128(adjust, _mm_and_si128(mask, _mm_set1_epi8(26 - 'a')));
+		valid = _mm_or_si128(valid, mask);
+
+		/* 0-9 */
+		temp = _mm_sub_epi8(data, _mm_set1_epi8('0'));
+		mask = _mm_cmpeq_epi8(_mm_min_epu8(temp, _mm_set1_epi8(9)), temp);
+		adjust = _mm_or_si128(adjust, _mm_and_si128(mask, _mm_set1_epi8(52 - '0')));
+		valid = _mm_or_si128(valid, mask);
+
+		/* + and / */
+		mask = _mm_cmpeq_epi8(data, _mm_set1_epi8('+'));
+		adjust = _mm_or_si128(adjust, _mm_and_si128(mask, _mm_set1_epi8(62 - '+')));
+		valid = _mm_or_si128(valid, mask);
+		mask = _mm_cmpeq_epi8(data, _mm_set1_epi8('/'));
+		adjust = _mm_or_si128(adjust, _mm_and_si128(mask, _mm_set1_epi8(63 - '/')));
+		valid = _mm_or_si128(valid, mask);
+
+		temp = _mm_and_si128(_mm_add_epi8(data, adjust), valid);
+
+		/* combine pairs of 6 bits into 12 bits and then pairs of 12 bits into 24 bits */
+		temp = _mm_maddubs_epi16(temp, _mm_set1_epi32(0x01400140));
+		temp = _mm_madd_epi16(temp, _mm_set1_epi32(0x00011000));
+
+		_mm_storeu_si128((__m128i *)(output + o), _mm_shuffle_epi8(temp, pack));
+		i += 16;
+		o += 12;
 	}
+
+	return i;
 }
 
 /**************************************************************/
 /*                                                            */
-/* Translate from Hex to ASCII                                */
+/* Same as decode64SSE41 but 32 characters at a time.         */
 /*                                                            */
 /**************************************************************/
 
-void HexToAscii(char *dati, size_t pl, char *dato)
+TARGET_AVX2 static size_t decode64AVX2(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen)
 
 {
-	size_t	i;
-	int		buffer;
-	char	ch;
-
-	buffer = 0;
-	i = 0;
-	while (i < pl)
+	size_t	i=0;
+	size_t	o=0;
+	__m256i	pack=_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+								  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	__m256i	join=_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+	__m256i	data;
+	__m256i	temp;
+	__m256i	mask;
+	__m256i	valid;
+	__m256i	adjust;
+
+	while ((i + 32 <= len) && (o + 32 <= maxLen))
 	{
-		ch = getHexCharValue((unsigned char) dati[i++]) << 4;
-		ch += getHexCharValue((unsigned char) dati[i++]);
-		dato[buffer++] = ch;
+		data = _mm256_loadu_si256((const __m256i *)(input + i));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, _mm256_set1_epi8('='))) != 0)
+		{
+			break;
+		}
+
+		temp = _mm256_sub_epi8(data, _mm256_set1_epi8('A'));
+		valid = _mm256_cmpeq_epi8(_mm256_min_epu8(temp, _mm256_set1_epi8(25)), temp);
+		adjust = _mm256_and_si256(valid, _mm256_set1_epi8(-'A'));
+
+		temp = _mm256_sub_epi8(data, _mm256_set1_epi8('a'));
+		mask = _mm256_cmpeq_epi8(_mm256_min_epu8(temp, _mm256_set1_epi8(25)), temp);
+		adjust = _mm256_or_si256(adjust, _mm256_and_si256(mask, _mm256_set1_epi8(26 - 'a')));
+		valid = _mm256_or_si256(valid, mask);
+
+		temp = _mm256_sub_epi8(data, _mm256_set1_epi8('0'));
+		mask = _mm256_cmpeq_epi8(_mm256_min_epu8(temp, _mm256_set1_epi8(9)), temp);
+		adjust = _mm256_or_si256(adjust, _mm256_and_si256(mask, _mm256_set1_epi8(52 - '0')));
+		valid = _mm256_or_si256(valid, mask);
+
+		mask = _mm256_cmpeq_epi8(data, _mm256_set1_epi8('+'));
+		adjust = _mm256_or_si256(adjust, _mm256_and_si256(mask, _mm256_set1_epi8(62 - '+')));
+		valid = _mm256_or_si256(valid, mask);
+		mask = _mm256_cmpeq_epi8(data, _mm256_set1_epi8('/'));
+		adjust = _mm256_or_si256(adjust, _mm256_and_si256(mask, _mm256_set1_epi8(63 - '/')));
+		valid = _mm256_or_si256(valid, mask);
+
+		temp = _mm256_and_si256(_mm256_add_epi8(data, adjust), valid);
+		temp = _mm256_maddubs_epi16(temp, _mm256_set1_epi32(0x01400140));
+		temp = _mm256_madd_epi16(temp, _mm256_set1_epi32(0x00011000));
+
+		/* each half has 12 bytes - move them together */
+		temp = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(temp, pack), join);
+
+		_mm256_storeu_si256((__m256i *)(output + o), temp);
+		i += 32;
+		o += 24;
 	}
+
+	return i;
 }
+#endif
 
 /**************************************************************/
 /*                                                            */
@@ -612,6 +1608,31 @@ size_t Encode64(const unsigned char * input, size_t len, unsigned char * output,
 	unsigned char *			out=output;			/* pointer to next output byte */
 	int						index=0;			/* index into encode table */
 	int						index2=0;			/* index into encode table */
+#ifdef HAVE_SIMD
+	size_t					done=0;				/* input bytes converted with vector instructions */
+	int						level;
+
+	/* convert most of the data with vector instructions */
+	if (len >= 16)
+	{
+		level = currentSimdLevel();
+		if (SIMD_AVX2 == level)
+		{
+			done = encode64AVX2(input, len, output, maxLen);
+		}
+
+		if (level >= SIMD_SSE41)
+		{
+			done += encode64SSE41(input + done, len - done, output + (done / 3) * 4, maxLen - (done / 3) * 4);
+		}
+
+		/* the rest is done 3 bytes at a time */
+		in += done;
+		remaining -= done;
+		charsOut = (done / 3) * 4;
+		out += charsOut;
+	}
+#endif
 
 	/* Loop through the input data 3 bytes at a time */
 	while ((remaining > 0) && (charsOut < maxLen))
@@ -782,6 +1803,30 @@ size_t Decode64(const unsigned char * input, size_t len, unsigned char * output,
 	size_t	remaining=len;
 	int		value=0;
 	int		padding;
+#ifdef HAVE_SIMD
+	size_t	done=0;				/* characters converted with vector instructions */
+	int		level;
+
+	/* convert the data up to any padding with vector instructions */
+	if (len >= 16)
+	{
+		level = currentSimdLevel();
+		if (SIMD_AVX2 == level)
+		{
+			done = decode64AVX2(input, len, output, maxLen);
+		}
+
+		if (level >= SIMD_SSE41)
+		{
+			done += decode64SSE41(input + done, len - done, output + (done / 4) * 3, maxLen - (done / 4) * 3);
+		}
+
+		/* the rest is done 4 characters at a time */
+		input += done;
+		remaining -= done;
+		charsOut = (done / 4) * 3;
+	}
+#endif
 
 	/* loop through taking four characters of output at a time */
 	while ((remaining > 0) && (charsOut <= maxLen))
@@ -882,6 +1927,357 @@ size_t Decode64(const unsigned char * input, size_t len, unsigned char * output,
 	return charsOut;
 }
 
+/**************************************************************/
+/*                                                            */
+/* Delimiter search.  Rather than looking for the first byte  */
+/* of the delimiter, which may be common in the data (e.g. a  */
+/* carriage return), the two least common bytes are looked    */
+/* for and only the places where both are found are compared  */
+/* with the whole delimiter.                                  */
+/*                                                            */
+/**************************************************************/
+
+#define		DELIM_NOT_FOUND		((size_t)-1)
+#define		DELIM_OFFSETS		256			/* initial number of entries in an offsets array */
+
+typedef struct {
+	const unsigned char *	delim;
+	size_t					len;
+	size_t					rare1;			/* position of the least common byte */
+	size_t					rare2;			/* position of the next least common byte */
+} DELIMSEARCH;
+
+/**************************************************************/
+/*                                                            */
+/* Rough guide to how often a byte appears in message data.   */
+/* Higher values are more common.                             */
+/*                                                            */
+/**************************************************************/
+
+static int byteRank(unsigned char ch)
+
+{
+	switch (ch)
+	{
+	case ' ':
+	case 0:
+		return 10;
+	case 'e': case 't': case 'a': case 'o': case 'i':
+	case 'n': case 's': case 'r': case 'h':
+		return 9;
+	case '\r':
+	case '\n':
+		return 7;
+	case '\t': case ',': case '.': case '"': case '\'':
+	case ':': case ';': case '<': case '>': case '/':
+	case '=': case '-': case '_':
+		return 5;
+	case 0xFF:
+		return 4;
+	}
+
+	if ((ch >= 'a') && (ch <= 'z'))
+	{
+		return 8;
+	}
+
+	if ((ch >= '0') && (ch <= '9'))
+	{
+		return 7;
+	}
+
+	if ((ch >= 'A') && (ch <= 'Z'))
+	{
+		return 6;
+	}
+
+	if ((ch > ' ') && (ch < 0x7F))
+	{
+		return 3;
+	}
+
+	/* other control characters and bytes above 0x7F */
+	return 1;
+}
+
+static void initDelimSearch(DELIMSEARCH *search, const char *delim, size_t delimLen)
+
+{
+	size_t	i;
+	int		rank;
+	int		rank1=11;
+	int		rank2=11;
+
+	search->delim = (const unsigned char *)delim;
+	search->len = delimLen;
+	search->rare1 = 0;
+	search->rare2 = 0;
+
+	/* find the two least common bytes - later bytes win ties, since they are less likely to start something else */
+	for (i = 0; i < delimLen; i++)
+	{
+		rank = byteRank(search->delim[i]);
+		if (rank <= rank1)
+		{
+			search->rare2 = search->rare1;
+			rank2 = rank1;
+			search->rare1 = i;
+			rank1 = rank;
+		}
+		else if (rank < rank2)
+		{
+			search->rare2 = i;
+			rank2 = rank;
+		}
+	}
+}
+
+#ifdef HAVE_SIMD
+/**************************************************************/
+/*                                                            */
+/* Return the position of the lowest bit that is set.         */
+/*                                                            */
+/**************************************************************/
+
+static int lowBit(unsigned int mask)
+
+{
+#ifdef _MSC_VER
+	unsigned long	bit;
+
+	_BitScanForward(&bit, mask);
+	return (int)bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Look for the delimiter 16 positions at a time.  The two    */
+/* least common bytes of the delimiter are compared with the  */
+/* data at their offsets and the whole delimiter is only      */
+/* compared where both match.  Returns the offset of the      */
+/* delimiter, or DELIM_NOT_FOUND with the offset where the    */
+/* search stopped in next.                                    */
+/*                                                            */
+/**************************************************************/
+
+TARGET_SSE41 static size_t findDelimSSE41(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start, size_t *next)
+
+{
+	size_t			pos=start;
+	size_t			last;
+	unsigned int	mask;
+	int				bit;
+	__m128i			byte1=_mm_set1_epi8((char)search->delim[search->rare1]);
+	__m128i			byte2=_mm_set1_epi8((char)search->delim[search->rare2]);
+
+	/* the loads must stay within the data */
+	last = (search->rare1 > search->rare2) ? search->rare1 : search->rare2;
+
+	while (pos + last + 16 <= len)
+	{
+		mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + pos + search->rare1)), byte1),
+											   _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + pos + search->rare2)), byte2)));
+		while (mask != 0)
+		{
+			bit = lowBit(mask);
+			if ((pos + bit + search->len <= len) && (0 == memcmp(data + pos + bit, search->delim, search->len)))
+			{
+				return pos + bit;
+			}
+
+			mask &= mask - 1;
+		}
+
+		pos += 16;
+	}
+
+	*next = pos;
+	return DELIM_NOT_FOUND;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Same as findDelimSSE41 but 32 positions at a time.         */
+/*                                                            */
+/**************************************************************/
+
+TARGET_AVX2 static size_t findDelimAVX2(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start, size_t *next)
+
+{
+	size_t			pos=start;
+	size_t			last;
+	unsigned int	mask;
+	int				bit;
+	__m256i			byte1=_mm256_set1_epi8((char)search->delim[search->rare1]);
+	__m256i			byte2=_mm256_set1_epi8((char)search->delim[search->rare2]);
+
+	last = (search->rare1 > search->rare2) ? search->rare1 : search->rare2;
+
+	while (pos + last + 32 <= len)
+	{
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + pos + search->rare1)), byte1),
+																   _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + pos + search->rare2)), byte2)));
+		while (mask != 0)
+		{
+			bit = lowBit(mask);
+			if ((pos + bit + search->len <= len) && (0 == memcmp(data + pos + bit, search->delim, search->len)))
+			{
+				return pos + bit;
+			}
+
+			mask &= mask - 1;
+		}
+
+		pos += 32;
+	}
+
+	*next = pos;
+	return DELIM_NOT_FOUND;
+}
+#endif
+
+/**************************************************************/
+/*                                                            */
+/* Find the first delimiter at or after the start offset.     */
+/* The end of the data is searched with memchr for the least  */
+/* common byte.                                               */
+/*                                                            */
+/**************************************************************/
+
+static size_t findDelim(const DELIMSEARCH *search, const unsigned char *data, size_t len, size_t start)
+
+{
+	size_t					pos=start;
+	size_t					found;
+	const unsigned char *	ptr;
+#ifdef HAVE_SIMD
+	int						level;
+
+	level = currentSimdLevel();
+	if (SIMD_AVX2 == level)
+	{
+		found = findDelimAVX2(search, data, len, pos, &pos);
+		if (found != DELIM_NOT_FOUND)
+		{
+			return found;
+		}
+	}
+
+	if (level >= SIMD_SSE41)
+	{
+		found = findDelimSSE41(search, data, len, pos, &pos);
+		if (found != DELIM_NOT_FOUND)
+		{
+			return found;
+		}
+	}
+#endif
+
+	while (pos + search->len <= len)
+	{
+		ptr = (const unsigned char *)memchr(data + pos + search->rare1, search->delim[search->rare1], len - search->len - pos + 1);
+		if (NULL == ptr)
+		{
+			break;
+		}
+
+		found = ptr - data - search->rare1;
+		if ((data[found + search->rare2] == search->delim[search->rare2]) && (0 == memcmp(data + found, search->delim, search->len)))
+		{
+			return found;
+		}
+
+		pos = found + 1;
+	}
+
+	return DELIM_NOT_FOUND;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Return a pointer to the first delimiter in the data, or    */
+/* NULL if the data does not contain the whole delimiter.     */
+/*                                                            */
+/**************************************************************/
+
+const char * searchDelim(const char *data, size_t len, const char *delim, size_t delimLen)
+
+{
+	size_t		found;
+	DELIMSEARCH	search;
+
+	if ((0 == delimLen) || (len < delimLen))
+	{
+		return NULL;
+	}
+
+	initDelimSearch(&search, delim, delimLen);
+	found = findDelim(&search, (const unsigned char *)data, len, 0);
+
+	if (DELIM_NOT_FOUND == found)
+	{
+		return NULL;
+	}
+
+	return data + found;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Find all the delimiters in the data in one pass.  Returns  */
+/* an array with the offset of each delimiter, which must be  */
+/* released with free, and sets count to the number found.    */
+/* Delimiters do not overlap - the search for the next one    */
+/* starts after the end of the previous one.  Returns NULL if */
+/* the array could not be allocated.                          */
+/*                                                            */
+/**************************************************************/
+
+size_t * splitAtDelim(const char *data, size_t len, const char *delim, size_t delimLen, size_t *count)
+
+{
+	size_t		pos=0;
+	size_t		found;
+	size_t		maxCount=DELIM_OFFSETS;
+	size_t *	offsets;
+	size_t *	newOffsets;
+	DELIMSEARCH	search;
+
+	(*count) = 0;
+	offsets = (size_t *)malloc(maxCount * sizeof(size_t));
+	if ((NULL == offsets) || (0 == delimLen))
+	{
+		return offsets;
+	}
+
+	initDelimSearch(&search, delim, delimLen);
+
+	while ((found = findDelim(&search, (const unsigned char *)data, len, pos)) != DELIM_NOT_FOUND)
+	{
+		/* make the array bigger if it is full */
+		if ((*count) == maxCount)
+		{
+			maxCount *= 2;
+			newOffsets = (size_t *)realloc(offsets, maxCount * sizeof(size_t));
+			if (NULL == newOffsets)
+			{
+				free(offsets);
+				return NULL;
+			}
+
+			offsets = newOffsets;
+		}
+
+		offsets[(*count)++] = found;
+		pos = found + delimLen;
+	}
+
+	return offsets;
+}
+
 /**************************************************************/
 /*                                                            */
 /* Remove the leading and trailing quotes if present.         */
@@ -956,7 +2352,11 @@ void editHexParm(const char * parmName,
 	}
 
 	memset(parm, 0, maxsize);
-	HexToAscii(valueptr, len, parm);
+	if (HexToAscii(valueptr, len, parm) > 0)
+	{
+		/* characters that are not hex digits are treated as zero */
+		printf("*****Error - %s contains characters that are not hex digits - %s\n", parmName, valueptr);
+	}
 }
 
 int checkHexParm(const char * parmName,
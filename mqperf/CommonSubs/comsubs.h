@@ -22,11 +22,23 @@ Jim MacNair - Initial Contribution
 #ifndef _CommonSubs_comsubs_h
 #define _CommonSubs_comsubs_h
 
+/* levels of vector instructions used by the data conversion routines */
+#define		SIMD_NONE		0
+#define		SIMD_SSE41		1
+#define		SIMD_AVX2		2
+
+/* bytes of data on each line of a dump and the length of a full line */
+#define		DUMP_BYTES_PER_LINE		16
+#define		DUMP_LINE_LENGTH		63
+
 void Log(const char *szFormat, ...);
 void LogNoCRLF(const char *szFormat, ...);
 int openLog(const char * fileName);
 void closeLog();
+int startAsyncLog(int flushSecs);
+void stopAsyncLog();
 void dumpTraceData(const char * label, const unsigned char *data, unsigned int length);
+int formatDumpLine(char *line, const unsigned char *data, size_t count, size_t offset);
 char * skipBlanks(char *str);
 char * findBlank(char *str);
 void strupper(char *str);
@@ -35,10 +47,15 @@ unsigned int iStrLen(const char * ptr);
 int reverseBytes4(int var);
 void AsciiToEbcdic(unsigned char *dato, const unsigned char *dati, size_t pl);
 void EbcdicToAscii(const unsigned char *dati, size_t pl, unsigned char *dato);
+void AsciiToEbcdicInPlace(unsigned char *data, size_t pl);
+void EbcdicToAsciiInPlace(unsigned char *data, size_t pl);
+int limitSimdLevel(int maxLevel);
 void AsciiToHex(unsigned char *dato, const unsigned char *dati, const unsigned int pl);
-void HexToAscii(char *dati, size_t pl, char *dato);
+int HexToAscii(char *dati, size_t pl, char *dato);
 size_t Encode64(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen, int padding);
 size_t Decode64(const unsigned char * input, size_t len, unsigned char * output, size_t maxLen);
+const char * searchDelim(const char *data, size_t len, const char *delim, size_t delimLen);
+size_t * splitAtDelim(const char *data, size_t len, const char *delim, size_t delimLen, size_t *count);
 char * removeQuotes(char *dati);
 int64_t reverseBytes8(int64_t in);
 void reverseBytes24(unsigned char *in, unsigned char *out);
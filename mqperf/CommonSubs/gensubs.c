@@ -0,0 +1,816 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   gensubs.c - generated message data subroutines                 */
+/*                                                                  */
+/*   Builds a pool of messages when the program starts, so a size   */
+/*   distribution can be tested without writing thousands of data   */
+/*   files.  The sizes can be fixed, uniform, normal, lognormal or  */
+/*   taken from a histogram file, and the data can be random bytes  */
+/*   (which do not compress), text or a repeated sentence.  A       */
+/*   template file can give the text around the generated data.    */
+/*                                                                  */
+/*   All the messages are generated one after the other in a       */
+/*   single buffer, with the offset of the end of each message,     */
+/*   in the same way as an expanded indexed capture file.  The      */
+/*   same seed always produces the same messages.                   */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "math.h"
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "gensubs.h"
+
+#define GEN_PI				3.14159265358979323846
+#define GEN_RAND_DIGITS		10
+
+/* types of template pieces */
+#define GEN_PIECE_TEXT		0
+#define GEN_PIECE_SEQ		1
+#define GEN_PIECE_SIZE		2
+#define GEN_PIECE_RAND		3
+#define GEN_PIECE_DATA		4
+
+static const char * genWords[] = {
+	"account", "amount", "balance", "branch", "customer", "date", "order", "payment",
+	"price", "product", "quantity", "reference", "status", "the", "and", "of",
+	"to", "for", "with", "new", "open", "closed", "pending", "shipped",
+	"invoice", "transfer", "currency", "total", "item", "address", "city", "region" };
+
+#define GEN_WORD_COUNT		(sizeof(genWords) / sizeof(genWords[0]))
+#define GEN_SENTENCE		"The quick brown fox jumps over the lazy dog. "
+
+/**********************************************************/
+/* One line of a histogram file.  Sizes between low and   */
+/* high are equally likely.  The weights are kept as a    */
+/* running total so a line can be found with a binary     */
+/* search.                                                */
+/**********************************************************/
+typedef struct {
+	size_t		low;
+	size_t		high;
+	double		total;
+} GENHIST;
+
+/**********************************************************/
+/* Piece of a template - either literal text or one of   */
+/* the placeholders.                                      */
+/**********************************************************/
+typedef struct {
+	int			type;
+	const char	*text;
+	size_t		len;
+} GENPIECE;
+
+typedef struct {
+	PUTPARMS	*parms;
+	uint64_t	seed;
+	GENHIST		*hist;
+	int			histCount;
+	char		*tmpl;
+	GENPIECE	*pieces;
+	int			pieceCount;
+	size_t		textLen;			/* length of the literal text in the template */
+	int			seqCount;			/* number of each placeholder in the template */
+	int			sizeCount;
+	int			randCount;
+	int			dataCount;
+} GENSTATE;
+
+/**************************************************************/
+/*                                                            */
+/* Random numbers (xorshift64*).  The C library rand function */
+/* only returns 15 bits on Windows.                           */
+/*                                                            */
+/**************************************************************/
+
+static uint64_t nextRandom(uint64_t *state)
+
+{
+	uint64_t	x=*state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	(*state) = x;
+
+	return x * (((uint64_t)0x2545F491 << 32) | 0x4F6CDD1D);
+}
+
+/* random number that is at least zero and less than one */
+static double randomFraction(uint64_t *state)
+
+{
+	return (double)(nextRandom(state) >> 11) / 9007199254740992.0;
+}
+
+/* random number from the standard normal distribution (Box-Muller) */
+static double randomNormal(uint64_t *state)
+
+{
+	double	u1;
+	double	u2;
+
+	u1 = 1.0 - randomFraction(state);
+	u2 = randomFraction(state);
+
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * GEN_PI * u2);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read a histogram file.  Each line has a message size, or   */
+/* a range of sizes such as 1000-2000, followed by a weight.  */
+/* The weight is 1 if it is left out.  For example, a file    */
+/* with the lines                                             */
+/*                                                            */
+/*   512 70                                                   */
+/*   4096-8192 25                                             */
+/*   1048576 5                                                */
+/*                                                            */
+/* makes 70% of the messages 512 bytes long.  Blank lines and */
+/* lines that start with *, # or ; are ignored.               */
+/*                                                            */
+/**************************************************************/
+
+static int readHistFile(GENSTATE *gs)
+
+{
+	FILE	*histFile;
+	char	*ptr;
+	char	*endPtr;
+	double	weight;
+	double	total=0.0;
+	size_t	low;
+	size_t	high;
+	size_t	len;
+	int		lineNo=0;
+	char	line[256];
+
+	histFile = fopen(gs->parms->genHistFile, "r");
+	if (NULL == histFile)
+	{
+		Log("***** unable to open histogram file %s", gs->parms->genHistFile);
+		return -1;
+	}
+
+	gs->hist = (GENHIST *)malloc(GEN_MAX_HIST * sizeof(GENHIST));
+	if (NULL == gs->hist)
+	{
+		Log("***** unable to allocate storage for histogram file %s", gs->parms->genHistFile);
+		fclose(histFile);
+		return -1;
+	}
+
+	while ((fgets(line, sizeof(line), histFile) != NULL) && (gs->histCount < GEN_MAX_HIST))
+	{
+		lineNo++;
+
+		/* get rid of the new line character */
+		len = strlen(line);
+		while ((len > 0) && (line[len - 1] < ' '))
+		{
+			line[--len] = 0;
+		}
+
+		ptr = skipBlanks(line);
+
+		/* check for a comment or blank line */
+		if ((ptr[0] < ' ') || ('*' == ptr[0]) || ('#' == ptr[0]) || (';' == ptr[0]))
+		{
+			continue;
+		}
+
+		low = strtoul(ptr, &endPtr, 10);
+		high = low;
+		weight = -1.0;
+		if (endPtr > ptr)
+		{
+			if ('-' == endPtr[0])
+			{
+				high = strtoul(endPtr + 1, &endPtr, 10);
+			}
+
+			ptr = endPtr;
+			weight = strtod(ptr, &endPtr);
+			if (endPtr == ptr)
+			{
+				weight = 1.0;
+			}
+		}
+
+		if ((high < low) || (high > (size_t)(MAX_MESSAGE_LENGTH)) || (weight <= 0.0))
+		{
+			Log("***** line %d in histogram file %s ignored - %s", lineNo, gs->parms->genHistFile, line);
+			continue;
+		}
+
+		total += weight;
+		gs->hist[gs->histCount].low = low;
+		gs->hist[gs->histCount].high = high;
+		gs->hist[gs->histCount].total = total;
+		gs->histCount++;
+	}
+
+	fclose(histFile);
+
+	if (0 == gs->histCount)
+	{
+		Log("***** no message sizes found in histogram file %s", gs->parms->genHistFile);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read a template file and break it into literal text and    */
+/* placeholders.                                              */
+/*                                                            */
+/**************************************************************/
+
+static int addPiece(GENSTATE *gs, int type, const char *text, size_t len)
+
+{
+	if ((GEN_PIECE_TEXT == type) && (0 == len))
+	{
+		return 0;
+	}
+
+	gs->pieces[gs->pieceCount].type = type;
+	gs->pieces[gs->pieceCount].text = text;
+	gs->pieces[gs->pieceCount].len = len;
+	gs->pieceCount++;
+
+	switch (type)
+	{
+	case GEN_PIECE_TEXT:
+		{
+			gs->textLen += len;
+			break;
+		}
+	case GEN_PIECE_SEQ:
+		{
+			gs->seqCount++;
+			break;
+		}
+	case GEN_PIECE_SIZE:
+		{
+			gs->sizeCount++;
+			break;
+		}
+	case GEN_PIECE_RAND:
+		{
+			gs->randCount++;
+			break;
+		}
+	case GEN_PIECE_DATA:
+		{
+			gs->dataCount++;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int readTemplate(GENSTATE *gs)
+
+{
+	FILE	*tmplFile;
+	char	*ptr;
+	char	*textPtr;
+	size_t	len;
+	size_t	tagLen;
+	int		type;
+
+	tmplFile = fopen(gs->parms->genTemplate, "rb");
+	if (NULL == tmplFile)
+	{
+		Log("***** unable to open template file %s", gs->parms->genTemplate);
+		return -1;
+	}
+
+	fseek(tmplFile, 0L, SEEK_END);
+	len = ftell(tmplFile);
+	fseek(tmplFile, 0L, SEEK_SET);
+
+	if (len > GEN_MAX_TEMPLATE)
+	{
+		Log("***** template file %s is longer than %d bytes", gs->parms->genTemplate, GEN_MAX_TEMPLATE);
+		fclose(tmplFile);
+		return -1;
+	}
+
+	gs->tmpl = (char *)malloc(len + 1);
+
+	/* there can be no more pieces than characters in the file */
+	gs->pieces = (GENPIECE *)malloc((len + 1) * sizeof(GENPIECE));
+	if ((NULL == gs->tmpl) || (NULL == gs->pieces))
+	{
+		Log("***** unable to allocate storage for template file %s", gs->parms->genTemplate);
+		fclose(tmplFile);
+		return -1;
+	}
+
+	len = fread(gs->tmpl, 1, len, tmplFile);
+	gs->tmpl[len] = 0;
+	fclose(tmplFile);
+
+	/* find the placeholders - the data is terminated so strncmp */
+	/* cannot run past the end                                   */
+	ptr = gs->tmpl;
+	textPtr = ptr;
+	while (ptr < gs->tmpl + len)
+	{
+		type = GEN_PIECE_TEXT;
+		tagLen = 0;
+		if ('$' == ptr[0])
+		{
+			if (strncmp(ptr, GEN_TAG_SEQ, sizeof(GEN_TAG_SEQ) - 1) == 0)
+			{
+				type = GEN_PIECE_SEQ;
+				tagLen = sizeof(GEN_TAG_SEQ) - 1;
+			}
+			else if (strncmp(ptr, GEN_TAG_SIZE, sizeof(GEN_TAG_SIZE) - 1) == 0)
+			{
+				type = GEN_PIECE_SIZE;
+				tagLen = sizeof(GEN_TAG_SIZE) - 1;
+			}
+			else if (strncmp(ptr, GEN_TAG_RAND, sizeof(GEN_TAG_RAND) - 1) == 0)
+			{
+				type = GEN_PIECE_RAND;
+				tagLen = sizeof(GEN_TAG_RAND) - 1;
+			}
+			else if (strncmp(ptr, GEN_TAG_DATA, sizeof(GEN_TAG_DATA) - 1) == 0)
+			{
+				type = GEN_PIECE_DATA;
+				tagLen = sizeof(GEN_TAG_DATA) - 1;
+			}
+		}
+
+		if (GEN_PIECE_TEXT == type)
+		{
+			ptr++;
+		}
+		else
+		{
+			/* the text in front of the placeholder */
+			addPiece(gs, GEN_PIECE_TEXT, textPtr, ptr - textPtr);
+			addPiece(gs, type, NULL, 0);
+
+			ptr += tagLen;
+			textPtr = ptr;
+		}
+	}
+
+	addPiece(gs, GEN_PIECE_TEXT, textPtr, ptr - textPtr);
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Choose the size of the next message.                       */
+/*                                                            */
+/**************************************************************/
+
+static size_t pickSize(GENSTATE *gs)
+
+{
+	PUTPARMS	*parms=gs->parms;
+	double		size;
+	double		sigma;
+	double		mu;
+	double		r;
+	double		minSize=parms->genMinSize;
+	double		maxSize=(parms->genMaxSize > 0) ? parms->genMaxSize : (MAX_MESSAGE_LENGTH);
+	double		stdDev=(parms->genStdDev > 0) ? parms->genStdDev : parms->genSize / 4.0;
+	int			lo;
+	int			hi;
+	int			mid;
+	GENHIST		*entry;
+
+	switch (parms->genDist)
+	{
+	case GEN_UNIFORM:
+		{
+			if (0 == parms->genMaxSize)
+			{
+				maxSize = 2.0 * parms->genSize;
+			}
+
+			size = minSize + floor(randomFraction(&gs->seed) * (maxSize - minSize + 1));
+			break;
+		}
+	case GEN_NORMAL:
+		{
+			size = floor(parms->genSize + (stdDev * randomNormal(&gs->seed)) + 0.5);
+			break;
+		}
+	case GEN_LOGNORMAL:
+		{
+			/* work out the parameters of the underlying normal distribution */
+			/* from the mean and standard deviation of the sizes             */
+			sigma = sqrt(log(1.0 + ((stdDev * stdDev) / ((double)parms->genSize * parms->genSize))));
+			mu = log((double)parms->genSize) - ((sigma * sigma) / 2.0);
+			size = floor(exp(mu + (sigma * randomNormal(&gs->seed))) + 0.5);
+			break;
+		}
+	case GEN_EMPIRICAL:
+		{
+			/* find the histogram line */
+			r = randomFraction(&gs->seed) * gs->hist[gs->histCount - 1].total;
+			lo = 0;
+			hi = gs->histCount - 1;
+			while (lo < hi)
+			{
+				mid = (lo + hi) / 2;
+				if (gs->hist[mid].total > r)
+				{
+					hi = mid;
+				}
+				else
+				{
+					lo = mid + 1;
+				}
+			}
+
+			/* the histogram gives the limits */
+			entry = gs->hist + lo;
+			return entry->low + (size_t)(nextRandom(&gs->seed) % (entry->high - entry->low + 1));
+		}
+	default:
+		{
+			size = parms->genSize;
+			break;
+		}
+	}
+
+	if (size < minSize)
+	{
+		size = minSize;
+	}
+
+	if (size > maxSize)
+	{
+		size = maxSize;
+	}
+
+	return (size_t)size;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Work out the length of a message, including any template   */
+/* text.  The generated data makes up the rest of the size    */
+/* if the template has a ${DATA} placeholder.                 */
+/*                                                            */
+/**************************************************************/
+
+static int countDigits(size_t value)
+
+{
+	int		digits=1;
+
+	while (value >= 10)
+	{
+		value /= 10;
+		digits++;
+	}
+
+	return digits;
+}
+
+static size_t fixedLength(GENSTATE *gs, size_t seq, size_t size)
+
+{
+	return gs->textLen + (gs->seqCount * countDigits(seq)) + (gs->sizeCount * countDigits(size)) + (gs->randCount * GEN_RAND_DIGITS);
+}
+
+static size_t messageLength(GENSTATE *gs, size_t seq, size_t size)
+
+{
+	size_t	fixedLen;
+
+	if (NULL == gs->pieces)
+	{
+		return size;
+	}
+
+	fixedLen = fixedLength(gs, seq, size);
+	if ((gs->dataCount > 0) && (size > fixedLen))
+	{
+		return size;
+	}
+
+	return fixedLen;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Fill an area with generated data.                          */
+/*                                                            */
+/**************************************************************/
+
+static void fillData(GENSTATE *gs, char *ptr, size_t len)
+
+{
+	uint64_t	r;
+	size_t		wordLen;
+	const char	*word;
+	char		*endPtr=ptr + len;
+
+	switch (gs->parms->genContent)
+	{
+	case GEN_TEXT:
+		{
+			/* random words separated by blanks */
+			while (ptr < endPtr)
+			{
+				word = genWords[nextRandom(&gs->seed) % GEN_WORD_COUNT];
+				wordLen = strlen(word);
+				if (wordLen > (size_t)(endPtr - ptr))
+				{
+					wordLen = endPtr - ptr;
+				}
+
+				memcpy(ptr, word, wordLen);
+				ptr += wordLen;
+				if (ptr < endPtr)
+				{
+					ptr++[0] = ' ';
+				}
+			}
+
+			break;
+		}
+	case GEN_REPEAT:
+		{
+			while (ptr < endPtr)
+			{
+				wordLen = sizeof(GEN_SENTENCE) - 1;
+				if (wordLen > (size_t)(endPtr - ptr))
+				{
+					wordLen = endPtr - ptr;
+				}
+
+				memcpy(ptr, GEN_SENTENCE, wordLen);
+				ptr += wordLen;
+			}
+
+			break;
+		}
+	default:
+		{
+			/* random bytes do not compress */
+			while (endPtr - ptr >= 8)
+			{
+				r = nextRandom(&gs->seed);
+				memcpy(ptr, &r, 8);
+				ptr += 8;
+			}
+
+			r = nextRandom(&gs->seed);
+			memcpy(ptr, &r, endPtr - ptr);
+			break;
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Build one message from the template.                       */
+/*                                                            */
+/**************************************************************/
+
+static void buildMessage(GENSTATE *gs, char *ptr, size_t seq, size_t size, size_t msgLen)
+
+{
+	size_t	dataLen;
+	size_t	pieceLen;
+	int		dataNo=0;
+	int		i;
+	char	number[32];
+
+	/* no template - the message is all generated data */
+	if (NULL == gs->pieces)
+	{
+		fillData(gs, ptr, msgLen);
+		return;
+	}
+
+	/* share the generated data between the ${DATA} placeholders */
+	dataLen = msgLen - fixedLength(gs, seq, size);
+
+	for (i = 0; i < gs->pieceCount; i++)
+	{
+		switch (gs->pieces[i].type)
+		{
+		case GEN_PIECE_SEQ:
+			{
+				sprintf(number, "%u", (unsigned int)seq);
+				memcpy(ptr, number, strlen(number));
+				ptr += strlen(number);
+				break;
+			}
+		case GEN_PIECE_SIZE:
+			{
+				sprintf(number, "%u", (unsigned int)size);
+				memcpy(ptr, number, strlen(number));
+				ptr += strlen(number);
+				break;
+			}
+		case GEN_PIECE_RAND:
+			{
+				sprintf(number, "%010u", (unsigned int)(nextRandom(&gs->seed) >> 32));
+				memcpy(ptr, number, GEN_RAND_DIGITS);
+				ptr += GEN_RAND_DIGITS;
+				break;
+			}
+		case GEN_PIECE_DATA:
+			{
+				/* the first placeholder gets any odd bytes */
+				pieceLen = dataLen / gs->dataCount;
+				if (0 == dataNo)
+				{
+					pieceLen += dataLen % gs->dataCount;
+				}
+
+				fillData(gs, ptr, pieceLen);
+				ptr += pieceLen;
+				dataNo++;
+				break;
+			}
+		default:
+			{
+				memcpy(ptr, gs->pieces[i].text, gs->pieces[i].len);
+				ptr += gs->pieces[i].len;
+				break;
+			}
+		}
+	}
+}
+
+static void freeState(GENSTATE *gs)
+
+{
+	if (gs->hist != NULL)
+	{
+		free(gs->hist);
+	}
+
+	if (gs->tmpl != NULL)
+	{
+		free(gs->tmpl);
+	}
+
+	if (gs->pieces != NULL)
+	{
+		free(gs->pieces);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Generate the pool of messages.  The messages are returned  */
+/* one after the other in a single buffer, which is followed  */
+/* by a zero byte, along with the offset of the end of each   */
+/* message.  Both areas must be released with free.  NULL is  */
+/* returned and the error switch is set if the messages       */
+/* cannot be generated.                                       */
+/*                                                            */
+/**************************************************************/
+
+char * generateData(PUTPARMS *parms, size_t *dataLen, size_t **msgEnds, size_t *msgCount)
+
+{
+	GENSTATE	gs;
+	size_t		*ends;
+	size_t		count=parms->genCount;
+	size_t		size;
+	size_t		len;
+	size_t		total=0;
+	size_t		minLen=0;
+	size_t		maxLen=0;
+	size_t		i;
+	char		*data;
+	static const char *distNames[] = { "fixed", "uniform", "normal", "lognormal", "empirical" };
+	static const char *contentNames[] = { "random", "text", "repeated" };
+
+	(*dataLen) = 0;
+	(*msgEnds) = NULL;
+	(*msgCount) = 0;
+
+	memset(&gs, 0, sizeof(gs));
+	gs.parms = parms;
+
+	/* the seed must not be zero */
+	gs.seed = (((uint64_t)0x9E3779B9 << 32) | 0x7F4A7C15) ^ (uint64_t)parms->genSeed;
+	if (0 == gs.seed)
+	{
+		gs.seed = 1;
+	}
+
+	if (((GEN_EMPIRICAL == parms->genDist) && (readHistFile(&gs) != 0)) ||
+		((parms->genTemplate[0] != 0) && (readTemplate(&gs) != 0)))
+	{
+		freeState(&gs);
+		parms->err = 77;
+		return NULL;
+	}
+
+	/* choose the sizes first so the total length is known */
+	ends = (size_t *)malloc(count * sizeof(size_t));
+	if (NULL == ends)
+	{
+		Log("***** unable to allocate storage for %u generated messages", (unsigned int)count);
+		freeState(&gs);
+		parms->err = 77;
+		return NULL;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		size = pickSize(&gs);
+		len = messageLength(&gs, i + 1, size);
+
+		if ((0 == i) || (len < minLen))
+		{
+			minLen = len;
+		}
+
+		if (len > maxLen)
+		{
+			maxLen = len;
+		}
+
+		ends[i] = size;
+		total += len;
+	}
+
+	data = (char *)malloc(total + 1);
+	if (NULL == data)
+	{
+		Log("***** unable to allocate %.0f bytes for %u generated messages", (double)total, (unsigned int)count);
+		free(ends);
+		freeState(&gs);
+		parms->err = 77;
+		return NULL;
+	}
+
+	parms->memUsed += total + 1 + (count * sizeof(size_t));
+
+	/* now generate the messages */
+	total = 0;
+	for (i = 0; i < count; i++)
+	{
+		size = ends[i];
+		len = messageLength(&gs, i + 1, size);
+		buildMessage(&gs, data + total, i + 1, size, len);
+		total += len;
+		ends[i] = total;
+	}
+
+	data[total] = 0;
+	freeState(&gs);
+
+	Log("%u messages generated with %s sizes and %s data - smallest %u largest %u average %u bytes",
+		(unsigned int)count, distNames[parms->genDist], contentNames[parms->genContent],
+		(unsigned int)minLen, (unsigned int)maxLen, (unsigned int)(total / count));
+
+	(*dataLen) = total;
+	(*msgEnds) = ends;
+	(*msgCount) = count;
+
+	return data;
+}
@@ -0,0 +1,38 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   gensubs.h - header file for gensubs.c                          */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_gensubs_h
+#define _CommonSubs_gensubs_h
+
+#define GEN_SIZE_DEFAULT	1024
+#define GEN_MAX_HIST		4096				/* maximum number of lines in a histogram file */
+#define GEN_MAX_TEMPLATE	(1024 * 1024)		/* maximum length of a template file */
+
+/* placeholders that can be used in a template file */
+#define GEN_TAG_SEQ			"${SEQ}"			/* message number in the pool, starting at 1 */
+#define GEN_TAG_SIZE		"${SIZE}"			/* size chosen for the message */
+#define GEN_TAG_RAND		"${RAND}"			/* random ten digit number */
+#define GEN_TAG_DATA		"${DATA}"			/* generated data to make up the size */
+
+char * generateData(PUTPARMS *parms, size_t *dataLen, size_t **msgEnds, size_t *msgCount);
+#endif
@@ -0,0 +1,341 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   histsubs.c - latency histogram subroutines                     */
+/*                                                                  */
+/*   The histogram uses a fixed amount of memory regardless of      */
+/*   the number of values recorded, and two histograms can be       */
+/*   added together, so each thread can keep its own histogram      */
+/*   and the results combined for reporting.                        */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "timesubs.h"
+#include "histsubs.h"
+
+/**************************************************************/
+/*                                                            */
+/* Find the position of the highest bit that is set.          */
+/*                                                            */
+/**************************************************************/
+
+static int highBit(int64_t value)
+
+{
+	int		bit=0;
+
+	if (value >= ((int64_t)1 << 32))
+	{
+		value >>= 32;
+		bit += 32;
+	}
+
+	if (value >= (1 << 16))
+	{
+		value >>= 16;
+		bit += 16;
+	}
+
+	if (value >= (1 << 8))
+	{
+		value >>= 8;
+		bit += 8;
+	}
+
+	if (value >= (1 << 4))
+	{
+		value >>= 4;
+		bit += 4;
+	}
+
+	if (value >= (1 << 2))
+	{
+		value >>= 2;
+		bit += 2;
+	}
+
+	if (value >= (1 << 1))
+	{
+		bit += 1;
+	}
+
+	return bit;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the slot in the histogram that counts a value.         */
+/*                                                            */
+/**************************************************************/
+
+int getHistogramSlot(int64_t value)
+
+{
+	int		shift;
+
+	if (value < 0)
+	{
+		value = 0;
+	}
+
+	/* small values are counted exactly */
+	if (value < 2 * HIST_SUB_COUNT)
+	{
+		return (int)value;
+	}
+
+	/* larger values keep the top HIST_SUB_BITS + 1 bits */
+	shift = highBit(value) - HIST_SUB_BITS;
+	if (shift > HIST_MAX_BITS - HIST_SUB_BITS - 1)
+	{
+		/* too large - count in the last slot */
+		return HIST_SIZE - 1;
+	}
+
+	return (shift * HIST_SUB_COUNT) + (int)(value >> shift);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the largest value that is counted in a slot.           */
+/*                                                            */
+/**************************************************************/
+
+static int64_t getSlotValue(int slot)
+
+{
+	int		shift;
+	int64_t	top;
+
+	if (slot < 2 * HIST_SUB_COUNT)
+	{
+		return slot;
+	}
+
+	shift = (slot / HIST_SUB_COUNT) - 1;
+	top = slot - (shift * HIST_SUB_COUNT);
+
+	return ((top + 1) << shift) - 1;
+}
+
+void clearHistogram(HISTOGRAM *hist)
+
+{
+	memset(hist, 0, sizeof(HISTOGRAM));
+}
+
+void addToHistogram(HISTOGRAM *hist, int64_t value)
+
+{
+	hist->counts[getHistogramSlot(value)]++;
+	hist->total += value;
+	hist->count++;
+
+	/* keep track of the exact minimum and maximum */
+	if ((1 == hist->count) || (value < hist->min))
+	{
+		hist->min = value;
+	}
+
+	if (value > hist->max)
+	{
+		hist->max = value;
+	}
+}
+
+void mergeHistogram(HISTOGRAM *total, const HISTOGRAM *hist)
+
+{
+	int		i;
+
+	if (0 == hist->count)
+	{
+		/* nothing to add */
+		return;
+	}
+
+	if ((0 == total->count) || (hist->min < total->min))
+	{
+		total->min = hist->min;
+	}
+
+	if (hist->max > total->max)
+	{
+		total->max = hist->max;
+	}
+
+	total->count += hist->count;
+	total->total += hist->total;
+
+	for (i = 0; i < HIST_SIZE; i++)
+	{
+		total->counts[i] += hist->counts[i];
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the values recorded since an earlier copy of the same  */
+/* histogram was taken, such as the values for a reporting    */
+/* interval.  The minimum and maximum are exact if they       */
+/* changed during the interval and otherwise are only as      */
+/* accurate as the slots they were counted in.                */
+/*                                                            */
+/**************************************************************/
+
+void subtractHistogram(HISTOGRAM *result, const HISTOGRAM *hist, const HISTOGRAM *earlier)
+
+{
+	int		i;
+	int		first=-1;
+	int		last=-1;
+
+	clearHistogram(result);
+	result->count = hist->count - earlier->count;
+	result->total = hist->total - earlier->total;
+
+	if (result->count <= 0)
+	{
+		clearHistogram(result);
+		return;
+	}
+
+	for (i = 0; i < HIST_SIZE; i++)
+	{
+		result->counts[i] = hist->counts[i] - earlier->counts[i];
+		if (result->counts[i] > 0)
+		{
+			if (-1 == first)
+			{
+				first = i;
+			}
+
+			last = i;
+		}
+	}
+
+	/* get the minimum */
+	if ((0 == earlier->count) || (hist->min < earlier->min))
+	{
+		result->min = hist->min;
+	}
+	else if (first > 0)
+	{
+		result->min = getSlotValue(first - 1) + 1;
+	}
+
+	/* get the maximum */
+	if (hist->max > earlier->max)
+	{
+		result->max = hist->max;
+	}
+	else if (last >= 0)
+	{
+		result->max = getSlotValue(last);
+		if (result->max > hist->max)
+		{
+			result->max = hist->max;
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the value at or below which the given percentage of    */
+/* the recorded values fall.                                  */
+/*                                                            */
+/**************************************************************/
+
+int64_t getPercentile(const HISTOGRAM *hist, double percentile)
+
+{
+	int64_t	target;
+	int64_t	sofar=0;
+	int64_t	value;
+	int		i;
+
+	if (0 == hist->count)
+	{
+		return 0;
+	}
+
+	/* get the number of values that must be at or below the result */
+	target = (int64_t)((percentile / 100.0) * (double)hist->count + 0.5);
+	if (target < 1)
+	{
+		target = 1;
+	}
+
+	if (target >= hist->count)
+	{
+		return hist->max;
+	}
+
+	for (i = 0; i < HIST_SIZE; i++)
+	{
+		sofar += hist->counts[i];
+		if (sofar >= target)
+		{
+			break;
+		}
+	}
+
+	/* never report more than the actual maximum */
+	value = getSlotValue(i);
+	if (value > hist->max)
+	{
+		value = hist->max;
+	}
+
+	return value;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Format the standard set of percentiles as a string.        */
+/* The result area must be at least 160 bytes.                */
+/*                                                            */
+/**************************************************************/
+
+void formatPercentiles(char * result, const HISTOGRAM *hist)
+
+{
+	char	p50[24];
+	char	p90[24];
+	char	p99[24];
+	char	p999[24];
+	char	p9999[24];
+	char	max[24];
+
+	formatTimeDiffNs(p50, getPercentile(hist, 50.0));
+	formatTimeDiffNs(p90, getPercentile(hist, 90.0));
+	formatTimeDiffNs(p99, getPercentile(hist, 99.0));
+	formatTimeDiffNs(p999, getPercentile(hist, 99.9));
+	formatTimeDiffNs(p9999, getPercentile(hist, 99.99));
+	formatTimeDiffNs(max, hist->max);
+
+	sprintf(result, "p50 %s p90 %s p99 %s p99.9 %s p99.99 %s max %s", p50, p90, p99, p999, p9999, max);
+}
@@ -0,0 +1,57 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   histsubs.h - header file for histsubs.c                        */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_histsubs_h
+#define _CommonSubs_histsubs_h
+
+/**********************************************************/
+/* Log-linear latency histogram.                          */
+/*                                                        */
+/* Values below 2*HIST_SUB_COUNT are counted exactly.     */
+/* Above that each power of two is split into             */
+/* HIST_SUB_COUNT equal slots, so a recorded value is     */
+/* never more than 1/HIST_SUB_COUNT (under 1%) away from  */
+/* the value that is reported.  Values are in            */
+/* nanoseconds and the range is 1 nanosecond to over an   */
+/* hour; larger values are counted in the last slot.      */
+/**********************************************************/
+#define HIST_SUB_BITS	7
+#define HIST_SUB_COUNT	(1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS	42
+#define HIST_SIZE		((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+typedef struct {
+	int64_t		count;				/* number of values recorded */
+	int64_t		total;				/* sum of all values recorded */
+	int64_t		min;				/* smallest value recorded */
+	int64_t		max;				/* largest value recorded */
+	int64_t		counts[HIST_SIZE];
+} HISTOGRAM;
+
+void clearHistogram(HISTOGRAM *hist);
+void addToHistogram(HISTOGRAM *hist, int64_t value);
+int getHistogramSlot(int64_t value);
+void mergeHistogram(HISTOGRAM *total, const HISTOGRAM *hist);
+void subtractHistogram(HISTOGRAM *result, const HISTOGRAM *hist, const HISTOGRAM *earlier);
+int64_t getPercentile(const HISTOGRAM *hist, double percentile);
+void formatPercentiles(char * result, const HISTOGRAM *hist);
+#endif
@@ -0,0 +1,618 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   livesubs.c - live statistics subroutines                       */
+/*                                                                  */
+/*   When the liveStats parameter is set the counters of a running  */
+/*   program are kept in a shared memory segment named after the   */
+/*   process id (/mqperf.<pid>, or Local\mqperf.<pid> on Windows),  */
+/*   so they can be looked at from another process with mqperfstat  */
+/*   while the test is running.                                     */
+/*                                                                  */
+/*   Each worker thread has its own slot in the segment, so there   */
+/*   is only ever one writer for a slot and no locks or atomic      */
+/*   instructions are needed.  Counting a message is a handful of   */
+/*   ordinary stores between two changes to a sequence number,      */
+/*   which a reader uses to check it got a consistent copy.  The    */
+/*   rate is worked out once a second by a separate thread.         */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "thrdsubs.h"
+#include "histsubs.h"
+#include "livesubs.h"
+
+/* how often the rate thread checks for a new second */
+#define LIVE_UPDATE_INTERVAL	100
+
+/* how many times a reader tries to get a consistent copy */
+#define LIVE_READ_TRIES			10000
+
+/**************************************************************/
+/*                                                            */
+/* Build the name of the segment for a process.               */
+/*                                                            */
+/**************************************************************/
+
+static void getLiveName(char *name, int pid)
+
+{
+#ifdef WIN32
+	sprintf(name, "Local\\mqperf.%d", pid);
+#else
+	sprintf(name, "/mqperf.%d", pid);
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Set the rate from the messages since the last second.      */
+/*                                                            */
+/**************************************************************/
+
+static void updateLiveRate(LIVESTATS *live, time_t now)
+
+{
+	int			i;
+	int64_t		msgs=0;
+	int64_t		bytes=0;
+	int64_t		secs;
+	LIVESEGMENT	*seg=live->seg;
+
+	/* the counters only go up, so they can be added up without a copy */
+	for (i = 0; i < seg->slotCount; i++)
+	{
+		msgs += seg->slots[i].msgs;
+		bytes += seg->slots[i].bytes;
+	}
+
+	secs = now - live->lastTime;
+	if (secs < 1)
+	{
+		secs = 1;
+	}
+
+	seg->seq++;
+	WRITE_BARRIER();
+
+	seg->updateTime = now;
+	seg->rate = (msgs - live->lastMsgs) / secs;
+	seg->byteRate = (bytes - live->lastBytes) / secs;
+
+	WRITE_BARRIER();
+	seg->seq++;
+
+	live->lastTime = now;
+	live->lastMsgs = msgs;
+	live->lastBytes = bytes;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Rate thread.  Sets the rate each time the second changes.  */
+/*                                                            */
+/**************************************************************/
+
+static void liveUpdater(void * arg)
+
+{
+	LIVESTATS	*live=(LIVESTATS *)arg;
+	time_t		now;
+
+	while (0 == live->ending)
+	{
+		sleepThread(LIVE_UPDATE_INTERVAL);
+
+		time(&now);
+		if (now != live->lastTime)
+		{
+			updateLiveRate(live, now);
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Create the shared memory segment with a slot for each      */
+/* worker thread and start the rate thread.  Returns NULL if  */
+/* the liveStats parameter was not set or the segment could   */
+/* not be created, in which case the program runs as usual.   */
+/*                                                            */
+/**************************************************************/
+
+LIVESTATS * openLiveStats(const char *program, PUTPARMS *parms, int slotCount)
+
+{
+	int			i;
+	int			pid;
+	LIVESTATS	*live;
+	LIVESEGMENT	*seg;
+
+	if ((0 == parms->liveStats) || (slotCount < 1))
+	{
+		return NULL;
+	}
+
+	live = (LIVESTATS *)malloc(sizeof(LIVESTATS));
+	if (NULL == live)
+	{
+		Log("***** unable to allocate storage for live statistics");
+		return NULL;
+	}
+
+	memset(live, 0, sizeof(LIVESTATS));
+	live->owner = 1;
+	live->size = sizeof(LIVESEGMENT) + (slotCount - 1) * sizeof(LIVESLOT);
+
+#ifdef WIN32
+	pid = (int)GetCurrentProcessId();
+	getLiveName(live->name, pid);
+
+	/* the segment is backed by the paging file and starts out zero */
+	live->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+									   (DWORD)(((unsigned __int64)live->size) >> 32), (DWORD)live->size, live->name);
+	if (NULL == live->mapping)
+	{
+		Log("***** unable to create live statistics segment %s rc=%d", live->name, GetLastError());
+		free(live);
+		return NULL;
+	}
+
+	seg = (LIVESEGMENT *)MapViewOfFile(live->mapping, FILE_MAP_ALL_ACCESS, 0, 0, live->size);
+	if (NULL == seg)
+	{
+		Log("***** unable to map live statistics segment %s rc=%d", live->name, GetLastError());
+		CloseHandle(live->mapping);
+		free(live);
+		return NULL;
+	}
+#else
+	pid = (int)getpid();
+	getLiveName(live->name, pid);
+
+	/* a segment left by an earlier process with the same pid is replaced */
+	live->fd = shm_open(live->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if ((live->fd < 0) && (EEXIST == errno))
+	{
+		shm_unlink(live->name);
+		live->fd = shm_open(live->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	}
+
+	if (live->fd < 0)
+	{
+		Log("***** unable to create live statistics segment %s errno=%d", live->name, errno);
+		free(live);
+		return NULL;
+	}
+
+	/* a new segment starts out zero */
+	if (ftruncate(live->fd, (off_t)live->size) != 0)
+	{
+		Log("***** unable to set size of live statistics segment %s errno=%d", live->name, errno);
+		close(live->fd);
+		shm_unlink(live->name);
+		free(live);
+		return NULL;
+	}
+
+	seg = (LIVESEGMENT *)mmap(NULL, live->size, PROT_READ | PROT_WRITE, MAP_SHARED, live->fd, 0);
+	if (MAP_FAILED == seg)
+	{
+		Log("***** unable to map live statistics segment %s errno=%d", live->name, errno);
+		close(live->fd);
+		shm_unlink(live->name);
+		free(live);
+		return NULL;
+	}
+#endif
+
+	live->seg = seg;
+	seg->version = LIVE_VERSION;
+	seg->pid = pid;
+	seg->slotCount = slotCount;
+	seg->histSize = HIST_SIZE;
+	strncpy(seg->program, program, sizeof(seg->program) - 1);
+	strncpy(seg->qmname, parms->qmname, sizeof(seg->qmname) - 1);
+	strncpy(seg->qname, parms->qname, sizeof(seg->qname) - 1);
+	time(&(live->lastTime));
+	seg->startTime = live->lastTime;
+	seg->updateTime = live->lastTime;
+
+	for (i = 0; i < slotCount; i++)
+	{
+		seg->slots[i].sleepTime = -1;
+		seg->slots[i].batchSize = -1;
+	}
+
+	/* the eye catcher tells a reader the segment is ready */
+	MEMORY_BARRIER();
+	memcpy(seg->eyeCatcher, LIVE_EYECATCHER, sizeof(seg->eyeCatcher));
+
+	if (startThread(&(live->updater), liveUpdater, live) != 0)
+	{
+		live->ending = 1;
+		closeLiveStats(live);
+		return NULL;
+	}
+
+	Log("live statistics in shared memory segment %s", live->name);
+
+	return live;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the slot for a worker thread, starting with zero.      */
+/* Returns NULL if there are no live statistics.              */
+/*                                                            */
+/**************************************************************/
+
+LIVESLOT * getLiveSlot(LIVESTATS *live, int slotNum)
+
+{
+	if ((NULL == live) || (slotNum < 0) || (slotNum >= live->seg->slotCount))
+	{
+		return NULL;
+	}
+
+	return live->seg->slots + slotNum;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Count a message.  A latency of zero or less means the      */
+/* latency of the message is not known.  This is called for  */
+/* each message, so it must only be used by the thread that   */
+/* owns the slot.                                             */
+/*                                                            */
+/**************************************************************/
+
+void addLiveMsg(LIVESLOT *slot, int64_t bytes, int64_t latency)
+
+{
+	if (NULL == slot)
+	{
+		return;
+	}
+
+	slot->seq++;
+	WRITE_BARRIER();
+
+	slot->msgs++;
+	slot->bytes += bytes;
+
+	if (latency > 0)
+	{
+		slot->counts[getHistogramSlot(latency)]++;
+		slot->latTotal += latency;
+
+		if ((0 == slot->latCount) || (latency < slot->latMin))
+		{
+			slot->latMin = latency;
+		}
+
+		if (latency > slot->latMax)
+		{
+			slot->latMax = latency;
+		}
+
+		slot->latCount++;
+	}
+
+	WRITE_BARRIER();
+	slot->seq++;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Set the current sleep time and batch size of a thread.     */
+/* Values less than zero are not changed.                     */
+/*                                                            */
+/**************************************************************/
+
+void setLiveTuning(LIVESLOT *slot, int sleepTime, int batchSize)
+
+{
+	if (NULL == slot)
+	{
+		return;
+	}
+
+	slot->seq++;
+	WRITE_BARRIER();
+
+	if (sleepTime >= 0)
+	{
+		slot->sleepTime = sleepTime;
+	}
+
+	if (batchSize >= 0)
+	{
+		slot->batchSize = batchSize;
+	}
+
+	WRITE_BARRIER();
+	slot->seq++;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Stop the rate thread, mark the segment as ended for any    */
+/* readers and remove it, or detach from another program's   */
+/* segment.                                                   */
+/*                                                            */
+/**************************************************************/
+
+void closeLiveStats(LIVESTATS *live)
+
+{
+	if (NULL == live)
+	{
+		return;
+	}
+
+	if (1 == live->owner)
+	{
+		if (0 == live->ending)
+		{
+			live->ending = 1;
+			MEMORY_BARRIER();
+			waitThread(live->updater);
+		}
+
+		/* readers that are still attached see the program has ended */
+		live->seg->ending = 1;
+		MEMORY_BARRIER();
+	}
+
+#ifdef WIN32
+	UnmapViewOfFile(live->seg);
+	CloseHandle(live->mapping);
+#else
+	munmap((void *)live->seg, live->size);
+	close(live->fd);
+
+	if (1 == live->owner)
+	{
+		shm_unlink(live->name);
+	}
+#endif
+
+	free(live);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Attach to the segment of a running program for reading.    */
+/* Returns NULL if the process does not have a segment or it  */
+/* was written by a different level of the code.              */
+/*                                                            */
+/**************************************************************/
+
+LIVESTATS * attachLiveStats(int pid)
+
+{
+	LIVESTATS	*live;
+	LIVESEGMENT	*seg;
+#ifndef WIN32
+	struct stat	info;
+#endif
+
+	live = (LIVESTATS *)malloc(sizeof(LIVESTATS));
+	if (NULL == live)
+	{
+		Log("***** unable to allocate storage for live statistics");
+		return NULL;
+	}
+
+	memset(live, 0, sizeof(LIVESTATS));
+	getLiveName(live->name, pid);
+
+#ifdef WIN32
+	live->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, live->name);
+	if (NULL == live->mapping)
+	{
+		Log("***** no live statistics found for process %d (%s) rc=%d", pid, live->name, GetLastError());
+		free(live);
+		return NULL;
+	}
+
+	/* map the whole segment */
+	seg = (LIVESEGMENT *)MapViewOfFile(live->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == seg)
+	{
+		Log("***** unable to map live statistics segment %s rc=%d", live->name, GetLastError());
+		CloseHandle(live->mapping);
+		free(live);
+		return NULL;
+	}
+#else
+	live->fd = shm_open(live->name, O_RDONLY, 0);
+	if (live->fd < 0)
+	{
+		Log("***** no live statistics found for process %d (%s) errno=%d", pid, live->name, errno);
+		free(live);
+		return NULL;
+	}
+
+	if ((fstat(live->fd, &info) != 0) || (info.st_size < (off_t)sizeof(LIVESEGMENT)))
+	{
+		Log("***** live statistics segment %s is not complete", live->name);
+		close(live->fd);
+		free(live);
+		return NULL;
+	}
+
+	live->size = (size_t)info.st_size;
+	seg = (LIVESEGMENT *)mmap(NULL, live->size, PROT_READ, MAP_SHARED, live->fd, 0);
+	if (MAP_FAILED == seg)
+	{
+		Log("***** unable to map live statistics segment %s errno=%d", live->name, errno);
+		close(live->fd);
+		free(live);
+		return NULL;
+	}
+#endif
+
+	live->seg = seg;
+
+	/* check the segment was set up by the same level of the code */
+	if ((memcmp(seg->eyeCatcher, LIVE_EYECATCHER, sizeof(seg->eyeCatcher)) != 0) ||
+		(seg->version != LIVE_VERSION) ||
+		(seg->histSize != HIST_SIZE) ||
+		(seg->slotCount < 1)
+#ifndef WIN32
+		|| (live->size < sizeof(LIVESEGMENT) + (seg->slotCount - 1) * sizeof(LIVESLOT))
+#endif
+		)
+	{
+		Log("***** live statistics segment %s is not ready or is a different version", live->name);
+		closeLiveStats(live);
+		return NULL;
+	}
+
+	return live;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Take a consistent copy of the counters in a slot.  The     */
+/* histogram counts are not copied.  If the writer keeps      */
+/* changing the slot the last copy is used anyway, so a       */
+/* program that ended in the middle of an update does not     */
+/* hang the reader.                                           */
+/*                                                            */
+/**************************************************************/
+
+void readLiveSlot(const LIVESLOT *slot, LIVESLOT *copy)
+
+{
+	int		tries=0;
+	int64_t	seq;
+
+	do
+	{
+		/* wait for any update in progress to complete */
+		while (((seq = slot->seq) & 1) && (++tries < LIVE_READ_TRIES))
+		{
+			MEMORY_BARRIER();
+		}
+
+		MEMORY_BARRIER();
+		memcpy(copy, (const void *)slot, offsetof(LIVESLOT, counts));
+		MEMORY_BARRIER();
+	} while ((seq != slot->seq) && (++tries < LIVE_READ_TRIES));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Take a consistent copy of the rate in the last second.     */
+/*                                                            */
+/**************************************************************/
+
+void readLiveRate(LIVESEGMENT *seg, int64_t *updateTime, int64_t *rate, int64_t *byteRate)
+
+{
+	int		tries=0;
+	int64_t	seq;
+
+	do
+	{
+		while (((seq = seg->seq) & 1) && (++tries < LIVE_READ_TRIES))
+		{
+			MEMORY_BARRIER();
+		}
+
+		MEMORY_BARRIER();
+		(*updateTime) = seg->updateTime;
+		(*rate) = seg->rate;
+		(*byteRate) = seg->byteRate;
+		MEMORY_BARRIER();
+	} while ((seq != seg->seq) && (++tries < LIVE_READ_TRIES));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add up the latency histograms of all the slots.  The count */
+/* is taken from the histogram counts, so the percentiles     */
+/* agree with the counts even if messages were added while    */
+/* the histogram was being read.                              */
+/*                                                            */
+/**************************************************************/
+
+void getLiveHistogram(LIVESEGMENT *seg, HISTOGRAM *hist)
+
+{
+	int			i;
+	int			j;
+	LIVESLOT	*slot;
+	LIVESLOT	copy;
+
+	clearHistogram(hist);
+
+	for (i = 0; i < seg->slotCount; i++)
+	{
+		slot = seg->slots + i;
+		readLiveSlot(slot, &copy);
+		if (0 == copy.latCount)
+		{
+			continue;
+		}
+
+		for (j = 0; j < HIST_SIZE; j++)
+		{
+			hist->counts[j] += slot->counts[j];
+			hist->count += slot->counts[j];
+		}
+
+		hist->total += copy.latTotal;
+
+		if ((0 == hist->min) || (copy.latMin < hist->min))
+		{
+			hist->min = copy.latMin;
+		}
+
+		if (copy.latMax > hist->max)
+		{
+			hist->max = copy.latMax;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   livesubs.h - header file for livesubs.c                        */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_livesubs_h
+#define _CommonSubs_livesubs_h
+
+#include <stddef.h>
+
+#include "thrdsubs.h"
+#include "histsubs.h"
+
+#define LIVE_EYECATCHER		"MQPFLIVE"
+#define LIVE_VERSION		1
+#define LIVE_NAME_SIZE		64			/* maximum length of a segment name */
+
+/**********************************************************/
+/* Counters for one worker thread.  Only the owning       */
+/* thread changes a slot.  The seq field is odd while     */
+/* the counters are being changed, so a reader in another */
+/* process can take a consistent copy without any locks.  */
+/* The histogram counts only ever go up and are read      */
+/* without checking seq.  A sleep time or batch size of   */
+/* -1 means the program does not use it.                  */
+/**********************************************************/
+typedef struct {
+	volatile int64_t	seq;
+	volatile int64_t	msgs;
+	volatile int64_t	bytes;
+	volatile int64_t	latCount;
+	volatile int64_t	latTotal;
+	volatile int64_t	latMin;
+	volatile int64_t	latMax;
+	volatile int64_t	sleepTime;
+	volatile int64_t	batchSize;
+	volatile int64_t	counts[HIST_SIZE];	/* latencies in nanoseconds */
+} LIVESLOT;
+
+/**********************************************************/
+/* Shared memory segment.  The rate is the number of      */
+/* messages in the last second and is set once a second   */
+/* by a separate thread, using the same seq convention as */
+/* the slots.  The slots follow the header.               */
+/**********************************************************/
+typedef struct {
+	char				eyeCatcher[8];
+	int					version;
+	int					pid;
+	int					slotCount;
+	int					histSize;
+	char				program[32];
+	char				qmname[52];
+	char				qname[52];
+	int64_t				startTime;
+	volatile int64_t	seq;
+	volatile int64_t	updateTime;		/* time the rate was last set */
+	volatile int64_t	rate;
+	volatile int64_t	byteRate;
+	volatile int64_t	ending;			/* set when the program is ending */
+	LIVESLOT			slots[1];
+} LIVESEGMENT;
+
+/**********************************************************/
+/* Live statistics for a running program, or a view of    */
+/* another program's statistics if attached by pid.       */
+/**********************************************************/
+typedef struct {
+	LIVESEGMENT			*seg;
+	size_t				size;
+	int					owner;			/* created by this process */
+	char				name[LIVE_NAME_SIZE];
+#ifdef WIN32
+	HANDLE				mapping;
+#else
+	int					fd;
+#endif
+	volatile int		ending;
+	time_t				lastTime;
+	int64_t				lastMsgs;
+	int64_t				lastBytes;
+	THREAD_T			updater;
+} LIVESTATS;
+
+LIVESTATS * openLiveStats(const char *program, PUTPARMS *parms, int slotCount);
+LIVESLOT * getLiveSlot(LIVESTATS *live, int slotNum);
+void addLiveMsg(LIVESLOT *slot, int64_t bytes, int64_t latency);
+void setLiveTuning(LIVESLOT *slot, int sleepTime, int batchSize);
+void closeLiveStats(LIVESTATS *live);
+LIVESTATS * attachLiveStats(int pid);
+void readLiveSlot(const LIVESLOT *slot, LIVESLOT *copy);
+void readLiveRate(LIVESEGMENT *seg, int64_t *updateTime, int64_t *rate, int64_t *byteRate);
+void getLiveHistogram(LIVESEGMENT *seg, HISTOGRAM *hist);
+#endif
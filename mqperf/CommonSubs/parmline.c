@@ -43,6 +43,7 @@ Jim MacNair - Initial Contribution
 /* parameter file processing routines */
 #include "parmline.h"
 #include "putparms.h"
+#include "gensubs.h"
 
 /* RFH processing subroutines include */
 #include "rfhsubs.h"
@@ -72,14 +73,44 @@ Jim MacNair - Initial Contribution
 #define SLEEPTIME			"SLEEPTIME"
 #define THINKTIME			"THINKTIME"
 #define BATCHSIZE			"BATCHSIZE"
+#define AUTOBATCH			"AUTOBATCH"
+#define BATCHMIN			"BATCHMIN"
+#define BATCHMAX			"BATCHMAX"
+#define BATCHWINDOW			"BATCHWINDOW"
+#define WARMUPTIME			"WARMUPTIME"
+#define WARMUPCOUNT			"WARMUPCOUNT"
+#define STEADYWINDOW		"STEADYWINDOW"
+#define STEADYCOV			"STEADYCOV"
+#define THREADS				"THREADS"
+#define RATE				"RATE"
+#define REPLAY				"REPLAY"
+#define REPLAYSPEED			"REPLAYSPEED"
+#define INFLIGHT			"INFLIGHT"
+#define REPLYHANDLES		"REPLYHANDLES"
 #define MAXTIME				"MAXTIME"
 #define DELIMITER			"DELIMITER"
 #define DELIMITERX			"DELIMITERX"
 #define SILENT				"SILENT"
+#define ASYNCLOG			"ASYNCLOG"
+#define LOGFLUSH			"LOGFLUSH"
 #define FILEASGROUP			"FILEASGROUP"
+#define MAPFILES			"MAPFILES"
+#define MAPPOPULATE			"MAPPOPULATE"
+/* fields used to generate message data */
+#define GENCOUNT			"GENCOUNT"
+#define GENDIST				"GENDIST"
+#define GENCONTENT			"GENCONTENT"
+#define GENSIZE				"GENSIZE"
+#define GENMINSIZE			"GENMINSIZE"
+#define GENMAXSIZE			"GENMAXSIZE"
+#define GENSTDDEV			"GENSTDDEV"
+#define GENSEED				"GENSEED"
+#define GENHISTFILE			"GENHISTFILE"
+#define GENTEMPLATE			"GENTEMPLATE"
 /* fields related to latency measurements */
 #define SETTIMESTAMP		"SETTIMESTAMP"
 #define TIMESTAMPOFFSET		"TIMESTAMPOFFSET"
+#define WALLCLOCK			"WALLCLOCK"
 #define TIMESTAMPACCTTOKEN	"TIMESTAMPACCTTOKEN"
 #define TIMESTAMPGROUPID	"TIMESTAMPGROUPID"
 #define TIMESTAMPCORRELID	"TIMESTAMPCORRELID"
@@ -95,12 +126,20 @@ Jim MacNair - Initial Contribution
 #define NANREPLYFILE		"NANREPLYFILE"
 #define PANREPLYFILE		"PANREPLYFILE"
 #define REPLYFILENAME		"REPLYFILENAME"
+#define STATSFILENAME		"STATSFILE"
+#define LIVESTATSPARM		"LIVESTATS"
 /* fields used by capture programs */
 #define OUTPUTFILENAME		"OUTPUTFILENAME"
 #define APPENDFILE			"APPENDFILE"
 #define ADDTIMESTAMP		"ADDTIMESTAMP"
 #define STRIPRFH			"STRIPRFH"
 #define WAITTIME			"WAITTIME"
+#define WRITEBUFSIZE		"WRITEBUFSIZE"
+#define WRITEBUFFERS		"WRITEBUFFERS"
+#define WRITEDIRECT			"WRITEDIRECT"
+#define WRITESYNC			"WRITESYNC"
+#define INDEXEDFILE			"INDEXEDFILE"
+#define CAPBLOCKSIZE		"CAPBLOCKSIZE"
 /* MQPMO options */
 #define NEWMSGID			"NEWMSGID"
 /* MQGMO options */
@@ -188,14 +227,8 @@ Jim MacNair - Initial Contribution
 void getRFHUsrTimeStamp(char * msg, int msgLen, MY_TIME_T * startTime)
 
 {
-#ifdef WIN32
-	/* initialize the start time to 0, in case one is not found */
-	(*startTime) = 0;
-#else
 	/* initialize the start time to 0, in case one is not found */
-	startTime->tv_sec = 0;
-	startTime->tv_usec = 0;
-#endif
+	clearTime(startTime);
 
 	/* check if the message is long enough */
 	if (msgLen > sizeof(LATENCYHEADER) + MQRFH_STRUC_LENGTH_FIXED_2 + 4)
@@ -468,6 +501,20 @@ void processArgs(int argc, char **argv, PUTPARMS *parms)
 								  parms);
 			}
 
+			/* check for option */
+			if ((0 == foundit) && ('J' == ch))
+			{
+				foundit = 1;
+
+				i = processIndArg(argc, 
+								  argv, 
+								  i,
+								  (char *)&(parms->saveStatsFilename), 
+								  sizeof(parms->saveStatsFilename), 
+								  "name of statistics file (-j)",
+								  parms);
+			}
+
 			/* check for option */
 			if ((0 == foundit) && ('B' == ch))
 			{
@@ -514,6 +561,29 @@ void processArgs(int argc, char **argv, PUTPARMS *parms)
 				}
 			}
 
+			/* check for option */
+			if ((0 == foundit) && ('N' == ch))
+			{
+				foundit = 1;
+
+				i = processNumArg(argc,
+								  argv, 
+								  i,
+								  &(parms->saveThreads), 
+								  "Number of threads (-n)",
+								  parms);
+
+				if ((parms->saveThreads < 1) || (parms->saveThreads > MAX_THREADS))
+				{
+					printf("Invalid number of threads (%d)\n", parms->saveThreads);
+					parms->saveThreads = 0;
+				}
+				else
+				{
+					printf("Number of threads will be set to %d\n", parms->saveThreads);
+				}
+			}
+
 			/* check for option */
 			if ((0 == foundit) && ('C' == ch))
 			{
@@ -555,6 +625,13 @@ void processArgs(int argc, char **argv, PUTPARMS *parms)
 				foundit = 1;
 				parms->silent = 1;
 			}
+
+			/* check for live statistics option */
+			if ((0 == foundit) && ('K' == ch))
+			{
+				foundit = 1;
+				parms->liveStats = 1;
+			}
 		}
 
 		/* did we recognize the parameter? */
@@ -789,24 +866,49 @@ int evaluateParm(char * ptr, char * value, PUTPARMS *parms)
 	foundit = checkCharParm(ptr, USERID, (parms->userId), valueptr, NULL, foundit, MQ_USER_ID_LENGTH);
 	foundit = checkCharParm(ptr, OUTPUTFILENAME, (parms->outputFilename), valueptr, NULL, foundit, sizeof(parms->outputFilename));
 	foundit = checkCharParm(ptr, REPLYFILENAME, (parms->replyFilename), valueptr, NULL, foundit, sizeof(parms->replyFilename));
+	foundit = checkCharParm(ptr, STATSFILENAME, (parms->statsFilename), valueptr, NULL, foundit, sizeof(parms->statsFilename));
+	foundit = checkYNParm(ptr, LIVESTATSPARM, &(parms->liveStats), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, WRITEONCE, &(parms->writeOnce), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, REPLAY, &(parms->replay), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, AUTOBATCH, &(parms->autoBatch), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, BATCHMIN, &(parms->batchMin), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, BATCHMAX, &(parms->batchMax), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, BATCHWINDOW, &(parms->batchWindow), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, WARMUPTIME, &(parms->warmupTime), valueptr, NULL, foundit);
+	foundit = checkI64Parm(ptr, WARMUPCOUNT, &(parms->warmupCount), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, STEADYWINDOW, &(parms->steadyWindow), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, STEADYCOV, &(parms->steadyCov), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, IGNOREMQMD, &(parms->ignoreMQMD), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, MAPFILES, &(parms->mapFiles), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, MAPPOPULATE, &(parms->mapPopulate), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, NEWMSGID, &(parms->newMsgId), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, GETBYCORRELID, &(parms->GetByCorrelId), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, SETTIMESTAMP, &(parms->setTimeStamp), valueptr, NULL, foundit);
 	foundit = checkIntParm(ptr, TIMESTAMPOFFSET, &(parms->timeStampOffset), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, WALLCLOCK, &(parms->wallClock), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, TIMESTAMPACCTTOKEN, &(parms->timeStampInAccountingToken), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, TIMESTAMPGROUPID, &(parms->timeStampInGroupId), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, TIMESTAMPCORRELID, &(parms->timeStampInCorrelId), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, TIMESTAMPUSERPROP, &(parms->timeStampUserProp), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, DRAINQ, &(parms->drainQ), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, SILENT, &(parms->silent), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, ASYNCLOG, &(parms->asyncLog), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, LOGFLUSH, &(parms->logFlush), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, LOGICALORDER, &(parms->logicalOrder), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, SAVEMQMD, &(parms->saveMQMD), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, READONLY, &(parms->readOnly), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, INDIVFILES, &(parms->indivFiles), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, STRIPRFH, &(parms->striprfh), valueptr, NULL, foundit);
 	foundit = checkYNParm(ptr, APPENDFILE, &(parms->appendFile), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, WRITEBUFSIZE, &(parms->writeBufSize), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, WRITEBUFFERS, &(parms->writeBuffers), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, WRITEDIRECT, &(parms->writeDirect), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, WRITESYNC, &(parms->writeSync), valueptr, NULL, foundit);
+	foundit = checkYNParm(ptr, INDEXEDFILE, &(parms->indexedFile), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, CAPBLOCKSIZE, &(parms->capBlockSize), valueptr, NULL, foundit);
+	foundit = checkIntParm(ptr, GENSEED, &(parms->genSeed), valueptr, NULL, foundit);
+	foundit = checkCharParm(ptr, GENHISTFILE, (parms->genHistFile), valueptr, NULL, foundit, sizeof(parms->genHistFile));
+	foundit = checkCharParm(ptr, GENTEMPLATE, (parms->genTemplate), valueptr, NULL, foundit, sizeof(parms->genTemplate));
 	foundit = checkYNParm(ptr, ADDTIMESTAMP, &(parms->addTimeStamp), valueptr, NULL, foundit);
 	foundit = checkCharParm(ptr, RFH_DOMAIN, (char *)&(parms->rfhdomain), valueptr, &foundMCD, foundit, sizeof(parms->rfhdomain) - 1);
 	foundit = checkCharParm(ptr, RFH_MSG_SET, (char *)&(parms->rfhset), valueptr, &foundMCD, foundit, sizeof(parms->rfhset) - 1);
@@ -962,7 +1064,10 @@ int evaluateParm(char * ptr, char * value, PUTPARMS *parms)
 		parms->iDelimiterLen = (iStrLen(valueptr) >> 1);
 		parms->delimiterLen = len >> 1;
 		parms->delimiterIsHex = 1;							/* delimiter was specified in hex */
-		HexToAscii(valueptr, len, parms->delimiter);
+		if (HexToAscii(valueptr, len, parms->delimiter) > 0)
+		{
+			printf("***** delimiterx value contains characters that are not hex digits - %s\n", value);
+		}
 	}
 
 	if (strcmp(ptr, PERSIST) == 0)
@@ -1112,6 +1217,180 @@ int evaluateParm(char * ptr, char * value, PUTPARMS *parms)
 		}
 	}
 
+	if (strcmp(ptr, THREADS) == 0)
+	{
+		foundit = 1;
+		parms->threads = atoi(valueptr);
+		if ((parms->threads < 1) || (parms->threads > MAX_THREADS))
+		{
+			printf("***** invalid value for threads %d *****\n", parms->threads);
+
+			/* reset value to default */
+			parms->threads = 1;
+		}
+	}
+
+	if (strcmp(ptr, RATE) == 0)
+	{
+		foundit = 1;
+		parms->rate = atoi(valueptr);
+		if (parms->rate < 0)
+		{
+			printf("***** invalid value for rate %d *****\n", parms->rate);
+
+			/* reset value to default */
+			parms->rate = 0;
+		}
+	}
+
+	if (strcmp(ptr, REPLAYSPEED) == 0)
+	{
+		/* allow the speed to be given as 2x or 0.5x */
+		foundit = 1;
+		parms->replaySpeed = atof(valueptr);
+		if (parms->replaySpeed <= 0)
+		{
+			printf("***** invalid value for replay speed %s *****\n", valueptr);
+
+			/* reset value to default */
+			parms->replaySpeed = 1.0;
+	parms->genSize = GEN_SIZE_DEFAULT;
+		}
+	}
+
+	if (strcmp(ptr, GENCOUNT) == 0)
+	{
+		foundit = 1;
+		parms->genCount = atoi(valueptr);
+		if (parms->genCount < 0)
+		{
+			printf("***** invalid value for genCount %d *****\n", parms->genCount);
+			parms->genCount = 0;
+		}
+	}
+
+	if (strcmp(ptr, GENDIST) == 0)
+	{
+		foundit = 1;
+		if (strcmp(tempValue, "FIXED") == 0)
+		{
+			parms->genDist = GEN_FIXED;
+		}
+		else if (strcmp(tempValue, "UNIFORM") == 0)
+		{
+			parms->genDist = GEN_UNIFORM;
+		}
+		else if (strcmp(tempValue, "NORMAL") == 0)
+		{
+			parms->genDist = GEN_NORMAL;
+		}
+		else if (strcmp(tempValue, "LOGNORMAL") == 0)
+		{
+			parms->genDist = GEN_LOGNORMAL;
+		}
+		else if (strcmp(tempValue, "EMPIRICAL") == 0)
+		{
+			parms->genDist = GEN_EMPIRICAL;
+		}
+		else
+		{
+			printf("***** invalid value for genDist %s *****\n", valueptr);
+			parms->genDist = GEN_FIXED;
+		}
+	}
+
+	if (strcmp(ptr, GENCONTENT) == 0)
+	{
+		foundit = 1;
+		if (strcmp(tempValue, "RANDOM") == 0)
+		{
+			parms->genContent = GEN_RANDOM;
+		}
+		else if (strcmp(tempValue, "TEXT") == 0)
+		{
+			parms->genContent = GEN_TEXT;
+		}
+		else if (strcmp(tempValue, "REPEAT") == 0)
+		{
+			parms->genContent = GEN_REPEAT;
+		}
+		else
+		{
+			printf("***** invalid value for genContent %s *****\n", valueptr);
+			parms->genContent = GEN_RANDOM;
+		}
+	}
+
+	if (strcmp(ptr, GENSIZE) == 0)
+	{
+		foundit = 1;
+		parms->genSize = atoi(valueptr);
+		if ((parms->genSize < 0) || (parms->genSize > MAX_MESSAGE_LENGTH))
+		{
+			printf("***** invalid value for genSize %d *****\n", parms->genSize);
+			parms->genSize = GEN_SIZE_DEFAULT;
+		}
+	}
+
+	if (strcmp(ptr, GENMINSIZE) == 0)
+	{
+		foundit = 1;
+		parms->genMinSize = atoi(valueptr);
+		if ((parms->genMinSize < 0) || (parms->genMinSize > MAX_MESSAGE_LENGTH))
+		{
+			printf("***** invalid value for genMinSize %d *****\n", parms->genMinSize);
+			parms->genMinSize = 0;
+		}
+	}
+
+	if (strcmp(ptr, GENMAXSIZE) == 0)
+	{
+		foundit = 1;
+		parms->genMaxSize = atoi(valueptr);
+		if ((parms->genMaxSize < 0) || (parms->genMaxSize > MAX_MESSAGE_LENGTH))
+		{
+			printf("***** invalid value for genMaxSize %d *****\n", parms->genMaxSize);
+			parms->genMaxSize = 0;
+		}
+	}
+
+	if (strcmp(ptr, GENSTDDEV) == 0)
+	{
+		foundit = 1;
+		parms->genStdDev = atoi(valueptr);
+		if (parms->genStdDev < 0)
+		{
+			printf("***** invalid value for genStdDev %d *****\n", parms->genStdDev);
+			parms->genStdDev = 0;
+		}
+	}
+
+	if (strcmp(ptr, INFLIGHT) == 0)
+	{
+		foundit = 1;
+		parms->inflight = atoi(valueptr);
+		if ((parms->inflight < 1) || (parms->inflight > MAX_INFLIGHT))
+		{
+			printf("***** invalid value for inflight %d *****\n", parms->inflight);
+
+			/* reset value to default */
+			parms->inflight = 1;
+		}
+	}
+
+	if (strcmp(ptr, REPLYHANDLES) == 0)
+	{
+		foundit = 1;
+		parms->replyHandles = atoi(valueptr);
+		if ((parms->replyHandles < 1) || (parms->replyHandles > MAX_REPLY_HANDLES))
+		{
+			printf("***** invalid value for reply handles %d *****\n", parms->replyHandles);
+
+			/* reset value to default */
+			parms->replyHandles = DEF_REPLY_HANDLES;
+		}
+	}
+
 	if (strcmp(ptr, REPORTEVERY) == 0)
 	{
 		foundit = 1;
@@ -1645,7 +1924,17 @@ void initializeParms(PUTPARMS *parms, size_t parmSize)
 	parms->maxmsglen = MAX_MESSAGE_LENGTH;
 	parms->reportInterval = 1;
 	parms->batchSize = DEF_SYNC;
+	parms->batchMin = 1;
+	parms->batchMax = MAX_SYNC_ALLOW;
+	parms->batchWindow = BATCH_WINDOW_DEF;
+	parms->steadyWindow = STEADY_WINDOW_DEF;
+	parms->steadyCov = STEADY_COV_DEF;
 	parms->subLevel = -1;
+	parms->threads = 1;
+	parms->replaySpeed = 1.0;
+	parms->inflight = 1;
+	parms->replyHandles = DEF_REPLY_HANDLES;
+	parms->logFlush = 1;
 }
 
 void processOverrides(PUTPARMS *parms)
@@ -1675,6 +1964,24 @@ void processOverrides(PUTPARMS *parms)
 		parms->batchSize = parms->saveBatchSize;
 	}
 
+	/* check for overrides */
+	if (parms->saveThreads > 0)
+	{
+		parms->threads = parms->saveThreads;
+	}
+
+	/* check for overrides */
+	if (parms->saveStatsFilename[0] != 0)
+	{
+		strcpy(parms->statsFilename, parms->saveStatsFilename);
+	}
+
+	/* time stamps compared with another machine must be the time of day */
+	if (1 == parms->wallClock)
+	{
+		setWallClock(1);
+	}
+
 	/* check if the write once parameter was found */
 	if (1 == parms->writeOnce)
 	{
@@ -1707,5 +2014,17 @@ void processOverrides(PUTPARMS *parms)
 	{
 		parms->thinkTime = parms->saveThinkTime;
 	}
+
+	/* check if log lines should be written on a separate thread */
+	if (1 == parms->asyncLog)
+	{
+		if (parms->logFlush < 0)
+		{
+			printf("***** invalid value for %s (%d) - flushing every line\n", LOGFLUSH, parms->logFlush);
+			parms->logFlush = 0;
+		}
+
+		startAsyncLog(parms->logFlush);
+	}
 }
 
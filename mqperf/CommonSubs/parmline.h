@@ -40,6 +40,16 @@ Jim MacNair - Initial Contribution
 #define TIMESTAMP_FORMAT_BIN	0
 #define TIMESTAMP_FORMAT_HEX	1
 
+#define GEN_FIXED				0			/* sizes of generated messages */
+#define GEN_UNIFORM				1
+#define GEN_NORMAL				2
+#define GEN_LOGNORMAL			3
+#define GEN_EMPIRICAL			4
+
+#define GEN_RANDOM				0			/* content of generated messages */
+#define GEN_TEXT				1
+#define GEN_REPEAT				2
+
 #define SKIPDATAFILES			0
 #define READDATAFILES			1
 
@@ -49,6 +59,11 @@ Jim MacNair - Initial Contribution
 #define TIME_OUT_DEF		120
 #define DEF_SYNC			25
 #define MAX_SYNC_ALLOW		1000
+#define BATCH_WINDOW_DEF	2000		/* milliseconds to measure each batch size */
+#define BATCH_WINDOW_MIN	100
+#define STEADY_WINDOW_DEF	10			/* intervals used to check for a steady rate */
+#define STEADY_WINDOW_MAX	120
+#define STEADY_COV_DEF		10			/* largest variation in the rate, in percent */
 
 /* default buffer size is 16MB but will be adjusted to maximum length supported */
 #define MAX_MESSAGE_LENGTH	256 * 65536
@@ -86,9 +101,20 @@ typedef struct {
 	/* silent mode indicator - do not issue normal operational messages */
 	int			silent;
 
+	/* write log lines on a separate thread */
+	int			asyncLog;
+
+	/* seconds between flushes of the asynchronous log - 0 flushes every line */
+	int			logFlush;
+
 	/* total memory used               */
 	size_t		memUsed;		
 
+	/* map message data files into memory rather than reading them */
+	int			mapFiles;
+	int			mapPopulate;			/* fault in all pages when the file is mapped */
+	size_t		memMapped;				/* bytes of file data mapped */
+
 	/* Counters and statistics         */
 	int			fileCount;				/* number of files read            */
 	int			mesgCount;				/* number of messages found        */
@@ -107,11 +133,25 @@ typedef struct {
 	int			priority;
 	int			batchSize;				/* number of messages in a unit of work */
 	int			saveBatchSize;
+	int			autoBatch;				/* change the batch size to get the highest rate - used by MQPut2, MQTimes2 and MQTimes3 */
+	int			batchMin;				/* smallest batch size tried by autoBatch */
+	int			batchMax;				/* largest batch size tried by autoBatch */
+	int			batchWindow;			/* milliseconds to measure each batch size */
+	int			warmupTime;				/* seconds to ignore at the start - used by MQTimes2, MQTimes3 and MQLatency */
+	int64_t		warmupCount;			/* messages to ignore at the start */
+	int			steadyWindow;			/* intervals used to check for a steady rate */
+	int			steadyCov;				/* largest coefficient of variation of the rate, in percent */
 	int			saveThinkTime;
 	int			qdepth;
 	int			qmax;
 	int			sleeptime;
 	int			tune;
+	int			threads;				/* number of worker threads - used by MQPut2, MQTimes2, MQTimes3 and MQReply */
+	int			saveThreads;
+	int			rate;					/* target messages per second (0 = not paced) - used by MQPut2 */
+	int			replay;					/* send messages at the times in their MQMDs - used by MQPut2 */
+	double		replaySpeed;			/* replay speed relative to the original times (2 = twice as fast) */
+	int64_t		replaySpan;				/* nanoseconds from the first to the last message being replayed */
 	int			maxtime;				/* maximum number of seconds for MQTimes3 to wait for first message */
 	int			saveMQMD;
 	int			readOnly;
@@ -150,6 +190,8 @@ typedef struct {
 	int			feedback;
 	int			report;
 	int			GetByCorrelId;			/* used by MQLatency */
+	int			inflight;				/* number of outstanding requests - used by MQLatency */
+	int			replyHandles;			/* number of cached reply queue handles - used by MQReply */
 	int			acctTokenSet;
 	int			inGroup;
 	int			lastGroup;
@@ -178,6 +220,24 @@ typedef struct {
 	int			striprfh;			/* whether to strip MQ headers before saving the data */
 	int			addTimeStamp;		/* insert a timestamp at the end of the file name */
 	int			appendFile;			/* append messages to output file */
+	int			writeBufSize;		/* size of each output buffer - 0 for the default of 8MB */
+	int			writeBuffers;		/* number of output buffers - 0 for the default of 2 */
+	int			writeDirect;		/* write the output with O_DIRECT where possible */
+	int			writeSync;			/* seconds between syncs of the output file - 0 for none */
+	int			indexedFile;		/* write a compressed capture file with an index */
+	int			capBlockSize;		/* size of the compressed blocks - 0 for the default of 256KB */
+
+	/* generated message data - used by MQPut2, MQTest and MQLatency */
+	int			genCount;			/* number of messages to generate - 0 for none */
+	int			genDist;			/* size distribution (GEN_FIXED, GEN_UNIFORM, ...) */
+	int			genContent;			/* content of the data (GEN_RANDOM, GEN_TEXT or GEN_REPEAT) */
+	int			genSize;			/* fixed or mean size */
+	int			genMinSize;
+	int			genMaxSize;			/* 0 for the maximum message length */
+	int			genStdDev;			/* 0 for a quarter of the mean size */
+	int			genSeed;
+	char		genHistFile[512];	/* sizes and weights for the empirical distribution */
+	char		genTemplate[512];	/* text with placeholders for the generated data */
 
 	/* think time after message is written (in milliseconds) */
 	int			thinkTime;
@@ -198,6 +258,7 @@ typedef struct {
 	int			timeStampInGroupId;
 	int			timeStampInCorrelId;
 	int			timeStampUserProp;
+	int			wallClock;				/* time stamps are the time of day, for other machines */
 
 	/* fields used by mqreply */
 	int			resendRFHusr;
@@ -330,6 +391,13 @@ typedef struct {
 	/* name of the log file */
 	char			logFileName[756];
 
+	/* name of the interval statistics file - used by MQTimes2, MQTimes3, MQPut2 and MQReply */
+	char			statsFilename[756];
+	char			saveStatsFilename[756];
+
+	/* keep the counters in shared memory for mqperfstat - used by MQTimes3 and MQPut2 */
+	int				liveStats;
+
 	/* reply data - used by MQReply */
 	int				useInputAsReply;
 	char			replyFilename[512];
@@ -33,6 +33,11 @@ Jim MacNair - Initial Contribution
 
 #ifdef WIN32
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 /* includes for MQI */
@@ -48,6 +53,8 @@ Jim MacNair - Initial Contribution
 /* parameter file processing routines */
 #include "parmline.h"
 #include "putparms.h"
+#include "capsubs.h"
+#include "gensubs.h"
 
 /* RFH and MQ processing subroutines include */
 #include "rfhsubs.h"
@@ -61,6 +68,20 @@ Jim MacNair - Initial Contribution
 #define DEF_CODEPAGE	850
 #endif
 
+/**************************************************************/
+/*                                                            */
+/* Message data files that have been mapped into memory.      */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	void			*nextMap;
+	char			*addr;
+	size_t			length;
+} MAPPEDFILE;
+
+static MAPPEDFILE *	mappedFiles=NULL;
+
 void mallocError(const size_t len, size_t memUsed)
 
 {
@@ -187,6 +208,7 @@ FILEPTR * createFileBlock(char * msgPtr, const char * userPtr, MQMD2 * mqmdPtr,
 
 		/* do some initializstion */
 		newfptr->hasMQMD = 0;
+		newfptr->replayNs = 0;
 
 		if (1 == parms->ignoreMQMD)
 		{
@@ -332,6 +354,136 @@ FILEPTR * createFileBlock(char * msgPtr, const char * userPtr, MQMD2 * mqmdPtr,
 	return newfptr;
 }
 
+/**************************************************************/
+/*                                                            */
+/* Map message data from a file into memory.                  */
+/*                                                            */
+/* The mapping is private, so the pages are shared with the   */
+/* file system cache until something is written into them.    */
+/* Only the pages that are changed (for example, when a time  */
+/* stamp is inserted into the message data or an MQMD or RFH */
+/* header is translated) are copied.  Unlike the data read    */
+/* by readFileData the data is not followed by a zero byte.   */
+/*                                                            */
+/* Returns 1 if the file should be read into memory instead.  */
+/*                                                            */
+/**************************************************************/
+
+static int mapFileData(const char *filename, size_t *length, char ** dataptr, PUTPARMS * parms)
+
+{
+	size_t		datalen;
+	char		*msgdata=NULL;
+	MAPPEDFILE	*mapPtr;
+#ifdef WIN32
+	HANDLE		hFile;
+	HANDLE		hMap;
+	LARGE_INTEGER	fileSize;
+#else
+	int			fd;
+	int			flags=MAP_PRIVATE;
+	struct stat	fileStat;
+#endif
+
+#ifdef WIN32
+	hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == hFile)
+	{
+		Log("Unable to open input file %s\n", filename);
+		exit(1);
+	}
+
+	if ((0 == GetFileSizeEx(hFile, &fileSize)) || (0 == fileSize.QuadPart))
+	{
+		/* nothing to map - let the caller read the file */
+		CloseHandle(hFile);
+		return 1;
+	}
+
+	datalen = (size_t)fileSize.QuadPart;
+
+	/* the view remains valid after the handles are closed */
+	hMap = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (hMap != NULL)
+	{
+		msgdata = (char *)MapViewOfFile(hMap, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(hMap);
+	}
+
+	CloseHandle(hFile);
+#else
+	if ((fd = open(filename, O_RDONLY)) < 0)
+	{
+		Log("Unable to open input file %s\n", filename);
+		exit(1);
+	}
+
+	if ((fstat(fd, &fileStat) != 0) || (0 == fileStat.st_size))
+	{
+		/* nothing to map - let the caller read the file */
+		close(fd);
+		return 1;
+	}
+
+	datalen = (size_t)fileStat.st_size;
+
+#ifdef MAP_POPULATE
+	/* read the whole file now rather than as the pages are first used */
+	if (1 == parms->mapPopulate)
+	{
+		flags |= MAP_POPULATE;
+	}
+#endif
+
+	/* the mapping remains valid after the file is closed */
+	msgdata = (char *)mmap(NULL, datalen, PROT_READ | PROT_WRITE, flags, fd, 0);
+	close(fd);
+
+	if (MAP_FAILED == msgdata)
+	{
+		msgdata = NULL;
+	}
+#ifdef POSIX_MADV_SEQUENTIAL
+	else
+	{
+		/* the messages are normally used in order */
+		posix_madvise(msgdata, datalen, POSIX_MADV_SEQUENTIAL);
+	}
+#endif
+#endif
+
+	if (NULL == msgdata)
+	{
+		Log("***** unable to map data file %s - reading file instead", filename);
+		return 1;
+	}
+
+	/* remember the mapping so it can be released */
+	mapPtr = (MAPPEDFILE *)malloc(sizeof(MAPPEDFILE));
+	if (NULL == mapPtr)
+	{
+		mallocError(sizeof(MAPPEDFILE), parms->memUsed);
+		exit(1);
+	}
+
+	mapPtr->addr = msgdata;
+	mapPtr->length = datalen;
+	mapPtr->nextMap = mappedFiles;
+	mappedFiles = mapPtr;
+
+	/* mapped data is not counted as memory used */
+	parms->memMapped += datalen;
+
+	/* tell what we are doing */
+	printf("\n%d bytes mapped from data file %s\n", datalen, filename);
+
+	/* set the length and data pointers */
+	(*length) = datalen;
+	(*dataptr) = msgdata;
+
+	return 0;
+}
+
 /**************************************************************/
 /*                                                            */
 /* Read message data from a file.                             */
@@ -347,6 +499,12 @@ int readFileData(const char *filename, size_t *length, char ** dataptr, PUTPARMS
 	FILE*	datafile;
 	int		rc=0;
 
+	/* check if the file should be mapped rather than read */
+	if ((1 == parms->mapFiles) && (0 == mapFileData(filename, length, dataptr, parms)))
+	{
+		return 0;
+	}
+
 	if ((datafile = fopen(filename, "rb")) == NULL)
 	{
 		Log("Unable to open input file %s\n", filename);
@@ -388,6 +546,52 @@ int readFileData(const char *filename, size_t *length, char ** dataptr, PUTPARMS
 	return rc;
 }
 
+/**************************************************************/
+/*                                                            */
+/* Release message data returned by readFileData.  The data   */
+/* is either unmapped or freed.                               */
+/*                                                            */
+/**************************************************************/
+
+void releaseFileData(char * dataptr)
+
+{
+	MAPPEDFILE	*mapPtr=mappedFiles;
+	MAPPEDFILE	*prevPtr=NULL;
+
+	/* check if this is a mapped file */
+	while ((mapPtr != NULL) && (mapPtr->addr != dataptr))
+	{
+		prevPtr = mapPtr;
+		mapPtr = (MAPPEDFILE *)mapPtr->nextMap;
+	}
+
+	if (NULL == mapPtr)
+	{
+		/* the data was read into storage */
+		free(dataptr);
+		return;
+	}
+
+	/* remove the mapping from the list */
+	if (NULL == prevPtr)
+	{
+		mappedFiles = (MAPPEDFILE *)mapPtr->nextMap;
+	}
+	else
+	{
+		prevPtr->nextMap = mapPtr->nextMap;
+	}
+
+#ifdef WIN32
+	UnmapViewOfFile(mapPtr->addr);
+#else
+	munmap(mapPtr->addr, mapPtr->length);
+#endif
+
+	free(mapPtr);
+}
+
 /**************************************************************/
 /*                                                            */
 /* Routine to scan for a delimiter sequence in the data.      */
@@ -397,37 +601,13 @@ int readFileData(const char *filename, size_t *length, char ** dataptr, PUTPARMS
 const char * scanForDelim(const char * msgdata, const size_t datalen, PUTPARMS *parms)
 
 {
-	const char *		ptr=NULL;
-	const char *		ptrend;
-
 	/* do we have a delimiter? */
 	if (parms->delimiterLen > 0)
 	{
-		ptr = msgdata;
-		ptrend = msgdata + datalen - parms->delimiterLen;
-		while ((ptr != NULL) && (ptr < ptrend) && (memcmp(ptr, parms->delimiter, parms->delimiterLen) != 0))
-		{
-			while ((ptr < ptrend) && (ptr[0] != parms->delimiter[0]))
-			{
-				ptr++;
-			}
-
-			/* could not find first character of delimiter - time to get out */
-			if (ptr[0] != parms->delimiter[0])
-			{
-				ptr = NULL;
-			}
-			else
-			{
-				if ((ptr != NULL) && (memcmp(ptr, parms->delimiter, parms->delimiterLen) != 0))
-				{
-					ptr++;
-				}
-			}
-		}
+		return searchDelim(msgdata, datalen, parms->delimiter, parms->delimiterLen);
 	}
 
-	return ptr;
+	return NULL;
 }
 
 void listMessage(size_t datalen, int useFileRFH, PUTPARMS *parms)
@@ -497,6 +677,205 @@ void listMessage(size_t datalen, int useFileRFH, PUTPARMS *parms)
 	}
 }
 
+/**************************************************************/
+/*                                                            */
+/* Create the message data file blocks for the messages in a  */
+/* buffer.  The messages are separated by delimiters, or      */
+/* delimOffsets gives the offset of the end of each message   */
+/* except the last one.  The delimOffsets area is released.   */
+/* Unless an RFH header is inserted the first file block owns */
+/* the buffer.                                                */
+/*                                                            */
+/**************************************************************/
+
+static FILEPTR * createMsgBlocks(char *msgdata, size_t datalen, size_t *delimOffsets, size_t delimCount, size_t delimLen, PUTPARMS *parms)
+
+{
+	size_t		remainLen=0;
+	size_t		memlen;
+	size_t		nextDelim=0;
+	char		*userPtr;			/* pointer to user data             */
+	const char	*delimPtr;
+	char		*allocPtr=NULL;
+	char		*allocMsg=NULL;
+	MQMD2		*mqmdPtr;
+	FILEPTR *	newfptr=NULL;
+	FILEPTR *	currfptr=NULL;
+	FILEPTR *	fptr=NULL;
+	int			mqmdVer=0;
+	int			mqmdLen=0;
+
+	/* remember the message data buffer */
+	allocPtr = msgdata;
+	userPtr = msgdata;
+
+	/* check if we are treating all the messages as a single group */
+	if (1 == parms->fileAsGroup)
+	{
+		/* indicate that we are in a group */
+		parms->inGroup = 1;
+	}
+
+	/* find all the delimiters in the file in one pass */
+	if ((NULL == delimOffsets) && (delimLen > 0))
+	{
+		delimOffsets = splitAtDelim(msgdata, datalen, parms->delimiter, parms->delimiterLen, &delimCount);
+	}
+
+	do
+	{
+		/* check if we have a delimiter in the data */
+		if (delimOffsets != NULL)
+		{
+			delimPtr = (nextDelim < delimCount) ? msgdata + delimOffsets[nextDelim++] : NULL;
+		}
+		else
+		{
+			delimPtr = scanForDelim(userPtr, datalen, parms);
+		}
+
+		/* did we find a delimiter in the data we just read in? */
+		if (delimPtr != NULL)
+		{
+			/* found a delimiter */
+			/* recalculate the data length and calculate the bytes remaining */
+			remainLen = datalen;
+			datalen = delimPtr - userPtr;
+			remainLen -= (datalen + delimLen);
+		}
+		else
+		{
+			/* last message in file */
+			remainLen = 0;
+		}
+
+		/* check for an MQMD */
+		mqmdVer = checkAndXlateMQMD(userPtr, datalen);
+		if (mqmdVer > 0)
+		{
+			/* point to the embedded MQMD */
+			mqmdPtr = (MQMD2 *)userPtr;
+
+			/* is this a Version 2 MQMD? */
+			if (MQMD_VERSION_2 == mqmdVer)
+			{
+				/* get length of MQMD V2 */
+				mqmdLen = sizeof(MQMD2);
+			}
+			else
+			{
+				/* get length of MQMD V1 */
+				mqmdLen = sizeof(MQMD);
+			}
+
+			/* move past the MQMD */
+			datalen -= mqmdLen;
+			userPtr += mqmdLen;
+		}
+		else
+		{
+			/* no MQMD */
+			mqmdPtr = NULL;
+			mqmdLen = 0;
+		}
+
+		/* check if we are inserting an RFH header at the front of the data */
+		/* an rfh header will also be inserted if latency measurements are  */
+		/* being made and the user property option has been selected.       */
+		if ((RFH_V1 == parms->rfh) || (RFH_V2 == parms->rfh) || (RFH_XML == parms->rfh) || (1 == parms->timeStampUserProp))
+		{
+			/* need to allocate storage */
+			memlen = datalen + parms->rfhlength + mqmdLen;
+			allocMsg = (char *)malloc(memlen + 1);
+
+			/* check if the malloc worked */
+			if (allocMsg != NULL)
+			{
+				/* remember how much memory we have used */
+				parms->memUsed += memlen;
+
+				/* terminate the memory to avoid overruns */
+				allocMsg[memlen] = 0;
+
+				/* is there an MQMD to copy? */
+				if (mqmdPtr != NULL)
+				{
+					/* copy the MQMD to the new message area */
+					memcpy(allocMsg, mqmdPtr, mqmdLen);
+				}
+
+				/* copy the RFH header and the message data to the allocated storage */
+				memcpy(allocMsg + mqmdLen, parms->rfhdata, parms->rfhlength);
+				memcpy(allocMsg + mqmdLen + parms->rfhlength, userPtr, datalen);
+
+				/* allocate a file pointer for this message */
+				newfptr = createFileBlock(allocMsg, allocMsg + parms->rfhlength, mqmdPtr, allocMsg, datalen + parms->rfhlength, parms->rfhlength, parms);
+
+				/* tell what we did */
+				listMessage(datalen, newfptr->useFileRFH, parms);
+			}
+			else
+			{
+				/* malloc failed - issue error message and exit the program */
+				Log("malloc failed for message with inserted RFH header - error 75");
+				parms->err = 75;
+			}
+		}
+		else
+		{
+			/* no RFH to insert - use the data in the original buffer */
+			/* allocate a file pointer for this message */
+			newfptr = createFileBlock(userPtr, userPtr + parms->rfhlength, mqmdPtr, allocPtr, datalen, 0, parms);
+
+			/* make sure to only release the acquired storage once */
+			allocPtr = NULL;
+
+			/* tell what we did */
+			listMessage(datalen, newfptr->useFileRFH, parms);
+		}
+
+		/* check if this is the first time through */
+		if (NULL == currfptr)
+		{
+			/* remember the first one */
+			fptr = newfptr;
+		}
+		else
+		{
+			/* chain the previous one to the new one */
+			currfptr->nextfile = newfptr;
+		}
+
+		/* point to the new file block */
+		currfptr = newfptr;
+
+		/* move on to the next message in the file data */
+		if (delimPtr != NULL)
+		{
+			userPtr = (char *)delimPtr + delimLen;
+			datalen = remainLen;
+		}
+	} while (((remainLen > 0) || ((delimPtr != NULL) && (0 == delimLen))) && (0 == parms->err));
+
+	if (delimOffsets != NULL)
+	{
+		free(delimOffsets);
+	}
+
+	/* check if we are treating a file as a group */
+	if (1 == parms->fileAsGroup)
+	{
+		/* check if we found at least one message in the file */
+		if (currfptr != NULL)
+		{
+			/* mark the last message in the file as last in group */
+			currfptr->lastGroup = 1;
+		}
+	}
+
+	return fptr;
+}
+
 /**************************************************************/
 /*                                                            */
 /* Create a message data file block and read and process the  */
@@ -530,27 +909,24 @@ void listMessage(size_t datalen, int useFileRFH, PUTPARMS *parms)
 /* a check will be made for an RFH header at the front of the */
 /* data.                                                      */
 /*                                                            */
+/* An indexed capture file written by mqcapture is expanded   */
+/* and the index is used instead of delimiters to find the    */
+/* messages.                                                  */
+/*                                                            */
 /**************************************************************/
 
 FILEPTR * getFileData(char *filename, PUTPARMS *parms)
 
 {
 	size_t		datalen=0;
-	size_t		remainLen=0;
-	size_t		memlen;
 	char		*msgdata=NULL;
-	char		*userPtr;			/* pointer to user data             */
-	const char	*delimPtr;
+	size_t		*delimOffsets=NULL;	/* offsets of the delimiters in the file data */
+	size_t		delimCount=0;
+	size_t		delimLen=parms->delimiterLen;
+	size_t		rawLen;
 	char		*allocPtr=NULL;
-	char		*allocMsg=NULL;
-	MQMD2		*mqmdPtr;
-	FILEPTR *	newfptr=NULL;
-	FILEPTR *	currfptr=NULL;
 	FILEPTR *	fptr=NULL;
 	int			rc;
-	int			mqmdVer=0;
-	int			mqmdLen=0;
-	int			insertRFH=0;
 
 	/* read the message data file after inserting an RFH header */
 	rc = readFileData(filename, &datalen, &msgdata, parms);
@@ -561,151 +937,37 @@ FILEPTR * getFileData(char *filename, PUTPARMS *parms)
 		/* increase the file counter */
 		parms->fileCount++;
 
-		/* was the data length > 0 */
-		if ((msgdata != NULL) && (datalen > 0))
+		/* check for an indexed capture file */
+		if ((msgdata != NULL) && isCapFile(msgdata, datalen))
 		{
-			/* remember the message data buffer */
-			allocPtr = msgdata;
-			userPtr = msgdata;
+			/* expand the file - the index gives the end of each message */
+			allocPtr = expandCapFile(msgdata, datalen, &rawLen, &delimOffsets, &delimCount);
+			releaseFileData(msgdata);
+			msgdata = allocPtr;
+			datalen = rawLen;
 
-			/* check if we are treating all the messages as a single group */
-			if (1 == parms->fileAsGroup)
+			if (NULL == msgdata)
 			{
-				/* indicate that we are in a group */
-				parms->inGroup = 1;
+				Log("***** unable to read indexed capture file %s", filename);
+				parms->err = 76;
+				return NULL;
 			}
 
-			do
+			/* the messages follow each other without any delimiters */
+			parms->memUsed += rawLen;
+			delimLen = 0;
+			if (delimCount > 0)
 			{
-				/* check if we have a delimiter in the data */
-				delimPtr = scanForDelim(userPtr, datalen, parms);
-
-				/* did we find a delimiter in the data we just read in? */
-				if (delimPtr != NULL)
-				{
-					/* found a delimiter */
-					/* recalculate the data length and calculate the bytes remaining */
-					remainLen = datalen;
-					datalen = delimPtr - userPtr;
-					remainLen -= (datalen + parms->delimiterLen);
-				}
-				else
-				{
-					/* last message in file */
-					remainLen = 0;
-				}
-
-				/* check for an MQMD */
-				mqmdVer = checkAndXlateMQMD(userPtr, datalen);
-				if (mqmdVer > 0)
-				{
-					/* point to the embedded MQMD */
-					mqmdPtr = (MQMD2 *)userPtr;
-
-					/* is this a Version 2 MQMD? */
-					if (MQMD_VERSION_2 == mqmdVer)
-					{
-						/* get length of MQMD V2 */
-						mqmdLen = sizeof(MQMD2);
-					}
-					else
-					{
-						/* get length of MQMD V1 */
-						mqmdLen = sizeof(MQMD);
-					}
-
-					/* move past the MQMD */
-					datalen -= mqmdLen;
-					userPtr += mqmdLen;
-				}
-				else
-				{
-					/* no MQMD */
-					mqmdPtr = NULL;
-					mqmdLen = 0;
-				}
-
-				/* check if we are inserting an RFH header at the front of the data */
-				/* an rfh header will also be inserted if latency measurements are  */
-				/* being made and the user property option has been selected.       */
-				if ((RFH_V1 == parms->rfh) || (RFH_V2 == parms->rfh) || (RFH_XML == parms->rfh) || (1 == parms->timeStampUserProp))
-				{
-					/* need to allocate storage */
-					memlen = datalen + parms->rfhlength + mqmdLen;
-					allocMsg = (char *)malloc(memlen + 1);
-
-					/* check if the malloc worked */
-					if (allocMsg != NULL)
-					{
-						/* remember how much memory we have used */
-						parms->memUsed += memlen;
-
-						/* terminate the memory to avoid overruns */
-						allocMsg[memlen] = 0;
-
-						/* is there an MQMD to copy? */
-						if (mqmdPtr != NULL)
-						{
-							/* copy the MQMD to the new message area */
-							memcpy(allocMsg, mqmdPtr, mqmdLen);
-						}
-
-						/* copy the RFH header and the message data to the allocated storage */
-						memcpy(allocMsg + mqmdLen, parms->rfhdata, parms->rfhlength);
-						memcpy(allocMsg + mqmdLen + parms->rfhlength, userPtr, datalen);
-
-						/* allocate a file pointer for this message */
-						newfptr = createFileBlock(allocMsg, allocMsg + parms->rfhlength, mqmdPtr, allocMsg, datalen + parms->rfhlength, parms->rfhlength, parms);
-
-						/* tell what we did */
-						listMessage(datalen, newfptr->useFileRFH, parms);
-					}
-					else
-					{
-						/* malloc failed - issue error message and exit the program */
-						Log("malloc failed for message with inserted RFH header - error 75");
-						parms->err = 75;
-					}
-				}
-				else
-				{
-					/* no RFH to insert - use the data in the original buffer */
-					/* allocate a file pointer for this message */
-					newfptr = createFileBlock(userPtr, userPtr + parms->rfhlength, mqmdPtr, allocPtr, datalen, 0, parms);
-
-					/* make sure to only release the acquired storage once */
-					allocPtr = NULL;
-
-					/* tell what we did */
-					listMessage(datalen, newfptr->useFileRFH, parms);
-				}
-
-				/* check if this is the first time through */
-				if (NULL == currfptr)
-				{
-					/* remember the first one */
-					fptr = newfptr;
-				}
-				else
-				{
-					/* chain the previous one to the new one */
-					currfptr->nextfile = newfptr;
-				}
+				delimCount--;
+			}
 
-				/* point to the new file block */
-				currfptr = newfptr;
-			} while ((remainLen > 0) && (0 == parms->err));
+			printf("%d messages (%d bytes) expanded from indexed capture file %s\n", (int)(delimCount + 1), (int)rawLen, filename);
+		}
 
-			/* check if we are treating a file as a group */
-			if (1 == parms->fileAsGroup)
-			{
-				/* check if we found at least one message in the file */
-				if (currfptr != NULL)
-				{
-					/* mark the last message in the file as last in group */
-					currfptr->lastGroup = 1;
-				}
-			}
+		/* was the data length > 0 */
+		if ((msgdata != NULL) && (datalen > 0))
+		{
+			fptr = createMsgBlocks(msgdata, datalen, delimOffsets, delimCount, delimLen, parms);
 		}
 	}
 	else
@@ -716,6 +978,33 @@ FILEPTR * getFileData(char *filename, PUTPARMS *parms)
 	return fptr;
 }
 
+/**************************************************************/
+/*                                                            */
+/* Create the message data file blocks for the messages built */
+/* by the generator.  They are treated the same way as the    */
+/* messages in a data file, except that the generator gives   */
+/* the end of each message instead of delimiters.             */
+/*                                                            */
+/**************************************************************/
+
+FILEPTR * getGeneratedData(PUTPARMS *parms)
+
+{
+	size_t		datalen=0;
+	size_t		*msgEnds=NULL;
+	size_t		msgCount=0;
+	char		*msgdata;
+
+	msgdata = generateData(parms, &datalen, &msgEnds, &msgCount);
+	if (NULL == msgdata)
+	{
+		return NULL;
+	}
+
+	/* the end of the last message is the end of the data */
+	return createMsgBlocks(msgdata, datalen, msgEnds, msgCount - 1, 0, parms);
+}
+
 /********************************************/
 /*                                          */
 /* Routine to read the parameters file.  It */
@@ -730,8 +1019,9 @@ FILEPTR * getFileData(char *filename, PUTPARMS *parms)
 /*  data files are ignored.                 */
 /*                                          */
 /* A chain of file blocks is created in     */
-/*  memory from the data files.  A pointer  */
-/*  to the first block is returned.         */
+/*  memory from the data files, followed by */
+/*  any generated messages.  A pointer to   */
+/*  the first block is returned.            */
 /*                                          */
 /********************************************/
 
@@ -853,6 +1143,26 @@ FILEPTR * processParmFile(char * parmFileName, PUTPARMS * parms, int readFiles)
 		}
 
 		fclose(parmfile);
+
+		/* add any generated messages after the data files */
+		if ((READDATAFILES == readFiles) && (parms->genCount > 0) && (0 == parms->err))
+		{
+			tempfptr = getGeneratedData(parms);
+			if (NULL == fptr)
+			{
+				fptr = tempfptr;
+			}
+			else
+			{
+				fileptr = fptr;
+				while (fileptr->nextfile != NULL)
+				{
+					fileptr = (FILEPTR *)fileptr->nextfile;
+				}
+
+				fileptr->nextfile = tempfptr;
+			}
+		}
 	}
 	else
 	{
@@ -997,3 +1307,133 @@ void appendTimeStamp(PUTPARMS * parms)
 	strcat(ptr, fileExt);
 }
 
+
+/**************************************************************/
+/*                                                            */
+/* Convert digits in an MQMD date or time field to a number.  */
+/* Returns -1 if any of the characters is not a digit.        */
+/*                                                            */
+/**************************************************************/
+
+static int getDigits(const char *ptr, int count)
+
+{
+	int		value=0;
+
+	while (count-- > 0)
+	{
+		if ((ptr[0] < '0') || (ptr[0] > '9'))
+		{
+			return -1;
+		}
+
+		value = (value * 10) + (ptr[0] - '0');
+		ptr++;
+	}
+
+	return value;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Convert the PutDate and PutTime in an MQMD to nanoseconds  */
+/* since 1970.  The MQMD times are in hundredths of a second. */
+/* Returns -1 if the date or time is not valid.               */
+/*                                                            */
+/**************************************************************/
+
+static int64_t getPutTimeNs(const MQMD2 *mqmd)
+
+{
+	int		year;
+	int		month;
+	int		day;
+	int		hours;
+	int		mins;
+	int		secs;
+	int		hundredths;
+	int		era;
+	int		yearOfEra;
+	int		dayOfYear;
+	int64_t	days;
+
+	year = getDigits(mqmd->PutDate, 4);
+	month = getDigits(mqmd->PutDate + 4, 2);
+	day = getDigits(mqmd->PutDate + 6, 2);
+	hours = getDigits(mqmd->PutTime, 2);
+	mins = getDigits(mqmd->PutTime + 2, 2);
+	secs = getDigits(mqmd->PutTime + 4, 2);
+	hundredths = getDigits(mqmd->PutTime + 6, 2);
+
+	if ((year < 0) || (month < 1) || (month > 12) || (day < 1) || (day > 31) ||
+		(hours < 0) || (mins < 0) || (secs < 0) || (hundredths < 0))
+	{
+		return -1;
+	}
+
+	/* count the days since 1970 - years start in March so the leap day is last */
+	if (month <= 2)
+	{
+		year--;
+	}
+
+	era = year / 400;
+	yearOfEra = year - (era * 400);
+	dayOfYear = (((153 * (month + ((month > 2) ? -3 : 9))) + 2) / 5) + day - 1;
+	days = ((int64_t)era * 146097) + (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear - 719468;
+
+	return ((((days * 24 + hours) * 60 + mins) * 60 + secs) * 100 + hundredths) * 10000000;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Work out when each message should be sent when the         */
+/* messages are replayed, from the put times in the MQMDs     */
+/* that were saved with the messages.  The times are relative */
+/* to the first message with a valid put time.  Messages      */
+/* without a put time, or with a put time earlier than the    */
+/* message before them, are sent straight after the previous  */
+/* message.  Returns the time from the first to the last      */
+/* message and the number of messages with put times.         */
+/*                                                            */
+/**************************************************************/
+
+int64_t setReplayTimes(FILEPTR *fptr, int64_t *timedCount)
+
+{
+	int64_t	firstNs=-1;
+	int64_t	putNs;
+	int64_t	offset=0;
+
+	(*timedCount) = 0;
+
+	while (fptr != NULL)
+	{
+		putNs = -1;
+		if ((1 == fptr->hasMQMD) && (fptr->mqmdptr != NULL))
+		{
+			putNs = getPutTimeNs((MQMD2 *)fptr->mqmdptr);
+		}
+
+		if (putNs >= 0)
+		{
+			(*timedCount)++;
+
+			if (firstNs < 0)
+			{
+				firstNs = putNs;
+			}
+
+			/* never go back in time */
+			if (putNs - firstNs > offset)
+			{
+				offset = putNs - firstNs;
+			}
+		}
+
+		fptr->replayNs = offset;
+		fptr = (FILEPTR *)fptr->nextfile;
+	}
+
+	return offset;
+}
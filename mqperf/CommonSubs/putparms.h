@@ -29,6 +29,10 @@ Jim MacNair - Initial Contribution
 #define DEF_SLEEP	10			/* Default sleep time (10 milliseconds) */
 #define MIN_THINK	0			/* 0 millisecond */
 #define MAX_THINK	30000		/* 30 seconds */
+#define MAX_THREADS	256			/* maximum number of worker threads */
+#define MAX_INFLIGHT	10000		/* maximum number of outstanding requests */
+#define DEF_REPLY_HANDLES	8		/* default number of cached reply queue handles */
+#define MAX_REPLY_HANDLES	256		/* maximum number of cached reply queue handles */
 
 typedef struct {
 	void*			nextfile;
@@ -64,6 +68,7 @@ typedef struct {
 	int				timeStampInCorrelId;
 	int				timeStampUserProp;
 	int				thinkTime;
+	int64_t			replayNs;				/* nanoseconds after the first message to replay this one */
 	char			*acqStorAddr;
 	char			CorrelId[MQ_CORREL_ID_LENGTH + 8];
 	char			GroupId[MQ_GROUP_ID_LENGTH + 8];
@@ -72,11 +77,19 @@ typedef struct {
 	char			ReplyQM[MQ_Q_MGR_NAME_LENGTH + 8];
 	char			UserId[MQ_USER_ID_LENGTH + 4];
 	char			AccountingToken[MQ_ACCOUNTING_TOKEN_LENGTH + 8];
+	int				putSlots;				/* fields to change for each put - used by MQPut2 */
+	MQLONG			openGroupFlags;			/* message flags when a group is already open - used by MQPut2 */
+	size_t			timeStampPos;			/* offset of a time stamp in the data - used by MQPut2 */
+	MQMD2			putMQMD;				/* MQMD built when the data is loaded - used by MQPut2 */
+	MQPMO			putPMO;					/* put options apart from syncpoint - used by MQPut2 */
 }	FILEPTR;
 
 FILEPTR * processParmFile(char * parmFileName, PUTPARMS * parms, int readFiles);
+FILEPTR * getGeneratedData(PUTPARMS *parms);
 int readFileData(const char *filename, size_t *length, char ** dataptr, PUTPARMS * parms);
+void releaseFileData(char * dataptr);
 const char * scanForDelim(const char * msgdata, const size_t datalen, PUTPARMS *parms);
 void createNextFileName(const char *fileName, char *newFileName, int fileCount);
 void appendTimeStamp(PUTPARMS * parms);
+int64_t setReplayTimes(FILEPTR *fptr, int64_t *timedCount);
 #endif
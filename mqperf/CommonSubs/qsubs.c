@@ -79,6 +79,29 @@ void connect2QM(char * qmname, PMQHCONN qm, PMQLONG cc, PMQLONG reason)
 	checkerror("MQCONN", *cc, *reason, qmname);
 }
 
+/********************************************************************/
+/*                                                                  */
+/*  Subroutine to connect to a queue manager using MQCONNX.         */
+/*  Used when each thread must own a separate connection handle.    */
+/*                                                                  */
+/********************************************************************/
+
+void connectX2QM(char * qmname, MQLONG options, PMQHCONN qm, PMQLONG cc, PMQLONG reason)
+
+{
+	MQCNO	mqcno={MQCNO_DEFAULT};
+
+	/* tell what we are doing */
+	Log("connecting to queue manager %s",qmname);
+
+	/* set the connect options */
+	mqcno.Options = options;
+
+	/* connect to the queue manager */
+	MQCONNX(qmname, &mqcno, qm, cc, reason);
+	checkerror("MQCONNX", *cc, *reason, qmname);
+}
+
 /********************************************************************/
 /*                                                                  */
 /*  Subroutine to connect to a queue manager.                       */
@@ -433,28 +456,28 @@ void translateMQMD(void * mqmdPtr, int datalen)
 		if (memcmp(mqmd->StrucId, ebcdicID, 4) == 0)
 		{
 			/* convert the character fields from EBCDIC to ASCII */
-			EbcdicToAscii((unsigned char *)&mqmd->Format, sizeof(mqmd->Format), (unsigned char *)&mqmd->Format);
-			EbcdicToAscii((unsigned char *)&mqmd->ReplyToQ, sizeof(mqmd->ReplyToQ), (unsigned char *)&mqmd->ReplyToQ);
-			EbcdicToAscii((unsigned char *)&mqmd->ReplyToQMgr, sizeof(mqmd->ReplyToQMgr), (unsigned char *)&mqmd->ReplyToQMgr);
-			EbcdicToAscii((unsigned char *)&mqmd->UserIdentifier, sizeof(mqmd->UserIdentifier), (unsigned char *)&mqmd->UserIdentifier);
-			EbcdicToAscii((unsigned char *)&mqmd->ApplIdentityData, sizeof(mqmd->ApplIdentityData), (unsigned char *)&mqmd->ApplIdentityData);
-			EbcdicToAscii((unsigned char *)&mqmd->PutApplName, sizeof(mqmd->PutApplName), (unsigned char *)&mqmd->PutApplName);
-			EbcdicToAscii((unsigned char *)&mqmd->PutDate, sizeof(mqmd->PutDate), (unsigned char *)&mqmd->PutDate);
-			EbcdicToAscii((unsigned char *)&mqmd->PutTime, sizeof(mqmd->PutTime), (unsigned char *)&mqmd->PutTime);
-			EbcdicToAscii((unsigned char *)&mqmd->ApplOriginData, sizeof(mqmd->ApplOriginData), (unsigned char *)&mqmd->ApplOriginData);
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->Format, sizeof(mqmd->Format));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->ReplyToQ, sizeof(mqmd->ReplyToQ));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->ReplyToQMgr, sizeof(mqmd->ReplyToQMgr));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->UserIdentifier, sizeof(mqmd->UserIdentifier));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->ApplIdentityData, sizeof(mqmd->ApplIdentityData));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->PutApplName, sizeof(mqmd->PutApplName));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->PutDate, sizeof(mqmd->PutDate));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->PutTime, sizeof(mqmd->PutTime));
+			EbcdicToAsciiInPlace((unsigned char *)&mqmd->ApplOriginData, sizeof(mqmd->ApplOriginData));
 		}
 		else if (memcmp(mqmd->StrucId, asciiID, 4) == 0)
 		{
 			/* convert the character fields from EBCDIC to ASCII */
-			AsciiToEbcdic((unsigned char *)&mqmd->Format, (unsigned char *)&mqmd->Format, sizeof(mqmd->Format));
-			AsciiToEbcdic((unsigned char *)&mqmd->ReplyToQ, (unsigned char *)&mqmd->ReplyToQ, sizeof(mqmd->ReplyToQ));
-			AsciiToEbcdic((unsigned char *)&mqmd->ReplyToQMgr, (unsigned char *)&mqmd->ReplyToQMgr, sizeof(mqmd->ReplyToQMgr));
-			AsciiToEbcdic((unsigned char *)&mqmd->UserIdentifier, (unsigned char *)&mqmd->UserIdentifier, sizeof(mqmd->UserIdentifier));
-			AsciiToEbcdic((unsigned char *)&mqmd->ApplIdentityData, (unsigned char *)&mqmd->ApplIdentityData, sizeof(mqmd->ApplIdentityData));
-			AsciiToEbcdic((unsigned char *)&mqmd->PutApplName, (unsigned char *)&mqmd->PutApplName, sizeof(mqmd->PutApplName));
-			AsciiToEbcdic((unsigned char *)&mqmd->PutDate, (unsigned char *)&mqmd->PutDate, sizeof(mqmd->PutDate));
-			AsciiToEbcdic((unsigned char *)&mqmd->PutTime, (unsigned char *)&mqmd->PutTime, sizeof(mqmd->PutTime));
-			AsciiToEbcdic((unsigned char *)&mqmd->ApplOriginData, (unsigned char *)&mqmd->ApplOriginData, sizeof(mqmd->ApplOriginData));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->Format, sizeof(mqmd->Format));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->ReplyToQ, sizeof(mqmd->ReplyToQ));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->ReplyToQMgr, sizeof(mqmd->ReplyToQMgr));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->UserIdentifier, sizeof(mqmd->UserIdentifier));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->ApplIdentityData, sizeof(mqmd->ApplIdentityData));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->PutApplName, sizeof(mqmd->PutApplName));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->PutDate, sizeof(mqmd->PutDate));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->PutTime, sizeof(mqmd->PutTime));
+			AsciiToEbcdicInPlace((unsigned char *)&mqmd->ApplOriginData, sizeof(mqmd->ApplOriginData));
 		}
 	}
 
@@ -24,6 +24,7 @@ Jim MacNair - Initial Contribution
 
 void checkerror(const char *mqcalltype, MQLONG compcode, MQLONG reason, const char *resource);
 void connect2QM(char * qmname, PMQHCONN qm, PMQLONG cc, PMQLONG reason);
+void connectX2QM(char * qmname, MQLONG options, PMQHCONN qm, PMQLONG cc, PMQLONG reason);
 void clientConnect2QM(char * qmname, PMQHCONN qm, int *maxMsgLen, PMQLONG cc, PMQLONG reason);
 void formatTime(char *timeOut, char *timeIn);
 void issueReply(MQHCONN qm, MQLONG	report, int *uow, char * msgId, PUTPARMS * parms);
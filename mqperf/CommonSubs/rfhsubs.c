@@ -185,14 +185,14 @@ void translateRFH(unsigned char * data, size_t length)
 		if (memcmp(rfh->StrucId, ebcdicID, 4) == 0)
 		{
 			/* convert the character fields from EBCDIC to ASCII */
-			EbcdicToAscii((unsigned char *)&rfh->StrucId, sizeof(rfh->StrucId), (unsigned char *)&rfh->StrucId);
-			EbcdicToAscii((unsigned char *)&rfh->Format, sizeof(rfh->Format), (unsigned char *)&rfh->Format);
+			EbcdicToAsciiInPlace((unsigned char *)&rfh->StrucId, sizeof(rfh->StrucId));
+			EbcdicToAsciiInPlace((unsigned char *)&rfh->Format, sizeof(rfh->Format));
 		}
 		else if (memcmp(rfh->StrucId, asciiID, 4) == 0)
 		{
 			/* convert the character fields from EBCDIC to ASCII */
-			AsciiToEbcdic((unsigned char *)&rfh->StrucId, (unsigned char *)&rfh->StrucId, sizeof(rfh->StrucId));
-			AsciiToEbcdic((unsigned char *)&rfh->Format, (unsigned char *)&rfh->Format, sizeof(rfh->Format));
+			AsciiToEbcdicInPlace((unsigned char *)&rfh->StrucId, sizeof(rfh->StrucId));
+			AsciiToEbcdicInPlace((unsigned char *)&rfh->Format, sizeof(rfh->Format));
 		}
 	}
 
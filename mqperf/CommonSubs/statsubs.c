@@ -0,0 +1,479 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   statsubs.c - statistics file subroutines                       */
+/*                                                                  */
+/*   Interval statistics are written as CSV or as JSON lines, one   */
+/*   record per line, so the results of a run can be loaded into    */
+/*   other tools without parsing the log.  The records are written  */
+/*   by a separate thread so the caller never waits on the file.    */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "thrdsubs.h"
+#include "timesubs.h"
+#include "histsubs.h"
+#include "statsubs.h"
+
+/* how often the writer thread checks for new records */
+#define STATS_WRITE_INTERVAL	100
+
+/* how often the counters thread checks for a new second */
+#define STATS_POLL_INTERVAL		100
+
+static const char csvHeader[] = "type,time,label,secs,msgs,bytes,total_msgs,rate,avg_rate,"
+								"lat_count,lat_avg_ns,p50_ns,p90_ns,p99_ns,p99_9_ns,p99_99_ns,lat_max_ns,depth\n";
+
+/**************************************************************/
+/*                                                            */
+/* Format a local time.  The records are built on the poll    */
+/* thread and the worker threads at the same time, so the     */
+/* static result of localtime cannot be used.                 */
+/*                                                            */
+/**************************************************************/
+
+static void formatLocalTime(char *timeStr, size_t len, const char *format, time_t now)
+
+{
+	struct tm	today;
+
+#ifdef WIN32
+	localtime_s(&today, &now);
+#else
+	localtime_r(&now, &today);
+#endif
+
+	strftime(timeStr, len, format, &today);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Writer thread.  Writes any records that have been added    */
+/* to the ring and ends when the file is closed and all the   */
+/* records have been written.                                 */
+/*                                                            */
+/**************************************************************/
+
+static void statsWriter(void * arg)
+
+{
+	STATSFILE	*stats=(STATSFILE *)arg;
+	int			ending;
+	int			count;
+
+	for (;;)
+	{
+		/* check for the end before looking for records so none are missed */
+		ending = stats->ending;
+		MEMORY_BARRIER();
+
+		count = 0;
+		while (stats->tail < stats->head)
+		{
+			/* the barrier makes sure the record is complete before it is read */
+			MEMORY_BARRIER();
+			fputs(stats->lines[stats->tail % STATS_RING_SIZE], stats->fp);
+
+			/* release the slot */
+			MEMORY_BARRIER();
+			stats->tail++;
+			count++;
+		}
+
+		if (count > 0)
+		{
+			fflush(stats->fp);
+		}
+
+		if (1 == ending)
+		{
+			break;
+		}
+
+		sleepThread(STATS_WRITE_INTERVAL);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Open a statistics file.  File names that end in .json or   */
+/* .jsonl are written as JSON lines, anything else as CSV.    */
+/* Returns NULL if the file cannot be opened.                 */
+/*                                                            */
+/**************************************************************/
+
+STATSFILE * openStatsFile(const char *fileName)
+
+{
+	size_t		len;
+	STATSFILE	*stats;
+
+	stats = (STATSFILE *)malloc(sizeof(STATSFILE));
+	if (NULL == stats)
+	{
+		Log("***** unable to allocate storage for statistics file %s", fileName);
+		return NULL;
+	}
+
+	memset(stats, 0, sizeof(STATSFILE));
+
+	/* check the file extension to decide the format */
+	len = strlen(fileName);
+	if (((len > 5) && (0 == strcmp(fileName + len - 5, ".json"))) ||
+		((len > 6) && (0 == strcmp(fileName + len - 6, ".jsonl"))))
+	{
+		stats->format = STATS_FORMAT_JSON;
+	}
+
+	stats->fp = fopen(fileName, "w");
+	if (NULL == stats->fp)
+	{
+		Log("***** unable to open statistics file %s", fileName);
+		free(stats);
+		return NULL;
+	}
+
+	if (STATS_FORMAT_CSV == stats->format)
+	{
+		fputs(csvHeader, stats->fp);
+	}
+
+	if (startThread(&(stats->writer), statsWriter, stats) != 0)
+	{
+		fclose(stats->fp);
+		free(stats);
+		return NULL;
+	}
+
+	Log("Statistics will be written to %s", fileName);
+
+	return stats;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add a record to the statistics file.  Only one thread may  */
+/* add records to a file.                                     */
+/*                                                            */
+/**************************************************************/
+
+void writeStatsRecord(STATSFILE *stats, const STATSRECORD *rec)
+
+{
+	char		timeStr[32];
+	char		depth[24];
+	char		*line;
+	time_t		now;
+
+	if (NULL == stats)
+	{
+		return;
+	}
+
+	/* never wait for the writer - drop the record if the ring is full */
+	if ((stats->head - stats->tail) >= STATS_RING_SIZE)
+	{
+		stats->dropped++;
+		return;
+	}
+
+	/* get the current local time */
+	time(&now);
+	formatLocalTime(timeStr, sizeof(timeStr), "%Y-%m-%dT%H:%M:%S", now);
+
+	line = stats->lines[stats->head % STATS_RING_SIZE];
+	if (STATS_FORMAT_JSON == stats->format)
+	{
+		if (rec->depth >= 0)
+		{
+			sprintf(depth, FMTI64, rec->depth);
+		}
+		else
+		{
+			strcpy(depth, "null");
+		}
+
+		sprintf(line, "{\"type\":\"%s\",\"time\":\"%s\",\"label\":\"%.32s\",\"secs\":" FMTI64 ",\"msgs\":" FMTI64
+					  ",\"bytes\":" FMTI64 ",\"total_msgs\":" FMTI64 ",\"rate\":%.2f,\"avg_rate\":%.2f"
+					  ",\"lat_count\":" FMTI64 ",\"lat_avg_ns\":" FMTI64 ",\"p50_ns\":" FMTI64 ",\"p90_ns\":" FMTI64
+					  ",\"p99_ns\":" FMTI64 ",\"p99_9_ns\":" FMTI64 ",\"p99_99_ns\":" FMTI64 ",\"lat_max_ns\":" FMTI64
+					  ",\"depth\":%s}\n",
+				rec->type, timeStr, rec->label, rec->secs, rec->msgs,
+				rec->bytes, rec->totalMsgs, rec->rate, rec->avgRate,
+				rec->latCount, rec->latAvg, rec->p50, rec->p90,
+				rec->p99, rec->p999, rec->p9999, rec->latMax,
+				depth);
+	}
+	else
+	{
+		if (rec->depth >= 0)
+		{
+			sprintf(depth, FMTI64, rec->depth);
+		}
+		else
+		{
+			depth[0] = 0;
+		}
+
+		sprintf(line, "%s,%s,%.32s," FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 ",%.2f,%.2f,"
+					  FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 "," FMTI64 ",%s\n",
+				rec->type, timeStr, rec->label, rec->secs, rec->msgs, rec->bytes, rec->totalMsgs, rec->rate, rec->avgRate,
+				rec->latCount, rec->latAvg, rec->p50, rec->p90, rec->p99, rec->p999, rec->p9999, rec->latMax, depth);
+	}
+
+	/* make sure the record is complete before the writer can see it */
+	MEMORY_BARRIER();
+	stats->head++;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write any remaining records and close the file.            */
+/*                                                            */
+/**************************************************************/
+
+void closeStatsFile(STATSFILE *stats)
+
+{
+	if (NULL == stats)
+	{
+		return;
+	}
+
+	/* tell the writer to finish and wait for it */
+	stats->ending = 1;
+	MEMORY_BARRIER();
+	waitThread(stats->writer);
+
+	if (stats->dropped > 0)
+	{
+		Log("***** " FMTI64 " statistics records were dropped", stats->dropped);
+	}
+
+	fclose(stats->fp);
+	free(stats);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Fill in the latency fields of a record from a histogram.   */
+/*                                                            */
+/**************************************************************/
+
+void setStatsLatency(STATSRECORD *rec, const HISTOGRAM *hist)
+
+{
+	rec->latCount = hist->count;
+	rec->latAvg = 0;
+	if (hist->count > 0)
+	{
+		rec->latAvg = hist->total / hist->count;
+	}
+
+	rec->p50 = getPercentile(hist, 50.0);
+	rec->p90 = getPercentile(hist, 90.0);
+	rec->p99 = getPercentile(hist, 99.0);
+	rec->p999 = getPercentile(hist, 99.9);
+	rec->p9999 = getPercentile(hist, 99.99);
+	rec->latMax = hist->max;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write a record from the counters.  Interval records have   */
+/* the messages since the last record and the summary has    */
+/* the totals.                                                */
+/*                                                            */
+/**************************************************************/
+
+static void writeCountRecord(STATSPOLL *poll, time_t now, int summary)
+
+{
+	int64_t		msgs=0;
+	int64_t		bytes=0;
+	int64_t		elapsed;
+	char		timeLabel[16];
+	MY_TIME_T	tick;
+	STATSRECORD	rec;
+
+	GetTime(&tick);
+	poll->countFunc(poll->arg, &msgs, &bytes);
+	formatLocalTime(timeLabel, sizeof(timeLabel), "%H:%M:%S", now);
+
+	memset(&rec, 0, sizeof(rec));
+	rec.label = timeLabel;
+	rec.totalMsgs = msgs;
+	rec.depth = -1;
+
+	if (1 == summary)
+	{
+		rec.type = "summary";
+		rec.label = "total";
+		rec.secs = now - poll->startTime;
+		rec.msgs = msgs;
+		rec.bytes = bytes;
+		elapsed = DiffTimeNs(poll->startTick, tick);
+	}
+	else
+	{
+		rec.type = "interval";
+		rec.secs = now - poll->lastTime;
+		rec.msgs = msgs - poll->lastMsgs;
+		rec.bytes = bytes - poll->lastBytes;
+		elapsed = DiffTimeNs(poll->lastTick, tick);
+	}
+
+	/* the last interval usually ends in the same second as the */
+	/* one before, so it is less than a second long - leave the  */
+	/* seconds at 0 and use the real elapsed time for the rate   */
+	if (rec.secs > 0)
+	{
+		rec.rate = (double)rec.msgs / rec.secs;
+	}
+	else if (elapsed > 0)
+	{
+		rec.rate = (double)rec.msgs * 1000000000.0 / elapsed;
+	}
+
+	if (now > poll->startTime)
+	{
+		rec.avgRate = (double)msgs / (now - poll->startTime);
+	}
+
+	writeStatsRecord(poll->stats, &rec);
+
+	poll->lastTime = now;
+	poll->lastTick = tick;
+	poll->lastMsgs = msgs;
+	poll->lastBytes = bytes;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Counters thread.  Writes an interval record each time the  */
+/* second changes, so the records from different programs    */
+/* line up on the same seconds.                               */
+/*                                                            */
+/**************************************************************/
+
+static void statsPoller(void * arg)
+
+{
+	STATSPOLL	*poll=(STATSPOLL *)arg;
+	time_t		now;
+
+	while (0 == poll->ending)
+	{
+		sleepThread(STATS_POLL_INTERVAL);
+
+		time(&now);
+		if (now != poll->lastTime)
+		{
+			writeCountRecord(poll, now, 0);
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start writing interval records from the counters.  The     */
+/* count routine is called on a separate thread, so it must   */
+/* only read the counters.  Returns NULL if there is no       */
+/* statistics file or the thread cannot be started.           */
+/*                                                            */
+/**************************************************************/
+
+STATSPOLL * startStatsPoll(STATSFILE *stats, STATS_COUNT_FUNC countFunc, void *arg)
+
+{
+	STATSPOLL	*poll;
+
+	if (NULL == stats)
+	{
+		return NULL;
+	}
+
+	poll = (STATSPOLL *)malloc(sizeof(STATSPOLL));
+	if (NULL == poll)
+	{
+		Log("***** unable to allocate storage for statistics counters");
+		return NULL;
+	}
+
+	memset(poll, 0, sizeof(STATSPOLL));
+	poll->stats = stats;
+	poll->countFunc = countFunc;
+	poll->arg = arg;
+	time(&(poll->startTime));
+	GetTime(&(poll->startTick));
+	poll->lastTime = poll->startTime;
+	poll->lastTick = poll->startTick;
+
+	if (startThread(&(poll->poller), statsPoller, poll) != 0)
+	{
+		free(poll);
+		return NULL;
+	}
+
+	return poll;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Stop the counters thread and write the last interval and   */
+/* the summary record.                                        */
+/*                                                            */
+/**************************************************************/
+
+void endStatsPoll(STATSPOLL *poll)
+
+{
+	int64_t		msgs=0;
+	int64_t		bytes=0;
+	time_t		now;
+
+	if (NULL == poll)
+	{
+		return;
+	}
+
+	poll->ending = 1;
+	MEMORY_BARRIER();
+	waitThread(poll->poller);
+
+	/* write anything since the last interval */
+	time(&now);
+	poll->countFunc(poll->arg, &msgs, &bytes);
+	if (msgs != poll->lastMsgs)
+	{
+		writeCountRecord(poll, now, 0);
+	}
+
+	writeCountRecord(poll, now, 1);
+	free(poll);
+}
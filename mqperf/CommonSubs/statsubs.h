@@ -0,0 +1,112 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   statsubs.h - header file for statsubs.c                        */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_statsubs_h
+#define _CommonSubs_statsubs_h
+
+#include <stdio.h>
+#include <time.h>
+
+#include "thrdsubs.h"
+#include "timesubs.h"
+#include "histsubs.h"
+
+#define STATS_FORMAT_CSV	0
+#define STATS_FORMAT_JSON	1
+
+#define STATS_LINE_SIZE		512			/* maximum length of a formatted record */
+#define STATS_RING_SIZE		1024		/* number of records that can be queued */
+
+/**********************************************************/
+/* One record in the statistics file.  Latencies are in   */
+/* nanoseconds.  A depth of -1 means the queue depth is   */
+/* not known.                                             */
+/**********************************************************/
+typedef struct {
+	const char	*type;				/* "interval" or "summary" */
+	const char	*label;				/* interval label, such as the put time */
+	int64_t		secs;				/* length of the interval in seconds */
+	int64_t		msgs;
+	int64_t		bytes;
+	int64_t		totalMsgs;			/* messages so far */
+	double		rate;				/* messages per second */
+	double		avgRate;			/* recent average rate */
+	int64_t		latCount;			/* number of latencies in the percentiles */
+	int64_t		latAvg;
+	int64_t		p50;
+	int64_t		p90;
+	int64_t		p99;
+	int64_t		p999;
+	int64_t		p9999;
+	int64_t		latMax;
+	int64_t		depth;
+} STATSRECORD;
+
+/**********************************************************/
+/* Statistics file.  Records are formatted by the caller  */
+/* into a ring of lines and written to the file by a      */
+/* separate thread, so adding a record never waits for    */
+/* the file system.  If the ring is full the record is    */
+/* dropped and counted.                                   */
+/**********************************************************/
+typedef struct {
+	FILE				*fp;
+	int					format;
+	volatile int		ending;
+	volatile int64_t	head;		/* next record to be added */
+	volatile int64_t	tail;		/* next record to be written */
+	int64_t				dropped;
+	THREAD_T			writer;
+	char				lines[STATS_RING_SIZE][STATS_LINE_SIZE];
+} STATSFILE;
+
+/**********************************************************/
+/* Statistics for a program that only keeps message and   */
+/* byte counters.  A separate thread calls the count      */
+/* routine each second, which must add up the counters    */
+/* from all the worker threads, and writes an interval    */
+/* record with the difference from the last call.         */
+/**********************************************************/
+typedef void (*STATS_COUNT_FUNC)(void *arg, int64_t *msgs, int64_t *bytes);
+
+typedef struct {
+	STATSFILE			*stats;
+	STATS_COUNT_FUNC	countFunc;
+	void				*arg;
+	volatile int		ending;
+	time_t				startTime;
+	time_t				lastTime;
+	MY_TIME_T			startTick;	/* for the rate of intervals under a second */
+	MY_TIME_T			lastTick;
+	int64_t				lastMsgs;
+	int64_t				lastBytes;
+	THREAD_T			poller;
+} STATSPOLL;
+
+STATSFILE * openStatsFile(const char *fileName);
+void writeStatsRecord(STATSFILE *stats, const STATSRECORD *rec);
+void closeStatsFile(STATSFILE *stats);
+void setStatsLatency(STATSRECORD *rec, const HISTOGRAM *hist);
+STATSPOLL * startStatsPoll(STATSFILE *stats, STATS_COUNT_FUNC countFunc, void *arg);
+void endStatsPoll(STATSPOLL *poll);
+#endif
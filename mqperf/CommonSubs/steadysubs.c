@@ -0,0 +1,424 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   steadysubs.c - steady state detection subroutines              */
+/*                                                                  */
+/*   The rate at the start of a run is affected by connecting,      */
+/*   opening queues, filling caches and the queue manager log, and  */
+/*   the rate at the end by the producers stopping.  To make the    */
+/*   results of different runs comparable the rate and latency are  */
+/*   also reported for a steady window only.                        */
+/*                                                                  */
+/*   Intervals are ignored until the warmupTime (seconds) and       */
+/*   warmupCount (messages) parameters have passed.  The rates of   */
+/*   the last steadyWindow intervals are then kept and the steady   */
+/*   window starts once their coefficient of variation is below    */
+/*   steadyCov percent.  The intervals used to decide that the      */
+/*   rate is steady are not included in the window.  The window     */
+/*   ends when the variation goes above the limit again, and if     */
+/*   the rate settles again later a new window is started.  The     */
+/*   longest window is reported.                                    */
+/*                                                                  */
+/*   The last interval of a run is never passed to these routines,  */
+/*   since it is usually only part of a second.                     */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "math.h"
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "steadysubs.h"
+
+/**************************************************************/
+/*                                                            */
+/* Get ready to check the intervals.  The latency histograms  */
+/* are only allocated if latencies are being measured.        */
+/*                                                            */
+/**************************************************************/
+
+void initSteadyState(STEADYSTATE *steady, PUTPARMS *parms, int latency)
+
+{
+	memset(steady, 0, sizeof(STEADYSTATE));
+
+	steady->state = STEADY_WARMUP;
+	steady->lowestCov = -1.0;
+	steady->warmupSecs = parms->warmupTime;
+	steady->warmupMsgs = parms->warmupCount;
+	steady->window = parms->steadyWindow;
+	steady->maxCov = (double)parms->steadyCov / 100.0;
+
+	/* make sure the window is sensible */
+	if (steady->window < 2)
+	{
+		steady->window = 2;
+	}
+
+	if (steady->window > STEADY_WINDOW_MAX)
+	{
+		steady->window = STEADY_WINDOW_MAX;
+	}
+
+	if (parms->steadyCov <= 0)
+	{
+		steady->maxCov = (double)STEADY_COV_DEF / 100.0;
+	}
+
+	if (1 == latency)
+	{
+		steady->startHist = (HISTOGRAM *)malloc(sizeof(HISTOGRAM));
+		steady->curr.hist = (HISTOGRAM *)malloc(sizeof(HISTOGRAM));
+		steady->best.hist = (HISTOGRAM *)malloc(sizeof(HISTOGRAM));
+
+		if ((NULL == steady->startHist) || (NULL == steady->curr.hist) || (NULL == steady->best.hist))
+		{
+			/* carry on without the latencies */
+			Log("***** unable to allocate storage for steady state latencies");
+			free(steady->startHist);
+			free(steady->curr.hist);
+			free(steady->best.hist);
+			steady->startHist = NULL;
+			steady->curr.hist = NULL;
+			steady->best.hist = NULL;
+		}
+		else
+		{
+			clearHistogram(steady->best.hist);
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the coefficient of variation of the recent rates.      */
+/*                                                            */
+/**************************************************************/
+
+static double getRateCov(STEADYSTATE *steady)
+
+{
+	int		i;
+	double	mean=0.0;
+	double	variance=0.0;
+
+	for (i = 0; i < steady->window; i++)
+	{
+		mean += steady->rates[i];
+	}
+
+	mean /= steady->window;
+	if (mean <= 0.0)
+	{
+		return 1.0e9;
+	}
+
+	for (i = 0; i < steady->window; i++)
+	{
+		variance += (steady->rates[i] - mean) * (steady->rates[i] - mean);
+	}
+
+	variance /= steady->window;
+
+	return sqrt(variance) / mean;
+}
+
+/**************************************************************/
+/*                                                            */
+/* End the current window, keeping it if it is the longest.   */
+/*                                                            */
+/**************************************************************/
+
+static void closeWindow(STEADYSTATE *steady)
+
+{
+	HISTOGRAM	*bestHist=steady->best.hist;
+
+	if ((steady->curr.intervals > 0) &&
+		((0 == steady->best.intervals) ||
+		 (steady->curr.endTime - steady->curr.startTime > steady->best.endTime - steady->best.startTime)))
+	{
+		memcpy(&(steady->best), &(steady->curr), sizeof(STEADYWINDOW));
+		steady->best.hist = bestHist;
+
+		if (bestHist != NULL)
+		{
+			memcpy(bestHist, steady->curr.hist, sizeof(HISTOGRAM));
+		}
+	}
+
+	steady->curr.intervals = 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check an interval that has ended.  The total message count */
+/* and the histogram are the values at the end of the         */
+/* interval.  The histogram must include all the latencies    */
+/* since the start of the run and can be NULL.                */
+/*                                                            */
+/**************************************************************/
+
+void addSteadyInterval(STEADYSTATE *steady, time_t intervalStart, int64_t secs, int64_t msgs, int64_t totalMsgs, const HISTOGRAM *hist)
+
+{
+	double		rate;
+	double		cov;
+	time_t		intervalEnd;
+	char		timeStr[16];
+
+	if (secs < 1)
+	{
+		return;
+	}
+
+	intervalEnd = intervalStart + (time_t)secs;
+	if (0 == steady->firstTime)
+	{
+		steady->firstTime = intervalStart;
+	}
+
+	/* ignore the intervals in the warm up */
+	if (STEADY_WARMUP == steady->state)
+	{
+		if ((intervalEnd - steady->firstTime < steady->warmupSecs) || (totalMsgs < steady->warmupMsgs))
+		{
+			return;
+		}
+
+		steady->state = STEADY_SEARCHING;
+
+		if ((steady->warmupSecs > 0) || (steady->warmupMsgs > 0))
+		{
+			formatTimeSecs(timeStr, intervalEnd);
+			Log("Warm up ended at %s after %d seconds and " FMTI64 " messages", timeStr, (int)(intervalEnd - steady->firstTime), totalMsgs);
+		}
+
+		return;
+	}
+
+	/* remember the rates of the last window intervals */
+	rate = (double)msgs / (double)secs;
+	steady->rates[steady->rateNext] = rate;
+	steady->rateNext = (steady->rateNext + 1) % steady->window;
+	if (steady->rateCount < steady->window)
+	{
+		steady->rateCount++;
+	}
+
+	if (steady->rateCount < steady->window)
+	{
+		return;
+	}
+
+	cov = getRateCov(steady);
+	if ((steady->lowestCov < 0.0) || (cov < steady->lowestCov))
+	{
+		steady->lowestCov = cov;
+	}
+
+	if (STEADY_SEARCHING == steady->state)
+	{
+		if (cov <= steady->maxCov)
+		{
+			/* start a new window at the end of this interval */
+			steady->state = STEADY_FOUND;
+			steady->curr.startTime = intervalEnd;
+			steady->curr.endTime = intervalEnd;
+			steady->curr.msgs = 0;
+			steady->curr.intervals = 0;
+			steady->curr.minRate = 0.0;
+			steady->curr.maxRate = 0.0;
+
+			if ((steady->startHist != NULL) && (hist != NULL))
+			{
+				memcpy(steady->startHist, hist, sizeof(HISTOGRAM));
+				clearHistogram(steady->curr.hist);
+			}
+
+			formatTimeSecs(timeStr, intervalEnd);
+			Log("Steady state reached at %s - rate varied by %.1f%% over the last %d intervals", timeStr, cov * 100.0, steady->window);
+		}
+
+		return;
+	}
+
+	/* check if the rate is still steady */
+	if (cov > steady->maxCov)
+	{
+		formatTimeSecs(timeStr, steady->curr.endTime);
+		Log("Steady state ended at %s - rate varied by %.1f%% over the last %d intervals", timeStr, cov * 100.0, steady->window);
+
+		closeWindow(steady);
+		steady->state = STEADY_SEARCHING;
+		return;
+	}
+
+	/* add the interval to the window */
+	if ((0 == steady->curr.intervals) || (rate < steady->curr.minRate))
+	{
+		steady->curr.minRate = rate;
+	}
+
+	if ((0 == steady->curr.intervals) || (rate > steady->curr.maxRate))
+	{
+		steady->curr.maxRate = rate;
+	}
+
+	steady->curr.msgs += msgs;
+	steady->curr.intervals++;
+	steady->curr.endTime = intervalEnd;
+
+	if ((steady->startHist != NULL) && (hist != NULL))
+	{
+		subtractHistogram(steady->curr.hist, hist, steady->startHist);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check the intervals for a program that does not report     */
+/* each second.  This is called before each message is        */
+/* counted, with the number of messages so far, and passes    */
+/* an interval on each time the second changes.               */
+/*                                                            */
+/**************************************************************/
+
+void addSteadyCount(STEADYSTATE *steady, int64_t totalMsgs, const HISTOGRAM *hist)
+
+{
+	time_t		now;
+
+	time(&now);
+	if (0 == steady->lastTime)
+	{
+		steady->lastTime = now;
+		steady->lastMsgs = totalMsgs;
+		return;
+	}
+
+	if (now == steady->lastTime)
+	{
+		return;
+	}
+
+	addSteadyInterval(steady, steady->lastTime, now - steady->lastTime, totalMsgs - steady->lastMsgs, totalMsgs, hist);
+
+	steady->lastTime = now;
+	steady->lastMsgs = totalMsgs;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Report the longest steady window at the end of the run and */
+/* write it to the statistics file as a steady record.        */
+/*                                                            */
+/**************************************************************/
+
+void reportSteadyState(STEADYSTATE *steady, STATSFILE *stats)
+
+{
+	int64_t		secs;
+	double		rate;
+	char		timeStart[16];
+	char		timeEnd[16];
+	char		label[40];
+	char		avgLatency[16];
+	char		percentiles[160];
+	STATSRECORD	rec;
+	STEADYWINDOW	*best=&(steady->best);
+
+	if (STEADY_FOUND == steady->state)
+	{
+		closeWindow(steady);
+	}
+
+	if (0 == best->intervals)
+	{
+		if (STEADY_WARMUP == steady->state)
+		{
+			Log("\nSteady state not found - the run ended in the warm up");
+		}
+		else if (steady->lowestCov < 0.0)
+		{
+			Log("\nSteady state not found - fewer than %d intervals after the warm up", steady->window + 1);
+		}
+		else
+		{
+			Log("\nSteady state not found - the lowest variation in the rate over %d intervals was %.1f%% (limit %.1f%%)",
+				steady->window, steady->lowestCov * 100.0, steady->maxCov * 100.0);
+		}
+	}
+	else
+	{
+		secs = best->endTime - best->startTime;
+		rate = (double)best->msgs / (double)secs;
+		formatTimeSecs(timeStart, best->startTime);
+		formatTimeSecs(timeEnd, best->endTime);
+
+		Log("\nSteady state from %s to %s (%d seconds) messages " FMTI64 " rate %.2f msgs/sec", timeStart, timeEnd, (int)secs, best->msgs, rate);
+		Log("Steady state interval rates min %.2f max %.2f", best->minRate, best->maxRate);
+
+		if ((best->hist != NULL) && (best->hist->count > 0))
+		{
+			formatTimeDiffNs(avgLatency, best->hist->total / best->hist->count);
+			formatPercentiles(percentiles, best->hist);
+			Log("Steady state latency avg %s %s", avgLatency, percentiles);
+		}
+
+		if (stats != NULL)
+		{
+			sprintf(label, "%s-%s", timeStart, timeEnd);
+
+			memset(&rec, 0, sizeof(rec));
+			rec.type = "steady";
+			rec.label = label;
+			rec.secs = secs;
+			rec.msgs = best->msgs;
+			rec.totalMsgs = best->msgs;
+			rec.rate = rate;
+			rec.avgRate = rate;
+			rec.depth = -1;
+
+			if (best->hist != NULL)
+			{
+				setStatsLatency(&rec, best->hist);
+			}
+
+			writeStatsRecord(stats, &rec);
+		}
+	}
+
+	free(steady->startHist);
+	free(steady->curr.hist);
+	free(steady->best.hist);
+	steady->startHist = NULL;
+	steady->curr.hist = NULL;
+	steady->best.hist = NULL;
+}
@@ -0,0 +1,82 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   steadysubs.h - header file for steadysubs.c                    */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_steadysubs_h
+#define _CommonSubs_steadysubs_h
+
+#include <time.h>
+
+#include "histsubs.h"
+#include "statsubs.h"
+
+#define STEADY_WARMUP		0			/* still in the warm up */
+#define STEADY_SEARCHING	1			/* waiting for the rate to settle */
+#define STEADY_FOUND		2			/* in a steady window */
+
+/**********************************************************/
+/* One window of intervals with a steady rate.  The       */
+/* latencies are only kept if a histogram is passed with  */
+/* the intervals.                                         */
+/**********************************************************/
+typedef struct {
+	time_t		startTime;			/* start of the first interval */
+	time_t		endTime;			/* end of the last interval */
+	int64_t		msgs;
+	int64_t		intervals;
+	double		minRate;
+	double		maxRate;
+	HISTOGRAM	*hist;				/* latencies in the window */
+} STEADYWINDOW;
+
+/**********************************************************/
+/* Steady state detector.  Intervals are ignored until    */
+/* the warm up time and message count have passed.  After */
+/* that the steady window starts once the coefficient of  */
+/* variation (standard deviation divided by the mean) of  */
+/* the rates of the last window intervals is below the    */
+/* limit, and ends when it goes above it again.  The      */
+/* longest steady window is reported.                     */
+/**********************************************************/
+typedef struct {
+	int			state;
+	int			window;				/* intervals used to check the rate */
+	double		maxCov;				/* largest coefficient of variation */
+	double		lowestCov;			/* smallest seen, to report if never steady */
+	int			warmupSecs;
+	int64_t		warmupMsgs;
+	time_t		firstTime;			/* start of the first interval */
+	time_t		lastTime;			/* used by addSteadyCount */
+	int64_t		lastMsgs;
+	int			rateCount;
+	int			rateNext;
+	double		rates[STEADY_WINDOW_MAX];
+	HISTOGRAM	*startHist;			/* latencies at the start of the current window */
+	STEADYWINDOW	curr;
+	STEADYWINDOW	best;
+} STEADYSTATE;
+
+void initSteadyState(STEADYSTATE *steady, PUTPARMS *parms, int latency);
+void addSteadyInterval(STEADYSTATE *steady, time_t intervalStart, int64_t secs, int64_t msgs, int64_t totalMsgs, const HISTOGRAM *hist);
+void addSteadyCount(STEADYSTATE *steady, int64_t totalMsgs, const HISTOGRAM *hist);
+void reportSteadyState(STEADYSTATE *steady, STATSFILE *stats);
+#endif
@@ -0,0 +1,162 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   thrdsubs.c - platform independent thread subroutines           */
+/*                                                                  */
+/********************************************************************/
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+/* thread subroutines */
+#include "thrdsubs.h"
+#include "comsubs.h"
+
+/* area passed to the platform specific thread entry point */
+typedef struct {
+	THREAD_FUNC	func;
+	void		*arg;
+} THREAD_START;
+
+/**************************************************************/
+/*                                                            */
+/* Common entry point for all worker threads.  The start      */
+/* area is released before the worker routine is called.      */
+/*                                                            */
+/**************************************************************/
+
+#ifdef WIN32
+static DWORD WINAPI threadEntry(LPVOID parm)
+#else
+static void * threadEntry(void * parm)
+#endif
+
+{
+	THREAD_START	start;
+
+	/* make a local copy of the start parameters and release the area */
+	memcpy(&start, parm, sizeof(start));
+	free(parm);
+
+	/* run the worker routine */
+	start.func(start.arg);
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start a new thread running the specified routine.          */
+/* Returns zero if the thread was started.                    */
+/*                                                            */
+/**************************************************************/
+
+int startThread(THREAD_T *thread, THREAD_FUNC func, void * arg)
+
+{
+	int				rc=0;
+	THREAD_START	*start;
+
+	/* get an area to pass the routine and argument to the new thread */
+	start = (THREAD_START *)malloc(sizeof(THREAD_START));
+	if (NULL == start)
+	{
+		Log("***** unable to allocate storage to start thread");
+		return 1;
+	}
+
+	start->func = func;
+	start->arg = arg;
+
+#ifdef WIN32
+	(*thread) = CreateThread(NULL, 0, threadEntry, start, 0, NULL);
+	if (NULL == (*thread))
+	{
+		rc = GetLastError();
+	}
+#else
+	rc = pthread_create(thread, NULL, threadEntry, start);
+#endif
+
+	if (rc != 0)
+	{
+		/* the thread did not start so release the area here */
+		Log("***** unable to start thread rc=%d", rc);
+		free(start);
+	}
+
+	return rc;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Wait for a thread to end and release the thread handle.    */
+/*                                                            */
+/**************************************************************/
+
+void waitThread(THREAD_T thread)
+
+{
+#ifdef WIN32
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Atomically add to a 64-bit counter that is shared by       */
+/* several threads.  Returns the new value of the counter.    */
+/*                                                            */
+/**************************************************************/
+
+int64_t atomicAdd64(volatile int64_t *value, int64_t amount)
+
+{
+#ifdef WIN32
+	return InterlockedExchangeAdd64(value, amount) + amount;
+#else
+	return __sync_add_and_fetch(value, amount);
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Suspend the calling thread for a number of milliseconds.   */
+/*                                                            */
+/**************************************************************/
+
+void sleepThread(int millis)
+
+{
+#ifdef WIN32
+	Sleep(millis);
+#else
+	usleep(millis * 1000);
+#endif
+}
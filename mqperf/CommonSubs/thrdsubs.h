@@ -0,0 +1,76 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   thrdsubs.h - header file for thrdsubs.c                        */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_thrdsubs_h
+#define _CommonSubs_thrdsubs_h
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/**********************************************************/
+/* THREAD_T                                               */
+/* The definition of this data type is platform specific. */
+/**********************************************************/
+#ifdef WIN32
+typedef HANDLE THREAD_T;
+#else
+typedef pthread_t THREAD_T;
+#endif
+
+/* routine run by a worker thread */
+typedef void (*THREAD_FUNC)(void * arg);
+
+/**********************************************************/
+/* MEMORY_BARRIER                                         */
+/* Full memory fence, used to publish counters that are   */
+/* read by other threads without a lock.                  */
+/**********************************************************/
+#ifdef WIN32
+#define MEMORY_BARRIER()	MemoryBarrier()
+#else
+#define MEMORY_BARRIER()	__sync_synchronize()
+#endif
+
+/**********************************************************/
+/* WRITE_BARRIER                                          */
+/* Keeps earlier stores ahead of later ones.  This costs  */
+/* nothing on x86, where stores are not reordered, so it  */
+/* can be used for each message.                          */
+/**********************************************************/
+#ifdef WIN32
+#if defined(_M_IX86) || defined(_M_X64)
+#define WRITE_BARRIER()		_WriteBarrier()
+#else
+#define WRITE_BARRIER()		MemoryBarrier()
+#endif
+#else
+#define WRITE_BARRIER()		__atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+int startThread(THREAD_T *thread, THREAD_FUNC func, void * arg);
+void waitThread(THREAD_T thread);
+int64_t atomicAdd64(volatile int64_t *value, int64_t amount);
+void sleepThread(int millis);
+#endif
@@ -36,12 +36,65 @@ Jim MacNair - Initial Contribution
 #ifdef _WIN32
 	/* Results of QueryPerformanceFrequency - done only once to reduce overhead */
 	static __int64	freq=0;
+#else
+/* use the raw hardware clock if available, since it is not adjusted by NTP */
+#if defined(CLOCK_MONOTONIC_RAW)
+#define MY_CLOCK	CLOCK_MONOTONIC_RAW
+#elif defined(CLOCK_MONOTONIC)
+#define MY_CLOCK	CLOCK_MONOTONIC
+#endif
+
+#if defined(USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HAVE_TSC
+
+	/* TSC calibration - set by InitializeTimer */
+	static int		tscEnabled=0;
+	static int64_t	tscBase=0;			/* TSC value at calibration */
+	static int64_t	tscBaseNs=0;		/* clock time at calibration */
+	static double	tscNsPerTick=0.0;	/* nanoseconds per TSC tick */
+#endif
+#endif
+
+/* set to 1 to use the time of day instead of the monotonic clock */
+static int	wallClock=0;
+
+#ifndef _WIN32
+/*********************************************************/
+/* readClock - get the monotonic clock in nanoseconds,   */
+/*  or the time of day if setWallClock was called.       */
+/*********************************************************/
+
+static int64_t readClock()
+
+{
+#ifdef MY_CLOCK
+	struct timespec	ts;
+
+	clock_gettime((1 == wallClock) ? CLOCK_REALTIME : MY_CLOCK, &ts);
+	return ((int64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+#else
+	struct timeval	tv;
+
+	/* no monotonic clock - fall back to the time of day */
+	gettimeofday(&tv, 0);
+	return ((int64_t)tv.tv_sec * 1000000000) + ((int64_t)tv.tv_usec * 1000);
+#endif
+}
 #endif
 
 void InitializeTimer()
 
 {
 #ifdef WIN32
+	/* the time of day is in units of 100 nanoseconds */
+	if (1 == wallClock)
+	{
+		freq = 10000000;
+		return;
+	}
+
 	/* get the counts per second as a LARGE_INTEGER if running under windows */
 	if (!QueryPerformanceFrequency((LARGE_INTEGER *)&freq))
 	{
@@ -52,6 +105,41 @@ void InitializeTimer()
 		Log("*****WARNING! - No performance counter on hardware");
 	}
 #endif
+
+#ifdef HAVE_TSC
+	unsigned int	eax, ebx, ecx, edx;
+	int64_t			tsc;
+	int64_t			ns;
+	struct timespec	delay;
+
+	/* the TSC is only calibrated against the monotonic clock */
+	if (1 == wallClock)
+	{
+		return;
+	}
+
+	/* the TSC can only be used if it runs at a constant rate in all power states */
+	if ((0 == __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) || (0 == (edx & (1 << 8))))
+	{
+		Log("*****WARNING! - TSC is not invariant - using the system clock");
+		return;
+	}
+
+	/* measure the TSC against the clock over 50 milliseconds */
+	tscBaseNs = readClock();
+	tscBase = (int64_t)__rdtsc();
+	delay.tv_sec = 0;
+	delay.tv_nsec = 50000000;
+	nanosleep(&delay, NULL);
+	ns = readClock();
+	tsc = (int64_t)__rdtsc();
+
+	if ((tsc > tscBase) && (ns > tscBaseNs))
+	{
+		tscNsPerTick = (double)(ns - tscBaseNs) / (double)(tsc - tscBase);
+		tscEnabled = 1;
+	}
+#endif
 }
 
 /*********************************************************/
@@ -62,6 +150,15 @@ void GetTime(MY_TIME_T *tv)
 {
 #ifdef _WIN32
 	LARGE_INTEGER	count;
+	FILETIME		now;
+
+	if (1 == wallClock)
+	{
+		/* 100 nanosecond units since 1601 */
+		GetSystemTimePreciseAsFileTime(&now);
+		(*tv) = ((unsigned __int64)now.dwHighDateTime << 32) | now.dwLowDateTime;
+		return;
+	}
 
 	if (!QueryPerformanceCounter(&count))
 	{
@@ -70,20 +167,74 @@ void GetTime(MY_TIME_T *tv)
 
 	(*tv) = count.QuadPart;
 #else
-	gettimeofday(tv, 0);
+	(*tv) = readClock();
+#endif
+}
+
+/*********************************************************/
+/* setWallClock - use the time of day for GetTime, so    */
+/*  that a time stamp set on one machine can be compared */
+/*  with the time on another.  The result is only as     */
+/*  good as the synchronization of the two clocks (NTP   */
+/*  or PTP), and a clock that is stepped gives wrong     */
+/*  intervals.  Must be called before any times are      */
+/*  taken.                                               */
+/*********************************************************/
+
+void setWallClock(int enabled)
+{
+	wallClock = enabled;
+
+#ifdef _WIN32
+	/* get the frequency again for the new clock */
+	freq = 0;
+	InitializeTimer();
+#endif
+
+#ifdef HAVE_TSC
+	/* the TSC follows the monotonic clock */
+	if (1 == enabled)
+	{
+		tscEnabled = 0;
+	}
 #endif
 }
 
+/*********************************************************/
+/* usingWallClock - check if times are the time of day.  */
+/*********************************************************/
+
+int usingWallClock()
+{
+	return wallClock;
+}
+
+/*********************************************************/
+/* GetFastTime - get high precision time, using the TSC  */
+/*  if it was calibrated by InitializeTimer.  The result */
+/*  can be compared with GetTime values, but should only */
+/*  be used for intervals measured within this program,  */
+/*  since other programs will have their own calibration.*/
+/*********************************************************/
+
+void GetFastTime(MY_TIME_T *tv)
+{
+#ifdef HAVE_TSC
+	if (1 == tscEnabled)
+	{
+		(*tv) = tscBaseNs + (int64_t)((double)((int64_t)__rdtsc() - tscBase) * tscNsPerTick);
+		return;
+	}
+#endif
+
+	GetTime(tv);
+}
+
 /* clear the time to zero */
 void clearTime(MY_TIME_T *time)
 
 {
-#ifdef _WIN32
 	(*time) = 0;
-#else
-	(*time).tv_sec = 0;
-	(*time).tv_usec = 0;
-#endif
 }
 
 /* return the time in microseconds */
@@ -97,9 +248,7 @@ int64_t timeToMicroSecs(MY_TIME_T time)
 		result = (time * 1000 * 1000) / freq;
 	}
 #else
-	result = time.tv_sec;
-	result = result * 1000 * 1000;
-	result = result + time.tv_usec;
+	result = time / 1000;
 #endif
 
 	return result;
@@ -128,27 +277,62 @@ int64_t DiffTime(MY_TIME_T start, MY_TIME_T end)
 		return 0;
 	}
 #else
-	int64_t	val;
+	/* return the difference in microseconds */
+	return (end - start) / 1000;
+#endif
+}
+
+/*********************************************************/
+/* DiffTimeNs - difference in nanoseconds between two    */
+/*  high precision times.                                */
+/*********************************************************/
 
-	/* is the ending microsecond value less than the starting microsecond value? */
-	if (end.tv_usec < start.tv_usec)
+int64_t DiffTimeNs(MY_TIME_T start, MY_TIME_T end)
+{
+#ifdef _WIN32
+	int64_t	diff;
+
+	if (0 == freq)
 	{
-		/* borrow a second (1000000 microsecs) from the end time */
-		val = 1000000 + end.tv_usec - start.tv_usec;
+		InitializeTimer();
+	}
 
-		/* account for the borrowed second */
-		end.tv_sec--;
+	if (freq > 0)
+	{
+		/* convert whole seconds separately to avoid overflow */
+		diff = (int64_t)(end - start);
+		return ((diff / freq) * 1000000000) + (((diff % freq) * 1000000000) / freq);
 	}
 	else
 	{
-		/* just subtract the two microsecond value */
-		val = end.tv_usec - start.tv_usec;
+		/* unable to get frequency - don't divide by zero */
+		return 0;
 	}
+#else
+	return end - start;
+#endif
+}
+
+/*********************************************************/
+/* AddTimeNs - advance a high precision time by a number */
+/*  of nanoseconds.                                      */
+/*********************************************************/
 
-	val += (end.tv_sec - start.tv_sec)*1000000;
+void AddTimeNs(MY_TIME_T *time, int64_t ns)
+{
+#ifdef _WIN32
+	if (0 == freq)
+	{
+		InitializeTimer();
+	}
 
- /* return the difference in microseconds */
-	return val;
+	if (freq > 0)
+	{
+		/* convert whole seconds separately to avoid overflow */
+		(*time) += ((ns / 1000000000) * freq) + (((ns % 1000000000) * freq) / 1000000000);
+	}
+#else
+	(*time) += ns;
 #endif
 }
 
@@ -190,6 +374,44 @@ void formatTimeDiff(char * result, int64_t diff)
 	}
 }
 
+/*********************************************************/
+/* formatTimeDiffNs - format a number of nanoseconds     */
+/*  resulting from a difference between two times.       */
+/*********************************************************/
+
+void formatTimeDiffNs(char * result, int64_t diff)
+
+{
+	int64_t	secs=0;
+	int64_t	nsecs=0;
+	int		i;
+	int		slen;
+
+	result[0] = 0;
+
+	/* divide the time into seconds and nanoseconds */
+	secs = diff / 1000000000;
+	nsecs = diff % 1000000000;
+
+#ifdef _WIN32
+	/* format the results */
+	sprintf(result, "%I64d.%9.9I64d", secs, nsecs);
+#else
+	/* format the results */
+	sprintf(result, "%lld.%9.9lld", secs, nsecs);
+#endif
+
+	/* replace any blanks with zeros */
+	slen = strlen(result);
+	for (i = 0; i < slen; i++)
+	{
+		if (' ' == result[i])
+		{
+			result[i] = '0';
+		}
+	}
+}
+
 /*********************************************************/
 /*                                                       */
 /* Perform a timer check and then exit.                  */
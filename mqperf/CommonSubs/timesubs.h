@@ -24,22 +24,36 @@ Jim MacNair - Initial Contribution
 /**********************************************************/
 /* MY_TIME_T                                              */
 /* The definition of this data type is platform specific. */
+/* On Windows it is a performance counter value.  On      */
+/* other platforms it is a monotonic clock reading in     */
+/* nanoseconds.  Either way it is 8 bytes long and can be */
+/* carried in a message and compared with a value read    */
+/* by another program on the same machine.  After         */
+/* setWallClock(1) it is the time of day instead, which   */
+/* can be compared between machines whose clocks are      */
+/* kept in step.                                          */
 /**********************************************************/
 #ifdef WIN32
 typedef unsigned __int64 MY_TIME_T;
 #else
-typedef struct timeval MY_TIME_T;
+typedef int64_t MY_TIME_T;
 #endif
 
 void GetTime(MY_TIME_T *tv);
+void GetFastTime(MY_TIME_T *tv);
 void clearTime(MY_TIME_T *time);
 int64_t timeToMicroSecs(MY_TIME_T time);
 int64_t DiffTime(MY_TIME_T start, MY_TIME_T end);
+int64_t DiffTimeNs(MY_TIME_T start, MY_TIME_T end);
+void AddTimeNs(MY_TIME_T *time, int64_t ns);
 void formatTimeDiff(char * result, int64_t diff);
+void formatTimeDiffNs(char * result, int64_t diff);
 void performTimerCheck();
 void formatTimeSecsNoColons(char * timeOut, time_t timeIn);
 void formatTimeSecs(char * timeOut, time_t timeIn);
 void formatTimeDiffSecs(char * result, int64_t time);
 void InitializeTimer();
+void setWallClock(int enabled);
+int usingWallClock();
 int getSecs(int time);
 #endif
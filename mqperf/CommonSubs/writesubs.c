@@ -0,0 +1,644 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   writesubs.c - capture file writer subroutines                  */
+/*                                                                  */
+/*   Captured messages are copied into large output buffers and     */
+/*   the buffers are written to the file by a separate thread, so   */
+/*   a slow disk does not hold up the MQGETs until all the buffers  */
+/*   are waiting to be written.  On Linux the data can be written   */
+/*   with O_DIRECT to bypass the file system cache.                 */
+/*                                                                  */
+/********************************************************************/
+
+/* O_DIRECT is only defined by glibc for GNU extensions */
+#if !defined(WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+#include "errno.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "thrdsubs.h"
+#include "timesubs.h"
+#include "writesubs.h"
+
+/* how long the threads sleep while waiting for each other */
+#define WRITE_WAIT_INTERVAL		1
+
+/**************************************************************/
+/*                                                            */
+/* Allocate and release output buffers.  The buffers are      */
+/* aligned so they can be used for direct writes.             */
+/*                                                            */
+/**************************************************************/
+
+static char * allocBuffer(size_t size)
+
+{
+#ifdef WIN32
+	return (char *)_aligned_malloc(size, WRITE_BUF_ALIGN);
+#else
+	void	*ptr=NULL;
+
+	if (posix_memalign(&ptr, WRITE_BUF_ALIGN, size) != 0)
+	{
+		return NULL;
+	}
+
+	return (char *)ptr;
+#endif
+}
+
+static void freeBuffer(char *ptr)
+
+{
+#ifdef WIN32
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Open an output file, either replacing or appending to an   */
+/* existing file.  Returns zero if the file was opened.       */
+/*                                                            */
+/**************************************************************/
+
+static int openOutput(CAPTUREWRITER *cw, const char *fileName, int append)
+
+{
+#ifdef WIN32
+	LARGE_INTEGER	fileSize;
+
+	cw->file = CreateFileA(fileName, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+						   append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == cw->file)
+	{
+		Log("***** unable to open output file %s rc=%d", fileName, GetLastError());
+		return 1;
+	}
+
+	cw->offset = 0;
+	if (append && GetFileSizeEx(cw->file, &fileSize))
+	{
+		SetFilePointerEx(cw->file, fileSize, NULL, FILE_BEGIN);
+		cw->offset = fileSize.QuadPart;
+	}
+#else
+	int		flags=O_WRONLY | O_CREAT;
+
+	flags |= append ? O_APPEND : O_TRUNC;
+
+#ifdef O_DIRECT
+	if (1 == cw->direct)
+	{
+		cw->fd = open(fileName, flags | O_DIRECT, 0666);
+		if (cw->fd >= 0)
+		{
+			cw->directOn = 1;
+		}
+		else if (EINVAL == errno)
+		{
+			/* the file system does not support direct writes */
+			Log("direct writes are not supported for %s - using the file system cache", fileName);
+			cw->direct = 0;
+		}
+	}
+#endif
+
+	if (0 == cw->directOn)
+	{
+		cw->fd = open(fileName, flags, 0666);
+	}
+
+	if (cw->fd < 0)
+	{
+		Log("***** unable to open output file %s errno=%d %s", fileName, errno, strerror(errno));
+		return 1;
+	}
+
+	cw->offset = 0;
+	if (append)
+	{
+		cw->offset = (int64_t)lseek(cw->fd, 0, SEEK_END);
+	}
+#endif
+
+	cw->files++;
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Force the data in the current file to the disk.            */
+/*                                                            */
+/**************************************************************/
+
+static void syncOutput(CAPTUREWRITER *cw)
+
+{
+#ifdef WIN32
+	FlushFileBuffers(cw->file);
+#else
+	fdatasync(cw->fd);
+#endif
+
+	cw->syncs++;
+	time(&(cw->lastSync));
+}
+
+static void closeOutput(CAPTUREWRITER *cw)
+
+{
+	if (cw->syncSecs > 0)
+	{
+		syncOutput(cw);
+	}
+
+#ifdef WIN32
+	CloseHandle(cw->file);
+	cw->file = INVALID_HANDLE_VALUE;
+#else
+	close(cw->fd);
+	cw->fd = -1;
+	cw->directOn = 0;
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write data to the current file, allowing for partial       */
+/* writes.  Returns zero if all the data was written.         */
+/*                                                            */
+/**************************************************************/
+
+static int writeAll(CAPTUREWRITER *cw, const char *data, size_t len)
+
+{
+#ifdef WIN32
+	DWORD	count;
+#else
+	ssize_t	count;
+#endif
+
+	while (len > 0)
+	{
+#ifdef WIN32
+		if (!WriteFile(cw->file, data, (len > 0x40000000) ? 0x40000000 : (DWORD)len, &count, NULL))
+		{
+			Log("***** write to capture file failed rc=%d", GetLastError());
+			return 1;
+		}
+#else
+		count = write(cw->fd, data, len);
+		if (count < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+
+			Log("***** write to capture file failed errno=%d %s", errno, strerror(errno));
+			return 1;
+		}
+#endif
+
+		data += count;
+		len -= count;
+		cw->offset += count;
+		cw->bytesOut += count;
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write one buffer.  Direct writes must start at a multiple  */
+/* of the block size in the file and be a multiple of the     */
+/* block size long, so only whole blocks are written directly */
+/* and O_DIRECT is turned off for anything left over.  Full   */
+/* buffers are a multiple of the block size, so only the      */
+/* last buffer for a file is normally written through the     */
+/* cache.                                                     */
+/*                                                            */
+/**************************************************************/
+
+static int writeBuffer(CAPTUREWRITER *cw, const char *data, size_t len)
+
+{
+#ifdef O_DIRECT
+	size_t	directLen=0;
+	int		flags;
+
+	if (1 == cw->direct)
+	{
+		if (0 == (cw->offset % WRITE_BUF_ALIGN))
+		{
+			directLen = len & ~((size_t)WRITE_BUF_ALIGN - 1);
+		}
+
+		if ((directLen > 0) != (1 == cw->directOn))
+		{
+			flags = fcntl(cw->fd, F_GETFL);
+			flags = (directLen > 0) ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+			if (0 == fcntl(cw->fd, F_SETFL, flags))
+			{
+				cw->directOn = (directLen > 0);
+			}
+		}
+
+		if (directLen > 0)
+		{
+			if (writeAll(cw, data, directLen) != 0)
+			{
+				return 1;
+			}
+
+			data += directLen;
+			len -= directLen;
+
+			if ((len > 0) && (0 == fcntl(cw->fd, F_SETFL, fcntl(cw->fd, F_GETFL) & ~O_DIRECT)))
+			{
+				cw->directOn = 0;
+			}
+		}
+	}
+#endif
+
+	return writeAll(cw, data, len);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Writer thread.  Writes the buffers in the order they were  */
+/* filled, opening a new file first if the buffer asks for    */
+/* one, and ends when the writer is closed and all the        */
+/* buffers have been written.  After a failure the buffers    */
+/* are discarded so the caller never waits forever.           */
+/*                                                            */
+/**************************************************************/
+
+static void captureWriter(void * arg)
+
+{
+	CAPTUREWRITER	*cw=(CAPTUREWRITER *)arg;
+	WRITEBUFFER		*buf;
+	int				ending;
+	time_t			now;
+	MY_TIME_T		startTime;
+	MY_TIME_T		endTime;
+
+	for (;;)
+	{
+		/* check for the end before looking for buffers so none are missed */
+		ending = cw->ending;
+		MEMORY_BARRIER();
+
+		while (cw->written < cw->filled)
+		{
+			/* the barrier makes sure the buffer is complete before it is read */
+			MEMORY_BARRIER();
+			buf = cw->bufs + (cw->written % cw->bufCount);
+
+			if (0 == cw->failed)
+			{
+				GetTime(&startTime);
+
+				if (buf->fileName[0] != 0)
+				{
+					closeOutput(cw);
+					if (openOutput(cw, buf->fileName, 0) != 0)
+					{
+						cw->failed = 1;
+					}
+				}
+
+				if ((0 == cw->failed) && (writeBuffer(cw, buf->data, buf->len) != 0))
+				{
+					cw->failed = 1;
+				}
+
+				if ((0 == cw->failed) && (cw->syncSecs > 0))
+				{
+					time(&now);
+					if (now - cw->lastSync >= cw->syncSecs)
+					{
+						syncOutput(cw);
+					}
+				}
+
+				GetTime(&endTime);
+				cw->writeNs += DiffTimeNs(startTime, endTime);
+			}
+
+			/* release the buffer */
+			buf->len = 0;
+			buf->fileName[0] = 0;
+			MEMORY_BARRIER();
+			cw->written++;
+		}
+
+		if (1 == ending)
+		{
+			break;
+		}
+
+		sleepThread(WRITE_WAIT_INTERVAL);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Open a capture file and start the writer thread.  The      */
+/* buffer size is rounded up to a multiple of the block size. */
+/* Returns NULL if the file cannot be opened.                 */
+/*                                                            */
+/**************************************************************/
+
+CAPTUREWRITER * openCaptureWriter(const char *fileName, int append, size_t bufSize, int bufCount, int direct, int syncSecs)
+
+{
+	int				i;
+	CAPTUREWRITER	*cw;
+
+	cw = (CAPTUREWRITER *)malloc(sizeof(CAPTUREWRITER));
+	if (NULL == cw)
+	{
+		Log("***** unable to allocate storage for capture file %s", fileName);
+		return NULL;
+	}
+
+	memset(cw, 0, sizeof(CAPTUREWRITER));
+
+	if (0 == bufSize)
+	{
+		bufSize = WRITE_BUF_DEFAULT;
+	}
+
+	if (bufCount < 2)
+	{
+		bufCount = WRITE_BUF_COUNT;
+	}
+
+	cw->bufSize = (bufSize + WRITE_BUF_ALIGN - 1) & ~((size_t)WRITE_BUF_ALIGN - 1);
+	cw->bufCount = bufCount;
+	cw->direct = direct;
+	cw->syncSecs = syncSecs;
+	time(&(cw->lastSync));
+
+#ifndef O_DIRECT
+	if (1 == direct)
+	{
+		Log("direct writes are not supported on this platform - using the file system cache");
+		cw->direct = 0;
+	}
+#endif
+
+	cw->bufs = (WRITEBUFFER *)malloc(bufCount * sizeof(WRITEBUFFER));
+	if (NULL == cw->bufs)
+	{
+		Log("***** unable to allocate storage for capture file %s", fileName);
+		free(cw);
+		return NULL;
+	}
+
+	memset(cw->bufs, 0, bufCount * sizeof(WRITEBUFFER));
+	for (i = 0; i < bufCount; i++)
+	{
+		cw->bufs[i].data = allocBuffer(cw->bufSize);
+		if (NULL == cw->bufs[i].data)
+		{
+			Log("***** unable to allocate %d output buffers of %d bytes", bufCount, (int)cw->bufSize);
+			while (--i >= 0)
+			{
+				freeBuffer(cw->bufs[i].data);
+			}
+
+			free(cw->bufs);
+			free(cw);
+			return NULL;
+		}
+	}
+
+	/* open the first file here so the caller finds out about any problem */
+	if (openOutput(cw, fileName, append) != 0)
+	{
+		for (i = 0; i < bufCount; i++)
+		{
+			freeBuffer(cw->bufs[i].data);
+		}
+
+		free(cw->bufs);
+		free(cw);
+		return NULL;
+	}
+
+	cw->initialLength = cw->offset;
+	GetTime(&(cw->startTime));
+
+	if (startThread(&(cw->writer), captureWriter, cw) != 0)
+	{
+		closeOutput(cw);
+		for (i = 0; i < bufCount; i++)
+		{
+			freeBuffer(cw->bufs[i].data);
+		}
+
+		free(cw->bufs);
+		free(cw);
+		return NULL;
+	}
+
+	return cw;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Pass the buffer being filled to the writer thread and wait */
+/* until the next buffer is free.                             */
+/*                                                            */
+/**************************************************************/
+
+static void passBuffer(CAPTUREWRITER *cw)
+
+{
+	MY_TIME_T	startTime;
+	MY_TIME_T	endTime;
+
+	/* make sure the buffer is complete before the writer can see it */
+	MEMORY_BARRIER();
+	cw->filled++;
+
+	if (cw->filled - cw->written >= cw->bufCount)
+	{
+		cw->waits++;
+		GetTime(&startTime);
+		while (cw->filled - cw->written >= cw->bufCount)
+		{
+			sleepThread(WRITE_WAIT_INTERVAL);
+		}
+
+		GetTime(&endTime);
+		cw->waitNs += DiffTimeNs(startTime, endTime);
+	}
+
+	MEMORY_BARRIER();
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add data to the capture file.  Only one thread may add     */
+/* data.  Returns 1 if the writer has failed.                 */
+/*                                                            */
+/**************************************************************/
+
+int writeCaptureData(CAPTUREWRITER *cw, const void *data, size_t len)
+
+{
+	size_t			count;
+	const char		*ptr=(const char *)data;
+	WRITEBUFFER		*buf;
+
+	while (len > 0)
+	{
+		buf = cw->bufs + (cw->filled % cw->bufCount);
+
+		count = cw->bufSize - buf->len;
+		if (count > len)
+		{
+			count = len;
+		}
+
+		memcpy(buf->data + buf->len, ptr, count);
+		buf->len += count;
+		ptr += count;
+		len -= count;
+		cw->bytesIn += count;
+
+		if (buf->len == cw->bufSize)
+		{
+			passBuffer(cw);
+		}
+	}
+
+	return cw->failed;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start a new file.  The file is opened by the writer        */
+/* thread when there is data for it, so a file is not         */
+/* created if nothing is written to it.  Returns 1 if the     */
+/* writer has failed.                                         */
+/*                                                            */
+/**************************************************************/
+
+int nextCaptureFile(CAPTUREWRITER *cw, const char *fileName)
+
+{
+	WRITEBUFFER		*buf;
+
+	buf = cw->bufs + (cw->filled % cw->bufCount);
+	if (buf->len > 0)
+	{
+		passBuffer(cw);
+		buf = cw->bufs + (cw->filled % cw->bufCount);
+	}
+
+	strncpy(buf->fileName, fileName, sizeof(buf->fileName) - 1);
+
+	return cw->failed;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write any remaining data, close the file and report how    */
+/* fast data was added and written.  The add rate leaves out  */
+/* the time spent waiting for the writer, so it shows how     */
+/* fast the messages could be read if the file system kept    */
+/* up, and the write rate only counts the time the writer was */
+/* busy.  Returns 1 if the writer failed.                     */
+/*                                                            */
+/**************************************************************/
+
+int closeCaptureWriter(CAPTUREWRITER *cw)
+
+{
+	int			i;
+	int			failed;
+	int64_t		elapsedNs;
+	double		getSecs;
+	double		writeSecs;
+	MY_TIME_T	endTime;
+
+	/* a new file name without any data is dropped */
+	if (cw->bufs[cw->filled % cw->bufCount].len > 0)
+	{
+		MEMORY_BARRIER();
+		cw->filled++;
+	}
+
+	cw->ending = 1;
+	waitThread(cw->writer);
+	closeOutput(cw);
+
+	GetTime(&endTime);
+	elapsedNs = DiffTimeNs(cw->startTime, endTime);
+	getSecs = (double)(elapsedNs - cw->waitNs) / 1000000000.0;
+	writeSecs = (double)cw->writeNs / 1000000000.0;
+
+	Log("Get stage   " FMTI64 " bytes in %.3f seconds (%.1f MB/sec) waited " FMTI64 " times for %.3f seconds",
+		cw->bytesIn, getSecs, (getSecs > 0.0) ? (double)cw->bytesIn / getSecs / 1048576.0 : 0.0,
+		cw->waits, (double)cw->waitNs / 1000000000.0);
+	Log("Write stage " FMTI64 " bytes in %.3f seconds (%.1f MB/sec) to %d files with " FMTI64 " syncs",
+		cw->bytesOut, writeSecs, (writeSecs > 0.0) ? (double)cw->bytesOut / writeSecs / 1048576.0 : 0.0,
+		cw->files, cw->syncs);
+
+	if (cw->waits > 0)
+	{
+		Log("Writing the capture file limited the rate messages were read");
+	}
+
+	failed = cw->failed;
+	for (i = 0; i < cw->bufCount; i++)
+	{
+		freeBuffer(cw->bufs[i].data);
+	}
+
+	free(cw->bufs);
+	free(cw);
+
+	return failed;
+}
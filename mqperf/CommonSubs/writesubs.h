@@ -0,0 +1,89 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   writesubs.h - header file for writesubs.c                      */
+/*                                                                  */
+/********************************************************************/
+
+#ifndef _CommonSubs_writesubs_h
+#define _CommonSubs_writesubs_h
+
+#include "thrdsubs.h"
+#include "timesubs.h"
+
+#define WRITE_BUF_DEFAULT	(8 * 1024 * 1024)	/* default size of each output buffer */
+#define WRITE_BUF_COUNT		2					/* default number of output buffers */
+#define WRITE_BUF_ALIGN		4096				/* buffers and direct writes are multiples of this */
+#define WRITE_NAME_LEN		512
+
+/**********************************************************/
+/* One output buffer.  If fileName is set the current     */
+/* file is closed and the named file is opened before     */
+/* the data in the buffer is written.                     */
+/**********************************************************/
+typedef struct {
+	char		*data;
+	size_t		len;
+	char		fileName[WRITE_NAME_LEN];
+} WRITEBUFFER;
+
+/**********************************************************/
+/* Capture file writer.  The caller copies data into the  */
+/* output buffers and a separate thread writes each       */
+/* buffer once it is full, so the caller only waits for   */
+/* the file system when all the buffers are waiting to be */
+/* written.  Times are in nanoseconds.                    */
+/**********************************************************/
+typedef struct {
+	WRITEBUFFER			*bufs;
+	int					bufCount;
+	size_t				bufSize;
+	int					direct;				/* bypass the file system cache where possible */
+	int					syncSecs;			/* seconds between syncs of the file data - 0 for none */
+	volatile int64_t	filled;				/* buffers passed to the writer */
+	volatile int64_t	written;			/* buffers written */
+	volatile int		ending;
+	volatile int		failed;
+	THREAD_T			writer;
+#ifdef WIN32
+	HANDLE				file;
+#else
+	int					fd;
+	int					directOn;			/* O_DIRECT is set on the file */
+#endif
+	int64_t				offset;				/* offset of the next write in the current file */
+	int64_t				initialLength;		/* length of the first file before anything was added */
+	time_t				lastSync;
+	MY_TIME_T			startTime;
+
+	/* statistics */
+	int					files;
+	int64_t				bytesIn;			/* bytes added by the caller */
+	int64_t				waits;				/* number of times the caller waited for a buffer */
+	int64_t				waitNs;
+	int64_t				bytesOut;			/* bytes written to the files */
+	int64_t				writeNs;			/* time spent writing and syncing */
+	int64_t				syncs;
+} CAPTUREWRITER;
+
+CAPTUREWRITER * openCaptureWriter(const char *fileName, int append, size_t bufSize, int bufCount, int direct, int syncSecs);
+int writeCaptureData(CAPTUREWRITER *cw, const void *data, size_t len);
+int nextCaptureFile(CAPTUREWRITER *cw, const char *fileName);
+int closeCaptureWriter(CAPTUREWRITER *cw);
+#endif
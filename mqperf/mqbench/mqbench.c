@@ -0,0 +1,955 @@
+/*
+Copyright (c) IBM Corporation 2000, 2019
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   MQBENCH measures the common subroutines that are called for    */
+/*   every message.  It supports the following parameters           */
+/*                                                                  */
+/*      -o name of the file to write the JSON results to            */
+/*      -s smallest payload size in bytes (default 64)              */
+/*      -m largest payload size in bytes (default 64 MB)            */
+/*      -t minimum time to run each measurement in milliseconds     */
+/*      -r only run the routines whose name contains this string    */
+/*      -l label to include in the results, such as a commit id     */
+/*      -v highest level of vector instructions to use              */
+/*         (0=none, 1=SSE4.1, 2=AVX2, default is what the processor */
+/*         supports)                                                */
+/*      -c number of random tests to compare the vector routines    */
+/*         with the byte at a time routines (default 1000, 0 skips  */
+/*         the tests)                                               */
+/*                                                                  */
+/*    The routines that work on message data are measured with      */
+/*    payloads from the smallest to the largest size, increasing by */
+/*    a factor of four each time.  The routines that work on a      */
+/*    header or a time stamp are measured once.  The results are    */
+/*    printed and written as JSON so runs on different levels of    */
+/*    the code can be compared.                                     */
+/*                                                                  */
+/*    The program is built with the bench target in the Makefile,   */
+/*    which links it with the MQI stub, so no queue manager is      */
+/*    needed.                                                       */
+/*                                                                  */
+/********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef WIN32
+#include "windows.h"
+#endif
+
+/* includes for MQI */
+#include <cmqc.h>
+
+#include "int64defs.h"
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "putparms.h"
+#include "qsubs.h"
+#include "rfhsubs.h"
+
+#define MIN_SIZE		64
+#define MAX_SIZE		(64 * 1024 * 1024)
+#define DEF_TIME		100				/* milliseconds */
+#define MAX_RESULTS		512
+#define DEF_CHECKS		1000
+#define MAX_CHECK_LEN	8192			/* longest random test data */
+#define BENCH_SIZED		0				/* cost depends on the payload size */
+#define BENCH_MQMD		1				/* works on an MQMD */
+#define BENCH_RFH		2				/* works on an RFH2 header */
+#define BENCH_TIME		3				/* works on a time stamp */
+
+#define BENCH_USR		"<usr><bench>mqbench</bench><size>1024</size></usr>"
+
+static char copyright[] = "(C) Copyright IBM Corp, 2001/2002/2004/2005/2014";
+static char Version[]=\
+"@(#)MQBench V3.1 - MQ Performance subroutine benchmarks  - Jim MacNair ";
+
+#ifdef _DEBUG
+static char Level[]="mqbench.c V3.1 Debug version ("__DATE__" "__TIME__")";
+#else
+static char Level[]="mqbench.c V3.1 Release version ("__DATE__" "__TIME__")";
+#endif
+
+/**************************************************************/
+/*                                                            */
+/* Work areas shared by the routines being measured.          */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	unsigned char	*input;				/* payload */
+	unsigned char	*output;			/* result of the routine */
+	unsigned char	*encoded;			/* hex or base64 form of the payload */
+	size_t			encodedLen;
+	size_t			bufferSize;			/* size of the output and encoded areas */
+	MQMD2			mqmd;				/* native MQMD */
+	MQMD2			mqmdReversed;		/* MQMD with the integers reversed */
+	unsigned char	rfh[4096];			/* native RFH2 */
+	unsigned char	rfhReversed[4096];	/* RFH2 with the integers reversed */
+	unsigned char	work[4096];
+	size_t			rfhLen;
+	PUTPARMS		*parms;
+	int64_t			sink;				/* keeps results from being optimized away */
+} BENCHDATA;
+
+typedef void (*BENCH_FUNC)(BENCHDATA *bd, size_t len);
+
+typedef struct {
+	const char		*name;
+	int				kind;
+	BENCH_FUNC		setup;				/* called before each size is measured */
+	BENCH_FUNC		func;
+} BENCHROUTINE;
+
+typedef struct {
+	const char		*name;
+	size_t			bytes;
+	int64_t			iterations;
+	int64_t			elapsedNs;
+} BENCHRESULT;
+
+typedef struct {
+	char			outputFile[512];
+	char			filter[64];
+	char			label[128];
+	size_t			minSize;
+	size_t			maxSize;
+	int				minTime;
+	int				maxSimd;
+	int				checks;
+	int				err;
+} BENCHPARMS;
+
+/**************************************************************/
+/*                                                            */
+/* Routines being measured.                                   */
+/*                                                            */
+/**************************************************************/
+
+static void benchAsciiToEbcdic(BENCHDATA *bd, size_t len)
+
+{
+	AsciiToEbcdic(bd->output, bd->input, len);
+}
+
+static void benchEbcdicToAscii(BENCHDATA *bd, size_t len)
+
+{
+	EbcdicToAscii(bd->input, len, bd->output);
+}
+
+static void benchAsciiToHex(BENCHDATA *bd, size_t len)
+
+{
+	AsciiToHex(bd->output, bd->input, (unsigned int)len);
+}
+
+static void setupHex(BENCHDATA *bd, size_t len)
+
+{
+	AsciiToHex(bd->encoded, bd->input, (unsigned int)len);
+	bd->encodedLen = len * 2;
+}
+
+static void benchHexToAscii(BENCHDATA *bd, size_t len)
+
+{
+	HexToAscii((char *)bd->encoded, bd->encodedLen, (char *)bd->output);
+}
+
+static void benchDumpLines(BENCHDATA *bd, size_t len)
+
+{
+	size_t	offset;
+	size_t	count;
+
+	for (offset = 0; offset < len; offset += DUMP_BYTES_PER_LINE)
+	{
+		count = len - offset;
+		bd->sink += formatDumpLine((char *)bd->output, bd->input + offset, count, offset);
+	}
+}
+
+static void benchEncode64(BENCHDATA *bd, size_t len)
+
+{
+	bd->sink += Encode64(bd->input, len, bd->output, bd->bufferSize, 1);
+}
+
+static void setupBase64(BENCHDATA *bd, size_t len)
+
+{
+	bd->encodedLen = Encode64(bd->input, len, bd->encoded, bd->bufferSize, 1);
+}
+
+static void benchDecode64(BENCHDATA *bd, size_t len)
+
+{
+	bd->sink += Decode64(bd->encoded, bd->encodedLen, bd->output, bd->bufferSize);
+}
+
+static void benchScanForDelim(BENCHDATA *bd, size_t len)
+
+{
+	const char	*delim;
+
+	/* the delimiter is at the end of the data, so all of it is scanned */
+	delim = scanForDelim((const char *)bd->input, len, bd->parms);
+	if (delim != NULL)
+	{
+		bd->sink += delim - (const char *)bd->input;
+	}
+}
+
+static void setupDelim(BENCHDATA *bd, size_t len)
+
+{
+	/* put the delimiter at the end of the payload */
+	memcpy(bd->input + len - bd->parms->delimiterLen, bd->parms->delimiter, bd->parms->delimiterLen);
+}
+
+static void cleanDelim(BENCHDATA *bd, size_t len)
+
+{
+	/* restore the payload for the other routines */
+	memset(bd->input + len - bd->parms->delimiterLen, 'x', bd->parms->delimiterLen);
+}
+
+static void setupSplit(BENCHDATA *bd, size_t len)
+
+{
+	size_t	i;
+	size_t	delimLen=bd->parms->delimiterLen;
+	static const char	text[]="Text message data with a carriage return and line feed at the end of each line\r\n";
+
+	/* lines of text with a delimiter about every 1KB */
+	for (i = 0; i < len; i++)
+	{
+		bd->encoded[i] = text[i % (sizeof(text) - 1)];
+		if ((i % 1024 == 1024 - delimLen) && (i + delimLen <= len))
+		{
+			memcpy(bd->encoded + i, bd->parms->delimiter, delimLen);
+			i += delimLen - 1;
+		}
+	}
+
+	bd->encodedLen = len;
+}
+
+static void benchSplitAtDelim(BENCHDATA *bd, size_t len)
+
+{
+	size_t	count;
+	size_t	*offsets;
+
+	offsets = splitAtDelim((const char *)bd->encoded, bd->encodedLen, bd->parms->delimiter, bd->parms->delimiterLen, &count);
+	bd->sink += count;
+	free(offsets);
+}
+
+static void benchIsRFH(BENCHDATA *bd, size_t len)
+
+{
+	size_t	rfhLen;
+
+	bd->sink += isRFH(bd->rfh, bd->rfhLen, &rfhLen);
+}
+
+static void benchTranslateRFH(BENCHDATA *bd, size_t len)
+
+{
+	/* each pass starts from the reversed header, so includes a copy */
+	memcpy(bd->work, bd->rfhReversed, bd->rfhLen);
+	translateRFH(bd->work, bd->rfhLen);
+}
+
+static void benchCheckMQMD(BENCHDATA *bd, size_t len)
+
+{
+	bd->sink += checkAndXlateMQMD(&(bd->mqmd), sizeof(MQMD2));
+}
+
+static void benchXlateMQMD(BENCHDATA *bd, size_t len)
+
+{
+	/* each pass starts from the reversed MQMD, so includes a copy */
+	memcpy(bd->work, &(bd->mqmdReversed), sizeof(MQMD2));
+	bd->sink += checkAndXlateMQMD(bd->work, sizeof(MQMD2));
+}
+
+static void benchBuildRFH2(BENCHDATA *bd, size_t len)
+
+{
+	bd->sink += buildRFH2((char *)bd->work, bd->parms, 1);
+}
+
+static void benchGetTime(BENCHDATA *bd, size_t len)
+
+{
+	MY_TIME_T	now;
+
+	GetTime(&now);
+	bd->sink += (int64_t)now;
+}
+
+static void benchDiffTime(BENCHDATA *bd, size_t len)
+
+{
+	static MY_TIME_T	start=0;
+	MY_TIME_T			now;
+
+	GetTime(&now);
+	bd->sink += DiffTime(start, now);
+	start = now;
+}
+
+static const char * simdNames[] = {"none", "SSE4.1", "AVX2"};
+
+static const BENCHROUTINE routines[] = {
+	{"AsciiToEbcdic", BENCH_SIZED, NULL, benchAsciiToEbcdic},
+	{"EbcdicToAscii", BENCH_SIZED, NULL, benchEbcdicToAscii},
+	{"AsciiToHex", BENCH_SIZED, NULL, benchAsciiToHex},
+	{"HexToAscii", BENCH_SIZED, setupHex, benchHexToAscii},
+	{"formatDumpLine", BENCH_SIZED, NULL, benchDumpLines},
+	{"Encode64", BENCH_SIZED, NULL, benchEncode64},
+	{"Decode64", BENCH_SIZED, setupBase64, benchDecode64},
+	{"scanForDelim", BENCH_SIZED, setupDelim, benchScanForDelim},
+	{"splitAtDelim", BENCH_SIZED, setupSplit, benchSplitAtDelim},
+	{"isRFH", BENCH_RFH, NULL, benchIsRFH},
+	{"translateRFH", BENCH_RFH, NULL, benchTranslateRFH},
+	{"checkAndXlateMQMD", BENCH_MQMD, NULL, benchCheckMQMD},
+	{"checkAndXlateMQMD.reversed", BENCH_MQMD, NULL, benchXlateMQMD},
+	{"buildRFH2", BENCH_RFH, NULL, benchBuildRFH2},
+	{"GetTime", BENCH_TIME, NULL, benchGetTime},
+	{"GetTime+DiffTime", BENCH_TIME, NULL, benchDiffTime},
+	{NULL, 0, NULL, NULL}
+};
+
+void printHelp(char *pgmName)
+
+{
+	printf("\nformat is:\n");
+	printf("   %s <-o output file> <-s min size> <-m max size> <-t millisecs> <-r routine> <-l label> <-v level> <-c tests>\n", pgmName);
+	printf("    The output file receives the results in JSON.\n");
+	printf("    Payloads start at min size bytes (default %d) and increase by a factor\n", MIN_SIZE);
+	printf("     of four up to max size bytes (default %d).\n", MAX_SIZE);
+	printf("    Each measurement runs for at least millisecs milliseconds (default %d).\n", DEF_TIME);
+	printf("    The -r option only runs the routines whose name contains the string.\n");
+	printf("    The label is copied to the results, for example to record a commit id.\n");
+	printf("    The -v option limits the vector instructions (0=none, 1=SSE4.1, 2=AVX2).\n");
+	printf("    The -c option sets the number of random tests that compare the vector\n");
+	printf("     routines with the byte at a time routines (default %d, 0 to skip).\n", DEF_CHECKS);
+}
+
+static void processBenchArgs(int argc, char **argv, BENCHPARMS *parms)
+
+{
+	int		i;
+	char	option;
+	char	*parmData;
+
+	for (i = 1; (i < argc) && (0 == parms->err); i++)
+	{
+		if ((argv[i][0] != '-') || (0 == argv[i][1]))
+		{
+			printf("***** unrecognized argument %s\n", argv[i]);
+			parms->err = 1;
+			break;
+		}
+
+		/* the value can follow the option or be the next argument */
+		option = argv[i][1];
+		if (argv[i][2] != 0)
+		{
+			parmData = argv[i] + 2;
+		}
+		else if (i + 1 < argc)
+		{
+			parmData = argv[++i];
+		}
+		else
+		{
+			printf("***** missing value for option %s\n", argv[i]);
+			parms->err = 1;
+			break;
+		}
+
+		switch (option)
+		{
+		case 'o':
+			{
+				strncpy(parms->outputFile, parmData, sizeof(parms->outputFile) - 1);
+				break;
+			}
+		case 's':
+			{
+				parms->minSize = (size_t)atol(parmData);
+				break;
+			}
+		case 'm':
+			{
+				parms->maxSize = (size_t)atol(parmData);
+				break;
+			}
+		case 't':
+			{
+				parms->minTime = atoi(parmData);
+				break;
+			}
+		case 'r':
+			{
+				strncpy(parms->filter, parmData, sizeof(parms->filter) - 1);
+				break;
+			}
+		case 'l':
+			{
+				strncpy(parms->label, parmData, sizeof(parms->label) - 1);
+				break;
+			}
+		case 'v':
+			{
+				parms->maxSimd = atoi(parmData);
+				break;
+			}
+		case 'c':
+			{
+				parms->checks = atoi(parmData);
+				break;
+			}
+		default:
+			{
+				printf("***** unrecognized option -%c\n", option);
+				parms->err = 1;
+				break;
+			}
+		}
+	}
+
+	if ((parms->minSize < 16) || (parms->maxSize < parms->minSize))
+	{
+		printf("***** invalid payload sizes %d to %d\n", (int)parms->minSize, (int)parms->maxSize);
+		parms->err = 1;
+	}
+
+	if ((parms->maxSimd < SIMD_NONE) || (parms->maxSimd > SIMD_AVX2))
+	{
+		printf("***** invalid vector level %d\n", parms->maxSimd);
+		parms->err = 1;
+	}
+
+	if (parms->minTime < 1)
+	{
+		printf("***** invalid measurement time %d\n", parms->minTime);
+		parms->err = 1;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Run a routine repeatedly, doubling the number of calls     */
+/* until the run takes at least the minimum time.             */
+/*                                                            */
+/**************************************************************/
+
+static void measure(const BENCHROUTINE *routine, BENCHDATA *bd, size_t len, int minTime, BENCHRESULT *result)
+
+{
+	int64_t		i;
+	int64_t		iterations=1;
+	int64_t		elapsed;
+	MY_TIME_T	start;
+	MY_TIME_T	end;
+
+	/* warm up the caches and the branch predictors */
+	routine->func(bd, len);
+
+	while (1)
+	{
+		GetTime(&start);
+		for (i = 0; i < iterations; i++)
+		{
+			routine->func(bd, len);
+		}
+
+		GetTime(&end);
+		elapsed = DiffTimeNs(start, end);
+
+		if (elapsed >= (int64_t)minTime * 1000000)
+		{
+			break;
+		}
+
+		iterations *= 2;
+	}
+
+	result->name = routine->name;
+	result->bytes = len;
+	result->iterations = iterations;
+	result->elapsedNs = elapsed;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Write a string as a JSON string value.                     */
+/*                                                            */
+/**************************************************************/
+
+static void writeJSONString(FILE *out, const char *str)
+
+{
+	fputc('"', out);
+	while (str[0] != 0)
+	{
+		if (('"' == str[0]) || ('\\' == str[0]))
+		{
+			fputc('\\', out);
+		}
+
+		if ((unsigned char)str[0] >= ' ')
+		{
+			fputc(str[0], out);
+		}
+
+		str++;
+	}
+
+	fputc('"', out);
+}
+
+static void writeJSON(FILE *out, BENCHPARMS *parms, int simd, BENCHRESULT *results, int count)
+
+{
+	int			i;
+	double		secs;
+	time_t		now;
+	char		dateTime[32];
+
+	time(&now);
+	strftime(dateTime, sizeof(dateTime), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+	fprintf(out, "{\n  \"program\": \"mqbench\",\n  \"level\": ");
+	writeJSONString(out, Level);
+	fprintf(out, ",\n  \"label\": ");
+	writeJSONString(out, parms->label);
+	fprintf(out, ",\n  \"simd\": \"%s\",\n  \"time\": \"%s\",\n  \"results\": [\n", simdNames[simd], dateTime);
+
+	for (i = 0; i < count; i++)
+	{
+		secs = (double)results[i].elapsedNs / 1000000000.0;
+		fprintf(out, "    {\"routine\": \"%s\", \"bytes\": %lu, \"iterations\": " FMTI64 ", \"seconds\": %.6f, \"nsPerOp\": %.3f, \"nsPerByte\": %.6f, \"msgsPerSec\": %.1f}%s\n",
+				results[i].name,
+				(unsigned long)results[i].bytes,
+				results[i].iterations,
+				secs,
+				(double)results[i].elapsedNs / (double)results[i].iterations,
+				(double)results[i].elapsedNs / ((double)results[i].iterations * (double)results[i].bytes),
+				(double)results[i].iterations / secs,
+				(i + 1 < count) ? "," : "");
+	}
+
+	fprintf(out, "  ]\n}\n");
+}
+
+/**************************************************************/
+/*                                                            */
+/* Compare the results of the data conversion routines using  */
+/* vector instructions with the byte at a time versions, with */
+/* random data, lengths and output area sizes.  The hex and   */
+/* base 64 input includes invalid characters and the base 64  */
+/* input includes padding.  Returns the number of differences */
+/* found.                                                     */
+/*                                                            */
+/**************************************************************/
+
+static int compareResults(const char *name, int test, size_t len, size_t count1, const unsigned char *out1, size_t count2, const unsigned char *out2)
+
+{
+	if ((count1 != count2) || (memcmp(out1, out2, count1) != 0))
+	{
+		Log("***** %s results differ in test %d length %d (%d and %d bytes)", name, test, (int)len, (int)count1, (int)count2);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int checkSimd(int checks, int maxSimd)
+
+{
+	int				i;
+	int				errors=0;
+	int				simd;
+	int				padding;
+	size_t			j;
+	size_t			len;
+	size_t			maxLen;
+	size_t			count1;
+	size_t			count2;
+	unsigned char	*input;
+	unsigned char	*out1;
+	unsigned char	*out2;
+	unsigned char	*hex;
+	int				invalid1;
+	int				invalid2;
+	static const unsigned char	base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	simd = limitSimdLevel(maxSimd);
+	if (SIMD_NONE == simd)
+	{
+		Log("No vector instructions in use - tests skipped");
+		return 0;
+	}
+
+	input = (unsigned char *)malloc(MAX_CHECK_LEN * 2);
+	out1 = (unsigned char *)malloc(MAX_CHECK_LEN * 2);
+	out2 = (unsigned char *)malloc(MAX_CHECK_LEN * 2);
+	hex = (unsigned char *)malloc(MAX_CHECK_LEN * 2);
+	if ((NULL == input) || (NULL == out1) || (NULL == out2) || (NULL == hex))
+	{
+		Log("***** unable to allocate test areas");
+		return 1;
+	}
+
+	/* the same tests are run every time */
+	srand(1);
+
+	for (i = 0; i < checks; i++)
+	{
+		len = rand() % MAX_CHECK_LEN;
+		for (j = 0; j < len; j++)
+		{
+			input[j] = (unsigned char)rand();
+		}
+
+		/* the output area is usually big enough */
+		maxLen = (rand() % 4 != 0) ? MAX_CHECK_LEN * 2 : rand() % (len * 2 + 1);
+		padding = rand() % 2;
+
+		/* code page translation */
+		limitSimdLevel(SIMD_NONE);
+		AsciiToEbcdic(out1, input, len);
+		limitSimdLevel(simd);
+		AsciiToEbcdic(out2, input, len);
+		errors += compareResults("AsciiToEbcdic", i, len, len, out1, len, out2);
+
+		limitSimdLevel(SIMD_NONE);
+		EbcdicToAscii(input, len, out1);
+		limitSimdLevel(simd);
+		EbcdicToAscii(input, len, out2);
+		errors += compareResults("EbcdicToAscii", i, len, len, out1, len, out2);
+
+		/* hex conversion, with the odd character that is not a hex digit */
+		limitSimdLevel(SIMD_NONE);
+		AsciiToHex(hex, input, (unsigned int)len);
+		limitSimdLevel(simd);
+		AsciiToHex(out2, input, (unsigned int)len);
+		errors += compareResults("AsciiToHex", i, len, len * 2, hex, len * 2, out2);
+
+		for (j = 0; j < len * 2; j++)
+		{
+			if (0 == rand() % 1000)
+			{
+				hex[j] = (unsigned char)rand();
+			}
+		}
+
+		limitSimdLevel(SIMD_NONE);
+		invalid1 = HexToAscii((char *)hex, len * 2, (char *)out1);
+		limitSimdLevel(simd);
+		invalid2 = HexToAscii((char *)hex, len * 2, (char *)out2);
+		errors += compareResults("HexToAscii", i, len, len, out1, len, out2);
+		if (invalid1 != invalid2)
+		{
+			Log("***** HexToAscii invalid character counts differ in test %d (%d and %d)", i, invalid1, invalid2);
+			errors++;
+		}
+
+		/* dump lines for the first 16 bytes */
+		limitSimdLevel(SIMD_NONE);
+		count1 = formatDumpLine((char *)out1, input, len, len);
+		limitSimdLevel(simd);
+		count2 = formatDumpLine((char *)out2, input, len, len);
+		errors += compareResults("formatDumpLine", i, len, count1, out1, count2, out2);
+
+		/* base 64 encoding */
+		limitSimdLevel(SIMD_NONE);
+		count1 = Encode64(input, len, out1, maxLen, padding);
+		limitSimdLevel(simd);
+		count2 = Encode64(input, len, out2, maxLen, padding);
+		errors += compareResults("Encode64", i, len, count1, out1, count2, out2);
+
+		/* base 64 decoding - mostly valid characters with padding at the end */
+		for (j = 0; j < len; j++)
+		{
+			input[j] = base64Chars[rand() % 64];
+			if (0 == rand() % 1000)
+			{
+				/* invalid character or padding in the middle */
+				input[j] = (rand() % 2) ? (unsigned char)rand() : '=';
+			}
+		}
+
+		for (j = 0; (j < 2) && (j < len); j++)
+		{
+			if (rand() % 2)
+			{
+				input[len - j - 1] = '=';
+			}
+		}
+
+		limitSimdLevel(SIMD_NONE);
+		count1 = Decode64(input, len, out1, maxLen);
+		limitSimdLevel(simd);
+		count2 = Decode64(input, len, out2, maxLen);
+		errors += compareResults("Decode64", i, len, count1, out1, count2, out2);
+	}
+
+	Log("%d random tests of the %s routines found %d differences", checks, simdNames[simd], errors);
+
+	free(input);
+	free(out1);
+	free(out2);
+	free(hex);
+
+	return errors;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Build the message headers used by the header routines.     */
+/*                                                            */
+/**************************************************************/
+
+static void buildHeaders(BENCHDATA *bd)
+
+{
+	MQMD2	mqmd={MQMD2_DEFAULT};
+	MQRFH2	*rfh;
+
+	mqmd.Version = MQMD_VERSION_2;
+	memcpy(&(bd->mqmd), &mqmd, sizeof(MQMD2));
+
+	/* create an MQMD with the integers in the opposite byte order */
+	memcpy(&(bd->mqmdReversed), &mqmd, sizeof(MQMD2));
+	bd->mqmdReversed.Version = reverseBytes4(mqmd.Version);
+	bd->mqmdReversed.Report = reverseBytes4(mqmd.Report);
+	bd->mqmdReversed.MsgType = reverseBytes4(mqmd.MsgType);
+	bd->mqmdReversed.Expiry = reverseBytes4(mqmd.Expiry);
+	bd->mqmdReversed.Feedback = reverseBytes4(mqmd.Feedback);
+	bd->mqmdReversed.Encoding = reverseBytes4(mqmd.Encoding);
+	bd->mqmdReversed.CodedCharSetId = reverseBytes4(mqmd.CodedCharSetId);
+	bd->mqmdReversed.Priority = reverseBytes4(mqmd.Priority);
+	bd->mqmdReversed.Persistence = reverseBytes4(mqmd.Persistence);
+
+	/* build an RFH2 with a usr folder */
+	bd->rfhLen = buildRFH2((char *)bd->rfh, bd->parms, 1);
+
+	/* buildRFH2 may create the header in the opposite encoding */
+	translateRFH(bd->rfh, bd->rfhLen);
+
+	/* and a copy with the integers reversed */
+	memcpy(bd->rfhReversed, bd->rfh, bd->rfhLen);
+	rfh = (MQRFH2 *)bd->rfhReversed;
+	rfh->Version = reverseBytes4(rfh->Version);
+	rfh->StrucLength = reverseBytes4(rfh->StrucLength);
+	rfh->Encoding = reverseBytes4(rfh->Encoding);
+	rfh->CodedCharSetId = reverseBytes4(rfh->CodedCharSetId);
+	rfh->Flags = reverseBytes4(rfh->Flags);
+	rfh->NameValueCCSID = reverseBytes4(rfh->NameValueCCSID);
+}
+
+int main(int argc, char **argv)
+
+{
+	int				i;
+	int				count=0;
+	int				simd;
+	size_t			len;
+	size_t			j;
+	FILE			*out;
+	BENCHDATA		bd;
+	BENCHPARMS		parms;
+	BENCHRESULT		*results;
+	PUTPARMS		*putParms;
+
+	/* display the program name and version information */
+	Log("%s program start", Level);
+
+	/* print the copyright statement */
+	Log(copyright);
+
+	/* set the defaults */
+	memset(&parms, 0, sizeof(parms));
+	parms.minSize = MIN_SIZE;
+	parms.maxSize = MAX_SIZE;
+	parms.minTime = DEF_TIME;
+	parms.maxSimd = SIMD_AVX2;
+	parms.checks = DEF_CHECKS;
+
+	/* check for help request */
+	if ((argc > 1) && ((argv[1][0] == '?') || (argv[1][1] == '?')))
+	{
+		printHelp(argv[0]);
+		exit(0);
+	}
+
+	/* process any command line arguments */
+	processBenchArgs(argc, argv, &parms);
+
+	if (parms.err != 0)
+	{
+		printHelp(argv[0]);
+		exit(99);
+	}
+
+	InitializeTimer();
+
+	/* check the vector routines give the same results */
+	if ((parms.checks > 0) && (checkSimd(parms.checks, parms.maxSimd) != 0))
+	{
+		exit(96);
+	}
+
+	simd = limitSimdLevel(parms.maxSimd);
+	Log("Vector instructions used: %s", simdNames[simd]);
+
+	/* the parameters area is too large for the stack */
+	putParms = (PUTPARMS *)malloc(sizeof(PUTPARMS));
+	results = (BENCHRESULT *)malloc(MAX_RESULTS * sizeof(BENCHRESULT));
+	memset(&bd, 0, sizeof(bd));
+	bd.bufferSize = parms.maxSize * 2 + 16;
+	bd.input = (unsigned char *)malloc(parms.maxSize);
+	bd.output = (unsigned char *)malloc(bd.bufferSize);
+	bd.encoded = (unsigned char *)malloc(bd.bufferSize);
+
+	if ((NULL == putParms) || (NULL == results) || (NULL == bd.input) || (NULL == bd.output) || (NULL == bd.encoded))
+	{
+		Log("***** unable to allocate work areas for payloads up to %d bytes", (int)parms.maxSize);
+		exit(98);
+	}
+
+	/* use the same defaults as the other programs */
+	initializeParms(putParms, sizeof(PUTPARMS));
+	putParms->rfh_usr = BENCH_USR;
+	bd.parms = putParms;
+
+	/* printable payload without any delimiters */
+	for (j = 0; j < parms.maxSize; j++)
+	{
+		bd.input[j] = 'a' + (j % 26);
+	}
+
+	buildHeaders(&bd);
+
+	printf("\n%-28s %10s %14s %12s %12s\n", "routine", "bytes", "ns/op", "ns/byte", "msgs/sec");
+
+	for (i = 0; routines[i].name != NULL; i++)
+	{
+		if ((parms.filter[0] != 0) && (strstr(routines[i].name, parms.filter) == NULL))
+		{
+			continue;
+		}
+
+		switch (routines[i].kind)
+		{
+		case BENCH_MQMD:
+			{
+				len = sizeof(MQMD2);
+				break;
+			}
+		case BENCH_RFH:
+			{
+				len = bd.rfhLen;
+				break;
+			}
+		case BENCH_TIME:
+			{
+				len = sizeof(MY_TIME_T);
+				break;
+			}
+		default:
+			{
+				len = parms.minSize;
+				break;
+			}
+		}
+
+		while (((len <= parms.maxSize) || (routines[i].kind != BENCH_SIZED)) && (count < MAX_RESULTS))
+		{
+			if (routines[i].setup != NULL)
+			{
+				routines[i].setup(&bd, len);
+			}
+
+			measure(routines + i, &bd, len, parms.minTime, results + count);
+
+			if (benchScanForDelim == routines[i].func)
+			{
+				cleanDelim(&bd, len);
+			}
+
+			printf("%-28s %10lu %14.3f %12.6f %12.1f\n",
+				   results[count].name,
+				   (unsigned long)len,
+				   (double)results[count].elapsedNs / (double)results[count].iterations,
+				   (double)results[count].elapsedNs / ((double)results[count].iterations * (double)len),
+				   (double)results[count].iterations * 1000000000.0 / (double)results[count].elapsedNs);
+			fflush(stdout);
+
+			count++;
+
+			/* the header routines are only measured once */
+			if (routines[i].kind != BENCH_SIZED)
+			{
+				break;
+			}
+
+			len *= 4;
+		}
+	}
+
+	/* write the results */
+	if (parms.outputFile[0] != 0)
+	{
+		out = fopen(parms.outputFile, "w");
+		if (NULL == out)
+		{
+			Log("***** unable to open output file %s", parms.outputFile);
+			exit(97);
+		}
+
+		writeJSON(out, &parms, simd, results, count);
+		fclose(out);
+		Log("\nResults written to %s", parms.outputFile);
+	}
+	else
+	{
+		writeJSON(stdout, &parms, simd, results, count);
+	}
+
+	free(bd.input);
+	free(bd.output);
+	free(bd.encoded);
+	free(results);
+	free(putParms);
+
+	return 0;
+}
@@ -119,6 +119,8 @@ Jim MacNair - Initial Contribution
 #include "timesubs.h"
 #include "parmline.h"
 #include "putparms.h"
+#include "writesubs.h"
+#include "capsubs.h"
 
 /* MQ user subroutines includes */
 #include "qsubs.h"
@@ -180,6 +182,20 @@ void displayOptions(PUTPARMS * parms)
 		Log("indivFiles option selected - Each file will be saved in a seperate file");
 	}
 
+	/* tell how the output file will be written */
+	Log("Output written from %d buffers of %d bytes%s", (parms->writeBuffers > 1) ? parms->writeBuffers : WRITE_BUF_COUNT,
+		(parms->writeBufSize > 0) ? parms->writeBufSize : WRITE_BUF_DEFAULT, (1 == parms->writeDirect) ? " with direct writes" : "");
+	if (parms->writeSync > 0)
+	{
+		Log("Output file will be synced every %d seconds", parms->writeSync);
+	}
+
+	/* tell if the messages will be compressed with an index */
+	if (1 == parms->indexedFile)
+	{
+		Log("indexedFile option selected - Messages will be compressed in blocks of %d bytes with an index", parms->capBlockSize);
+	}
+
 	/* Tell what queue and qm will be used */
 	if (0 == parms->qmname[0])
 	{
@@ -191,7 +207,11 @@ void displayOptions(PUTPARMS * parms)
 	}
 
 	/* Tell what delimiter we are using */
-	if ((0 == parms->delimiterLen) && (0 == parms->indivFiles))
+	if (1 == parms->indexedFile)
+	{
+		/* the index replaces the delimiters */
+	}
+	else if ((0 == parms->delimiterLen) && (0 == parms->indivFiles))
 	{
 		/* print a warning message */
 		Log("***** WARNING - delimiter length is zero");
@@ -241,12 +261,13 @@ int main(int argc, char **argv)
 	int64_t			msgcount=0;
 	int64_t			totalbytes=0;
 	int64_t			avgbytes;
-	size_t			fileLen=0;					/* starting length of output file */
+	int64_t			fileLen=0;					/* starting length of output file */
 	size_t			fDataLen;
 	size_t			msgLen;						/* alternate message length used for 64-bit compatibility */
 	size_t			memSize;					/* number of bytes to allocate */
 	unsigned int	rfhlength=0;
 	int				fileCount=0;				/* count of individual files used */
+	int				rc;
 	int				waitCount;					/* count number of seconds this MQGET has waited */
 	MQLONG			qm=0;
 	MQLONG			q=0;
@@ -256,7 +277,10 @@ int main(int argc, char **argv)
 	MQLONG			IAV[1];						/* integer attribute values      */
 	MQLONG			openopt = 0;				/* MQ open options */
 	MQLONG			datalen=0;					/* length of the message that was read */
-	FILE			*outFile;					/* output file */
+	CAPTUREWRITER	*outFile;					/* output file */
+	CAPFILE			*capFile=NULL;				/* indexed output file */
+	int64_t			rawBytes=0;					/* bytes added to an indexed file */
+	int64_t			capBytes=0;					/* bytes written to an indexed file */
 	char			*msgdata;					/* pointer to message data */
 	MQOD			objdesc = {MQOD_DEFAULT};
 	MQMD2			msgdesc = {MQMD_DEFAULT};
@@ -312,6 +336,32 @@ int main(int argc, char **argv)
 	/* check for overrides */
 	processOverrides(&parms);
 
+	/* check the indexed file options */
+	if (1 == parms.indexedFile)
+	{
+		if (1 == parms.indivFiles)
+		{
+			Log("***** indexedFile cannot be used with indivFiles - indexedFile ignored");
+			parms.indexedFile = 0;
+		}
+
+		if (1 == parms.appendFile)
+		{
+			Log("***** appendFile cannot be used with indexedFile - the output file will be replaced");
+			parms.appendFile = 0;
+		}
+
+		if (0 == parms.capBlockSize)
+		{
+			parms.capBlockSize = CAP_BLOCK_DEFAULT;
+		}
+		else if ((parms.capBlockSize < CAP_BLOCK_MIN) || (parms.capBlockSize > CAP_BLOCK_MAX))
+		{
+			Log("***** capBlockSize must be between %d and %d - using %d", CAP_BLOCK_MIN, CAP_BLOCK_MAX, CAP_BLOCK_DEFAULT);
+			parms.capBlockSize = CAP_BLOCK_DEFAULT;
+		}
+	}
+
 	/* exit if queue name not found */
 	if (0 == parms.qname[0])
 	{
@@ -348,27 +398,33 @@ int main(int argc, char **argv)
 	{
 		/* open output file for append */
 		Log("appending to output file %s", parms.outputFilename);
-		outFile = fopen(parms.outputFilename, "ab");
 	}
 	else
 	{
 		/* open output file */
 		Log("opening output file %s", parms.outputFilename);
-		outFile = fopen(parms.outputFilename, "wb");
 	}
 
+	/* the file is written from a separate thread */
+	outFile = openCaptureWriter(parms.outputFilename, parms.appendFile, parms.writeBufSize, parms.writeBuffers, parms.writeDirect, parms.writeSync);
 	if (NULL == outFile)
 	{
 		Log("unable to open output file %s for output", parms.outputFilename);
 		return 100;
 	}
 
-	/* check for an append option */
-	if (1 == parms.appendFile)
+	/* check if the file is empty or being appended */
+	fileLen = outFile->initialLength;
+
+	/* check if the messages are compressed with an index */
+	if (1 == parms.indexedFile)
 	{
-		/* check if the file is empty or being appended */
-		fseek(outFile, 0L, SEEK_END);
-		fileLen = ftell(outFile);
+		capFile = openCapFile(outFile, parms.capBlockSize);
+		if (NULL == capFile)
+		{
+			closeCaptureWriter(outFile);
+			return 100;
+		}
 	}
 
 	/* Connect to the queue manager */
@@ -382,7 +438,12 @@ int main(int argc, char **argv)
 	if (compcode != MQCC_OK)
 	{
 		/* close the output file */
-		fclose(outFile);
+		if (capFile != NULL)
+		{
+			closeCapFile(capFile, NULL, NULL);
+		}
+
+		closeCaptureWriter(outFile);
 
 		/* exit */
 		return 98;
@@ -529,14 +590,18 @@ int main(int argc, char **argv)
 			totalbytes += datalen;
 
 			/* check if a delimiter should be added to the file */
-			if ((0 == fileLen) || (1 == parms.indivFiles))
+			if (capFile != NULL)
+			{
+				/* the index replaces the delimiters */
+			}
+			else if ((0 == fileLen) || (1 == parms.indivFiles))
 			{
 				fileLen = 1;
 			}
 			else
 			{
 				/* insert a delimiter string */
-				fwrite(parms.delimiter, parms.delimiterLen, 1, outFile);
+				writeCaptureData(outFile, parms.delimiter, parms.delimiterLen);
 			}
 
 
@@ -554,46 +619,47 @@ int main(int argc, char **argv)
 				}
 			}
 
-			/* include the MQMD in the file data? */
-			if (1 == parms.saveMQMD)
-			{
-				/* write the MQMD to the file */
-				fwrite(&msgdesc, sizeof(msgdesc), 1, outFile);
-			}
-
-			/* append the data to the file */
+			/* get the length of the data without any RFH */
 			fDataLen = (unsigned int)datalen - (unsigned int)rfhlength;
-			fwrite(msgdata + rfhlength, fDataLen, 1, outFile);
 
-			/* check if individual files are to be used for each message */
-			if (1 == parms.indivFiles)
+			if (capFile != NULL)
+			{
+				/* add the message and the MQMD if requested to the compressed blocks */
+				rc = addCapMessage(capFile, (1 == parms.saveMQMD) ? &msgdesc : NULL, (1 == parms.saveMQMD) ? sizeof(msgdesc) : 0, msgdata + rfhlength, fDataLen);
+			}
+			else
 			{
-				/* using one file per message */
-				if (outFile != NULL)
+				/* include the MQMD in the file data? */
+				if (1 == parms.saveMQMD)
 				{
-					/* close the current file */
-					fclose(outFile);
-					outFile = NULL;
+					/* write the MQMD to the file */
+					writeCaptureData(outFile, &msgdesc, sizeof(msgdesc));
 				}
 
+				/* append the data to the file */
+				rc = writeCaptureData(outFile, msgdata + rfhlength, fDataLen);
+			}
+
+			if (rc != 0)
+			{
+				/* the writer has already said what went wrong */
+				Log("***** Unable to write to the output file");
+
+				/* break out of the loop */
+				compcode = MQCC_FAILED;
+			}
+
+			/* check if individual files are to be used for each message */
+			if ((MQCC_OK == compcode) && (1 == parms.indivFiles))
+			{
 				/* increment the file counter */
 				fileCount++;
 
 				/* build the next file name to use */
 				createNextFileName(parms.outputFilename, newFileName, fileCount);
 
-				/* try to open the new output file */
-				outFile = fopen(newFileName, "wb");
-
-				/* check if the file open failed */
-				if (NULL == outFile)
-				{
-					/* tell what happened */
-					Log("***** Open failed for file %s", newFileName);
-
-					/* break out of the loop */
-					compcode = MQCC_FAILED;
-				}
+				/* the writer opens the new file when there is data for it */
+				nextCaptureFile(outFile, newFileName);
 			}
 		} 
 		else if ((compcode == MQCC_WARNING) && (2080 == reason))
@@ -603,17 +669,22 @@ int main(int argc, char **argv)
 		}
 	}
 
-	/* close the file */
-	fclose(outFile);
-
-	/* files are created before reading messages  */
-	/* delete the last file since it was not used */
-	if (1 == parms.indivFiles)
+	/* write the last block and the index of an indexed file */
+	if (capFile != NULL)
 	{
-		/* delete the last file that was created */
-		remove(newFileName);
+		if (closeCapFile(capFile, &rawBytes, &capBytes) != 0)
+		{
+			Log("***** Unable to write the index to the output file");
+		}
+		else if (rawBytes > 0)
+		{
+			Log("Indexed file " FMTI64 " bytes compressed to " FMTI64 " bytes (%d%%)", rawBytes, capBytes, (int)((capBytes * 100) / rawBytes));
+		}
 	}
 
+	/* write any remaining data and close the file */
+	closeCaptureWriter(outFile);
+
 	/* close the input queue */
 	Log("closing the input queue");
 	MQCLOSE(qm, &q, MQCO_NONE, &compcode, &reason);
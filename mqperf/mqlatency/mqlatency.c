@@ -37,6 +37,28 @@ Jim MacNair - Initial Contribution
 /*                                                                  */
 /********************************************************************/
 
+/********************************************************************/
+/*                                                                  */
+/* Changes in V3.1                                                  */
+/*                                                                  */
+/* 1) Replaced the fixed latency range counters with a histogram.   */
+/*    The 50th, 90th, 99th, 99.9th and 99.99th percentiles and the  */
+/*    maximum latency are reported for each reporting interval and  */
+/*    at the end of the run.                                        */
+/* 2) Latencies are measured and reported in nanoseconds, using     */
+/*    the TSC when the program is built with USE_TSC.               */
+/* 3) Added inflight parameter to keep more than one request       */
+/*    outstanding.  Replies are matched to requests by correlation  */
+/*    id and the reply rate is reported with the latencies.  The    */
+/*    request message ids are set by the program and hold the slot  */
+/*    of the request, so a reply is found without a search.         */
+/* 4) The reply rate and latency are also reported for a steady     */
+/*    window, after the warmupTime and warmupCount parameters have  */
+/*    passed and once the rate varies by less than steadyCov        */
+/*    percent over steadyWindow seconds.                            */
+/*                                                                  */
+/********************************************************************/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -68,6 +90,7 @@ void Sleep(int amount)
 /* includes for common subroutines */
 #include "comsubs.h"
 #include "timesubs.h"
+#include "histsubs.h"
 
 /* definition of parameters area */
 #include "parmline.h"
@@ -79,16 +102,19 @@ void Sleep(int amount)
 /* parameter file processing routines */
 #include "putparms.h"
 
+/* warm up and steady state detection */
+#include "steadysubs.h"
+
 #define MAX_BATCH_ALLOW		5000
 
 static char copyright[] = "\n(C) Copyright IBM Corp, 2008-2014";
 static char Version[]=\
-"@(#)MQLatency V3.0 - Latency measurement tool  - Jim MacNair ";
+"@(#)MQLatency V3.1 - Latency measurement tool  - Jim MacNair ";
 
 #ifdef _DEBUG
-static char Level[]="mqlatency.c V3.0 Debug version ("__DATE__" "__TIME__")";
+static char Level[]="mqlatency.c V3.1 Debug version ("__DATE__" "__TIME__")";
 #else
-static char Level[]="mqlatency.c V3.0 Release version ("__DATE__" "__TIME__")";
+static char Level[]="mqlatency.c V3.1 Release version ("__DATE__" "__TIME__")";
 #endif
 
 	MQHCONN			qm=0;			/* queue manager connection handle */
@@ -100,13 +126,33 @@ static char Level[]="mqlatency.c V3.0 Release version ("__DATE__" "__TIME__")";
 	volatile int	terminate=0;
 	volatile int	cancelled=0;
 
+/**************************************************************/
+/*                                                            */
+/* Entry in the table of outstanding requests.  The message   */
+/* id of each request is set by the program.  It starts with  */
+/* the time the run started and the request number, which     */
+/* make it unique, followed by the number of the slot, so a   */
+/* reply can be matched to its slot without a search.         */
+/*                                                            */
+/**************************************************************/
+
+#define REQID_RUN		0				/* offset of the run start time in the message id */
+#define REQID_NUMBER	8				/* offset of the request number */
+#define REQID_SLOT		16				/* offset of the slot number */
+
+typedef struct {
+	MQBYTE24		msgId;			/* message id of the request       */
+	MY_TIME_T		sendTime;		/* time the request was sent       */
+	int				inUse;
+} REQUESTSLOT;
+
 /**************************************************************/
 /*                                                            */
 /* This routine puts a message on the queue.                  */
 /*                                                            */
 /**************************************************************/
 
-int getMessage(FILEPTR* fptr, int maxWait, PUTPARMS * parms)
+int getMessage(FILEPTR* fptr, int maxWait, PUTPARMS * parms, MQBYTE24 correlId)
 
 {
 	MQLONG			compcode=0;
@@ -155,6 +201,12 @@ int getMessage(FILEPTR* fptr, int maxWait, PUTPARMS * parms)
 	/* check for errors */
 	checkerror("MQGET", compcode, reason, parms->replyQ);
 
+	/* return the correlation id if requested */
+	if (correlId != NULL)
+	{
+		memcpy(correlId, mqmd.CorrelId, MQ_CORREL_ID_LENGTH);
+	}
+
 	/* calculate the total number of bytes in the reply, even though it wasn't read */
 	parms->totMsgLen += msgSize;
 
@@ -166,11 +218,13 @@ int getMessage(FILEPTR* fptr, int maxWait, PUTPARMS * parms)
 
 /**************************************************************/
 /*                                                            */
-/* This routine puts a message on the queue.                  */
+/* This routine puts a message on the queue.  If msgId is     */
+/* not NULL it is used as the message id instead of one       */
+/* generated by the queue manager.                            */
 /*                                                            */
 /**************************************************************/
 
-int putMessage(FILEPTR* fptr, MQCHAR8 *puttime, PUTPARMS * parms)
+int putMessage(FILEPTR* fptr, MQCHAR8 *puttime, PUTPARMS * parms, const MQBYTE *msgId)
 
 {
 	MQLONG	compcode=0;
@@ -293,6 +347,13 @@ int putMessage(FILEPTR* fptr, MQCHAR8 *puttime, PUTPARMS * parms)
 		}
 	}
 
+	/* check if the message id was provided */
+	if (msgId != NULL)
+	{
+		mqpmo.Options &= ~MQPMO_NEW_MSG_ID;
+		memcpy(msgdesc.MsgId, msgId, MQ_MSG_ID_LENGTH);
+	}
+
 	/* perform the MQPUT */
 	putLen = (MQLONG)fptr->length;
 	MQPUT(qm, q, &msgdesc, &mqpmo, putLen, fptr->dataptr, &compcode, &reason);
@@ -301,7 +362,7 @@ int putMessage(FILEPTR* fptr, MQCHAR8 *puttime, PUTPARMS * parms)
 	checkerror("MQPUT", compcode, reason, parms->qname);
 
 	/* check if correlation ids are to be used to read the reply messages */
-	if (1 == parms->GetByCorrelId)
+	if ((1 == parms->GetByCorrelId) || (parms->inflight > 1))
 	{
 		/* save the message id to match with the expected reply id */
 		/* if this option is used the application must set the correlation id in the reply message */
@@ -325,6 +386,201 @@ int putMessage(FILEPTR* fptr, MQCHAR8 *puttime, PUTPARMS * parms)
 }
 
 
+/**************************************************************/
+/*                                                            */
+/* Send requests with more than one request outstanding.      */
+/*                                                            */
+/* Up to inflight requests are written before waiting for a   */
+/* reply.  The message id and the time of each outstanding    */
+/* request are kept in a fixed size table and each reply is   */
+/* matched to its request using the correlation id, which     */
+/* the replying application must set to the request message   */
+/* id.  The slot number is taken from the correlation id and  */
+/* the whole id is compared to make sure the reply is for the */
+/* request in the slot.  A new request is sent as soon as a   */
+/* reply arrives.                                             */
+/*                                                            */
+/**************************************************************/
+
+int pipelineRequests(FILEPTR *fptr, PUTPARMS * parms, HISTOGRAM *latencyHist, STEADYSTATE *steady)
+
+{
+	int64_t		elapsed;
+	int64_t		latency;
+	int64_t		MsgsAtLastInterval=0;
+	int64_t		repliesMatched=0;
+	int64_t		repliesUnmatched=0;
+	int			outstanding=0;
+	int			freeCount;
+	int			i;
+	int			compcode=MQCC_OK;
+	double		avgrate;
+	MQCHAR8		puttime;
+	MQBYTE24	correlId;
+	MQBYTE24	reqId;
+	char		formTime[16];
+	char		percentiles[160];
+	MY_TIME_T	afterGet;
+	MY_TIME_T	timeNow;
+	MY_TIME_T	prevTime;
+	FILEPTR		*fileptr=fptr;
+	REQUESTSLOT	*slots;
+	int			*freeSlots;
+	HISTOGRAM	intervalHist;
+
+	/* allocate the table of outstanding requests and a stack of the free slots */
+	slots = (REQUESTSLOT *)malloc(parms->inflight * sizeof(REQUESTSLOT));
+	freeSlots = (int *)malloc(parms->inflight * sizeof(int));
+	if ((NULL == slots) || (NULL == freeSlots))
+	{
+		Log("***** unable to allocate table for %d outstanding requests", parms->inflight);
+		free(slots);
+		free(freeSlots);
+		parms->err = 1;
+		return MQCC_FAILED;
+	}
+
+	memset(slots, 0, parms->inflight * sizeof(REQUESTSLOT));
+	parms->memUsed += parms->inflight * (sizeof(REQUESTSLOT) + sizeof(int));
+	for (i = 0; i < parms->inflight; i++)
+	{
+		freeSlots[i] = parms->inflight - 1 - i;
+	}
+
+	freeCount = parms->inflight;
+	clearHistogram(&intervalHist);
+	GetTime(&prevTime);
+
+	/* the start of the run makes the request message ids unique */
+	memset(reqId, 0, sizeof(reqId));
+	memcpy(reqId + REQID_RUN, &prevTime, sizeof(prevTime));
+
+	while ((MQCC_OK == compcode) && (0 == terminate) && (0 == parms->err) &&
+		   ((parms->msgwritten < parms->totcount) || (outstanding > 0)))
+	{
+		/* fill up the table of outstanding requests */
+		while ((MQCC_OK == compcode) && (0 == terminate) && (outstanding < parms->inflight) && (parms->msgwritten < parms->totcount))
+		{
+			/* take a free slot and put its number in the message id */
+			i = freeSlots[freeCount - 1];
+			memcpy(reqId + REQID_NUMBER, &(parms->msgwritten), sizeof(parms->msgwritten));
+			memcpy(reqId + REQID_SLOT, &i, sizeof(i));
+
+			/* perform the MQPUT */
+			compcode = putMessage(fileptr, &puttime, parms, reqId);
+
+			if (MQCC_OK == compcode)
+			{
+				/* remember the message id and the time the request was sent */
+				GetFastTime(&(slots[i].sendTime));
+				memcpy(slots[i].msgId, reqId, sizeof(slots[i].msgId));
+				slots[i].inUse = 1;
+				freeCount--;
+				outstanding++;
+
+				/* increment the message count */
+				parms->msgwritten++;
+
+				/* move on to the next message file */
+				fileptr = (FILEPTR *)fileptr->nextfile;
+				if (NULL == fileptr)
+				{
+					/* go back to the first message data file */
+					fileptr = fptr;
+				}
+			}
+		}
+
+		if ((compcode != MQCC_OK) || (0 == outstanding))
+		{
+			break;
+		}
+
+		/* wait for the next reply */
+		compcode = getMessage(fileptr, parms->maxWaitTime * 1000, parms, correlId);
+		if (compcode != MQCC_OK)
+		{
+			/* let the user know about the error */
+			Log("***** Error reading reply message %d with %d requests outstanding", compcode, outstanding);
+
+			/* error reading message - time to exit */
+			parms->err = 1;
+			break;
+		}
+
+		/* get the time after the MQGET */
+		GetFastTime(&afterGet);
+
+		/* find the request this reply belongs to */
+		memcpy(&i, correlId + REQID_SLOT, sizeof(i));
+		if ((i < 0) || (i >= parms->inflight) || (0 == slots[i].inUse) ||
+			(memcmp(slots[i].msgId, correlId, sizeof(correlId)) != 0))
+		{
+			/* not one of our requests - ignore it */
+			repliesUnmatched++;
+			continue;
+		}
+
+		/* calculate the latency and release the slot */
+		latency = DiffTimeNs(slots[i].sendTime, afterGet);
+		slots[i].inUse = 0;
+		freeSlots[freeCount++] = i;
+		outstanding--;
+		repliesMatched++;
+
+		/* check for a steady rate before counting this reply */
+		addSteadyCount(steady, latencyHist->count, latencyHist);
+
+		/* add the latency to the histograms for the test and the interval */
+		addToHistogram(latencyHist, latency);
+		addToHistogram(&intervalHist, latency);
+
+		/* check if we are supposed to report progress */
+		if ((parms->reportEvery > 0) && ((repliesMatched % parms->reportEvery) == 0))
+		{
+			/* calculate the length of the interval */
+			GetTime(&timeNow);
+			elapsed = DiffTime(prevTime, timeNow);
+			prevTime = timeNow;
+
+			formatTimeDiffSecs(formTime, elapsed);
+			if (elapsed > 0)
+			{
+				/* get the reply rate */
+				avgrate = (double)(((repliesMatched - MsgsAtLastInterval) * 1000000) / elapsed);
+				Log(FMTI64 " replies received in %s seconds rate %.2f", repliesMatched - MsgsAtLastInterval, formTime, avgrate);
+			}
+			else
+			{
+				Log(FMTI64 " replies received in %s seconds", repliesMatched - MsgsAtLastInterval, formTime);
+			}
+
+			/* remember the count at the beginning of the next interval */
+			MsgsAtLastInterval = repliesMatched;
+
+			/* display the latency percentiles for this interval */
+			formatPercentiles(percentiles, &intervalHist);
+			Log("Interval latency %s", percentiles);
+			clearHistogram(&intervalHist);
+		}
+	}
+
+	if (outstanding > 0)
+	{
+		Log("***** %d requests did not receive a reply", outstanding);
+	}
+
+	if (repliesUnmatched > 0)
+	{
+		Log("***** " FMTI64 " replies did not match an outstanding request", repliesUnmatched);
+	}
+
+	free(slots);
+	free(freeSlots);
+
+	return compcode;
+}
+
 void InterruptHandler (int sigVal) 
 
 { 
@@ -361,25 +617,12 @@ void printHelp(char *pgmName)
 int main(int argc, char **argv)
 
 {
-	int64_t		latency10=0;		/* latency < 10 microseconds */
-	int64_t		latency100=0;		/* latency > 10 microseconds and < 100 microseconds */
-	int64_t		latency500=0;		/* latency > 10 microseconds and < 100 microseconds */
-	int64_t		latency1000=0;		/* latency > 100 microseconds and < 1 milliseconds */
-	int64_t		latency5000=0;		/* latency > 1 millisecond and < 5 milliseconds */
-	int64_t		latency10000=0;		/* latency > 5 milliseconds and < 10 milliseconds */
-	int64_t		latency50000=0;		/* latency > 10 milliseconds and < 50 milliseconds */
-	int64_t		latency100000=0;	/* latency > 50 milliseconds and < 100 milliseconds */
-	int64_t		latency500000=0;	/* latency > 100 milliseconds and < 500 milliseconds */
-	int64_t		latency1000000=0;	/* latency > 500 millioseconds and < 1 second */
-	int64_t		latency10000000=0;	/* latency > 1 second and < 10 seconds */
-	int64_t		latency100000000=0;	/* latency > 10 seconds */
+	HISTOGRAM	latencyHist;			/* latencies observed during test */
+	HISTOGRAM	intervalHist;			/* latencies observed during the current reporting interval */
 	int64_t		avglatency;				/* average latency */
 	int64_t		elapsed=0;
 	int64_t		latency=0;
-	int64_t		totalLatency=0;			/* total of all latency observed during test - used to calculate average latency */
-	int64_t		minLatency=0;			/* minimum latency observed during test */
-	int64_t		maxLatency=0;			/* maximum latency observed during test */
-	int64_t		tempLatency=0;			/* latency in milliseconds */
+	int64_t		tempLatency=0;			/* latency in nanoseconds */
 	double		avgrate;
 	MQLONG		compcode=MQCC_OK;
 	MQLONG		reason;
@@ -404,9 +647,11 @@ int main(int argc, char **argv)
 	time_t		endTOD;
 	FILEPTR		*fptr=NULL;
 	FILEPTR		*fileptr;
-	char		avgLatency[16];
-	char		minLat[16];
-	char		maxLat[16];
+	char		avgLatency[24];
+	char		minLat[24];
+	char		maxLat[24];
+	char		percentiles[160];
+	STEADYSTATE	steady;
 	PUTPARMS	parms;
 
 	/* print the copyright statement */
@@ -418,11 +663,16 @@ int main(int argc, char **argv)
 	memset(&parms, 0, sizeof(parms));
 	memset(minLat, 0, sizeof(minLat));
 	memset(maxLat, 0, sizeof(maxLat));
+	clearHistogram(&latencyHist);
+	clearHistogram(&intervalHist);
 	memset(avgLatency, 0, sizeof(avgLatency));
 
 	/* initialize the work areas */
 	initializeParms(&parms, sizeof(PUTPARMS));
 
+	/* calibrate the high resolution timer */
+	InitializeTimer();
+
 	/* check for too few input parameters */
 	if (argc < 2)
 	{
@@ -501,6 +751,18 @@ int main(int argc, char **argv)
 		Log("wait time between messages = %d", parms.thinkTime);
 	}
 
+	/* check if more than one request is to be kept outstanding */
+	if (parms.inflight > 1)
+	{
+		Log("%d requests will be kept in flight", parms.inflight);
+
+		/* replies are matched to the outstanding requests instead */
+		parms.GetByCorrelId = 0;
+	}
+
+	/* get ready to find the steady window */
+	initSteadyState(&steady, &parms, 1);
+
 	/* set a termination handler */
 	signal(SIGINT, InterruptHandler);
 
@@ -571,7 +833,7 @@ int main(int argc, char **argv)
 		{
 			/* read any spurious reply messages with no wait time */
 			/* the reply queue must be empty before the latency measurements begin */
-			compcode = getMessage(fptr, 0, &parms);
+			compcode = getMessage(fptr, 0, &parms, NULL);
 		}
 
 		/* restore the get by correlation id */
@@ -585,6 +847,12 @@ int main(int argc, char **argv)
 	/* reset the completion code */
 	compcode = MQCC_OK;
 
+	/* check if more than one request is to be kept outstanding */
+	if (parms.inflight > 1)
+	{
+		compcode = pipelineRequests(fptr, &parms, &latencyHist, &steady);
+	}
+
 	/* loop until all the messages have been written or an error occurs */
 	while ((compcode == MQCC_OK) && (0 == terminate) && (0 == parms.err) && (parms.msgwritten < parms.totcount))
 	{
@@ -596,20 +864,20 @@ int main(int argc, char **argv)
 		}
 
 		/* perform the MQPUT */
-		compcode = putMessage(fileptr, &puttime, &parms);
+		compcode = putMessage(fileptr, &puttime, &parms, NULL);
 
 		/* check for errors */
 		if (compcode == MQCC_OK)
 		{
 			/* get the time after the put */
-			GetTime(&afterPut);
+			GetFastTime(&afterPut);
 
 			/* increment the message count */
 			parms.msgwritten++;
 
 			/* read the reply message with a maximum wait - default is 5 seconds */
 			/* this can be overridden on the command line using the -w parameter */
-			compcode = getMessage(fileptr, parms.maxWaitTime * 1000, &parms);
+			compcode = getMessage(fileptr, parms.maxWaitTime * 1000, &parms, NULL);
 
 			if (compcode != MQCC_OK)
 			{
@@ -622,88 +890,17 @@ int main(int argc, char **argv)
 			else
 			{
 				/* get the time after the MQGET */
-				GetTime(&afterGet);
+				GetFastTime(&afterGet);
 
 				/* calculate the latency */
-				latency = DiffTime(afterPut, afterGet);
-				totalLatency += latency;
-
-				/* check if this is the lowest latency so far */
-				if ((0 == minLatency) || (minLatency > latency))
-				{
-					/* update the minimum latency */
-					minLatency = latency;
-				}
+				latency = DiffTimeNs(afterPut, afterGet);
 
-				/* check if this is the highest latency so far */
-				if (latency > maxLatency)
-				{
-					/* update the minimum latency */
-					maxLatency = latency;
-				}
+				/* check for a steady rate before counting this reply */
+				addSteadyCount(&steady, latencyHist.count, &latencyHist);
 
-				/* keep track of the number of latencies by ranges */
-				/* of microseconds, from less than 10 to over 10 seconds */
-				if (latency < 10)
-				{
-					/* increment counter */
-					latency10++;
-				} 
-				else if (latency < 100)
-				{
-					/* increment counter */
-					latency100++;
-				} 
-				else if (latency < 500)
-				{
-					/* increment counter */
-					latency500++;
-				} 
-				else if (latency < 1000)
-				{
-					/* increment counter */
-					latency1000++;
-				} 
-				else if (latency < 5000)
-				{
-					/* increment counter */
-					latency5000++;
-				} 
-				else if (latency < 10000)
-				{
-					/* increment counter */
-					latency10000++;
-				} 
-				else if (latency < 50000)
-				{
-					/* increment counter */
-					latency50000++;
-				} 
-				else if (latency < 100000)
-				{
-					/* increment counter */
-					latency100000++;
-				} 
-				else if (latency < 500000)
-				{
-					/* increment counter */
-					latency500000++;
-				} 
-				else if (latency < 1000000)
-				{
-					/* increment counter */
-					latency1000000++;
-				} 
-				else if (latency < 10000000)
-				{
-					/* increment counter */
-					latency10000000++;
-				}
-				else
-				{
-					/* increment counter */
-					latency100000000++;
-				}
+				/* add the latency to the histograms for the test and the interval */
+				addToHistogram(&latencyHist, latency);
+				addToHistogram(&intervalHist, latency);
 
 				/* check if we are supposed to report progress */
 				if ((parms.reportEvery > 0) && ((parms.msgwritten % parms.reportEvery) == 0))
@@ -720,7 +917,7 @@ int main(int argc, char **argv)
 					if (parms.msgwritten > 0)
 					{
 						/* calculate the average latency */
-						tempLatency = totalLatency / parms.msgwritten;
+						tempLatency = latencyHist.total / parms.msgwritten;
 					}
 					else
 					{
@@ -730,9 +927,9 @@ int main(int argc, char **argv)
 
 					/* format the difference as a string (seconds and 6 decimal places) */
 					formatTimeDiffSecs(formTime, elapsed);
-					formatTimeDiff(avgLatency, tempLatency);
-					formatTimeDiff(minLat, minLatency);
-					formatTimeDiff(maxLat, maxLatency);
+					formatTimeDiffNs(avgLatency, tempLatency);
+					formatTimeDiffNs(minLat, latencyHist.min);
+					formatTimeDiffNs(maxLat, latencyHist.max);
 
 					if (elapsed > 0)
 					{
@@ -753,6 +950,11 @@ int main(int argc, char **argv)
 
 					/* display the minimum, maximum and average latencies */
 					Log("Min latency = %s  Max latency = %s Average latency = %s", minLat, maxLat, avgLatency);
+
+					/* display the latency percentiles for this interval */
+					formatPercentiles(percentiles, &intervalHist);
+					Log("Interval latency %s", percentiles);
+					clearHistogram(&intervalHist);
 				}
 
 				/* was a think time specified? */
@@ -797,6 +999,10 @@ int main(int argc, char **argv)
 	Log("Total messages read %d", parms.msgsRead);
 	Log("Total bytes read      %d", parms.totMsgLen);
 	Log("Total memory used %d", parms.memUsed);
+	if (parms.memMapped > 0)
+	{
+		Log("Total file data mapped %d", parms.memMapped);
+	}
 	Log("\nTotal messages written " FMTI64 " out of " FMTI64, parms.msgwritten, parms.totcount);
 	Log("Total bytes written   " FMTI64, parms.byteswritten);
 
@@ -807,53 +1013,33 @@ int main(int argc, char **argv)
 		formatTimeDiffSecs(formTime, elapsed);
 		Log("Total elapsed time in seconds %s", formTime);
 
+		/* give the rate at which replies were received */
+		if (elapsed > 0)
+		{
+			avgrate = (double)(latencyHist.count * 1000000) / (double)elapsed;
+			Log("Reply rate %.2f with %d requests in flight", avgrate, parms.inflight);
+		}
+
 		/* calculate the average latency */
-		avglatency = totalLatency / parms.msgwritten;
-		formatTimeDiff(avgLatency, avglatency);
-		formatTimeDiff(minLat, minLatency);
-		formatTimeDiff(maxLat, maxLatency);
+		avglatency = 0;
+		if (latencyHist.count > 0)
+		{
+			avglatency = latencyHist.total / latencyHist.count;
+		}
+		formatTimeDiffNs(avgLatency, avglatency);
+		formatTimeDiffNs(minLat, latencyHist.min);
+		formatTimeDiffNs(maxLat, latencyHist.max);
 
 		/* display the minimum, maximum and average latencies */
 		Log("Min latency = %s  Max latency = %s Average latency = %s", minLat, maxLat, avgLatency);
-	}
-
-	/* display the counters */
-	/* Some of the counters are only displayed if there were actually */
-	/* messages that took that amount of time to be processed */
-	if (latency10 > 0)
-	{
-		/* less than 0.01 millsecond */
-		Log("Less than 10 Microseconds   " FMTI64, latency10);
-	}
 
-	if ((latency10 > 0) || (latency100 > 0))
-	{
-		/* less than 0.1 millisecond */
-		Log("Less than 100 Microseconds  " FMTI64, latency100);
+		/* display the latency percentiles */
+		formatPercentiles(percentiles, &latencyHist);
+		Log("Latency %s", percentiles);
 	}
 
-	if ((latency10 > 0) || (latency100 > 0) || (latency500 > 0))
-	{
-		/* less than 0.5 millisecond */
-		Log("Less than 500 Microseconds  " FMTI64, latency500);
-	}
-
-	/* always display these counters */
-	/* range covers 0.5 millsecond to 10 seconds */
-	Log("Less than 1 Millisecond     " FMTI64, latency1000);
-	Log("Less than 5 Milliseconds    " FMTI64, latency5000);
-	Log("Less than 10 Milliseconds   " FMTI64, latency10000);
-	Log("Less than 50 Milliseconds   " FMTI64, latency50000);
-	Log("Less than 100 Milliseconds  " FMTI64, latency100000);
-	Log("Less than 500 Milliseconds  " FMTI64, latency500000);
-	Log("Less than 1 Second          " FMTI64, latency1000000);
-	Log("Less than 10 Seconds        " FMTI64, latency10000000);
-
-	/* check if this counter actually has been used */
-	if (latency100000000 > 0)
-	{
-		Log("Over 10 Seconds             " FMTI64, latency100000000);
-	}
+	/* report the reply rate and latency in the steady window */
+	reportSteadyState(&steady, NULL);
 
 	/* close the output queue */
 	Log("\nclosing the output queue");
@@ -884,7 +1070,7 @@ int main(int argc, char **argv)
 		if (fileptr->acqStorAddr != NULL)
 		{
 			/* release the acquired storage */
-			free(fileptr->acqStorAddr);
+			releaseFileData(fileptr->acqStorAddr);
 		}
 
 		/* remember the address of the current control block */
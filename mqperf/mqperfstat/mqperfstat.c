@@ -0,0 +1,434 @@
+/*
+Copyright (c) IBM Corporation 2000, 2018
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+
+/********************************************************************/
+/*                                                                  */
+/*   MQPERFSTAT displays the live statistics of a running MQPut2   */
+/*   or MQTimes3 process.  The process must have been started with  */
+/*   the liveStats=Y parameter or the -k option, which keeps its    */
+/*   counters in a shared memory segment named after the process    */
+/*   id.  The display is refreshed each interval, like top,        */
+/*   until the process ends.  It supports the following parameters */
+/*                                                                  */
+/*      -p process id of the program to display (required)          */
+/*      -i seconds between refreshes (default 1)                    */
+/*      -c number of refreshes (default until the program ends)     */
+/*                                                                  */
+/*   The display has the total messages and bytes, the rate in the  */
+/*   last second and since the start, the latency percentiles if   */
+/*   the program measures latency, and a line for each thread with  */
+/*   its messages, rate over the refresh interval, sleep time and   */
+/*   batch size.                                                    */
+/*                                                                  */
+/*   Reading the counters does not slow down the program, which     */
+/*   never waits for this one.                                      */
+/*                                                                  */
+/********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "signal.h"
+
+#ifdef WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "thrdsubs.h"
+#include "histsubs.h"
+#include "livesubs.h"
+
+#define DEF_INTERVAL	1				/* seconds between refreshes */
+#define MAX_INTERVAL	3600
+
+static char copyright[] = "(C) Copyright IBM Corp, 2001/2002/2004/2005/2014";
+static char Version[]=\
+"@(#)MQPerfStat V3.1 - live statistics viewer  - Jim MacNair ";
+
+#ifdef _DEBUG
+static char Level[]="mqperfstat.c V3.1 Debug version ("__DATE__" "__TIME__")";
+#else
+static char Level[]="mqperfstat.c V3.1 Release version ("__DATE__" "__TIME__")";
+#endif
+
+volatile int	terminate=0;
+
+void InterruptHandler (int sigVal)
+
+{
+	/* stop displaying */
+	terminate = 1;
+}
+
+void printHelp(char *pgmName)
+
+{
+	printf("\nformat is:\n");
+	printf("   %s -p process id <-i seconds> <-c count>\n", pgmName);
+	printf("    The process must be an MQPut2 or MQTimes3 program started with the\n");
+	printf("     liveStats=Y parameter or the -k option.\n");
+	printf("    The -i option sets the number of seconds between refreshes.\n");
+	printf("    The -c option sets the number of refreshes (default until the program ends).\n");
+}
+
+static int processStatArgs(int argc, char **argv, int *pid, int *interval, int *count)
+
+{
+	int		i;
+	int		err=0;
+	char	option;
+	char	*parmData;
+
+	for (i = 1; (i < argc) && (0 == err); i++)
+	{
+		if ((argv[i][0] != '-') || (0 == argv[i][1]))
+		{
+			printf("***** unrecognized argument %s\n", argv[i]);
+			err = 1;
+			break;
+		}
+
+		/* the value can follow the option or be the next argument */
+		option = argv[i][1];
+		if (argv[i][2] != 0)
+		{
+			parmData = argv[i] + 2;
+		}
+		else if (i + 1 < argc)
+		{
+			parmData = argv[++i];
+		}
+		else
+		{
+			printf("***** missing value for option %s\n", argv[i]);
+			err = 1;
+			break;
+		}
+
+		switch (option)
+		{
+		case 'p':
+			{
+				(*pid) = atoi(parmData);
+				break;
+			}
+		case 'i':
+			{
+				(*interval) = atoi(parmData);
+				break;
+			}
+		case 'c':
+			{
+				(*count) = atoi(parmData);
+				break;
+			}
+		default:
+			{
+				printf("***** unrecognized option -%c\n", option);
+				err = 1;
+				break;
+			}
+		}
+	}
+
+	if ((*pid) <= 0)
+	{
+		printf("***** process id (-p) is required\n");
+		err = 1;
+	}
+
+	if (((*interval) < 1) || ((*interval) > MAX_INTERVAL))
+	{
+		printf("***** interval must be between 1 and %d seconds\n", MAX_INTERVAL);
+		err = 1;
+	}
+
+	return err;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if a process is still running.  A program that was   */
+/* killed leaves its segment behind without setting the       */
+/* ending flag.                                               */
+/*                                                            */
+/**************************************************************/
+
+static int processRunning(int pid)
+
+{
+#ifdef WIN32
+	DWORD	exitCode=0;
+	HANDLE	proc;
+
+	proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)pid);
+	if (NULL == proc)
+	{
+		return 0;
+	}
+
+	GetExitCodeProcess(proc, &exitCode);
+	CloseHandle(proc);
+
+	return (STILL_ACTIVE == exitCode);
+#else
+	if ((kill(pid, 0) != 0) && (ESRCH == errno))
+	{
+		return 0;
+	}
+
+	return 1;
+#endif
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start a new screen.  The screen is only cleared when the   */
+/* output is a terminal, so the output can also be saved in   */
+/* a file.                                                    */
+/*                                                            */
+/**************************************************************/
+
+static void newScreen()
+
+{
+#ifdef WIN32
+	if (_isatty(_fileno(stdout)))
+	{
+		system("cls");
+		return;
+	}
+#else
+	if (isatty(fileno(stdout)))
+	{
+		printf("\033[H\033[2J");
+		return;
+	}
+#endif
+
+	printf("\n");
+}
+
+/**************************************************************/
+/*                                                            */
+/* Display the counters.  prevMsgs holds the message count of */
+/* each slot at the last refresh and is updated.  elapsed is  */
+/* the time since the last refresh in microseconds, or zero   */
+/* the first time.                                            */
+/*                                                            */
+/**************************************************************/
+
+static void displayStats(LIVESEGMENT *seg, int64_t *prevMsgs, int64_t elapsed, HISTOGRAM *hist)
+
+{
+	int			i;
+	int64_t		msgs=0;
+	int64_t		bytes=0;
+	int64_t		updateTime;
+	int64_t		rate;
+	int64_t		byteRate;
+	int64_t		upSecs;
+	double		avgRate=0.0;
+	double		slotRate;
+	time_t		now;
+	char		nowTime[16];
+	char		sleepTime[16];
+	char		batchSize[16];
+	char		latAvg[24];
+	char		percentiles[160];
+	LIVESLOT	*copies;
+	LIVESLOT	*copy;
+
+	copies = (LIVESLOT *)malloc(seg->slotCount * sizeof(LIVESLOT));
+	if (NULL == copies)
+	{
+		Log("***** unable to allocate storage for %d threads", seg->slotCount);
+		terminate = 1;
+		return;
+	}
+
+	/* take a copy of the counters of each thread */
+	for (i = 0; i < seg->slotCount; i++)
+	{
+		readLiveSlot(seg->slots + i, copies + i);
+		msgs += copies[i].msgs;
+		bytes += copies[i].bytes;
+	}
+
+	readLiveRate(seg, &updateTime, &rate, &byteRate);
+	getLiveHistogram(seg, hist);
+
+	time(&now);
+	upSecs = now - seg->startTime;
+	if (upSecs > 0)
+	{
+		avgRate = (double)msgs / (double)upSecs;
+	}
+
+	formatTimeSecs(nowTime, now);
+
+	newScreen();
+	printf("%s pid %d queue %s on %s at %s up " FMTI64 " secs\n", seg->program, seg->pid, seg->qname,
+		   (0 == seg->qmname[0]) ? "(default)" : seg->qmname, nowTime, upSecs);
+	printf("messages " FMTI64 " bytes " FMTI64 "\n", msgs, bytes);
+	printf("rate " FMTI64 " msgs/sec " FMTI64 " bytes/sec average %.2f msgs/sec\n", rate, byteRate, avgRate);
+
+	if (hist->count > 0)
+	{
+		formatTimeDiffNs(latAvg, hist->total / hist->count);
+		formatPercentiles(percentiles, hist);
+		printf("latency avg %s %s\n", latAvg, percentiles);
+	}
+
+	printf("\nthread         messages            bytes  msgs/sec  sleep  batch\n");
+
+	for (i = 0; i < seg->slotCount; i++)
+	{
+		copy = copies + i;
+
+		/* the rate of each thread is over the refresh interval */
+		slotRate = 0.0;
+		if (elapsed > 0)
+		{
+			slotRate = (double)(copy->msgs - prevMsgs[i]) * 1000000.0 / (double)elapsed;
+		}
+
+		prevMsgs[i] = copy->msgs;
+
+		strcpy(sleepTime, "-");
+		if (copy->sleepTime >= 0)
+		{
+			sprintf(sleepTime, FMTI64, copy->sleepTime);
+		}
+
+		strcpy(batchSize, "-");
+		if (copy->batchSize >= 0)
+		{
+			sprintf(batchSize, FMTI64, copy->batchSize);
+		}
+
+		printf("%6d %16.0f %16.0f %9.0f %6s %6s\n", i + 1, (double)copy->msgs, (double)copy->bytes, slotRate, sleepTime, batchSize);
+	}
+
+	fflush(stdout);
+	free(copies);
+}
+
+int main(int argc, char **argv)
+
+{
+	int			pid=0;
+	int			interval=DEF_INTERVAL;
+	int			count=0;
+	int			refreshes=0;
+	int			waited;
+	int64_t		elapsed=0;
+	int64_t		*prevMsgs;
+	MY_TIME_T	lastTime;
+	MY_TIME_T	now;
+	HISTOGRAM	*hist;
+	LIVESTATS	*live;
+
+	/* check for help request */
+	if ((argc < 2) || (argv[1][0] == '?') || (argv[1][1] == '?'))
+	{
+		printf("%s\n%s\n", Level, copyright);
+		printHelp(argv[0]);
+		exit(0);
+	}
+
+	/* process any command line arguments */
+	if (processStatArgs(argc, argv, &pid, &interval, &count) != 0)
+	{
+		printHelp(argv[0]);
+		exit(99);
+	}
+
+	live = attachLiveStats(pid);
+	if (NULL == live)
+	{
+		exit(98);
+	}
+
+	prevMsgs = (int64_t *)malloc(live->seg->slotCount * sizeof(int64_t));
+	hist = (HISTOGRAM *)malloc(sizeof(HISTOGRAM));
+	if ((NULL == prevMsgs) || (NULL == hist))
+	{
+		Log("***** unable to allocate storage for %d threads", live->seg->slotCount);
+		closeLiveStats(live);
+		exit(97);
+	}
+
+	memset(prevMsgs, 0, live->seg->slotCount * sizeof(int64_t));
+
+	/* set a termination handler */
+	signal(SIGINT, InterruptHandler);
+
+	GetTime(&lastTime);
+	while (0 == terminate)
+	{
+		displayStats(live->seg, prevMsgs, elapsed, hist);
+		refreshes++;
+
+		if (live->seg->ending != 0)
+		{
+			printf("\nprocess %d has ended\n", pid);
+			break;
+		}
+
+		if (0 == processRunning(pid))
+		{
+			printf("\nprocess %d is no longer running\n", pid);
+			break;
+		}
+
+		if ((count > 0) && (refreshes >= count))
+		{
+			break;
+		}
+
+		/* wait in short steps so an interrupt is seen quickly */
+		for (waited = 0; (waited < interval * 10) && (0 == terminate) && (0 == live->seg->ending); waited++)
+		{
+			sleepThread(100);
+		}
+
+		GetTime(&now);
+		elapsed = DiffTime(lastTime, now);
+		lastTime = now;
+	}
+
+	free(prevMsgs);
+	free(hist);
+	closeLiveStats(live);
+
+	return 0;
+}
@@ -193,6 +193,39 @@ Jim MacNair - Initial Contribution
 /*                                                                  */
 /********************************************************************/
 
+/********************************************************************/
+/*                                                                  */
+/* Changes in V3.1                                                  */
+/*                                                                  */
+/* 1) Added threads parameter (and -n override) to write messages   */
+/*    from multiple threads, each with its own connection and       */
+/*    queue handles.  The message data files are shared.            */
+/* 2) Added rate parameter to write messages at a constant rate.    */
+/*    The intended send time of each message is used as the time    */
+/*    stamp so latency measurements include any delays when the     */
+/*    producer falls behind the schedule.                           */
+/* 3) Added replay parameter to write captured messages with the    */
+/*    same gaps between them as when they were originally put,      */
+/*    using the put times in the saved MQMDs.  The replaySpeed      */
+/*    parameter speeds up or slows down the replay.                 */
+/* 4) The MQMD and put options for each message are built once when */
+/*    the messages are loaded.  Each put copies them and only sets  */
+/*    the fields that change, such as the time stamp.               */
+/* 5) Added autoBatch parameter to change the batch size while      */
+/*    writing to find the one with the highest rate.  The batchMin  */
+/*    and batchMax parameters limit the sizes that are tried and    */
+/*    batchWindow sets how long each size is measured.              */
+/* 6) Added statsFile parameter (and -j override) to write the      */
+/*    number of messages written each second to a CSV or JSON lines */
+/*    file, in the same format as MQTimes2.                         */
+/* 7) Added liveStats parameter (and -k option) to keep the message */
+/*    counts, sleep time and batch size of each thread in shared    */
+/*    memory, where mqperfstat can display them during the test.    */
+/* 8) Added wallClock parameter to use the time of day for the time */
+/*    stamps, so the messages can be read on another machine.       */
+/*                                                                  */
+/********************************************************************/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -232,68 +265,122 @@ void Sleep(int amount)
 /* MQ subroutines include */
 #include "qsubs.h"
 #include "rfhsubs.h"
+#include "batchsubs.h"
+
+/* thread subroutines */
+#include "thrdsubs.h"
+
+/* statistics file subroutines */
+#include "statsubs.h"
+#include "livesubs.h"
 
 static char copyright[] = "(C) Copyright IBM Corp, 2001 - 2014";
 static char Version[]=\
-"@(#)MQPut2 V3.0 - Performance driver test tool  - Jim MacNair ";
+"@(#)MQPut2 V3.1 - Performance driver test tool  - Jim MacNair ";
 
 #ifdef _DEBUG
-static char Level[]="mqput2.c V3.0 Debug version ("__DATE__" "__TIME__")";
+static char Level[]="mqput2.c V3.1 Debug version ("__DATE__" "__TIME__")";
 #else
 #ifdef NOTUNE
 #ifdef MQCLIENT
-static char Level[]="mqputsc.c V3.0 Client version ("__DATE__" "__TIME__")";
+static char Level[]="mqputsc.c V3.1 Client version ("__DATE__" "__TIME__")";
 #else
-static char Level[]="mqputs.c V3.0 Release version ("__DATE__" "__TIME__")";
+static char Level[]="mqputs.c V3.1 Release version ("__DATE__" "__TIME__")";
 #endif
 #else
 #ifdef MQCLIENT
-static char Level[]="mqput2c.c V3.0 Client version ("__DATE__" "__TIME__")";
+static char Level[]="mqput2c.c V3.1 Client version ("__DATE__" "__TIME__")";
 #else
-static char Level[]="mqput2.c V3.0 Release version ("__DATE__" "__TIME__")";
+static char Level[]="mqput2.c V3.1 Release version ("__DATE__" "__TIME__")";
 #endif
 #endif
 #endif
 
-	MQHCONN			qm=0;			/* queue manager connection handle */
-	MQHOBJ			q=0;			/* queue handle used for mqput     */
-#ifndef NOTUNE
-	MQHOBJ			Hinq=0;			/* inquire object handle           */
-#endif
-
 	/* global termination switch */
 	volatile int	terminate=0;
 	volatile int	cancelled=0;
 
+/* when writing at a fixed rate spin rather than sleep */
+/* for the last two milliseconds before a send time    */
+#define RATE_SPIN_NS	2000000
+
+/* replayed messages sent more than a millisecond after their */
+/* original time are counted as late                          */
+#define REPLAY_LATE_NS	1000000
+
 /**************************************************************/
 /*                                                            */
-/* This routine puts a message on the queue.                  */
+/* Work area for each producer thread.  Each thread has its   */
+/* own connection, queue handles and copy of the parameters.  */
+/* The list of message data files is shared by all threads.   */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int				threadNum;			/* thread number, starting with 1  */
+	int				threadCount;		/* total number of threads         */
+	char			label[16];			/* prefix for thread log messages  */
+	MQHCONN			qm;					/* queue manager connection handle */
+	MQHOBJ			q;					/* queue handle used for mqput     */
+#ifndef NOTUNE
+	MQHOBJ			Hinq;				/* inquire object handle           */
+	int				numWrittenMin;
+	int				numWrittenMax;
+#endif
+	int				rc;					/* return code from the thread     */
+	FILEPTR			*fptr;				/* first message data file         */
+	char			*msgBuffer;			/* private copy of message data    */
+	MQCHAR8			puttime;			/* put time of last message        */
+	MY_TIME_T		startTime;
+	MY_TIME_T		endTime;
+	MY_TIME_T		sendTime;			/* intended send time when paced   */
+	int64_t			lateCount;			/* messages that missed their slot */
+	int64_t			maxLag;				/* nanoseconds behind the schedule */
+	int64_t			totalLag;
+	time_t			contextTime;		/* second of the cached put date   */
+	char			contextDateTime[32];	/* put date and time for context */
+	BATCHTUNE		batchTune;			/* automatic batch size            */
+	LIVESLOT		*live;				/* live statistics or NULL         */
+	PUTPARMS		parms;				/* private copy of the parameters  */
+} PUTTHREAD;
+
+/**************************************************************/
+/*                                                            */
+/* Fields in the prebuilt MQMD that must be changed for each  */
+/* message.  Everything else is set once when the message     */
+/* data is loaded.                                            */
+/*                                                            */
+/**************************************************************/
+
+#define PUT_SLOT_GROUP			1		/* group id of an open group      */
+#define PUT_SLOT_CONTEXT		2		/* put date and time              */
+#define PUT_SLOT_COPY			4		/* private copy of the data       */
+#define PUT_SLOT_TS_ACCT		8		/* time stamp in accounting token */
+#define PUT_SLOT_TS_CORREL		16		/* time stamp in correl id        */
+#define PUT_SLOT_TS_GROUP		32		/* time stamp in group id         */
+#define PUT_SLOT_TS_USERPROP	64		/* time stamp in RFH2 usr folder  */
+#define PUT_SLOT_TS_DATA		128		/* time stamp in message data     */
+#define PUT_SLOT_TS_SHORT		256		/* data too short for time stamp  */
+#define PUT_SLOT_TIME_STAMP		(PUT_SLOT_TS_ACCT | PUT_SLOT_TS_CORREL | PUT_SLOT_TS_GROUP | PUT_SLOT_TS_USERPROP | PUT_SLOT_TS_DATA | PUT_SLOT_TS_SHORT)
+
+/**************************************************************/
+/*                                                            */
+/* This routine builds the MQMD and put message options for   */
+/* a message when the data is loaded, so that each put only   */
+/* has to copy them and change the fields in putSlots.        */
 /*                                                            */
 /**************************************************************/
 
-int putMessage(FILEPTR* fptr, 
-			   MQCHAR8 *puttime, 
-			   int *groupOpen,
-			   PUTPARMS *parms)
+void buildPutTemplate(FILEPTR *fptr, PUTPARMS *parms)
 
 {
-	MQLONG	compcode=0;
-	MQLONG	reason=0;
 	MQMD2	msgdesc = {MQMD2_DEFAULT};
 	MQPMO	mqpmo = {MQPMO_DEFAULT};
-	MY_TIME_T	perfCounter;		/* high performance counter to measure latency */
+	MQLONG	groupFlags=0;
+	int		slots=0;
 
-	/* set the get message options */
-	if (parms->batchSize > 1)
-	{
-		/* use syncpoints */
-		mqpmo.Options = MQPMO_SYNCPOINT | MQPMO_FAIL_IF_QUIESCING;
-	}
-	else
-	{
-		/* no synchpoint, each message as a separate UOW */
-		mqpmo.Options = MQPMO_NO_SYNCPOINT | MQPMO_FAIL_IF_QUIESCING;
-	}
+	/* the syncpoint option is added for each put */
+	mqpmo.Options = MQPMO_FAIL_IF_QUIESCING;
 
 	/* check if we are using an mqmd from the file */
 	if (fptr->mqmdptr != NULL)
@@ -319,15 +406,17 @@ int putMessage(FILEPTR* fptr,
 
 			if (1 == fptr->inGroup)
 			{
-				msgdesc.MsgFlags |= MQMF_MSG_IN_GROUP;
+				groupFlags |= MQMF_MSG_IN_GROUP;
 			}
 
 			if ((1 == fptr->lastGroup) || ((1 == fptr->timeStampInGroupId) && (1 == fptr->setTimeStamp)))
 			{
-				msgdesc.MsgFlags |= MQMF_LAST_MSG_IN_GROUP;
+				groupFlags |= MQMF_LAST_MSG_IN_GROUP;
 			}
 		}
 
+		msgdesc.MsgFlags = groupFlags;
+
 		/* Indicate V2 of MQMD */
 		msgdesc.Version = MQMD_VERSION_2;
 
@@ -421,23 +510,19 @@ int putMessage(FILEPTR* fptr,
 		}
 
 		/* check if a group id was specified */
-		if (1 == (*groupOpen))
+		/* the group id of a group that is already open is set for each put */
+		if (1 == fptr->GroupIdSet)
 		{
-			memcpy(msgdesc.GroupId, parms->saveGroupId, MQ_GROUP_ID_LENGTH);
+			memcpy(msgdesc.GroupId, fptr->GroupId, MQ_GROUP_ID_LENGTH);
+			msgdesc.MsgFlags |= MQMF_LAST_MSG_IN_GROUP | MQMF_MSG_IN_GROUP ;
 		}
 		else
 		{
-			if (1 == fptr->GroupIdSet)
-			{
-				memcpy(msgdesc.GroupId, fptr->GroupId, MQ_GROUP_ID_LENGTH);
-				msgdesc.MsgFlags |= MQMF_LAST_MSG_IN_GROUP | MQMF_MSG_IN_GROUP ;
-			}
-			else
-			{
-				memset(msgdesc.GroupId, 0, sizeof(msgdesc.GroupId));
-			}
+			memset(msgdesc.GroupId, 0, sizeof(msgdesc.GroupId));
 		}
 
+		slots |= PUT_SLOT_GROUP;
+
 		/* check if an accounting token was specified */
 		if (1 == fptr->AcctTokenSet)
 		{
@@ -449,14 +534,10 @@ int putMessage(FILEPTR* fptr,
 	/* check if a timestamp for latency measurements is to be inserted */
 	if (1 == fptr->setTimeStamp)
 	{
-		/* get a high resolution time stamp */
-		GetTime(&perfCounter);
-
 		/* check if the timer is to be stored in the MQMD accounting token */
 		if (fptr->timeStampInAccountingToken)
 		{
-			/* hide the performance counter in the MQMD accounting token field */
-			memcpy(&(msgdesc.AccountingToken), &perfCounter, sizeof(MY_TIME_T));
+			slots |= PUT_SLOT_TS_ACCT;
 
 			/* check if existing MQMDs are being used */
 			if (NULL == fptr->mqmdptr)
@@ -464,24 +545,24 @@ int putMessage(FILEPTR* fptr,
 				/* must use entire MQMD */
 				mqpmo.Options |= MQPMO_SET_ALL_CONTEXT;
 
-				/* set the context fields */
+				/* set the context fields - the put date and time are set for each put */
 				setContext(&msgdesc);
+				slots |= PUT_SLOT_CONTEXT;
 			}
 		}
 		/* check if the timer is to be stored in the MQMD correlation id */
 		else if (fptr->timeStampInCorrelId)
 		{
-			/* hide the performance counter in the MQMD correlation id field */
-			memcpy(&(msgdesc.CorrelId), &perfCounter, sizeof(MY_TIME_T));
+			slots |= PUT_SLOT_TS_CORREL;
 		}
 		/* check if the timer is to be stored in the MQMD group id */
 		else if (fptr->timeStampInGroupId)
 		{
-			/* hide the performance counter in the MQMD group id field */
-			memcpy(&(msgdesc.GroupId), &perfCounter, sizeof(MY_TIME_T));
+			slots |= PUT_SLOT_TS_GROUP;
 
 			/* force on the last in group indicator */
 			msgdesc.MsgFlags |= MQMF_LAST_MSG_IN_GROUP;
+			groupFlags |= MQMF_LAST_MSG_IN_GROUP;
 
 			/* force the MQMD to be type 2 */
 			msgdesc.Version = MQMD_VERSION_2;
@@ -494,18 +575,174 @@ int putMessage(FILEPTR* fptr,
 				(memcmp(fptr->dataptr, MQRFH_STRUC_ID, 4) == 0) && 
 				(memcmp(fptr->dataptr + MQRFH_STRUC_LENGTH_FIXED_2 + 4, LATENCYHEADER, 9) == 0))
 			{
-				/* convert the timestamp to hex and insert into usr folder */
-				AsciiToHex((unsigned char *)fptr->dataptr + MQRFH_STRUC_LENGTH_FIXED_2 + 13, (unsigned char *)&perfCounter, 8);
+				slots |= PUT_SLOT_TS_USERPROP | PUT_SLOT_COPY;
+				fptr->timeStampPos = MQRFH_STRUC_LENGTH_FIXED_2 + 13;
 			}
 		}
 		else if ((fptr->length - fptr->rfhlen) > (strlen(parms->qmname) + sizeof(MY_TIME_T) + 1))
+		{
+			/* the time stamp is followed by the queue manager name */
+			slots |= PUT_SLOT_TS_DATA | PUT_SLOT_COPY;
+			fptr->timeStampPos = (fptr->userDataPtr - fptr->dataptr) + fptr->timeStampOffset;
+		}
+		else
+		{
+			slots |= PUT_SLOT_TS_SHORT;
+		}
+	}
+
+	memcpy(&(fptr->putMQMD), &msgdesc, sizeof(fptr->putMQMD));
+	memcpy(&(fptr->putPMO), &mqpmo, sizeof(fptr->putPMO));
+	fptr->openGroupFlags = groupFlags;
+	fptr->putSlots = slots;
+}
+
+/**************************************************************/
+/*                                                            */
+/* This routine sets the put date and time when the context   */
+/* fields are set by the program.  The date is only formatted */
+/* again when the second changes.  The put threads run at     */
+/* the same time, so the static result of localtime cannot    */
+/* be used.                                                   */
+/*                                                            */
+/**************************************************************/
+
+void setPutDateTime(PUTTHREAD *thrd, MQMD2 *msgdesc)
+
+{
+	time_t		now;
+	struct tm	today;
+
+	time(&now);
+	if (now != thrd->contextTime)
+	{
+		thrd->contextTime = now;
+#ifdef WIN32
+		localtime_s(&today, &now);
+#else
+		localtime_r(&now, &today);
+#endif
+		strftime(thrd->contextDateTime, sizeof(thrd->contextDateTime), "%Y%m%d%H%M%S00", &today);
+	}
+
+	memcpy(&(msgdesc->PutDate), thrd->contextDateTime, sizeof(msgdesc->PutDate));
+	memcpy(&(msgdesc->PutTime), thrd->contextDateTime + 8, sizeof(msgdesc->PutTime));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Format a time of day the same way as ctime.  The put       */
+/* threads all log the time of their first message at once,   */
+/* so the time is formatted into the caller's buffer.         */
+/*                                                            */
+/**************************************************************/
+
+void formatTimeOfDay(char *timeStr, size_t len, time_t now)
+
+{
+	struct tm	today;
+
+#ifdef WIN32
+	localtime_s(&today, &now);
+#else
+	localtime_r(&now, &today);
+#endif
+
+	strftime(timeStr, len, "%a %b %d %H:%M:%S %Y\n", &today);
+}
+
+/**************************************************************/
+/*                                                            */
+/* This routine puts a message on the queue.                  */
+/*                                                            */
+/**************************************************************/
+
+int putMessage(PUTTHREAD *thrd, 
+			   FILEPTR* fptr, 
+			   int *groupOpen)
+
+{
+	MQLONG	compcode=0;
+	MQLONG	reason=0;
+	MQMD2	msgdesc;
+	MQPMO	mqpmo;
+	MY_TIME_T	perfCounter;		/* high performance counter to measure latency */
+	char	*msgdata=fptr->dataptr;	/* message data to be written */
+	PUTPARMS	*parms=&(thrd->parms);
+
+	/* start with the MQMD and put options built when the data was loaded */
+	memcpy(&msgdesc, &(fptr->putMQMD), sizeof(msgdesc));
+	memcpy(&mqpmo, &(fptr->putPMO), sizeof(mqpmo));
+
+	/* set the put message options */
+	if (parms->batchSize > 1)
+	{
+		/* use syncpoints */
+		mqpmo.Options |= MQPMO_SYNCPOINT;
+	}
+	else
+	{
+		/* no synchpoint, each message as a separate UOW */
+		mqpmo.Options |= MQPMO_NO_SYNCPOINT;
+	}
+
+	/* check if a group was started by an earlier message */
+	if ((fptr->putSlots & PUT_SLOT_GROUP) && (1 == (*groupOpen)))
+	{
+		memcpy(msgdesc.GroupId, parms->saveGroupId, MQ_GROUP_ID_LENGTH);
+		msgdesc.MsgFlags = fptr->openGroupFlags;
+	}
+
+	/* check if a timestamp for latency measurements is to be inserted */
+	if (fptr->putSlots & PUT_SLOT_TIME_STAMP)
+	{
+		/* get a high resolution time stamp */
+		/* when sending at a fixed rate use the intended send time */
+		if (thrd->sendTime != 0)
+		{
+			perfCounter = thrd->sendTime;
+		}
+		else
+		{
+			GetTime(&perfCounter);
+		}
+
+		/* check if the time stamp will be inserted into the message data */
+		/* the file data is shared with other threads so use a private copy */
+		if ((fptr->putSlots & PUT_SLOT_COPY) && (thrd->msgBuffer != NULL))
+		{
+			memcpy(thrd->msgBuffer, fptr->dataptr, fptr->length);
+			msgdata = thrd->msgBuffer;
+		}
+
+		if (fptr->putSlots & PUT_SLOT_TS_ACCT)
+		{
+			/* hide the performance counter in the MQMD accounting token field */
+			memcpy(&(msgdesc.AccountingToken), &perfCounter, sizeof(MY_TIME_T));
+		}
+		else if (fptr->putSlots & PUT_SLOT_TS_CORREL)
+		{
+			/* hide the performance counter in the MQMD correlation id field */
+			memcpy(&(msgdesc.CorrelId), &perfCounter, sizeof(MY_TIME_T));
+		}
+		else if (fptr->putSlots & PUT_SLOT_TS_GROUP)
+		{
+			/* hide the performance counter in the MQMD group id field */
+			memcpy(&(msgdesc.GroupId), &perfCounter, sizeof(MY_TIME_T));
+		}
+		else if (fptr->putSlots & PUT_SLOT_TS_USERPROP)
+		{
+			/* convert the timestamp to hex and insert into usr folder */
+			AsciiToHex((unsigned char *)msgdata + fptr->timeStampPos, (unsigned char *)&perfCounter, 8);
+		}
+		else if (fptr->putSlots & PUT_SLOT_TS_DATA)
 		{
 			/* insert the performance counter into the first 8 bytes of the message data */
 			/* note that this will clobber the first 8 bytes of the message data */
 			/* this should only be done if the mqtimes2 program is processing the messages */
 			/* and the latency option is selected for mqtimes2 */
-			memcpy((char *)fptr->userDataPtr + fptr->timeStampOffset, &perfCounter, sizeof(MY_TIME_T));
-			strcpy((char *)fptr->userDataPtr + fptr->timeStampOffset + sizeof(MY_TIME_T), parms->qmname);
+			memcpy(msgdata + fptr->timeStampPos, &perfCounter, sizeof(MY_TIME_T));
+			strcpy(msgdata + fptr->timeStampPos + sizeof(MY_TIME_T), parms->qmname);
 		}
 		else
 		{
@@ -514,8 +751,14 @@ int putMessage(FILEPTR* fptr,
 		}
 	}
 
+	/* check if the context fields are set by the program */
+	if (fptr->putSlots & PUT_SLOT_CONTEXT)
+	{
+		setPutDateTime(thrd, &msgdesc);
+	}
+
 	/* write the message to the queue */
-	MQPUT(qm, q, &msgdesc, &mqpmo, fptr->length, fptr->dataptr, &compcode, &reason);
+	MQPUT(thrd->qm, thrd->q, &msgdesc, &mqpmo, fptr->length, msgdata, &compcode, &reason);
 
 	/* check for errors */
 	checkerror("MQPUT", compcode, reason, parms->qname);
@@ -524,6 +767,7 @@ int putMessage(FILEPTR* fptr,
 	{
 		/* keep track of the number of bytes we have written */
 		parms->byteswritten += fptr->length;
+		addLiveMsg(thrd->live, fptr->length, 0);
 	}
 
 	/* check if this message is part of a group */
@@ -544,7 +788,7 @@ int putMessage(FILEPTR* fptr,
 		memcpy(parms->saveGroupId, msgdesc.GroupId, MQ_GROUP_ID_LENGTH);
 	}
 
-	memcpy(puttime, msgdesc.PutTime, sizeof(msgdesc.PutTime));
+	memcpy(thrd->puttime, msgdesc.PutTime, sizeof(msgdesc.PutTime));
 
 	return compcode;
 }
@@ -556,7 +800,7 @@ int putMessage(FILEPTR* fptr,
 /**************************************************************/
 
 #ifndef NOTUNE
-MQLONG openQueueInq(MQLONG openOpt, MQOD objdesc, const char * qmname, const char * qname, PUTPARMS *parms)
+MQLONG openQueueInq(PUTTHREAD *thrd, MQLONG openOpt, MQOD objdesc, const char * qmname, const char * qname)
 
 {
 	MQLONG	compcode;
@@ -565,11 +809,12 @@ MQLONG openQueueInq(MQLONG openOpt, MQOD objdesc, const char * qmname, const cha
 	MQLONG	IAV[1];				/* integer attribute values      */
 	MQLONG	compcode2;
 	MQLONG	reason2;
+	PUTPARMS	*parms=&(thrd->parms);
 
-	MQOPEN(qm,				/* connection handle              */
+	MQOPEN(thrd->qm,				/* connection handle              */
 		   &objdesc,		/* object descriptor for queue    */
 		   openOpt,			/* open options                   */
-		   &Hinq,			/* object handle for MQINQ        */
+		   &(thrd->Hinq),	/* object handle for MQINQ        */
 		   &compcode,		/* MQOPEN completion code         */
 		   &reason);		/* reason code                    */
 
@@ -580,8 +825,8 @@ MQLONG openQueueInq(MQLONG openOpt, MQOD objdesc, const char * qmname, const cha
 		/* try and get the queue depth */
 		/*  this will fail if the queue is really a cluster queue */
 		Select[0] = MQIA_CURRENT_Q_DEPTH;
-		MQINQ(qm,			/* connection handle                 */
-			  Hinq,			/* object handle                     */
+		MQINQ(thrd->qm,		/* connection handle                 */
+			  thrd->Hinq,	/* object handle                     */
 			  1L,			/* Selector count                    */
 			  Select,		/* Selector array                    */
 			  1L,			/* integer attribute count           */
@@ -600,14 +845,14 @@ MQLONG openQueueInq(MQLONG openOpt, MQOD objdesc, const char * qmname, const cha
 			parms->reopenInq = 1;
 
 			/* close the queue so we can reopen with the browse option added */
-			MQCLOSE(qm, &Hinq, MQCO_NONE, &compcode2, &reason2);
-			Hinq = 0;
+			MQCLOSE(thrd->qm, &(thrd->Hinq), MQCO_NONE, &compcode2, &reason2);
+			thrd->Hinq = 0;
 
 			/* now try to reopen the queue with a browse option as well */
 			openOpt |= MQOO_BROWSE;    /* open to inquire attributes     */
 			
 			/* try the open again */
-			compcode = openQueueInq(openOpt, objdesc, qmname, qname, parms);
+			compcode = openQueueInq(thrd, openOpt, objdesc, qmname, qname);
 		}
 	}
 
@@ -617,7 +862,7 @@ MQLONG openQueueInq(MQLONG openOpt, MQOD objdesc, const char * qmname, const cha
 	return compcode;
 }
 
-MQLONG getQueueDepth(const char * qmname)
+MQLONG getQueueDepth(PUTTHREAD *thrd, const char * qmname)
 
 {
 	MQLONG	numOnQueue=0;		/* Number of messages on Queue   */
@@ -628,8 +873,8 @@ MQLONG getQueueDepth(const char * qmname)
 
 	/* get the current queue depth */
 	Select[0] = MQIA_CURRENT_Q_DEPTH;
-	MQINQ(qm,			/* connection handle                 */
-		  Hinq,			/* object handle                     */
+	MQINQ(thrd->qm,		/* connection handle                 */
+		  thrd->Hinq,	/* object handle                     */
 		  1L,			/* Selector count                    */
 		  Select,		/* Selector array                    */
 		  1L,			/* integer attribute count           */
@@ -716,6 +961,27 @@ void adjustSleeptime(const int numOnQueue, const int lastdepth, PUTPARMS * parms
 }
 #endif
 
+/**************************************************************/
+/*                                                            */
+/* Add up the messages written by all the threads for the     */
+/* statistics file.  This is called on a separate thread so   */
+/* the counts may be slightly behind.                         */
+/*                                                            */
+/**************************************************************/
+
+void countMessages(void *arg, int64_t *msgs, int64_t *bytes)
+
+{
+	PUTTHREAD	*thrdTable=(PUTTHREAD *)arg;
+	int			i;
+
+	for (i = 0; i < thrdTable->threadCount; i++)
+	{
+		(*msgs) += thrdTable[i].parms.msgwritten;
+		(*bytes) += thrdTable[i].parms.byteswritten;
+	}
+}
+
 void InterruptHandler (int sigVal) 
 
 { 
@@ -737,207 +1003,330 @@ void printHelp(char *pgmName)
 {
 	printf("format is:\n");
 #ifdef NOTUNE
-	printf("  %s -f parm_file {-v} {-m QMgr} {-q queue} {-c count} {-b batchsize} {-p} {-t thinktime}\n", pgmName);
+	printf("  %s -f parm_file {-v} {-m QMgr} {-q queue} {-c count} {-b batchsize} {-n threads} {-j statsfile} {-k} {-p} {-t thinktime}\n", pgmName);
 #else
-	printf("  %s -f parm_file {-v} {-m QMgr} {-q queue} {-c count} {-b batchsize}\n", pgmName);
+	printf("  %s -f parm_file {-v} {-m QMgr} {-q queue} {-c count} {-b batchsize} {-n threads} {-j statsfile} {-k}\n", pgmName);
 #endif
 	printf("   parm_file is the fully qualified name of the parameters file\n");
 	printf("   -v verbose\n");
+	printf("   -k keep the counters in shared memory for mqperfstat\n");
 	printf("   Overrides\n");
 	printf("   -m name of queue manager\n");
 	printf("   -q name of queue\n");
 	printf("   -c message count\n");
 	printf("   -b batch size\n");
+	printf("   -n number of threads\n");
+	printf("   -j statistics file for the rate each second (CSV, or JSON lines if it ends in .json)\n");
 #ifdef NOTUNE
 	printf("   -t think time\n");
 #endif
 }
 
-int main(int argc, char **argv)
+
+/**************************************************************/
+/*                                                            */
+/* Write messages at a constant target rate.                  */
+/*                                                            */
+/* Each message has an intended send time on a fixed schedule */
+/* measured from the start of the thread.  When more than one */
+/* thread is used the threads take turns on the schedule.     */
+/* The pacer does not wait for the queue manager to catch up; */
+/* if a put is delayed the following messages are sent as    */
+/* soon as possible until the schedule is met again.  The     */
+/* intended send time rather than the actual put time is used */
+/* as the latency time stamp, so that a stall shows up in the */
+/* latency of every message that should have been sent        */
+/* during the stall.                                          */
+/*                                                            */
+/* When messages are replayed the schedule comes from the put */
+/* times of the captured messages instead, divided by the     */
+/* replay speed.  When more than one thread is used each      */
+/* thread replays every n'th message.                         */
+/*                                                            */
+/**************************************************************/
+
+static FILEPTR * nextReplayMsg(PUTTHREAD *thrd, FILEPTR *fileptr, int count, int64_t *replayBase)
 
 {
-	int64_t		MsgsAtLastInterval=0;
+	while (count-- > 0)
+	{
+		fileptr = (FILEPTR *)fileptr->nextfile;
+		if (NULL == fileptr)
+		{
+			/* the next pass through the messages starts where this one ended */
+			fileptr = thrd->fptr;
+			(*replayBase) += thrd->parms.replaySpan;
+		}
+	}
+
+	return fileptr;
+}
+
+int putAtRate(PUTTHREAD *thrd, FILEPTR **fileptr)
+
+{
+	PUTPARMS	*parms=&(thrd->parms);
+	int64_t		slot;
+	int64_t		replayBase=0;
+	int64_t		wait;
+	int64_t		lag;
+	int64_t		elapsed;
 	int64_t		lastInterval;
-	int64_t		elapsed=0;
+	int64_t		MsgsAtLastInterval=0;
 	int			uowcount=0;
-	int			groupOpen = 0;
-	int			notDone;
-	MQLONG		compcode;
+	int			groupOpen=0;
+	MQLONG		compcode=MQCC_OK;
 	MQLONG		reason;
-	MQOD		objdesc = {MQOD_DEFAULT};
-	MQLONG		openopt = 0;
-	MQLONG		maxMsgLen=0;
-	int			numWrittenMin=-1;
-	int			numWrittenMax=0;
-	int			iElapsed=0;
-	time_t		reportTime=0;		
-	time_t		prevReportTime=0;		
-#ifndef NOTUNE
-	int			numOnQueueMin=0;
-	int			numOnQueueMax=0;
-	int			writeCount;
-	int			lastdepth;
-	int64_t		saveCount;
-	MQLONG		numOnQueue;					/* Number of messages on Queue   */
-	MQLONG		O_optionsq;					/* inquire MQOPEN options        */
-#endif
-	MQCHAR8		puttime;
+	time_t		reportTime=0;
+	time_t		prevReportTime=0;
+	time_t		startTOD;
 	char		formTime[16];
+	char		formLag[24];
 	char		tempCount[16];
 	char		tempTotal[16];
 	char		tempRate[16];
-	MY_TIME_T	startTime;
-	MY_TIME_T	endTime;
+	char		todStr[32];
+	MY_TIME_T	intended;
+	MY_TIME_T	now;
 	MY_TIME_T	prevTime;
-	MY_TIME_T	newTime;
-	time_t		startTOD;
-	time_t		endTOD;
-	FILEPTR		*fptr=NULL;
-	FILEPTR		*fileptr;
-	PUTPARMS	parms;
-
-	/* print the copyright statement */
-	Log(copyright);
-	Log(Level);
-
-	/* initialize the work areas */
-	initializeParms(&parms, sizeof(PUTPARMS));
 
-	/* check for too few input parameters */
-	if (argc < 2)
+	if (1 == parms->replay)
 	{
-		printHelp(argv[0]);
-		exit(99);
-	}
+		Log("%sreplaying messages at %.2f times the original speed", thrd->label, parms->replaySpeed);
 
-	/* check for help request */
-	if ((argv[1][0] == '?') || (argv[1][1] == '?'))
-	{
-		printHelp(argv[0]);
-		exit(0);
+		/* each thread starts with a different message */
+		*fileptr = nextReplayMsg(thrd, *fileptr, thrd->threadNum - 1, &replayBase);
 	}
-
-	/* process any command line arguments */
-	processArgs(argc, argv, &parms);
-
-	if (parms.err != 0)
+	else
 	{
-		printHelp(argv[0]);
-		exit(99);
+		Log("%swriting messages at a rate of %d per second", thrd->label, parms->rate);
 	}
 
-	/* check for a log file name */
-	if (parms.logFileName[0] != 0)
+	prevTime = thrd->startTime;
+	while ((MQCC_OK == compcode) && ((parms->msgwritten < parms->totcount) || (1 == groupOpen)) && (0 == terminate))
 	{
-		/* open the log file */
-		openLog(parms.logFileName);
-	}
+		/* work out when this message should be sent */
+		/* the threads take turns on a single schedule */
+		intended = thrd->startTime;
+		if (1 == parms->replay)
+		{
+			AddTimeNs(&intended, (int64_t)((replayBase + (*fileptr)->replayNs) / parms->replaySpeed));
+		}
+		else
+		{
+			slot = (parms->msgwritten * thrd->threadCount) + thrd->threadNum - 1;
+			AddTimeNs(&intended, (slot * 1000000000) / parms->rate);
+		}
 
-	/* process the parameters file data */
-	/* process any data files in the parameters file */
-	fptr = processParmFile(parms.parmFilename, &parms, 1);
+		/* wait for the intended send time */
+		/* sleep for long waits and spin for the last part */
+		GetTime(&now);
+		wait = DiffTimeNs(now, intended);
+		while ((wait > 0) && (0 == terminate))
+		{
+			if (wait > RATE_SPIN_NS)
+			{
+				Sleep((int)((wait - RATE_SPIN_NS / 2) / 1000000));
+			}
 
-	/* start with the first message */
-	fileptr = fptr;
+			GetTime(&now);
+			wait = DiffTimeNs(now, intended);
+		}
 
-	/* check for overrides */
-	processOverrides(&parms);
+		/* remember how far behind the schedule this message is */
+		lag = -wait;
+		thrd->totalLag += lag;
+		if (lag > thrd->maxLag)
+		{
+			thrd->maxLag = lag;
+		}
 
-	/* check if we found any message data files */
-	if (NULL == fptr)
-	{
-		Log("***** No message data files found - program terminating");
-		return 94;
-	}
+		/* count messages that missed their slot completely */
+		if ((1 == parms->replay) ? (lag > REPLAY_LATE_NS) : ((lag * parms->rate) > ((int64_t)1000000000 * thrd->threadCount)))
+		{
+			thrd->lateCount++;
+		}
 
-	if (parms.err != 0)
-	{
-		Log("***** Error detected (err=%d) - program terminating", parms.err);
-		return parms.err;
-	}
+		/* perform the MQPUT with the intended time as the time stamp */
+		thrd->sendTime = intended;
+		compcode = putMessage(thrd,
+							  *fileptr,
+							  &groupOpen);
+		clearTime(&(thrd->sendTime));
 
-	/* check if a queue name or topic was specified */
-	if ((0 == parms.qname[0]) && (0 == parms.topicStr[0]) && (0 == parms.topicName[0]))
-	{
-		/* no queue name or topic */
-		Log("***** Queue name or topicStr/topicName required - program terminating");
-		return 95;
-	}
+		if (compcode != MQCC_OK)
+		{
+			break;
+		}
 
-	/* tell how many files and messages we found */
-	Log("Total files read %d", parms.fileCount);
-	Log("Total messages found %d", parms.mesgCount);
+		if (0 == parms->msgwritten)
+		{
+			/* write out the time the first messsage was sent */
+			time(&startTOD);
+			formatTimeOfDay(todStr, sizeof(todStr), startTOD);
+			LogNoCRLF("%sFirst message written at %s", thrd->label, todStr);
+
+			/* write out the time of the first message */
+			formatTime(formTime, thrd->puttime);
+			Log("%sMQ Timestamp of first message written at %8.8s", thrd->label, formTime);
+		}
 
-	/* explain what parameters are being used */
-	if (parms.qname[0] != 0)
-	{
-		Log("\n" FMTI64 " messages to be written to queue %s on queue manager %s", parms.totcount, &(parms.qname), &(parms.qmname));
-	}
-	else
-	{
-		Log("\n" FMTI64 " messages to be written to topic %s topic name %s on queue manager %s", parms.totcount, &(parms.topicStr), &(parms.topicName), &(parms.qmname));
-	}
+		/* increment the message count */
+		parms->msgwritten++;
+		uowcount++;
 
-	if (1 == parms.setTimeStamp)
-	{
-		if (1 == parms.timeStampUserProp)
+		/* check if we need to issue a commit */
+		if ((parms->batchSize > 1) && (uowcount >= parms->batchSize) && (0 == groupOpen))
 		{
-			/* indicate timestamp will be carried as user property */
-			Log("Timestamp will be carried in User Properties (rfh2 usr folder)");
+			MQCMIT(thrd->qm, &compcode, &reason);
+			checkerror("MQCMIT", compcode, reason, parms->qname);
+			uowcount = 0;
 		}
-		else if (1 == parms.timeStampInAccountingToken)
+
+		/* get the current time in seconds since 1970 */
+		time(&reportTime);
+
+		/* check if this is the first time through */
+		if (0 == prevReportTime)
 		{
-			/* indicate timestamp will be stored in MQMD */
-			Log("Timestamp will be carried in accounting token in MQMD");
+			prevReportTime = reportTime;
 		}
-		else if (1 == parms.timeStampInCorrelId)
+
+		/* check if we are supposed to report progress */
+		if (((parms->reportEvery > 0) && ((parms->msgwritten % parms->reportEvery) == 0)) ||
+			((parms->reportEverySecond > 0) && (prevReportTime != reportTime)))
 		{
-			/* indicate timestamp will be stored in MQMD */
-			Log("Timestamp will be carried in correlation ID in MQMD");
+			/* remember this report time in case reporting every second */
+			prevReportTime = reportTime;
+
+			/* calculate the length of the interval in microseconds */
+			GetTime(&now);
+			elapsed = DiffTime(prevTime, now);
+			prevTime = now;
+			formatTimeDiff(formTime, elapsed);
+
+			if (elapsed > 0)
+			{
+				/* get the message rate as a 64-bit integer */
+				lastInterval = ((parms->msgwritten - MsgsAtLastInterval) * 1000000) / elapsed;
+				sprintf(tempRate, " rate " FMTI64, lastInterval);
+			}
+			else
+			{
+				tempRate[0] = 0;
+			}
+
+			/* get the messages that were written in the previous interval */
+			/* and the total so far                                        */
+			sprintf(tempCount, FMTI64, parms->msgwritten - MsgsAtLastInterval);
+			sprintf(tempTotal, FMTI64, parms->msgwritten);
+			formatTimeDiffNs(formLag, lag);
+
+			Log("%s%7.7s messages written in %s seconds - total so far %9.9s%s behind %s", thrd->label, tempCount, formTime, tempTotal, tempRate, formLag);
+
+			/* remember the count at the beginning of the next interval */
+			MsgsAtLastInterval = parms->msgwritten;
 		}
-		else if (1 == parms.timeStampInGroupId)
+
+		/* move on to the next message */
+		if (1 == parms->replay)
 		{
-			/* indicate timestamp will be stored in MQMD */
-			Log("Timestamp will be carried in group ID in MQMD");
+			*fileptr = nextReplayMsg(thrd, *fileptr, thrd->threadCount, &replayBase);
 		}
 		else
 		{
-			/* indicate that we are adding a timestamp to the message */
-			Log("Some data in message will be overlaid with time stamp at offset %d", parms.timeStampOffset);
+			*fileptr = (FILEPTR *)(*fileptr)->nextfile;
+			if (NULL == *fileptr)
+			{
+				/* go back to the first message data file */
+				*fileptr = thrd->fptr;
+			}
 		}
 	}
 
-#ifdef NOTUNE
-	Log("thinkTime = %d batchsize = %d", parms.thinkTime, parms.batchSize);
-#else
-	Log("minimum queue depth %d max %d batchsize %d", parms.qdepth, parms.qmax, parms.batchSize);
-	Log("initial sleep time %d tune = %d", parms.sleeptime, parms.tune);
+	/* commit any remaining messages */
+	if (uowcount > 0)
+	{
+		MQCMIT(thrd->qm, &compcode, &reason);
+		checkerror("MQCMIT", compcode, reason, parms->qname);
+	}
+
+	return compcode;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Producer thread.  Connects to the queue manager, opens     */
+/* the queue and writes this thread's share of the messages.  */
+/* When only one thread is used this routine is called        */
+/* directly from the main routine.                            */
+/*                                                            */
+/**************************************************************/
+
+void putThread(void * arg)
+
+{
+	PUTTHREAD	*thrd=(PUTTHREAD *)arg;
+	PUTPARMS	*parms=&(thrd->parms);
+	int64_t		MsgsAtLastInterval=0;
+	int64_t		lastInterval;
+	int64_t		elapsed=0;
+	int			uowcount=0;
+	int			groupOpen = 0;
+	int			notDone;
+	MQLONG		compcode;
+	MQLONG		reason;
+	MQOD		objdesc = {MQOD_DEFAULT};
+	MQLONG		openopt = 0;
+	MQLONG		maxMsgLen=0;
+	time_t		reportTime=0;
+	time_t		prevReportTime=0;
+#ifndef NOTUNE
+	int			numOnQueueMin=0;
+	int			numOnQueueMax=0;
+	int			writeCount;
+	int			lastdepth;
+	int64_t		saveCount;
+	MQLONG		numOnQueue;					/* Number of messages on Queue   */
+	MQLONG		O_optionsq;					/* inquire MQOPEN options        */
 #endif
+	char		formTime[16];
+	char		tempCount[16];
+	char		tempTotal[16];
+	char		tempRate[16];
+	char		todStr[32];
+	MY_TIME_T	prevTime;
+	MY_TIME_T	newTime;
+	time_t		startTOD;
+	FILEPTR		*fileptr;
 
-	/* set a termination handler */
-	signal(SIGINT, InterruptHandler);
+	/* start with the first message */
+	fileptr = thrd->fptr;
 
 	/* Connect to the queue manager */
 #ifdef MQCLIENT
-	clientConnect2QM((char *)&(parms.qmname), &qm, &maxMsgLen, &compcode, &reason);
+	clientConnect2QM((char *)&(parms->qmname), &(thrd->qm), &maxMsgLen, &compcode, &reason);
 #else
-	connect2QM((char *)&(parms.qmname), &qm, &compcode, &reason);
+	/* each thread must have its own connection handle */
+	connectX2QM((char *)&(parms->qmname), MQCNO_HANDLE_SHARE_NONE, &(thrd->qm), &compcode, &reason);
 #endif
 
 	/* check for errors */
 	if (compcode != MQCC_OK)
 	{
-		return 98;
+		thrd->rc = 98;
+		terminate = 1;
+		return;
 	}
 
 	/* set the queue manager name */
-	strcpy(objdesc.ObjectQMgrName, parms.remoteQM);
+	strcpy(objdesc.ObjectQMgrName, parms->remoteQM);
 
 	/* check for a queue name */
-	if (parms.qname[0] != 0)
+	if (parms->qname[0] != 0)
 	{
 		/* set the qname in the open descriptor */
-		strncpy(objdesc.ObjectName, parms.qname, sizeof(objdesc.ObjectName));
+		strncpy(objdesc.ObjectName, parms->qname, sizeof(objdesc.ObjectName));
 
 		/* set the queue open options */
 		openopt = MQOO_OUTPUT + MQOO_FAIL_IF_QUIESCING;
@@ -948,29 +1337,31 @@ int main(int argc, char **argv)
 		/* set up the object descriptor for the topic */
 		objdesc.Version = MQOD_VERSION_4;
 		objdesc.ObjectType = MQOT_TOPIC;
-		objdesc.ObjectString.VSPtr = (void *)&(parms.topicStr);
+		objdesc.ObjectString.VSPtr = (void *)&(parms->topicStr);
 		objdesc.ObjectString.VSLength = MQVS_NULL_TERMINATED;
-		strncpy(objdesc.ObjectName, parms.topicName, sizeof(objdesc.ObjectName));
+		strncpy(objdesc.ObjectName, parms->topicName, sizeof(objdesc.ObjectName));
 
 		/* set the queue open options */
 		openopt = MQOO_OUTPUT + MQOO_FAIL_IF_QUIESCING;
 	}
 
 	/* check if we need to set all context */
-	if ((1 == parms.foundMQMD) || (1 == parms.timeStampInAccountingToken))
+	if ((1 == parms->foundMQMD) || (1 == parms->timeStampInAccountingToken))
 	{
 		openopt |= MQOO_SET_ALL_CONTEXT;
 	}
 
 	/* open the queue for output */
-	Log("opening queue %s for output", parms.qname);
-	MQOPEN(qm, &objdesc, openopt, &q, &compcode, &reason);
+	Log("%sopening queue %s for output", thrd->label, parms->qname);
+	MQOPEN(thrd->qm, &objdesc, openopt, &(thrd->q), &compcode, &reason);
 
 	/* check for errors */
-	checkerror("MQOPEN", compcode, reason, parms.qname);
+	checkerror("MQOPEN", compcode, reason, parms->qname);
 	if (compcode != MQCC_OK)
 	{
-		return 97;
+		thrd->rc = 97;
+		terminate = 1;
+		return;
 	}
 
 #ifdef NOTUNE
@@ -980,7 +1371,7 @@ int main(int argc, char **argv)
 	/*                                                            */
 	/**************************************************************/
 
-	if (parms.msgwritten < parms.totcount)
+	if (parms->msgwritten < parms->totcount)
 	{
 		notDone = 1;
 	}
@@ -999,22 +1390,27 @@ int main(int argc, char **argv)
 				 + MQOO_FAIL_IF_QUIESCING;
 
 	/* open the queue for inquiry */
-	compcode = openQueueInq(O_optionsq, objdesc, parms.qmname, parms.qname, &parms);
+	compcode = openQueueInq(thrd, O_optionsq, objdesc, parms->qmname, parms->qname);
 
 	if (compcode != MQCC_OK)
 	{
-		return 96;
+		thrd->rc = 96;
+		terminate = 1;
+		return;
 	}
 
-	numOnQueue = getQueueDepth(parms.qmname);
+	numOnQueue = getQueueDepth(thrd, parms->qmname);
 
 	/**************************************************************/
 	/*                                                            */
 	/*   Check if all the messages have been written              */
 	/*                                                            */
+	/*   When more than one thread is used each thread primes     */
+	/*   the queue with its share of the messages.                */
+	/*                                                            */
 	/**************************************************************/
 
-	if (((parms.msgwritten + numOnQueue) < parms.qmax) && (parms.msgwritten < parms.totcount))
+	if (((parms->msgwritten * thrd->threadCount + numOnQueue) < parms->qmax) && (parms->msgwritten < parms->totcount))
 	{
 		notDone = 1;
 	}
@@ -1024,10 +1420,27 @@ int main(int argc, char **argv)
 	}
 #endif
 
+	/* get ready to change the batch size if requested */
+	initBatchTune(&(thrd->batchTune), parms, &(parms->batchSize), thrd->label);
+
+	/* show the starting sleep time and batch size in the live statistics */
+#ifdef NOTUNE
+	setLiveTuning(thrd->live, -1, parms->batchSize);
+#else
+	setLiveTuning(thrd->live, parms->sleeptime, parms->batchSize);
+#endif
+
 	/* remember the starting time */
-	GetTime(&startTime);
+	GetTime(&(thrd->startTime));
 	GetTime(&prevTime);
 
+	/* check if the messages are to be written at a fixed rate or replayed */
+	if ((parms->rate > 0) || (1 == parms->replay))
+	{
+		compcode = putAtRate(thrd, &fileptr);
+		notDone = 0;
+	}
+
 	/* if monitoring queue depth top up the queue to hold qmax messages */
 	/* prime the queue with an initial number of messages               */
 	/* After this, we will monitor the queue depth and                  */
@@ -1036,27 +1449,27 @@ int main(int argc, char **argv)
 	while ((compcode == MQCC_OK) && (1 == notDone) && (0 == terminate))
 	{
 		/* perform the MQPUT */
-		compcode = putMessage(fileptr,
-							  &puttime,
-							  &groupOpen,
-							  &parms);
+		compcode = putMessage(thrd,
+							  fileptr,
+							  &groupOpen);
 
 		/* check for errors */
 		if (MQCC_OK == compcode)
 		{
-			if (0 == parms.msgwritten)
+			if (0 == parms->msgwritten)
 			{
 				/* write out the time the first messsage was sent */
 				time(&startTOD);
-				LogNoCRLF("First message written at %s", ctime(&startTOD));
+				formatTimeOfDay(todStr, sizeof(todStr), startTOD);
+				LogNoCRLF("%sFirst message written at %s", thrd->label, todStr);
 
 				/* write out the time of the first message */
-				formatTime(formTime, puttime);
-				Log("MQ Timestamp of first message written at %8.8s", formTime);
+				formatTime(formTime, thrd->puttime);
+				Log("%sMQ Timestamp of first message written at %8.8s", thrd->label, formTime);
 			}
 
 			/* increment the message count */
-			parms.msgwritten++;
+			parms->msgwritten++;
 
 			/* remember how many messages are in this uow */
 			uowcount++;
@@ -1065,11 +1478,19 @@ int main(int argc, char **argv)
 			/* if a group is in progress */
 			/* make sure to commit only after */
 			/* the group is finished */
-			if ((parms.batchSize > 1) && (uowcount >= parms.batchSize) && (0 == groupOpen))
+			if ((parms->batchSize > 1) && (uowcount >= parms->batchSize) && (0 == groupOpen))
+			{
+				commitBatch(thrd->qm, &(thrd->batchTune), &compcode, &reason);
+				checkerror("MQCMIT", compcode, reason, parms->qname);
+				uowcount = 0;
+			}
+
+			/* check if the batch size is to be changed between units of work */
+			if ((1 == thrd->batchTune.active) && ((0 == uowcount) || (1 == parms->batchSize)) && (0 == groupOpen))
 			{
-				MQCMIT(qm, &compcode, &reason);
-				checkerror("MQCMIT", compcode, reason, parms.qname);
 				uowcount = 0;
+				adjustBatchSize(&(thrd->batchTune), &(parms->batchSize), parms->msgwritten);
+				setLiveTuning(thrd->live, -1, parms->batchSize);
 			}
 
 #ifdef NOTUNE
@@ -1083,14 +1504,14 @@ int main(int argc, char **argv)
 			}
 
 			/* check if we are supposed to report progress */
-			if (((parms.reportEvery > 0) && ((parms.msgwritten % parms.reportEvery) == 0)) ||
-				((parms.reportEverySecond > 0) && (prevReportTime != reportTime)))
+			if (((parms->reportEvery > 0) && ((parms->msgwritten % parms->reportEvery) == 0)) ||
+				((parms->reportEverySecond > 0) && (prevReportTime != reportTime)))
 			{
 				/* remember this report time in case reporting every second */
 				prevReportTime = reportTime;
 #else
 			/* check if we are supposed to report progress */
-			if ((parms.reportEvery > 0) && ((parms.msgwritten % parms.reportEvery) == 0))
+			if ((parms->reportEvery > 0) && ((parms->msgwritten % parms->reportEvery) == 0))
 			{
 #endif
 				/* report the time to put a given number of messages */
@@ -1107,7 +1528,7 @@ int main(int argc, char **argv)
 				if (elapsed > 0)
 				{
 					/* avoid any 32-bit overflows */
-					lastInterval = parms.msgwritten - MsgsAtLastInterval;
+					lastInterval = parms->msgwritten - MsgsAtLastInterval;
 
 					/* get the message rate as a 64-bit integer */
 					/* this is a division by the number of microseconds */
@@ -1122,25 +1543,25 @@ int main(int argc, char **argv)
 
 				/* get the messages that were written in the previous interval */
 				/* and the total so far                                        */
-				sprintf(tempCount, FMTI64, parms.msgwritten - MsgsAtLastInterval);
-				sprintf(tempTotal, FMTI64, parms.msgwritten);
-				
+				sprintf(tempCount, FMTI64, parms->msgwritten - MsgsAtLastInterval);
+				sprintf(tempTotal, FMTI64, parms->msgwritten);
+
 				/* write out the time it took to write the messages without the rate */
-				Log("%7.7s messages written in %s seconds - total so far %9.9s%s", tempCount, formTime, tempTotal, tempRate);
+				Log("%s%7.7s messages written in %s seconds - total so far %9.9s%s", thrd->label, tempCount, formTime, tempTotal, tempRate);
 
 				/* remember the count at the beginning of the next interval */
-				MsgsAtLastInterval = parms.msgwritten;
+				MsgsAtLastInterval = parms->msgwritten;
 			}
 
 #ifdef NOTUNE
 			/* was a think time specified? */
-			if ((fileptr->thinkTime > 0) && ((parms.msgwritten % parms.batchSize) == 0) && (0 == groupOpen))
+			if ((fileptr->thinkTime > 0) && ((parms->msgwritten % parms->batchSize) == 0) && (0 == groupOpen))
 			{
-				if ((parms.batchSize > 1) && (uowcount > 1) && (0 == groupOpen))
+				if ((parms->batchSize > 1) && (uowcount > 1) && (0 == groupOpen))
 				{
 					/* commit the messages first before issuing the sleep */
-					MQCMIT(qm, &compcode, &reason);
-					checkerror("MQCMIT", compcode, reason, parms.qname);
+					MQCMIT(thrd->qm, &compcode, &reason);
+					checkerror("MQCMIT", compcode, reason, parms->qname);
 					uowcount = 0;
 				}
 
@@ -1154,18 +1575,18 @@ int main(int argc, char **argv)
 			if (NULL == fileptr)
 			{
 				/* go back to the first message data file */
-				fileptr = fptr;
+				fileptr = thrd->fptr;
 			}
 		}
 
 #ifdef NOTUNE
-		if (parms.msgwritten >= parms.totcount)
+		if (parms->msgwritten >= parms->totcount)
 		{
 			/* end as soon as the group is finished */
 			notDone = groupOpen;
 		}
 #else
-		if (((parms.msgwritten + numOnQueue) >= parms.qmax) || (parms.msgwritten >= parms.totcount))
+		if (((parms->msgwritten * thrd->threadCount + numOnQueue) >= parms->qmax) || (parms->msgwritten >= parms->totcount))
 		{
 			/* end as soon as the group is finished */
 			notDone = groupOpen;
@@ -1175,8 +1596,8 @@ int main(int argc, char **argv)
 
 	if (uowcount > 0)
 	{
-		MQCMIT(qm, &compcode, &reason);
-		checkerror("MQCMIT", compcode, reason, parms.qname);
+		MQCMIT(thrd->qm, &compcode, &reason);
+		checkerror("MQCMIT", compcode, reason, parms->qname);
 		uowcount = 0;
 	}
 
@@ -1186,13 +1607,13 @@ int main(int argc, char **argv)
 	prevReportTime = 0;
 
 	/* give the initial number of messages written */
-	if (parms.tune == 1)
+	if (parms->tune == 1)
 	{
-		Log("initial number of messages written " FMTI64, parms.msgwritten);
+		Log("%sinitial number of messages written " FMTI64, thrd->label, parms->msgwritten);
 	}
 
 	/* enter message loop */
-	if (parms.msgwritten < parms.totcount)
+	if (parms->msgwritten < parms->totcount)
 	{
 		notDone = 1;
 	}
@@ -1202,16 +1623,16 @@ int main(int argc, char **argv)
 	}
 
 	/* start the main loop */
-	while ((compcode == MQCC_OK) && (1 == notDone) && (0 == parms.err) && (0 == terminate))
+	while ((compcode == MQCC_OK) && (1 == notDone) && (0 == parms->err) && (0 == terminate))
 	{
 		/* initialize the last depth variable */
-		lastdepth = getQueueDepth(parms.qmname);
+		lastdepth = getQueueDepth(thrd, parms->qmname);
 
 		/* issue a wait for sleeptime milliseconds */
-		Sleep(parms.sleeptime); /*sleep in millisecs*/
+		Sleep(parms->sleeptime); /*sleep in millisecs*/
 
 		/* get the current queue depth */
-		numOnQueue = getQueueDepth(parms.qmname);
+		numOnQueue = getQueueDepth(thrd, parms->qmname);
 
 		/* remember the minimum and maximum counts */
 		if ((numOnQueueMax == 0) || (numOnQueue < numOnQueueMin))
@@ -1228,59 +1649,60 @@ int main(int argc, char **argv)
 		if (0 == numOnQueue)
 		{
 			/* issue error message if we find no messages on queue */
-			Log("***** warning - no messages on queue after " FMTI64 " msgs written", parms.msgwritten);
-			Log("***** decrease sleeptime parameter from %d", parms.sleeptime);
+			Log("%s***** warning - no messages on queue after " FMTI64 " msgs written", thrd->label, parms->msgwritten);
+			Log("%s***** decrease sleeptime parameter from %d", thrd->label, parms->sleeptime);
 		}
 
 		/* check if we are tuning the sleeptime parameter */
-		if (1 == parms.tune)
+		if (1 == parms->tune)
 		{
 			/* give the current message count */
-			Log("number on queue %d, lastdepth %d", numOnQueue, lastdepth);
+			Log("%snumber on queue %d, lastdepth %d", thrd->label, numOnQueue, lastdepth);
 
 			/* check if we want to adjust the sleep time */
-			adjustSleeptime(numOnQueue, lastdepth, &parms);
+			adjustSleeptime(numOnQueue, lastdepth, parms);
+			setLiveTuning(thrd->live, parms->sleeptime, -1);
 		}
 
 		/* check if we are below the minimum depth */
-		if (numOnQueue < parms.qdepth)
+		if (numOnQueue < parms->qdepth)
 		{
 			/* check if we need to update our max and min statistics */
-			writeCount = parms.qdepth - numOnQueue;
-			if ((-1 == numWrittenMin) || (writeCount < numWrittenMin))
+			writeCount = parms->qdepth - numOnQueue;
+			if ((-1 == thrd->numWrittenMin) || (writeCount < thrd->numWrittenMin))
 			{
-				numWrittenMin = writeCount;
+				thrd->numWrittenMin = writeCount;
 			}
 
-			if (writeCount > numWrittenMax)
+			if (writeCount > thrd->numWrittenMax)
 			{
-				numWrittenMax = writeCount;
+				thrd->numWrittenMax = writeCount;
 			}
 
 			/* remember the number of messages written previously */
-			saveCount = parms.msgwritten;
+			saveCount = parms->msgwritten;
 
 			/* check the depth of the queue */
-			while ((MQCC_OK == compcode) && (numOnQueue < parms.qmax) && (parms.msgwritten < parms.totcount) && (0 == terminate))
+			while ((MQCC_OK == compcode) && (numOnQueue < parms->qmax) && (parms->msgwritten < parms->totcount) && (0 == terminate))
 			{
 				/* perform the MQPUT */
-				compcode = putMessage(fileptr, 
-									  &puttime, 
-									  &groupOpen,
-									  &parms);
+				compcode = putMessage(thrd,
+									  fileptr,
+									  &groupOpen);
 
 				/* check for errors */
 				if (MQCC_OK == compcode)
 				{
-					if (0 == parms.msgwritten)
+					if (0 == parms->msgwritten)
 					{
 						/* write out the time the first messsage was sent */
 						time(&startTOD);
-						LogNoCRLF("First message written at %s", ctime(&startTOD));
+						formatTimeOfDay(todStr, sizeof(todStr), startTOD);
+						LogNoCRLF("%sFirst message written at %s", thrd->label, todStr);
 
 						/* write out the time of the first message */
-						formatTime(formTime, puttime);
-						Log("MQ Timestamp of first message written at %8.8s", formTime);
+						formatTime(formTime, thrd->puttime);
+						Log("%sMQ Timestamp of first message written at %8.8s", thrd->label, formTime);
 					}
 
 					/* get the current time in seconds since 1970 */
@@ -1293,8 +1715,8 @@ int main(int argc, char **argv)
 					}
 
 					/* check if we are supposed to report progress */
-					if (((parms.reportEvery > 0) && ((parms.msgwritten % parms.reportEvery) == 0)) ||
-						((parms.reportEverySecond > 0) && (prevReportTime != reportTime)))
+					if (((parms->reportEvery > 0) && ((parms->msgwritten % parms->reportEvery) == 0)) ||
+						((parms->reportEverySecond > 0) && (prevReportTime != reportTime)))
 					{
 						/* remember this report time in case reporting every second */
 						prevReportTime = reportTime;
@@ -1313,7 +1735,7 @@ int main(int argc, char **argv)
 						if (elapsed > 0)
 						{
 							/* get the number of messages and allow for the division by microseconds */
-							lastInterval = parms.msgwritten - MsgsAtLastInterval;
+							lastInterval = parms->msgwritten - MsgsAtLastInterval;
 							lastInterval *= 1000000;
 
 							/* get the message rate as a 64-bit integer */
@@ -1330,14 +1752,14 @@ int main(int argc, char **argv)
 
 						/* get the messages that were written in the previous interval */
 						/* and the total so far                                        */
-						sprintf(tempCount, FMTI64, parms.msgwritten - MsgsAtLastInterval);
-						sprintf(tempTotal, FMTI64, parms.msgwritten);
+						sprintf(tempCount, FMTI64, parms->msgwritten - MsgsAtLastInterval);
+						sprintf(tempTotal, FMTI64, parms->msgwritten);
 
 						/* write out the time it took to write the messages */
-						Log("%7.7s messages written in %s seconds - total so far %9.9s%s", tempCount, formTime, tempTotal, tempRate);
-				
+						Log("%s%7.7s messages written in %s seconds - total so far %9.9s%s", thrd->label, tempCount, formTime, tempTotal, tempRate);
+
 						/* remember the count at the beginning of the next interval */
-						MsgsAtLastInterval = parms.msgwritten;
+						MsgsAtLastInterval = parms->msgwritten;
 					}
 
 					/* move on to the next message file */
@@ -1345,39 +1767,48 @@ int main(int argc, char **argv)
 					if (NULL == fileptr)
 					{
 						/* go back to the first message data file */
-						fileptr = fptr;
+						fileptr = thrd->fptr;
 					}
 
 					/* increment the message count and uow counter */
-					parms.msgwritten++;
-					numOnQueue++;
+					/* assume the other threads are writing at the same rate */
+					parms->msgwritten++;
+					numOnQueue += thrd->threadCount;
 					uowcount++;
 
 					/* check if we need to issue a commit */
-					if ((parms.batchSize > 1) && (uowcount >= parms.batchSize) && (0 == groupOpen))
+					if ((parms->batchSize > 1) && (uowcount >= parms->batchSize) && (0 == groupOpen))
 					{
-						MQCMIT(qm, &compcode, &reason);
-						checkerror("MQCMIT", compcode, reason, parms.qname);
+						commitBatch(thrd->qm, &(thrd->batchTune), &compcode, &reason);
+						checkerror("MQCMIT", compcode, reason, parms->qname);
 						uowcount = 0;
 					}
+
+					/* check if the batch size is to be changed between units of work */
+					if ((1 == thrd->batchTune.active) && ((0 == uowcount) || (1 == parms->batchSize)) && (0 == groupOpen))
+					{
+						uowcount = 0;
+						adjustBatchSize(&(thrd->batchTune), &(parms->batchSize), parms->msgwritten);
+						setLiveTuning(thrd->live, -1, parms->batchSize);
+					}
 				}
 			}
 
 			/* commit the messages we have just written */
-			if ((parms.batchSize > 1) && (uowcount > 0))
+			if ((parms->batchSize > 1) && (uowcount > 0))
 			{
-				MQCMIT(qm, &compcode, &reason);
-				checkerror("MQCMIT", compcode, reason, parms.qname);
+				MQCMIT(thrd->qm, &compcode, &reason);
+				checkerror("MQCMIT", compcode, reason, parms->qname);
 				uowcount = 0;
 			}
 
-			if (1 == parms.tune)
+			if (1 == parms->tune)
 			{
-				Log(FMTI64 " messages written to queue",parms.msgwritten - saveCount);
+				Log("%s" FMTI64 " messages written to queue", thrd->label, parms->msgwritten - saveCount);
 			}
 		}
 
-		if (parms.msgwritten >= parms.totcount)
+		if (parms->msgwritten >= parms->totcount)
 		{
 			/* make sure we do not end in the middle of a group */
 			notDone = groupOpen;
@@ -1385,26 +1816,450 @@ int main(int argc, char **argv)
 	}
 
 	/* check if tuning of the sleep time was requested */
-	if (1 == parms.tune)
+	if (1 == parms->tune)
 	{
 		/* write out the final sleep time value */
-		Log("final sleep time value %d", parms.sleeptime);
+		Log("%sfinal sleep time value %d", thrd->label, parms->sleeptime);
 	}
 
 	/* write out the minimum and maximum number of messages on the queue */
-	Log("number on queue after sleep - min %d, max %d", numOnQueueMin, numOnQueueMax);
+	Log("%snumber on queue after sleep - min %d, max %d", thrd->label, numOnQueueMin, numOnQueueMax);
 #endif
 
+	/* write out the batch size that was used at the end */
+	reportBatchSize(&(thrd->batchTune), parms->batchSize);
+
 	/* remember the ending time */
-	GetTime(&endTime);
+	GetTime(&(thrd->endTime));
 
-	/* write out the time the first messsage was sent */
+	/* close the output queue */
+	Log("\n%sclosing the queue", thrd->label);
+	MQCLOSE(thrd->qm, &(thrd->q), MQCO_NONE, &compcode, &reason);
+
+	checkerror("MQCLOSE", compcode, reason, parms->qname);
+
+#ifndef NOTUNE
+	/* close the inquiry queue handle */
+	Log("%sclosing the inquiry queue", thrd->label);
+	MQCLOSE(thrd->qm, &(thrd->Hinq), MQCO_NONE, &compcode, &reason);
+
+	checkerror("MQCLOSE", compcode, reason, parms->qname);
+#endif
+
+	/* Disconnect from the queue manager */
+	Log("%sdisconnecting from the queue manager", thrd->label);
+	MQDISC(&(thrd->qm), &compcode, &reason);
+
+	checkerror("MQDISC", compcode, reason, parms->qmname);
+}
+
+int main(int argc, char **argv)
+
+{
+	int64_t		elapsed=0;
+	int64_t		share;
+	int64_t		msgRate;
+	int64_t		lateCount=0;
+	int64_t		maxLag=0;
+	int64_t		totalLag=0;
+	int64_t		timedCount=0;
+	int			i;
+	int			rc=0;
+	int			threadCount;
+	int			started=0;
+	int			numWrittenMin=-1;
+	int			numWrittenMax=0;
+	int			needCopy=0;
+	size_t		maxLength=0;
+	char		formTime[16];
+	char		formLag[24];
+	MY_TIME_T	startTime;
+	MY_TIME_T	endTime;
+	time_t		endTOD;
+	FILEPTR		*fptr=NULL;
+	FILEPTR		*fileptr;
+	PUTTHREAD	*thrdTable=NULL;
+	PUTTHREAD	*thrd;
+	PUTTHREAD	*lastThrd=NULL;
+	THREAD_T	*thrdHandles=NULL;
+	STATSFILE	*stats=NULL;
+	STATSPOLL	*statsPoll=NULL;
+	LIVESTATS	*live=NULL;
+	PUTPARMS	parms;
+
+	/* print the copyright statement */
+	Log(copyright);
+	Log(Level);
+
+	/* initialize the work areas */
+	initializeParms(&parms, sizeof(PUTPARMS));
+
+	/* check for too few input parameters */
+	if (argc < 2)
+	{
+		printHelp(argv[0]);
+		exit(99);
+	}
+
+	/* check for help request */
+	if ((argv[1][0] == '?') || (argv[1][1] == '?'))
+	{
+		printHelp(argv[0]);
+		exit(0);
+	}
+
+	/* process any command line arguments */
+	processArgs(argc, argv, &parms);
+
+	if (parms.err != 0)
+	{
+		printHelp(argv[0]);
+		exit(99);
+	}
+
+	/* check for a log file name */
+	if (parms.logFileName[0] != 0)
+	{
+		/* open the log file */
+		openLog(parms.logFileName);
+	}
+
+	/* process the parameters file data */
+	/* process any data files in the parameters file */
+	fptr = processParmFile(parms.parmFilename, &parms, 1);
+
+	/* check for overrides */
+	processOverrides(&parms);
+
+	/* check if we found any message data files */
+	if (NULL == fptr)
+	{
+		Log("***** No message data files found - program terminating");
+		return 94;
+	}
+
+	if (parms.err != 0)
+	{
+		Log("***** Error detected (err=%d) - program terminating", parms.err);
+		return parms.err;
+	}
+
+	/* check if a queue name or topic was specified */
+	if ((0 == parms.qname[0]) && (0 == parms.topicStr[0]) && (0 == parms.topicName[0]))
+	{
+		/* no queue name or topic */
+		Log("***** Queue name or topicStr/topicName required - program terminating");
+		return 95;
+	}
+
+	/* tell how many files and messages we found */
+	Log("Total files read %d", parms.fileCount);
+	Log("Total messages found %d", parms.mesgCount);
+
+	/* explain what parameters are being used */
+	if (parms.qname[0] != 0)
+	{
+		Log("\n" FMTI64 " messages to be written to queue %s on queue manager %s", parms.totcount, &(parms.qname), &(parms.qmname));
+	}
+	else
+	{
+		Log("\n" FMTI64 " messages to be written to topic %s topic name %s on queue manager %s", parms.totcount, &(parms.topicStr), &(parms.topicName), &(parms.qmname));
+	}
+
+	if (1 == parms.setTimeStamp)
+	{
+		if (1 == parms.timeStampUserProp)
+		{
+			/* indicate timestamp will be carried as user property */
+			Log("Timestamp will be carried in User Properties (rfh2 usr folder)");
+		}
+		else if (1 == parms.timeStampInAccountingToken)
+		{
+			/* indicate timestamp will be stored in MQMD */
+			Log("Timestamp will be carried in accounting token in MQMD");
+		}
+		else if (1 == parms.timeStampInCorrelId)
+		{
+			/* indicate timestamp will be stored in MQMD */
+			Log("Timestamp will be carried in correlation ID in MQMD");
+		}
+		else if (1 == parms.timeStampInGroupId)
+		{
+			/* indicate timestamp will be stored in MQMD */
+			Log("Timestamp will be carried in group ID in MQMD");
+		}
+		else
+		{
+			/* indicate that we are adding a timestamp to the message */
+			Log("Some data in message will be overlaid with time stamp at offset %d", parms.timeStampOffset);
+		}
+
+		/* the clock decides where the messages can be read */
+		if (1 == usingWallClock())
+		{
+			Log("Timestamp is the time of day - the clocks of the machines must be synchronized");
+		}
+		else
+		{
+			Log("Timestamp is the monotonic clock - the messages must be read on this machine");
+		}
+	}
+
+#ifdef NOTUNE
+	Log("thinkTime = %d batchsize = %d", parms.thinkTime, parms.batchSize);
+#else
+	Log("minimum queue depth %d max %d batchsize %d", parms.qdepth, parms.qmax, parms.batchSize);
+	Log("initial sleep time %d tune = %d", parms.sleeptime, parms.tune);
+#endif
+
+	/* the write once option requires each file to be written exactly once */
+	threadCount = parms.threads;
+	if ((threadCount > 1) && (1 == parms.writeOnce))
+	{
+		Log("***** threads parameter ignored when write once is selected");
+		threadCount = 1;
+	}
+
+	/* do not start more threads than there are messages */
+	if ((threadCount > 1) && (parms.totcount < threadCount))
+	{
+		threadCount = (int)parms.totcount;
+		if (threadCount < 1)
+		{
+			threadCount = 1;
+		}
+	}
+
+	if (threadCount > 1)
+	{
+		Log("%d threads will be used to write the messages", threadCount);
+	}
+
+	/* work out when each message should be sent if replaying */
+	if (1 == parms.replay)
+	{
+		parms.replaySpan = setReplayTimes(fptr, &timedCount);
+		if (0 == timedCount)
+		{
+			Log("***** replay ignored - no messages have an MQMD with a put time (capture with saveMQMD=Y)");
+			parms.replay = 0;
+		}
+		else
+		{
+			formatTimeDiffNs(formLag, parms.replaySpan);
+			Log("messages will be replayed at %.2f times the original speed - " FMTI64 " messages with put times over %s seconds", parms.replaySpeed, timedCount, formLag);
+
+			if (parms.rate > 0)
+			{
+				Log("***** rate parameter ignored when replaying messages");
+				parms.rate = 0;
+			}
+		}
+	}
+
+	if (parms.rate > 0)
+	{
+		Log("messages will be written at a rate of %d per second", parms.rate);
+	}
+
+	/* the batch size cannot be measured when the rate is fixed */
+	if ((1 == parms.autoBatch) && ((parms.rate > 0) || (1 == parms.replay)))
+	{
+		Log("***** autoBatch ignored when writing at a fixed rate or replaying messages");
+		parms.autoBatch = 0;
+	}
+
+	if (1 == parms.autoBatch)
+	{
+		Log("batch size will be changed between %d and %d to get the highest rate, measuring for %d milliseconds", parms.batchMin, parms.batchMax, parms.batchWindow);
+	}
+
+	/* build the MQMD and put options for each message, find the longest */
+	/* message and check if the time stamp is inserted into the message  */
+	/* data, which requires a private copy per thread                    */
+	fileptr = fptr;
+	while (fileptr != NULL)
+	{
+		buildPutTemplate(fileptr, &parms);
+
+		if (fileptr->length > maxLength)
+		{
+			maxLength = fileptr->length;
+		}
+
+		if (fileptr->putSlots & PUT_SLOT_COPY)
+		{
+			needCopy = 1;
+		}
+
+		fileptr = (FILEPTR *)fileptr->nextfile;
+	}
+
+	/* allocate the thread work areas */
+	thrdTable = (PUTTHREAD *)malloc(threadCount * sizeof(PUTTHREAD));
+	thrdHandles = (THREAD_T *)malloc(threadCount * sizeof(THREAD_T));
+	if ((NULL == thrdTable) || (NULL == thrdHandles))
+	{
+		Log("***** unable to allocate storage for %d threads - program terminating", threadCount);
+		return 93;
+	}
+
+	for (i = 0; i < threadCount; i++)
+	{
+		thrd = thrdTable + i;
+		memset(thrd, 0, sizeof(PUTTHREAD));
+		memcpy(&(thrd->parms), &parms, sizeof(PUTPARMS));
+
+		thrd->threadNum = i + 1;
+		thrd->threadCount = threadCount;
+		thrd->fptr = fptr;
+#ifndef NOTUNE
+		thrd->numWrittenMin = -1;
+#endif
+
+		/* divide the messages between the threads */
+		share = parms.totcount / threadCount;
+		if (i < (parms.totcount % threadCount))
+		{
+			share++;
+		}
+
+		thrd->parms.totcount = share;
+
+		if (threadCount > 1)
+		{
+			/* identify the thread in any messages */
+			sprintf(thrd->label, "thread %d ", i + 1);
+
+			/* get a private copy of the message data if a time stamp is inserted */
+			if (1 == needCopy)
+			{
+				thrd->msgBuffer = (char *)malloc(maxLength + 1);
+				if (NULL == thrd->msgBuffer)
+				{
+					Log("***** unable to allocate message buffer for thread %d - program terminating", i + 1);
+					return 93;
+				}
+
+				parms.memUsed += maxLength + 1;
+			}
+		}
+	}
+
+	/* check if interval statistics are to be written to a file */
+	if (parms.statsFilename[0] != 0)
+	{
+		stats = openStatsFile(parms.statsFilename);
+		statsPoll = startStatsPoll(stats, countMessages, thrdTable);
+	}
+
+	/* check if the counters are to be kept in shared memory for mqperfstat */
+	live = openLiveStats("mqput2", &parms, threadCount);
+	for (i = 0; i < threadCount; i++)
+	{
+		thrdTable[i].live = getLiveSlot(live, i);
+	}
+
+	/* set a termination handler */
+	signal(SIGINT, InterruptHandler);
+
+	if (1 == threadCount)
+	{
+		/* run the producer on this thread */
+		putThread(thrdTable);
+	}
+	else
+	{
+		/* start the producer threads */
+		while ((started < threadCount) && (0 == terminate))
+		{
+			if (startThread(thrdHandles + started, putThread, thrdTable + started) != 0)
+			{
+				/* stop any threads that were already started */
+				terminate = 1;
+				rc = 92;
+				break;
+			}
+
+			started++;
+		}
+
+		/* wait for all the threads that were started to finish */
+		for (i = 0; i < started; i++)
+		{
+			waitThread(thrdHandles[i]);
+		}
+	}
+
+	/* write the last interval and the totals to the statistics file */
+	endStatsPoll(statsPoll);
+	closeStatsFile(stats);
+	closeLiveStats(live);
+
+	/* total up the results from all the threads */
+	for (i = 0; i < threadCount; i++)
+	{
+		thrd = thrdTable + i;
+
+		parms.msgwritten += thrd->parms.msgwritten;
+		parms.byteswritten += thrd->parms.byteswritten;
+		lateCount += thrd->lateCount;
+		totalLag += thrd->totalLag;
+		if (thrd->maxLag > maxLag)
+		{
+			maxLag = thrd->maxLag;
+		}
+
+		/* remember the first return code */
+		if ((0 == rc) && (thrd->rc != 0))
+		{
+			rc = thrd->rc;
+		}
+
+		/* only threads that wrote messages have start and end times */
+		if (thrd->parms.msgwritten > 0)
+		{
+			if ((NULL == lastThrd) || (DiffTime(thrd->startTime, startTime) > 0))
+			{
+				startTime = thrd->startTime;
+			}
+
+			if ((NULL == lastThrd) || (DiffTime(endTime, thrd->endTime) > 0))
+			{
+				endTime = thrd->endTime;
+				lastThrd = thrd;
+			}
+		}
+
+#ifndef NOTUNE
+		if ((thrd->numWrittenMin != -1) && ((-1 == numWrittenMin) || (thrd->numWrittenMin < numWrittenMin)))
+		{
+			numWrittenMin = thrd->numWrittenMin;
+		}
+
+		if (thrd->numWrittenMax > numWrittenMax)
+		{
+			numWrittenMax = thrd->numWrittenMax;
+		}
+#endif
+	}
+
+	/* check if nothing was written due to an error */
+	if ((rc != 0) && (0 == parms.msgwritten))
+	{
+		return rc;
+	}
+
+	/* write out the time the last messsage was sent */
 	time(&endTOD);
 	LogNoCRLF("Last message written at %s", ctime(&endTOD));
 
 	/* write out the MQ timestamp of the last message */
-	formatTime(formTime, puttime);
-	Log("MQ timestamp of last message written at %8.8s", formTime);
+	if (lastThrd != NULL)
+	{
+		formatTime(formTime, lastThrd->puttime);
+		Log("MQ timestamp of last message written at %8.8s", formTime);
+	}
 
 	/* issue message if user cancelled the program */
 	if (1 == terminate)
@@ -1420,6 +2275,32 @@ int main(int argc, char **argv)
 		}
 	}
 
+	/* give the results for each thread */
+	if (threadCount > 1)
+	{
+		Log("");
+		for (i = 0; i < threadCount; i++)
+		{
+			thrd = thrdTable + i;
+
+			elapsed = 0;
+			msgRate = 0;
+			if (thrd->parms.msgwritten > 0)
+			{
+				elapsed = DiffTime(thrd->startTime, thrd->endTime);
+			}
+
+			if (elapsed > 0)
+			{
+				msgRate = (thrd->parms.msgwritten * 1000000) / elapsed;
+			}
+
+			formatTimeDiffSecs(formTime, elapsed);
+			Log("thread %3d messages " FMTI64 " bytes " FMTI64 " elapsed %s rate " FMTI64,
+				thrd->threadNum, thrd->parms.msgwritten, thrd->parms.byteswritten, formTime, msgRate);
+		}
+	}
+
 	/* dump out the total message count */
 	Log("\nTotal messages written " FMTI64 " out of " FMTI64, parms.msgwritten, parms.totcount);
 
@@ -1429,10 +2310,31 @@ int main(int argc, char **argv)
 		elapsed = DiffTime(startTime, endTime);
 		formatTimeDiffSecs(formTime, elapsed);
 		Log("Total elapsed time in seconds %s", formTime);
+
+		if ((threadCount > 1) && (elapsed > 0))
+		{
+			/* give the combined rate for all threads */
+			Log("Total message rate    " FMTI64, (parms.msgwritten * 1000000) / elapsed);
+		}
 	}
 
 	Log("Total bytes written   " FMTI64, parms.byteswritten);
+
+	/* report how far the producers fell behind the target rate */
+	if (((parms.rate > 0) || (1 == parms.replay)) && (parms.msgwritten > 0))
+	{
+		formatTimeDiffNs(formLag, maxLag);
+		Log("Maximum time behind schedule %s", formLag);
+		formatTimeDiffNs(formLag, totalLag / parms.msgwritten);
+		Log("Average time behind schedule %s", formLag);
+		Log("Messages that missed their send time " FMTI64, lateCount);
+	}
+
 	Log("Total memory used %d", parms.memUsed);
+	if (parms.memMapped > 0)
+	{
+		Log("Total file data mapped %d", parms.memMapped);
+	}
 #ifndef NOTUNE
 	if (numWrittenMax > 0)
 	{
@@ -1440,26 +2342,6 @@ int main(int argc, char **argv)
 	}
 #endif
 
-	/* close the input queue */
-	Log("\nclosing the queue");
-	MQCLOSE(qm, &q, MQCO_NONE, &compcode, &reason);
-
-	checkerror("MQCLOSE", compcode, reason, parms.qname);
-
-#ifndef NOTUNE
-	/* close the inquiry queue handle */
-	Log("closing the inquiry queue");
-	MQCLOSE(qm, &Hinq, MQCO_NONE, &compcode, &reason);
-
-	checkerror("MQCLOSE", compcode, reason, parms.qname);
-#endif
-
-	/* Disconnect from the queue manager */
-	Log("disconnecting from the queue manager");
-	MQDISC(&qm, &compcode, &reason);
-
-	checkerror("MQDISC", compcode, reason, parms.qmname);
-
 	/* check for a log file */
 	if (parms.logFileName[0] != 0)
 	{
@@ -1470,6 +2352,18 @@ int main(int argc, char **argv)
 	/* release any storage used for RFH areas */
 	releaseRFH(&parms);
 
+	/* release the thread work areas */
+	for (i = 0; i < threadCount; i++)
+	{
+		if (thrdTable[i].msgBuffer != NULL)
+		{
+			free(thrdTable[i].msgBuffer);
+		}
+	}
+
+	free(thrdTable);
+	free(thrdHandles);
+
 	/* release any storage we acquired for files */
 	fileptr = fptr;
 	while (fileptr != NULL)
@@ -1478,7 +2372,7 @@ int main(int argc, char **argv)
 		if (fileptr->acqStorAddr != NULL)
 		{
 			/* release the acquired storage */
-			free(fileptr->acqStorAddr);
+			releaseFileData(fileptr->acqStorAddr);
 		}
 
 		/* remember the address of the current control block */
@@ -1503,5 +2397,5 @@ int main(int argc, char **argv)
 	Log("MQPUT2 program ended");
 #endif
 
-	return(0);
+	return(rc);
 }
@@ -22,12 +22,30 @@ Jim MacNair - Initial Contribution
 /*      -t sleep time in milliseconds (wait before replying)        */
 /*      -m override the queue manager name in the parameters file.  */
 /*      -q override the queue  name in the parameters file.         */
+/*      -n number of worker threads.                                */
 /*                                                                  */
 /*    if no queue manager is specified, the default queue manager   */
 /*    is used.                                                      */
 /*                                                                  */
 /********************************************************************/
 
+/********************************************************************/
+/*                                                                  */
+/* Changes in V3.1                                                  */
+/*                                                                  */
+/* 1) Reply queue handles are kept open in a small cache, so that   */
+/*    requests which alternate between reply queues do not need an  */
+/*    MQOPEN and MQCLOSE for each reply.  The size of the cache is  */
+/*    set with the replyHandles parameter and the least recently    */
+/*    used handle is closed when the cache is full.                 */
+/* 2) Added threads parameter (and -n override) to read requests    */
+/*    on multiple threads, each with its own connection.            */
+/* 3) Added statsFile parameter (and -j override) to write the      */
+/*    number of requests read each second to a CSV or JSON lines    */
+/*    file, in the same format as MQTimes2.                         */
+/*                                                                  */
+/********************************************************************/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +75,12 @@ Jim MacNair - Initial Contribution
 #include "qsubs.h"
 #include "rfhsubs.h"
 
+/* thread subroutines */
+#include "thrdsubs.h"
+
+/* statistics file subroutines */
+#include "statsubs.h"
+
 #ifndef WIN32
 void Sleep(int amount)
 {
@@ -68,20 +92,57 @@ void Sleep(int amount)
 	volatile int	terminate=0;
 	volatile int	cancelled=0;
 
-	/* reply queue open and close counters */
-	int64_t			replyOpens=0;
-	int64_t			replyCloses=0;
+	/* number of requests claimed by the worker threads */
+	volatile int64_t	msgsClaimed=0;
 
 static char copyright[] = "(C) Copyright IBM Corp, 2001-2014\n";
 static char Version[]=\
-"@(#)MQReply V3.0 - MQ reply program  - Jim MacNair ";
+"@(#)MQReply V3.1 - MQ reply program  - Jim MacNair ";
 
 #ifdef _DEBUG
-static char Level[]="mqreply.c V3.0 Debug version ("__DATE__" "__TIME__")";
+static char Level[]="mqreply.c V3.1 Debug version ("__DATE__" "__TIME__")";
 #else
-static char Level[]="mqreply.c V3.0 Release version ("__DATE__" "__TIME__")";
+static char Level[]="mqreply.c V3.1 Release version ("__DATE__" "__TIME__")";
 #endif
 
+/**************************************************************/
+/*                                                            */
+/* Cached reply queue handle.                                 */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	char			qmName[MQ_Q_MGR_NAME_LENGTH + 8];
+	char			qName[MQ_Q_NAME_LENGTH + 8];
+	MQHOBJ			hObj;				/* 0 if the entry is not in use    */
+	int64_t			lastUsed;			/* use count when last used        */
+} REPLYHANDLE;
+
+/**************************************************************/
+/*                                                            */
+/* Work area for each worker thread.  Each thread has its     */
+/* own connection, reply handle cache and copy of the         */
+/* parameters.  The reply data is shared by all threads.      */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int				threadNum;			/* thread number, starting with 1  */
+	int				threadCount;		/* number of worker threads        */
+	char			label[16];			/* prefix for thread log messages  */
+	MQHCONN			qm;					/* queue manager connection handle */
+	int				rc;					/* return code from the thread     */
+	int64_t			msgsRead;
+	int64_t			bytesRead;
+	int64_t			replyOpens;			/* reply queue open and close      */
+	int64_t			replyCloses;		/* counters                        */
+	int64_t			useCount;			/* number of reply handle lookups  */
+	REPLYHANDLE		*cache;				/* parms.replyHandles entries      */
+	char			*replyData;			/* reply message data              */
+	size_t			replyDataLen;
+	PUTPARMS		parms;				/* private copy of the parameters  */
+} REPLYWORKER;
+
 /**************************************************************************************/
 /*                                                                                    */
 /* perform special processing on the jms folder when using it as the basis of a reply */
@@ -223,7 +284,145 @@ unsigned int processJMSfolder(char * inptr, char * outptr, size_t segLen)
 	return bytesMoved;
 }
 
-int	BuildReply(char * msgdata, size_t datalen, char * inputData, int inputLen, MQMD2 *md, MQLONG qm, PUTPARMS * parms)
+/**************************************************************/
+/*                                                            */
+/* Find an open handle for a reply queue.                     */
+/*                                                            */
+/* The reply queue is opened if it is not already in the      */
+/* cache.  When the cache is full the least recently used     */
+/* reply queue is closed to make room.                        */
+/*                                                            */
+/**************************************************************/
+
+MQHOBJ getReplyHandle(REPLYWORKER *wrk, const char *qmName, const char *qName, MQLONG *cc, MQLONG *rc)
+
+{
+	int			i;
+	int			victim=0;
+	MQLONG		openopt;
+	MQOD		od = {MQOD_DEFAULT};    /* Object Descriptor             */
+	REPLYHANDLE	*entry;
+	PUTPARMS	*parms=&(wrk->parms);
+
+	(*cc) = MQCC_OK;
+	(*rc) = MQRC_NONE;
+	wrk->useCount++;
+
+	/* check if the reply queue is already open */
+	for (i = 0; i < parms->replyHandles; i++)
+	{
+		entry = wrk->cache + i;
+		if (0 == entry->hObj)
+		{
+			/* remember the first free entry */
+			if (wrk->cache[victim].hObj != 0)
+			{
+				victim = i;
+			}
+		}
+		else
+		{
+			if ((strcmp(entry->qName, qName) == 0) && (strcmp(entry->qmName, qmName) == 0))
+			{
+				entry->lastUsed = wrk->useCount;
+				return entry->hObj;
+			}
+
+			/* otherwise remember the least recently used entry */
+			if ((wrk->cache[victim].hObj != 0) && (entry->lastUsed < wrk->cache[victim].lastUsed))
+			{
+				victim = i;
+			}
+		}
+	}
+
+	/* check if a reply queue must be closed to make room */
+	entry = wrk->cache + victim;
+	if (entry->hObj != 0)
+	{
+		MQCLOSE(wrk->qm, &(entry->hObj), MQCO_NONE, cc, rc);
+		entry->hObj = 0;
+
+		checkerror("MQCLOSE", (*cc), (*rc), entry->qName);
+
+		/* keep count of the number of closes */
+		wrk->replyCloses++;
+	}
+
+	/* set the queue open options */
+	openopt = MQOO_OUTPUT + MQOO_FAIL_IF_QUIESCING;
+
+	/* set the queue name */
+	strncpy(od.ObjectName, qName, MQ_Q_NAME_LENGTH);
+
+	/* check if the queue manager is the same as the connected queue manager */
+	if (strcmp(qmName, parms->qmname) != 0)
+	{
+		/* looks like a remote queue manager name */
+		strncpy(od.ObjectQMgrName, qmName, MQ_Q_MGR_NAME_LENGTH);
+	}
+
+	if (0 == parms->silent)
+	{
+		/* tell what we are doing */
+		Log("%sopening reply queue %s", wrk->label, qName);
+	}
+
+	/* open the queue for output */
+	MQOPEN(wrk->qm, &od, openopt, &(entry->hObj), cc, rc);
+
+	/* check for errors */
+	checkerror("MQOPEN", (*cc), (*rc), qName);
+
+	/* keep track of the number of opens */
+	wrk->replyOpens++;
+
+	if ((*cc) != MQCC_OK)
+	{
+		entry->hObj = 0;
+		return 0;
+	}
+
+	/* remember the queue in the cache */
+	strcpy(entry->qmName, qmName);
+	strcpy(entry->qName, qName);
+	entry->lastUsed = wrk->useCount;
+
+	return entry->hObj;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Close all the cached reply queue handles.                  */
+/*                                                            */
+/**************************************************************/
+
+void closeReplyHandles(REPLYWORKER *wrk)
+
+{
+	int			i;
+	MQLONG		cc;
+	MQLONG		rc;
+	REPLYHANDLE	*entry;
+
+	for (i = 0; i < wrk->parms.replyHandles; i++)
+	{
+		entry = wrk->cache + i;
+		if (entry->hObj != 0)
+		{
+			Log("%sclosing reply queue %s", wrk->label, entry->qName);
+			MQCLOSE(wrk->qm, &(entry->hObj), MQCO_NONE, &cc, &rc);
+			entry->hObj = 0;
+
+			checkerror("MQCLOSE", cc, rc, entry->qName);
+
+			/* keep count of the number of closes */
+			wrk->replyCloses++;
+		}
+	}
+}
+
+int	BuildReply(REPLYWORKER *wrk, char * msgdata, size_t datalen, char * inputData, int inputLen, MQMD2 *md)
 
 {
 	size_t	allocLen=0;
@@ -238,10 +437,10 @@ int	BuildReply(char * msgdata, size_t datalen, char * inputData, int inputLen, M
 	MQRFH2	*rfh2;
 	MQLONG	cc=MQCC_OK;
 	MQLONG	rc=MQRC_NONE;
-	MQLONG	openopt=0;
+	MQHOBJ	hReplyQ;
 	MQPMO	pmo = {MQPMO_DEFAULT};
-	MQOD	od = {MQOD_DEFAULT};    /* Object Descriptor             */
 	MQMD2	mqmd = {MQMD2_DEFAULT};
+	PUTPARMS	*parms=&(wrk->parms);
 	char	qmName[MQ_Q_MGR_NAME_LENGTH + 8];
 	char	qName[MQ_Q_NAME_LENGTH + 8];
 	char	trimmedQMname[MQ_Q_MGR_NAME_LENGTH + 8];
@@ -269,219 +468,187 @@ int	BuildReply(char * msgdata, size_t datalen, char * inputData, int inputLen, M
 	strcpy(trimmedQMname, qmName);
 	rtrim(trimmedQMname);
 
-	/* check if we are using the same queue as before */
-	if (((strcmp(parms->replyQname, trimmedQname) != 0) || (strcmp(parms->replyQMname, trimmedQMname) != 0)) && (parms->replyQname[0] != 0) && (parms->replyQ != 0))
+	/* check if we want to introduce a delay - specified in milliseconds */
+	if (parms->sleeptime > 0)
 	{
-		/* close the current reply to queue */
-		MQCLOSE(qm, &(parms->hReplyQ), MQCO_NONE, &cc, &rc);
-		parms->hReplyQ = 0;
+		Sleep(parms->sleeptime);
+	}
 
-		checkerror("MQCLOSE", cc, rc, parms->replyQMname);
+	/* get a handle for the reply to queue */
+	hReplyQ = getReplyHandle(wrk, trimmedQMname, trimmedQname, &cc, &rc);
 
-		/* keep count of the number of closes */
-		replyCloses++;
+	if (cc != MQCC_OK)
+	{
+		Log("Unable to open reply to queue %s for output", trimmedQname);
 	}
-
-	/* make sure the previous connect has worked */
-	if (0 == cc)
+	else
 	{
-		/* check if we want to introduce a delay - specified in milliseconds */
-		if (parms->sleeptime > 0)
+		/* check if the request message is to be sent back as the reply */
+		if (1 == parms->useInputAsReply)
 		{
-			Sleep(parms->sleeptime);
+			/* point to the request message */
+			replyData = inputData;
+			datalen = inputLen;
+
+			/* use most of the original MQMD */
+			memcpy(&mqmd, md, sizeof(mqmd));
+
+			/* set the correlation id and clear the message id */
+			/* clear the reply to queue and queue manager */
+			/* set the message type to reply */
+			memcpy(&(mqmd.CorrelId), md->MsgId, MQ_CORREL_ID_LENGTH);
+			memcpy(&(mqmd.MsgId), MQMI_NONE, MQ_MSG_ID_LENGTH);
+			mqmd.MsgType = MQMT_REPLY;
+			memset(&(mqmd.ReplyToQ), 0, sizeof(mqmd.ReplyToQ));
+			memset(&(mqmd.ReplyToQMgr), 0, sizeof(mqmd.ReplyToQMgr));
 		}
-
-		/* remember the queue manager we are connected to */
-		strcpy(parms->replyQMname, trimmedQMname);
-
-		/* check if we need to open the reply queue */
-		if (0 == parms->hReplyQ)
+		else
 		{
-			/* set the queue open options */
-			openopt = MQOO_OUTPUT + MQOO_FAIL_IF_QUIESCING;
-
-			/* set the queue name */
-			strncpy(od.ObjectName, trimmedQname, MQ_Q_NAME_LENGTH);
-
-			/* check if the queue manager is the same as the connected queue manager */
-			if (strcmp(trimmedQMname, parms->qmname) != 0)
+			/* set the MQMD options from the original message */
+			memcpy(mqmd.CorrelId, md->MsgId, MQ_CORREL_ID_LENGTH);
+			memcpy(&(mqmd.MsgId), MQMI_NONE, MQ_MSG_ID_LENGTH);
+			mqmd.MsgType = MQMT_REPLY;
+			memcpy(mqmd.Format, parms->msgformat, MQ_FORMAT_LENGTH);
+
+			/* check if a ccsid was specified */
+			if (parms->codepage != 0)
 			{
-				/* looks like a remote queue manager name */
-				strncpy(od.ObjectQMgrName, trimmedQMname, MQ_Q_MGR_NAME_LENGTH);
+				mqmd.CodedCharSetId = parms->codepage;
 			}
 
-			if (0 == parms->silent)
+			/* check if encoding was specified */
+			if (parms->encoding != 0)
 			{
-				/* tell what we are doing */
-				Log("opening reply queue %s", trimmedQname);
+				mqmd.Encoding = parms->encoding;
 			}
 
-			/* open the queue for output */
-			MQOPEN(qm, &od, openopt, &(parms->hReplyQ), &cc, &rc);
+			/* check if we need to return the RFH2 header from the request message */
+			/* some programs like WBI/SF may require this */
+			if (1 == parms->resendRFH)
+			{
+				/* check if we have an RFH2 header */
+				if ((memcmp(md->Format, MQFMT_RF_HEADER_2, MQ_FORMAT_LENGTH) == 0) && (inputLen >= MQRFH_STRUC_LENGTH_FIXED_2))
+				{
+					rfh2 = (MQRFH2 *)inputData;
+					rfhLen = (unsigned int)rfh2->StrucLength;
 
-			/* check for errors */
-			checkerror("MQOPEN", cc, rc, qName);
+					/* allocate memory to allocate for the reply */
+					allocLen = rfhLen + datalen;
+					replyData = (char *)malloc(allocLen);
+					rfh2 = (MQRFH2 *)replyData;
 
-			/* keep track of the number of opens */
-			replyOpens++;
-		}
+					/* copy the fixed part of the RFH to the data buffer */
+					memcpy(replyData, inputData, MQRFH_STRUC_LENGTH_FIXED_2);
 
-		if (cc != MQCC_OK)
-		{
-			Log("Unable to open reply to queue %s for output", trimmedQname);
-		}
-		else
-		{
-			/* remember the queue we are connected to */
-			strcpy(parms->replyQname, trimmedQname);
+					/* set the message format of the reply in the RFH2 header */
+					memcpy(rfh2->Format, parms->msgformat, 8);
 
-			/* check if the request message is to be sent back as the reply */
-			if (1 == parms->useInputAsReply)
-			{
-				/* point to the request message */
-				replyData = inputData;
-				datalen = inputLen;
-
-				/* use most of the original MQMD */
-				memcpy(&mqmd, md, sizeof(mqmd));
-
-				/* set the correlation id and clear the message id */
-				/* clear the reply to queue and queue manager */
-				/* set the message type to reply */
-				memcpy(&(mqmd.CorrelId), md->MsgId, MQ_CORREL_ID_LENGTH);
-				memcpy(&(mqmd.MsgId), MQMI_NONE, MQ_MSG_ID_LENGTH);
-				mqmd.MsgType = MQMT_REPLY;
-				memset(&(mqmd.ReplyToQ), 0, sizeof(mqmd.ReplyToQ));
-				memset(&(mqmd.ReplyToQMgr), 0, sizeof(mqmd.ReplyToQMgr));
-			}
-			else
-			{
-				/* set the MQMD options from the original message */
-				memcpy(mqmd.CorrelId, md->MsgId, MQ_CORREL_ID_LENGTH);
-				memcpy(&(mqmd.MsgId), MQMI_NONE, MQ_MSG_ID_LENGTH);
-				mqmd.MsgType = MQMT_REPLY;
-				memcpy(mqmd.Format, parms->msgformat, MQ_FORMAT_LENGTH);
-
-				/* check if a ccsid was specified */
-				if (parms->codepage != 0)
-				{
-					mqmd.CodedCharSetId = parms->codepage;
-				}
+					/* calculate the remaining length */
+					rfhLen -= MQRFH_STRUC_LENGTH_FIXED_2;
+					totLen = MQRFH_STRUC_LENGTH_FIXED_2;
 
-				/* check if encoding was specified */
-				if (parms->encoding != 0)
-				{
-					mqmd.Encoding = parms->encoding;
-				}
+					/* get an input and an output pointer */
+					outptr = replyData + MQRFH_STRUC_LENGTH_FIXED_2;
+					inptr = inputData + MQRFH_STRUC_LENGTH_FIXED_2;
 
-				/* check if we need to return the RFH2 header from the request message */
-				/* some programs like WBI/SF may require this */
-				if (1 == parms->resendRFH)
-				{
-					/* check if we have an RFH2 header */
-					if ((memcmp(md->Format, MQFMT_RF_HEADER_2, MQ_FORMAT_LENGTH) == 0) && (inputLen >= MQRFH_STRUC_LENGTH_FIXED_2))
+					while (rfhLen > 0)
 					{
-						rfh2 = (MQRFH2 *)inputData;
-						rfhLen = (unsigned int)rfh2->StrucLength;
-
-						/* allocate memory to allocate for the reply */
-						allocLen = rfhLen + datalen;
-						replyData = (char *)malloc(allocLen);
-						rfh2 = (MQRFH2 *)replyData;
+						/* get the length of this segment */
+						memcpy((char *)&segLen, inptr, 4);
+						inptr += 4;
 
-						/* copy the fixed part of the RFH to the data buffer */
-						memcpy(replyData, inputData, MQRFH_STRUC_LENGTH_FIXED_2);
+						/* figure out what kind of folder this is */
+						if (memcmp(inptr, "<jms>", 5) == 0)
+						{
+							/* need to remove the Dst element and change the Rto to Dst */
+							outSegLen = processJMSfolder(inptr, outptr + 4, segLen);
+						}
+						else
+						{
+							/* no special processing necessary - just copy the data */
+							memcpy(outptr + 4, inptr, segLen);
 
-						/* set the message format of the reply in the RFH2 header */
-						memcpy(rfh2->Format, parms->msgformat, 8);
+							/* output length is the same as the input length */
+							outSegLen = segLen;
+						}
 
-						/* calculate the remaining length */
-						rfhLen -= MQRFH_STRUC_LENGTH_FIXED_2;
-						totLen = MQRFH_STRUC_LENGTH_FIXED_2;
+						/* set the segment length */
+						memcpy(outptr, (char *)&outSegLen, 4);
 
-						/* get an input and an output pointer */
-						outptr = replyData + MQRFH_STRUC_LENGTH_FIXED_2;
-						inptr = inputData + MQRFH_STRUC_LENGTH_FIXED_2;
+						/* calculate the total length of the RFH2 */
+						totLen += outSegLen + 4;
 
-						while (rfhLen > 0)
-						{
-							/* get the length of this segment */
-							memcpy((char *)&segLen, inptr, 4);
-							inptr += 4;
-
-							/* figure out what kind of folder this is */
-							if (memcmp(inptr, "<jms>", 5) == 0)
-							{
-								/* need to remove the Dst element and change the Rto to Dst */
-								outSegLen = processJMSfolder(inptr, outptr + 4, segLen);
-							}
-							else
-							{
-								/* no special processing necessary - just copy the data */
-								memcpy(outptr + 4, inptr, segLen);
-
-								/* output length is the same as the input length */
-								outSegLen = segLen;
-							}
-
-							/* set the segment length */
-							memcpy(outptr, (char *)&outSegLen, 4);
-
-							/* calculate the total length of the RFH2 */
-							totLen += outSegLen + 4;
-
-							/* update the input and output pointers */
-							inptr += segLen;
-							outptr += outSegLen + 4;
-
-							/* calculate the remaining bytes in the input RFH2 */
-							rfhLen -= segLen + 4;
-						}
+						/* update the input and output pointers */
+						inptr += segLen;
+						outptr += outSegLen + 4;
 
-						/* set the total length in the RFH header */
-						rfh2->StrucLength = totLen;
+						/* calculate the remaining bytes in the input RFH2 */
+						rfhLen -= segLen + 4;
 					}
 
-					/* copy the message data */
-					copyLen = datalen;
-					memcpy(replyData + totLen, msgdata, copyLen);
-				}
-				else
-				{
-					replyData = msgdata;
+					/* set the total length in the RFH header */
+					rfh2->StrucLength = totLen;
 				}
-			}
 
-			/* write the reply message */
-			/* perform the MQPUT */
-			MQPUT(qm, parms->hReplyQ, &mqmd, &pmo, datalen + totLen, replyData, &cc, &rc);
+				/* copy the message data */
+				copyLen = datalen;
+				memcpy(replyData + totLen, msgdata, copyLen);
+			}
+			else
+			{
+				replyData = msgdata;
+			}
+		}
 
-			/* check for errors */
-			checkerror("MQPUT", cc, rc, parms->replyQname);
+		/* write the reply message */
+		/* perform the MQPUT */
+		MQPUT(wrk->qm, hReplyQ, &mqmd, &pmo, datalen + totLen, replyData, &cc, &rc);
 
-			if (0 == cc)
-			{
-				parms->replyCount++;
-				parms->byteswritten += datalen + totLen;
+		/* check for errors */
+		checkerror("MQPUT", cc, rc, trimmedQname);
 
-				if (1 == parms->verbose)
-				{
-					Log("Reply sent to queue %s on queue manager %s", trimmedQname, trimmedQMname);
-				}
-			}
+		if (0 == cc)
+		{
+			parms->replyCount++;
+			parms->byteswritten += datalen + totLen;
 
-			/* check if we acquired storage */
-			if ((1 == parms->resendRFH) && (memcpy(md->Format, MQFMT_RF_HEADER_2, MQ_FORMAT_LENGTH) == 0) && (datalen >= MQRFH_STRUC_LENGTH_FIXED_2))
+			if (1 == parms->verbose)
 			{
-				/* free the storage we acquired */
-				free(replyData);
+				Log("Reply sent to queue %s on queue manager %s", trimmedQname, trimmedQMname);
 			}
 		}
+
+		/* check if we acquired storage */
+		if ((1 == parms->resendRFH) && (memcpy(md->Format, MQFMT_RF_HEADER_2, MQ_FORMAT_LENGTH) == 0) && (datalen >= MQRFH_STRUC_LENGTH_FIXED_2))
+		{
+			/* free the storage we acquired */
+			free(replyData);
+		}
 	}
 
 	return cc;
 }
 
+/**************************************************************/
+/*                                                            */
+/* Add up the requests read by all the threads for the        */
+/* statistics file.                                           */
+/*                                                            */
+/**************************************************************/
+
+void countRequests(void *arg, int64_t *msgs, int64_t *bytes)
+
+{
+	REPLYWORKER	*wrkTable=(REPLYWORKER *)arg;
+	int			i;
+
+	for (i = 0; i < wrkTable->threadCount; i++)
+	{
+		(*msgs) += wrkTable[i].msgsRead;
+		(*bytes) += wrkTable[i].bytesRead;
+	}
+}
+
 void InterruptHandler (int sigVal) 
 
 { 
@@ -497,30 +664,36 @@ void printHelp(char *pgmName)
 {
 	printf("%s\n", Level);
 	printf("format is:\n");
-	printf("   %s -f parm_filename <-t milliseconds> <-m QMname> <-q queue>\n", pgmName);
+	printf("   %s -f parm_filename <-t milliseconds> <-m QMname> <-q queue> <-n threads> <-j statsfile>\n", pgmName);
 	printf("         -m will override the queue manager name\n");
 	printf("         -q will override the queue name\n");
+	printf("         -n number of worker threads\n");
+	printf("         -j statistics file for the requests each second\n");
 #ifdef MQCLIENT
 	printf("         -m can be in the form of ChannelName/TCP/hostname(port)\n");
 #endif
 }
 
-int main(int argc, char **argv)
+/**************************************************************/
+/*                                                            */
+/* Worker thread.  Connects to the queue manager, opens the   */
+/* request queue and replies to requests until the queue is   */
+/* empty for the wait time or the message count is reached.   */
+/* When only one thread is used this routine is called        */
+/* directly from the main routine.                            */
+/*                                                            */
+/**************************************************************/
+
+void replyThread(void * arg)
+
 {
-	size_t		replyDataLen=0;
+	REPLYWORKER	*wrk=(REPLYWORKER *)arg;
+	PUTPARMS	*parms=&(wrk->parms);
 	size_t		memSize;
-	int64_t		msgsRead=0;
-	int64_t		bytesRead=0;
-	int64_t		avgbytes;
-	int			maxrate=0;
-	int			firstsec=0;
-	int			secondcount=0;
-	int			firstTime=0;
-	int			rfhlength=0;
 	int			remainingTime;
-	MQLONG		qm=0;
 	MQLONG		q=0;
 	MQLONG		maxLen;
+	MQLONG		maxMsgLen=0;
 	MQLONG		compcode;
 	MQLONG		reason;
 	MQLONG		Select[1];			/* attribute selectors           */
@@ -531,9 +704,188 @@ int main(int argc, char **argv)
 	MQGMO		mqgmo = {MQGMO_DEFAULT};
 	MQLONG		datalen=0;
 	char		*msgdata;
+
+	/* Connect to the queue manager */
+#ifdef MQCLIENT
+	clientConnect2QM(parms->qmname, &(wrk->qm), &maxMsgLen, &compcode, &reason);
+#else
+	/* each thread must have its own connection handle */
+	connectX2QM(parms->qmname, MQCNO_HANDLE_SHARE_NONE, &(wrk->qm), &compcode, &reason);
+#endif
+
+	/* check for errors */
+	if (compcode != MQCC_OK)
+	{
+		wrk->rc = 98;
+		terminate = 1;
+		return;
+	}
+
+	/* set the queue open options */
+	strncpy(objdesc.ObjectName, parms->qname, MQ_Q_NAME_LENGTH);
+
+	/* set the queue open options */
+	openopt = MQOO_INPUT_SHARED + MQOO_FAIL_IF_QUIESCING + MQOO_INQUIRE;
+
+	/* open the queue for input */
+	Log("%sopening queue %s for input\n", wrk->label, parms->qname);
+	MQOPEN(wrk->qm, &objdesc, openopt, &q, &compcode, &reason);
+
+	/* check for errors */
+	checkerror("MQOPEN", compcode, reason, parms->qname);
+	if (compcode != MQCC_OK)
+	{
+		wrk->rc = 97;
+		terminate = 1;
+		MQDISC(&(wrk->qm), &compcode, &reason);
+		return;
+	}
+
+	/* check if our maximum message length is too large         */
+	/* This is to avoid 2010 return codes on client connections */
+	Select[0] = MQIA_MAX_MSG_LENGTH;
+	IAV[0]=0;
+	MQINQ(wrk->qm, q, 1L, Select, 1L, IAV, 0L, NULL, &compcode, &reason);
+
+	/* check if it worked */
+	if (MQCC_OK == compcode)
+	{
+		if (IAV[0] < parms->maxmsglen)
+		{
+			/* change the maximum message length to the maximum allowed */
+			parms->maxmsglen = IAV[0];
+		}
+	}
+
+	/* allocate a buffer for the message */
+	memSize = (unsigned int)parms->maxmsglen + 1;
+	msgdata = (char *)malloc(memSize);
+
+	/* make sure the malloc worked */
+	if (NULL == msgdata)
+	{
+		/* tell what happened */
+		Log("*****Error - memory allocation for buffer failed");
+
+		wrk->rc = 85;
+		terminate = 1;
+		MQCLOSE(wrk->qm, &q, MQCO_NONE, &compcode, &reason);
+		MQDISC(&(wrk->qm), &compcode, &reason);
+		return;
+	}
+
+	/* initialize the buffer */
+	memset(msgdata, 0, memSize);
+
+	/* enter get message loop */
+	while ((compcode == MQCC_OK) && (0 == terminate))
+	{
+		/* reserve the next request so the message count is not exceeded */
+		if ((parms->totcount > 0) && (atomicAdd64(&msgsClaimed, 1) > parms->totcount))
+		{
+			break;
+		}
+
+		/* set the get message options */
+		if (0 == parms->maxWaitTime)
+		{
+			mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING;
+		}
+		else
+		{
+			mqgmo.Options = MQGMO_WAIT | MQGMO_FAIL_IF_QUIESCING;
+			mqgmo.WaitInterval = parms->maxWaitTime * 1000;
+		}
+
+		mqgmo.MatchOptions = MQGMO_NONE;
+
+		/* check if we are using logical order */
+		if (1 == parms->logicalOrder)
+		{
+			mqgmo.Options |= MQGMO_LOGICAL_ORDER;
+		}
+
+		/* reset the msgid and correlid */
+		memcpy(msgdesc.MsgId, MQMI_NONE, sizeof(msgdesc.MsgId));
+		memcpy(msgdesc.CorrelId, MQCI_NONE, sizeof(msgdesc.CorrelId));
+
+		remainingTime = parms->maxWaitTime;
+		do
+		{
+			/* only wait for 1 second */
+			mqgmo.WaitInterval = 1000;
+			remainingTime--;
+
+			/* since we have a signal handler installed, we do not want to be in an MQGET for a long time */
+			/* perform the MQGET */
+			maxLen = parms->maxmsglen;
+			MQGET(wrk->qm, q, &msgdesc, &mqgmo, maxLen, msgdata, &datalen, &compcode, &reason);
+		} while ((remainingTime > 0) && (MQCC_FAILED == compcode) && (2033 == reason) && (0 == terminate));
+
+		if ((2 == compcode) && (2033 == reason))
+		{
+			Log("\n%sTimeout period expired - program is ending", wrk->label);
+		}
+		else
+		{
+			checkerror("MQGET", compcode, reason, parms->qname);
+		}
+
+		if ((MQCC_OK == compcode) && (0 == terminate))
+		{
+			/* count the total number of messages read */
+			wrk->msgsRead++;
+
+			/* calculate the total bytes in the message */
+			wrk->bytesRead += datalen;
+
+			/* generate a reply message */
+			BuildReply(wrk, wrk->replyData, wrk->replyDataLen, msgdata, datalen, &msgdesc);
+		}
+		else if (parms->totcount > 0)
+		{
+			/* give back the request that was not read */
+			atomicAdd64(&msgsClaimed, -1);
+		}
+	}
+
+	/* close the input queue */
+	Log("%sclosing the input queue", wrk->label);
+	MQCLOSE(wrk->qm, &q, MQCO_NONE, &compcode, &reason);
+
+	checkerror("MQCLOSE", compcode, reason, parms->qname);
+
+	/* close any open reply to queues */
+	closeReplyHandles(wrk);
+
+	/* Disconnect from the queue manager */
+	Log("%sdisconnecting from the queue manager", wrk->label);
+	MQDISC(&(wrk->qm), &compcode, &reason);
+
+	checkerror("MQDISC", compcode, reason, parms->qmname);
+
+	free(msgdata);
+}
+
+int main(int argc, char **argv)
+{
+	size_t		replyDataLen=0;
+	int64_t		msgsRead=0;
+	int64_t		bytesRead=0;
+	int64_t		replyOpens=0;
+	int64_t		replyCloses=0;
+	int64_t		avgbytes;
+	int			i;
+	int			rc=0;
+	int			threadCount;
+	int			started=0;
 	FILE		*replyDataFile;
 	char		*replyData=0;
-	MQOD		od = {MQOD_DEFAULT};    /* Object Descriptor             */
+	REPLYWORKER	*wrkTable=NULL;
+	REPLYWORKER	*wrk;
+	THREAD_T	*thrdHandles=NULL;
+	STATSFILE	*stats=NULL;
+	STATSPOLL	*statsPoll=NULL;
 	PUTPARMS	parms;					/* Input parameters and global variables */
 
 	/* print the copyright statement */
@@ -646,160 +998,134 @@ int main(int argc, char **argv)
 		Log("Sending input message back as reply");
 	}
 
-	/* set a termination handler */
-	signal(SIGINT, InterruptHandler);
-
-	/* Connect to the queue manager */
-#ifdef MQCLIENT
-	clientConnect2QM(parms.qmname, &qm, &(parms.maxMsgLen), &compcode, &reason);
-#else
-	connect2QM(parms.qmname, &qm, &compcode, &reason);
-#endif
-
-	/* check for errors */
-	if (compcode != MQCC_OK)
+	/* allocate the worker thread work areas */
+	threadCount = parms.threads;
+	wrkTable = (REPLYWORKER *)malloc(threadCount * sizeof(REPLYWORKER));
+	thrdHandles = (THREAD_T *)malloc(threadCount * sizeof(THREAD_T));
+	if ((NULL == wrkTable) || (NULL == thrdHandles))
 	{
-		return 98;
+		Log("***** unable to allocate storage for %d threads - program terminating", threadCount);
+		return 93;
 	}
 
-	/* set the queue open options */
-	strncpy(objdesc.ObjectName, parms.qname, MQ_Q_NAME_LENGTH);
-
-	/* set the queue open options */
-	openopt = MQOO_INPUT_SHARED + MQOO_FAIL_IF_QUIESCING + MQOO_INQUIRE;
-
-	/* open the queue for input */
-	Log("opening queue %s for input\n", parms.qname);
-	MQOPEN(qm, &objdesc, openopt, &q, &compcode, &reason);
-
-	/* check for errors */
-	checkerror("MQOPEN", compcode, reason, parms.qname);
-	if (compcode != MQCC_OK)
+	if (threadCount > 1)
 	{
-		return 97;
+		Log("%d threads will be used to reply to requests", threadCount);
 	}
 
-	/* check if our maximum message length is too large         */
-	/* This is to avoid 2010 return codes on client connections */
-	Select[0] = MQIA_MAX_MSG_LENGTH;
-	IAV[0]=0;
-	MQINQ(qm, q, 1L, Select, 1L, IAV, 0L, NULL, &compcode, &reason);
+	if (parms.replyHandles > 1)
+	{
+		Log("Up to %d reply queues will be kept open by each thread", parms.replyHandles);
+	}
 
-	/* check if it worked */
-	if (MQCC_OK == compcode)
+	for (i = 0; i < threadCount; i++)
 	{
-		if (IAV[0] < parms.maxmsglen)
+		wrk = wrkTable + i;
+		memset(wrk, 0, sizeof(REPLYWORKER));
+		memcpy(&(wrk->parms), &parms, sizeof(PUTPARMS));
+		wrk->threadNum = i + 1;
+		wrk->threadCount = threadCount;
+		wrk->replyData = replyData;
+		wrk->replyDataLen = replyDataLen;
+
+		/* allocate the reply handle cache */
+		wrk->cache = (REPLYHANDLE *)malloc(parms.replyHandles * sizeof(REPLYHANDLE));
+		if (NULL == wrk->cache)
 		{
-			/* change the maximum message length to the maximum allowed */
-			parms.maxmsglen = IAV[0];
+			Log("***** unable to allocate reply handle cache for thread %d - program terminating", i + 1);
+			return 93;
 		}
-	}
 
-	/* allocate a buffer for the message */
-	memSize = (unsigned int)parms.maxmsglen + 1;
-	msgdata = (char *)malloc(memSize);
+		memset(wrk->cache, 0, parms.replyHandles * sizeof(REPLYHANDLE));
 
-	/* make sure the malloc worked */
-	if (NULL == msgdata)
-	{
-		/* tell what happened */
-		Log("*****Error - memory allocation for buffer failed");
+		if (threadCount > 1)
+		{
+			/* identify the thread in any messages */
+			sprintf(wrk->label, "thread %d ", i + 1);
+		}
+	}
 
-		/* exit */
-		return 85;
+	/* check if interval statistics are to be written to a file */
+	if (parms.statsFilename[0] != 0)
+	{
+		stats = openStatsFile(parms.statsFilename);
+		statsPoll = startStatsPoll(stats, countRequests, wrkTable);
 	}
 
-	/* initialize the buffer */
-	memset(msgdata, 0, memSize);
+	/* set a termination handler */
+	signal(SIGINT, InterruptHandler);
 
-	/* enter get message loop */
-	while ((compcode == MQCC_OK) && (0 == terminate) && ((0 == parms.totcount) || (msgsRead < parms.totcount)))
+	if (1 == threadCount)
 	{
-		/* set the get message options */
-		if (0 == parms.maxWaitTime)
-		{
-			mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING;
-		}
-		else
+		/* reply to the requests on this thread */
+		replyThread(wrkTable);
+	}
+	else
+	{
+		/* start the worker threads */
+		while ((started < threadCount) && (0 == terminate))
 		{
-			mqgmo.Options = MQGMO_WAIT | MQGMO_FAIL_IF_QUIESCING;
-			mqgmo.WaitInterval = parms.maxWaitTime * 1000;
-		}
+			if (startThread(thrdHandles + started, replyThread, wrkTable + started) != 0)
+			{
+				/* stop any threads that were already started */
+				terminate = 1;
+				rc = 92;
+				break;
+			}
 
-		mqgmo.MatchOptions = MQGMO_NONE;
+			started++;
+		}
 
-		/* check if we are using logical order */
-		if (1 == parms.logicalOrder)
+		/* wait for all the threads that were started to finish */
+		for (i = 0; i < started; i++)
 		{
-			mqgmo.Options |= MQGMO_LOGICAL_ORDER;
+			waitThread(thrdHandles[i]);
 		}
+	}
 
-		/* reset the msgid and correlid */
-		memcpy(msgdesc.MsgId, MQMI_NONE, sizeof(msgdesc.MsgId));
-		memcpy(msgdesc.CorrelId, MQCI_NONE, sizeof(msgdesc.CorrelId));
+	/* write the last interval and the totals to the statistics file */
+	endStatsPoll(statsPoll);
+	closeStatsFile(stats);
 
-		remainingTime = parms.maxWaitTime;
-		do
-		{
-			/* only wait for 1 second */
-			mqgmo.WaitInterval = 1000;
-			remainingTime--;
+	/* total up the results from all the threads */
+	for (i = 0; i < threadCount; i++)
+	{
+		wrk = wrkTable + i;
 
-			/* since we have a signal handler installed, we do not want to be in an MQGET for a long time */
-			/* perform the MQGET */
-			maxLen = parms.maxmsglen;
-			MQGET(qm, q, &msgdesc, &mqgmo, maxLen, msgdata, &datalen, &compcode, &reason);
-		} while ((remainingTime > 0) && (MQCC_FAILED == compcode) && (2033 == reason) && (0 == terminate));
+		msgsRead += wrk->msgsRead;
+		bytesRead += wrk->bytesRead;
+		replyOpens += wrk->replyOpens;
+		replyCloses += wrk->replyCloses;
+		parms.replyCount += wrk->parms.replyCount;
+		parms.byteswritten += wrk->parms.byteswritten;
 
-		if ((2 == compcode) && (2033 == reason))
+		/* remember the first return code */
+		if ((0 == rc) && (wrk->rc != 0))
 		{
-			Log("\nTimeout period expired - program is ending");
-		}
-		else
-		{
-			checkerror("MQGET", compcode, reason, parms.qname);
+			rc = wrk->rc;
 		}
 
-		if ((MQCC_OK == compcode) && (0 == terminate))
+		if (threadCount > 1)
 		{
-			/* count the total number of messages read */
-			msgsRead++;
-
-			/* calculate the total bytes in the message */
-			bytesRead += datalen;
-
-			/* generate a reply message */
-			BuildReply(replyData, replyDataLen, msgdata, datalen, &msgdesc, qm, &parms);
+			Log("thread %3d requests " FMTI64 " replies " FMTI64 " reply queue opens " FMTI64,
+				wrk->threadNum, wrk->msgsRead, wrk->parms.replyCount, wrk->replyOpens);
 		}
-	}
 
-	/* close the input queue */
-	Log("closing the input queue");
-	MQCLOSE(qm, &q, MQCO_NONE, &compcode, &reason);
+		free(wrk->cache);
+	}
 
-	checkerror("MQCLOSE", compcode, reason, parms.qname);
+	free(wrkTable);
+	free(thrdHandles);
 
-	/* check if we have an open reply to queue */
-	if (parms.hReplyQ != 0)
+	/* check if the program failed before any messages were read */
+	if ((rc != 0) && (0 == msgsRead))
 	{
-		Log("closing the reply queue");
-		MQCLOSE(qm, &(parms.hReplyQ), MQCO_NONE, &compcode, &reason);
-
-		checkerror("MQCLOSE", compcode, reason, parms.replyQname);
-
-		/* account for the last close */
-		replyCloses++;
+		return rc;
 	}
 
 	/* dump out the statistics for reply queue opens and closes */
 	Log("Reply queue opened " FMTI64 " closed " FMTI64 " times", replyOpens, replyCloses);
 
-	/* Disconnect from the queue manager */
-	Log("disconnecting from the queue manager");
-	MQDISC(&qm, &compcode, &reason);
-
-	checkerror("MQDISC", compcode, reason, parms.qmname);
-
 	if (1 == terminate)
 	{
 		if (1 == cancelled)
@@ -0,0 +1,1462 @@
+/*
+Copyright (c) IBM Corporation 2000, 2019
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   MQRUN runs a benchmark scenario.  It starts the producers,     */
+/*   consumers and responders described in a scenario file as      */
+/*   separate processes (MQPut2, MQTimes2 and MQReply by default),  */
+/*   each with its own statistics file, waits for them to finish    */
+/*   and merges their statistics into a single report with one row  */
+/*   for each second of the run.  It supports the following         */
+/*   parameters                                                     */
+/*                                                                  */
+/*      -f name of the scenario file (required)                     */
+/*      -o directory for the output files (overrides outdir)        */
+/*      -d seconds to run the producers (overrides duration)        */
+/*      -w seconds of warm up to leave out (overrides warmup)       */
+/*                                                                  */
+/*   The scenario file has a [scenario] section followed by any     */
+/*   number of [producer], [consumer] and [responder] sections.     */
+/*   Lines that start with an asterisk are comments.  See           */
+/*   parmrun.txt for the parameters in each section.                */
+/*                                                                  */
+/*   The consumers and responders are started first, and the        */
+/*   producers startDelay seconds later.  The producers run until   */
+/*   they finish or for duration seconds.  The other processes are  */
+/*   then given drainTime seconds to finish reading the queues      */
+/*   before they are interrupted.                                   */
+/*                                                                  */
+/*   The output of each process is written to <name>.log and its    */
+/*   statistics to <name>.csv in the output directory, where the    */
+/*   name is the role and a number, such as consumer2.  The merged  */
+/*   statistics are written to merged.csv and a summary is          */
+/*   written to the log.                                            */
+/*                                                                  */
+/*   On Windows the processes cannot be interrupted, so they are    */
+/*   ended with TerminateProcess and will not write their summary   */
+/*   records.  Set the msgcount or maxtime parameters so the        */
+/*   processes end by themselves when this matters.                 */
+/*                                                                  */
+/********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "signal.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+/* include for 64-bit integer definitions */
+#include "int64defs.h"
+
+#include "comsubs.h"
+#include "thrdsubs.h"
+
+#define MAX_GROUPS		32				/* sections in the scenario file */
+#define MAX_PROCS		128				/* processes that can be started */
+#define MAX_ARGS		64				/* arguments for one process */
+#define MAX_LINE		1024
+#define MAX_RUN_SECS	(7 * 24 * 3600)	/* longest run that is merged */
+#define POLL_MILLIS		100				/* how often the processes are checked */
+#define KILL_SECS		10				/* wait after an interrupt before killing */
+
+#define DEF_START_DELAY	2
+#define DEF_DRAIN_TIME	30
+
+#define ROLE_PRODUCER	0
+#define ROLE_CONSUMER	1
+#define ROLE_RESPONDER	2
+#define ROLE_COUNT		3
+
+#define PROC_NOT_STARTED	0
+#define PROC_RUNNING		1
+#define PROC_INTERRUPTED	2
+#define PROC_ENDED			3
+
+/* fields in the statistics file records */
+#define STATS_FIELDS	18
+#define FLD_TYPE		0
+#define FLD_TIME		1
+#define FLD_SECS		3
+#define FLD_MSGS		4
+#define FLD_BYTES		5
+#define FLD_LAT_COUNT	9
+#define FLD_LAT_AVG		10
+#define FLD_P50			11
+#define FLD_P90			12
+#define FLD_P99			13
+#define FLD_P999		14
+#define FLD_P9999		15
+#define FLD_LAT_MAX		16
+
+static char copyright[] = "(C) Copyright IBM Corp, 2001/2002/2004/2005/2014";
+static char Version[]=\
+"@(#)MQRun V3.1 - MQ benchmark scenario driver  - Jim MacNair ";
+
+#ifdef _DEBUG
+static char Level[]="mqrun.c V3.1 Debug version ("__DATE__" "__TIME__")";
+#else
+static char Level[]="mqrun.c V3.1 Release version ("__DATE__" "__TIME__")";
+#endif
+
+static const char *roleNames[ROLE_COUNT] = { "producer", "consumer", "responder" };
+static const char *sectionNames[ROLE_COUNT] = { "[PRODUCER]", "[CONSUMER]", "[RESPONDER]" };
+static const char *rolePrograms[ROLE_COUNT] = { "mqput2", "mqtimes2", "mqreply" };
+
+volatile int	terminate=0;
+
+/**************************************************************/
+/*                                                            */
+/* One [producer], [consumer] or [responder] section.  The    */
+/* count is the number of processes to start with these       */
+/* parameters.  Zero values are not passed to the program,    */
+/* so the values in its parameters file are used.             */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int			role;
+	int			count;
+	int			threads;
+	int			batchSize;
+	int64_t		msgCount;
+	char		program[256];
+	char		parmFile[512];
+	char		qname[256];
+	char		qmgr[256];
+	char		args[512];			/* any other arguments */
+} RUNGROUP;
+
+/**************************************************************/
+/*                                                            */
+/* One process and the results read from its statistics file. */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	char		name[32];
+	char		logFile[768];
+	char		statsFile[768];
+	RUNGROUP	*grp;
+	int			state;
+	int			exitCode;
+	time_t		interruptTime;
+#ifdef WIN32
+	HANDLE		process;
+#else
+	pid_t		pid;
+#endif
+	int			haveSummary;
+	int64_t		msgs;				/* from the summary record */
+	int64_t		bytes;
+	int64_t		secs;
+	int64_t		latCount;
+	int64_t		latAvg;
+	int64_t		p50;
+	int64_t		p90;
+	int64_t		p99;
+	int64_t		p999;
+	int64_t		p9999;
+	int64_t		latMax;
+	int64_t		intervalMsgs;		/* total of the interval records */
+	double		*rates;				/* messages in each second of the run */
+	int64_t		*p50s;				/* latency in each second, 0 if none */
+	int64_t		*p99s;
+} RUNPROC;
+
+typedef struct {
+	int			err;
+	int			duration;
+	int			warmup;
+	int			startDelay;
+	int			drainTime;
+	int			groupCount;
+	int			procCount;
+	int			runSecs;			/* number of seconds merged */
+	time_t		startTime;			/* second zero of the merged results */
+	time_t		producerTime;		/* when the producers were started */
+	time_t		endTime;
+	char		scenarioFile[512];
+	char		name[64];
+	char		qmgr[256];
+	char		binDir[512];
+	char		outDir[512];
+	RUNGROUP	groups[MAX_GROUPS];
+	RUNPROC		procs[MAX_PROCS];
+} SCENARIO;
+
+void InterruptHandler (int sigVal)
+
+{
+	/* stop the run and interrupt the processes */
+	terminate = 1;
+}
+
+void printHelp(char *pgmName)
+
+{
+	printf("\nformat is:\n");
+	printf("   %s -f scenario file <-o output directory> <-d seconds> <-w seconds>\n", pgmName);
+	printf("    The scenario file describes the producers, consumers and responders to run.\n");
+	printf("    The output directory receives a log and a statistics file for each process\n");
+	printf("     and the merged statistics in merged.csv.\n");
+	printf("    The -d option sets how long the producers run (0 until they finish).\n");
+	printf("    The -w option sets the number of seconds of warm up that are left out of\n");
+	printf("     the steady state rates.\n");
+}
+
+static void processRunArgs(int argc, char **argv, SCENARIO *scen, char *outDir, int *duration, int *warmup)
+
+{
+	int		i;
+	char	option;
+	char	*parmData;
+
+	for (i = 1; (i < argc) && (0 == scen->err); i++)
+	{
+		if ((argv[i][0] != '-') || (0 == argv[i][1]))
+		{
+			printf("***** unrecognized argument %s\n", argv[i]);
+			scen->err = 1;
+			break;
+		}
+
+		/* the value can follow the option or be the next argument */
+		option = argv[i][1];
+		if (argv[i][2] != 0)
+		{
+			parmData = argv[i] + 2;
+		}
+		else if (i + 1 < argc)
+		{
+			parmData = argv[++i];
+		}
+		else
+		{
+			printf("***** missing value for option %s\n", argv[i]);
+			scen->err = 1;
+			break;
+		}
+
+		switch (option)
+		{
+		case 'f':
+			{
+				strncpy(scen->scenarioFile, parmData, sizeof(scen->scenarioFile) - 1);
+				break;
+			}
+		case 'o':
+			{
+				strncpy(outDir, parmData, sizeof(scen->outDir) - 1);
+				break;
+			}
+		case 'd':
+			{
+				(*duration) = atoi(parmData);
+				break;
+			}
+		case 'w':
+			{
+				(*warmup) = atoi(parmData);
+				break;
+			}
+		default:
+			{
+				printf("***** unrecognized option -%c\n", option);
+				scen->err = 1;
+				break;
+			}
+		}
+	}
+
+	if (0 == scen->scenarioFile[0])
+	{
+		printf("***** scenario file (-f) is required\n");
+		scen->err = 1;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Handle one name=value line from the scenario file.  The    */
+/* name has already been translated to upper case.  grp is    */
+/* NULL in the [scenario] section.                            */
+/*                                                            */
+/**************************************************************/
+
+static void evaluateRunParm(SCENARIO *scen, RUNGROUP *grp, const char *name, const char *value)
+
+{
+	int		foundit=1;
+
+	if (NULL == grp)
+	{
+		if (strcmp(name, "NAME") == 0)
+		{
+			strncpy(scen->name, value, sizeof(scen->name) - 1);
+		}
+		else if (strcmp(name, "QMGR") == 0)
+		{
+			strncpy(scen->qmgr, value, sizeof(scen->qmgr) - 1);
+		}
+		else if (strcmp(name, "BINDIR") == 0)
+		{
+			strncpy(scen->binDir, value, sizeof(scen->binDir) - 1);
+		}
+		else if (strcmp(name, "OUTDIR") == 0)
+		{
+			strncpy(scen->outDir, value, sizeof(scen->outDir) - 1);
+		}
+		else if (strcmp(name, "DURATION") == 0)
+		{
+			scen->duration = atoi(value);
+		}
+		else if (strcmp(name, "WARMUP") == 0)
+		{
+			scen->warmup = atoi(value);
+		}
+		else if (strcmp(name, "STARTDELAY") == 0)
+		{
+			scen->startDelay = atoi(value);
+		}
+		else if (strcmp(name, "DRAINTIME") == 0)
+		{
+			scen->drainTime = atoi(value);
+		}
+		else
+		{
+			foundit = 0;
+		}
+	}
+	else
+	{
+		if (strcmp(name, "PROGRAM") == 0)
+		{
+			strncpy(grp->program, value, sizeof(grp->program) - 1);
+		}
+		else if (strcmp(name, "PARMS") == 0)
+		{
+			strncpy(grp->parmFile, value, sizeof(grp->parmFile) - 1);
+		}
+		else if (strcmp(name, "COUNT") == 0)
+		{
+			grp->count = atoi(value);
+		}
+		else if (strcmp(name, "QNAME") == 0)
+		{
+			strncpy(grp->qname, value, sizeof(grp->qname) - 1);
+		}
+		else if (strcmp(name, "QMGR") == 0)
+		{
+			strncpy(grp->qmgr, value, sizeof(grp->qmgr) - 1);
+		}
+		else if (strcmp(name, "MSGCOUNT") == 0)
+		{
+			grp->msgCount = my_ato64(value);
+		}
+		else if (strcmp(name, "THREADS") == 0)
+		{
+			grp->threads = atoi(value);
+		}
+		else if (strcmp(name, "BATCHSIZE") == 0)
+		{
+			grp->batchSize = atoi(value);
+		}
+		else if (strcmp(name, "ARGS") == 0)
+		{
+			strncpy(grp->args, value, sizeof(grp->args) - 1);
+		}
+		else
+		{
+			foundit = 0;
+		}
+	}
+
+	if (0 == foundit)
+	{
+		printf("***** unrecognized parameter %s, value %s\n", name, value);
+		scen->err = 1;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read the scenario file.                                    */
+/*                                                            */
+/**************************************************************/
+
+static void readScenario(SCENARIO *scen)
+
+{
+	int			i;
+	int			role;
+	FILE		*in;
+	char		*ptr;
+	char		*valueptr;
+	RUNGROUP	*grp=NULL;
+	char		line[MAX_LINE];
+
+	in = fopen(scen->scenarioFile, "r");
+	if (NULL == in)
+	{
+		Log("***** unable to open scenario file %s", scen->scenarioFile);
+		scen->err = 1;
+		return;
+	}
+
+	while ((0 == scen->err) && (fgets(line, sizeof(line), in) != NULL))
+	{
+		/* remove the new line and any trailing blanks */
+		ptr = skipBlanks(line);
+		ptr[strcspn(ptr, "\r\n")] = 0;
+		rtrim(ptr);
+
+		/* skip comments and blank lines */
+		if ((0 == ptr[0]) || ('*' == ptr[0]))
+		{
+			continue;
+		}
+
+		/* check for the start of a section */
+		if ('[' == ptr[0])
+		{
+			strupper(ptr);
+			grp = NULL;
+
+			if (strcmp(ptr, "[SCENARIO]") == 0)
+			{
+				continue;
+			}
+
+			for (role = 0; role < ROLE_COUNT; role++)
+			{
+				if (strcmp(ptr, sectionNames[role]) == 0)
+				{
+					break;
+				}
+			}
+
+			if (ROLE_COUNT == role)
+			{
+				Log("***** unrecognized section %s in scenario file", ptr);
+				scen->err = 1;
+			}
+			else if (MAX_GROUPS == scen->groupCount)
+			{
+				Log("***** more than %d sections in scenario file", MAX_GROUPS);
+				scen->err = 1;
+			}
+			else
+			{
+				grp = scen->groups + scen->groupCount;
+				scen->groupCount++;
+				grp->role = role;
+				grp->count = 1;
+				strcpy(grp->program, rolePrograms[role]);
+			}
+
+			continue;
+		}
+
+		/* break the line into the name and the value */
+		valueptr = strchr(ptr, '=');
+		if (NULL == valueptr)
+		{
+			Log("***** missing value in scenario file line %s", ptr);
+			scen->err = 1;
+			continue;
+		}
+
+		valueptr[0] = 0;
+		valueptr = skipBlanks(valueptr + 1);
+		rtrim(ptr);
+		strupper(ptr);
+
+		evaluateRunParm(scen, grp, ptr, valueptr);
+	}
+
+	fclose(in);
+
+	if ((0 == scen->err) && (0 == scen->groupCount))
+	{
+		Log("***** no producer, consumer or responder sections in scenario file %s", scen->scenarioFile);
+		scen->err = 1;
+	}
+
+	/* the scenario queue manager is the default for every section */
+	for (i = 0; i < scen->groupCount; i++)
+	{
+		if ((0 == scen->groups[i].qmgr[0]) && (scen->qmgr[0] != 0))
+		{
+			strcpy(scen->groups[i].qmgr, scen->qmgr);
+		}
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Build the argument list for a process.  The strings point  */
+/* into the work area, which must stay allocated until the    */
+/* process has been started.                                  */
+/*                                                            */
+/**************************************************************/
+
+static int buildArgs(SCENARIO *scen, RUNPROC *proc, char *work, char **args)
+
+{
+	int			count=0;
+	char		*ptr;
+	char		*end;
+	RUNGROUP	*grp=proc->grp;
+
+	/* the program, from the bin directory if there is one */
+	if (scen->binDir[0] != 0)
+	{
+		sprintf(work, "%s/%s", scen->binDir, grp->program);
+	}
+	else
+	{
+		strcpy(work, grp->program);
+	}
+
+	args[count++] = work;
+	work += strlen(work) + 1;
+
+	if (grp->parmFile[0] != 0)
+	{
+		args[count++] = "-f";
+		args[count++] = grp->parmFile;
+	}
+
+	if (grp->qname[0] != 0)
+	{
+		args[count++] = "-q";
+		args[count++] = grp->qname;
+	}
+
+	if (grp->qmgr[0] != 0)
+	{
+		args[count++] = "-m";
+		args[count++] = grp->qmgr;
+	}
+
+	if (grp->msgCount > 0)
+	{
+		sprintf(work, FMTI64, grp->msgCount);
+		args[count++] = "-c";
+		args[count++] = work;
+		work += strlen(work) + 1;
+	}
+
+	if (grp->threads > 0)
+	{
+		sprintf(work, "%d", grp->threads);
+		args[count++] = "-n";
+		args[count++] = work;
+		work += strlen(work) + 1;
+	}
+
+	if (grp->batchSize > 0)
+	{
+		sprintf(work, "%d", grp->batchSize);
+		args[count++] = "-b";
+		args[count++] = work;
+		work += strlen(work) + 1;
+	}
+
+	args[count++] = "-j";
+	args[count++] = proc->statsFile;
+
+	/* split any other arguments at the blanks */
+	strcpy(work, grp->args);
+	ptr = skipBlanks(work);
+	while ((ptr[0] != 0) && (count < MAX_ARGS - 1))
+	{
+		end = findBlank(ptr);
+		args[count++] = ptr;
+
+		if (0 == end[0])
+		{
+			break;
+		}
+
+		end[0] = 0;
+		ptr = skipBlanks(end + 1);
+	}
+
+	args[count] = NULL;
+	return count;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start a process with its output going to its log file.     */
+/*                                                            */
+/**************************************************************/
+
+static int startProcess(SCENARIO *scen, RUNPROC *proc)
+
+{
+	int			i;
+	int			argCount;
+	char		*args[MAX_ARGS];
+	char		work[2048];
+#ifdef WIN32
+	char		cmdLine[4096];
+	HANDLE		logHandle;
+	SECURITY_ATTRIBUTES	sa;
+	STARTUPINFOA		si;
+	PROCESS_INFORMATION	pi;
+#else
+	int			fd;
+	pid_t		pid;
+#endif
+
+	argCount = buildArgs(scen, proc, work, args);
+
+	LogNoCRLF("Starting %s:", proc->name);
+	for (i = 0; i < argCount; i++)
+	{
+		LogNoCRLF(" %s", args[i]);
+	}
+
+	Log("");
+
+#ifdef WIN32
+	/* build the command line, quoting arguments with blanks */
+	cmdLine[0] = 0;
+	for (i = 0; i < argCount; i++)
+	{
+		if (strlen(cmdLine) + strlen(args[i]) + 4 >= sizeof(cmdLine))
+		{
+			break;
+		}
+
+		if (strchr(args[i], ' ') != NULL)
+		{
+			sprintf(cmdLine + strlen(cmdLine), "%s\"%s\"", (i > 0) ? " " : "", args[i]);
+		}
+		else
+		{
+			sprintf(cmdLine + strlen(cmdLine), "%s%s", (i > 0) ? " " : "", args[i]);
+		}
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.nLength = sizeof(sa);
+	sa.bInheritHandle = TRUE;
+	logHandle = CreateFileA(proc->logFile, GENERIC_WRITE, FILE_SHARE_READ, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == logHandle)
+	{
+		Log("***** unable to open log file %s", proc->logFile);
+		return 1;
+	}
+
+	memset(&si, 0, sizeof(si));
+	si.cb = sizeof(si);
+	si.dwFlags = STARTF_USESTDHANDLES;
+	si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+	si.hStdOutput = logHandle;
+	si.hStdError = logHandle;
+
+	if (!CreateProcessA(NULL, cmdLine, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi))
+	{
+		Log("***** unable to start %s - error %d", args[0], GetLastError());
+		CloseHandle(logHandle);
+		return 1;
+	}
+
+	CloseHandle(logHandle);
+	CloseHandle(pi.hThread);
+	proc->process = pi.hProcess;
+#else
+	fflush(stdout);
+
+	pid = fork();
+	if (pid < 0)
+	{
+		Log("***** unable to start %s - fork failed", args[0]);
+		return 1;
+	}
+
+	if (0 == pid)
+	{
+		/* child - run in its own process group so only we interrupt it */
+		setpgid(0, 0);
+
+		fd = open(proc->logFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0)
+		{
+			dup2(fd, 1);
+			dup2(fd, 2);
+			close(fd);
+		}
+
+		execvp(args[0], args);
+
+		/* only get here if the program could not be run */
+		fprintf(stderr, "***** unable to run %s\n", args[0]);
+		_exit(127);
+	}
+
+	proc->pid = pid;
+#endif
+
+	proc->state = PROC_RUNNING;
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if a process has ended.  Returns 1 if it has.        */
+/*                                                            */
+/**************************************************************/
+
+static int checkProcess(RUNPROC *proc)
+
+{
+#ifdef WIN32
+	DWORD		exitCode;
+#else
+	int			status;
+#endif
+
+	if ((PROC_RUNNING != proc->state) && (PROC_INTERRUPTED != proc->state))
+	{
+		return 0;
+	}
+
+#ifdef WIN32
+	if (WaitForSingleObject(proc->process, 0) != WAIT_OBJECT_0)
+	{
+		return 0;
+	}
+
+	GetExitCodeProcess(proc->process, &exitCode);
+	CloseHandle(proc->process);
+	proc->exitCode = (int)exitCode;
+#else
+	if (waitpid(proc->pid, &status, WNOHANG) != proc->pid)
+	{
+		return 0;
+	}
+
+	if (WIFEXITED(status))
+	{
+		proc->exitCode = WEXITSTATUS(status);
+	}
+	else
+	{
+		proc->exitCode = -1;
+	}
+#endif
+
+	proc->state = PROC_ENDED;
+	Log("%s ended with return code %d", proc->name, proc->exitCode);
+	return 1;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Ask a process to end.  The programs treat SIGINT like      */
+/* Ctrl-C and write their results before ending.  A process   */
+/* that has not ended KILL_SECS seconds after it was          */
+/* interrupted is killed.                                     */
+/*                                                            */
+/**************************************************************/
+
+static void interruptProcess(RUNPROC *proc, time_t now)
+
+{
+	if (PROC_RUNNING == proc->state)
+	{
+		Log("Interrupting %s", proc->name);
+		proc->state = PROC_INTERRUPTED;
+		proc->interruptTime = now;
+#ifdef WIN32
+		TerminateProcess(proc->process, 1);
+#else
+		kill(proc->pid, SIGINT);
+#endif
+	}
+	else if ((PROC_INTERRUPTED == proc->state) && (now - proc->interruptTime >= KILL_SECS))
+	{
+		Log("***** %s did not end - killing it", proc->name);
+		proc->interruptTime = now;
+#ifdef WIN32
+		TerminateProcess(proc->process, 1);
+#else
+		kill(proc->pid, SIGKILL);
+#endif
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Count the processes with a role that have not ended.  A    */
+/* role of -1 counts all the processes.                       */
+/*                                                            */
+/**************************************************************/
+
+static int countRunning(SCENARIO *scen, int role)
+
+{
+	int		i;
+	int		count=0;
+
+	for (i = 0; i < scen->procCount; i++)
+	{
+		if (((PROC_RUNNING == scen->procs[i].state) || (PROC_INTERRUPTED == scen->procs[i].state)) &&
+			((-1 == role) || (role == scen->procs[i].grp->role)))
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Start the processes and wait for them to end.  The         */
+/* producers are stopped after the duration, and the other    */
+/* processes after the drain time once the producers have     */
+/* ended.                                                     */
+/*                                                            */
+/**************************************************************/
+
+static void runScenario(SCENARIO *scen)
+
+{
+	int			i;
+	int			started=0;
+	time_t		now;
+	time_t		drainStart=0;
+	RUNPROC		*proc;
+
+	time(&(scen->startTime));
+
+	/* start the consumers and responders first */
+	for (i = 0; (i < scen->procCount) && (0 == terminate); i++)
+	{
+		proc = scen->procs + i;
+		if ((proc->grp->role != ROLE_PRODUCER) && (startProcess(scen, proc) != 0))
+		{
+			terminate = 1;
+		}
+	}
+
+	/* give them time to connect and open their queues */
+	if ((0 == terminate) && (countRunning(scen, -1) > 0))
+	{
+		sleepThread(scen->startDelay * 1000);
+	}
+
+	time(&(scen->producerTime));
+	for (i = 0; (i < scen->procCount) && (0 == terminate); i++)
+	{
+		proc = scen->procs + i;
+		if ((ROLE_PRODUCER == proc->grp->role) && (startProcess(scen, proc) == 0))
+		{
+			started++;
+		}
+		else if (ROLE_PRODUCER == proc->grp->role)
+		{
+			terminate = 1;
+		}
+	}
+
+	if (started > 0)
+	{
+		Log("%d producers started", started);
+	}
+
+	while (countRunning(scen, -1) > 0)
+	{
+		sleepThread(POLL_MILLIS);
+		time(&now);
+
+		for (i = 0; i < scen->procCount; i++)
+		{
+			checkProcess(scen->procs + i);
+		}
+
+		if (1 == terminate)
+		{
+			/* Ctrl-C - stop everything */
+			for (i = 0; i < scen->procCount; i++)
+			{
+				interruptProcess(scen->procs + i, now);
+			}
+
+			continue;
+		}
+
+		/* check if the producers have run for long enough */
+		if ((scen->duration > 0) && (now - scen->producerTime >= scen->duration))
+		{
+			for (i = 0; i < scen->procCount; i++)
+			{
+				if (ROLE_PRODUCER == scen->procs[i].grp->role)
+				{
+					interruptProcess(scen->procs + i, now);
+				}
+			}
+		}
+
+		/* once the producers end give the others time to empty the queues */
+		if ((0 == countRunning(scen, ROLE_PRODUCER)) &&
+			((started > 0) || ((scen->duration > 0) && (now - scen->producerTime >= scen->duration))))
+		{
+			if (0 == drainStart)
+			{
+				drainStart = now;
+				if (countRunning(scen, -1) > 0)
+				{
+					Log("Producers ended - waiting up to %d seconds for the other processes", scen->drainTime);
+				}
+			}
+
+			if (now - drainStart >= scen->drainTime)
+			{
+				for (i = 0; i < scen->procCount; i++)
+				{
+					interruptProcess(scen->procs + i, now);
+				}
+			}
+		}
+	}
+
+	time(&(scen->endTime));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Convert a time from a statistics file to a time_t.         */
+/*                                                            */
+/**************************************************************/
+
+static time_t parseStatsTime(const char *str)
+
+{
+	struct tm	tm;
+
+	memset(&tm, 0, sizeof(tm));
+	if (sscanf(str, "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+	{
+		return 0;
+	}
+
+	tm.tm_year -= 1900;
+	tm.tm_mon -= 1;
+	tm.tm_isdst = -1;
+
+	return mktime(&tm);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read the statistics file of a process.  Each interval      */
+/* record is spread over the seconds it covers, ending at     */
+/* the time it was written.  The last interval is usually     */
+/* written in the same second as the one before and is less   */
+/* than a second long, so it is counted in the next second.   */
+/*                                                            */
+/**************************************************************/
+
+static void readStatsFile(SCENARIO *scen, RUNPROC *proc)
+
+{
+	int			count;
+	int			first;
+	int			last;
+	int			sec;
+	int64_t		secs;
+	int64_t		msgs;
+	time_t		recTime;
+	time_t		prevTime=0;
+	FILE		*in;
+	char		*ptr;
+	char		*fields[STATS_FIELDS];
+	char		line[MAX_LINE];
+
+	in = fopen(proc->statsFile, "r");
+	if (NULL == in)
+	{
+		Log("***** unable to open statistics file %s", proc->statsFile);
+		return;
+	}
+
+	while (fgets(line, sizeof(line), in) != NULL)
+	{
+		line[strcspn(line, "\r\n")] = 0;
+
+		/* split the line at the commas */
+		count = 0;
+		ptr = line;
+		while (count < STATS_FIELDS)
+		{
+			fields[count++] = ptr;
+			ptr = strchr(ptr, ',');
+			if (NULL == ptr)
+			{
+				break;
+			}
+
+			ptr[0] = 0;
+			ptr++;
+		}
+
+		/* skip anything that is not complete */
+		if (count < STATS_FIELDS)
+		{
+			continue;
+		}
+
+		/* only interval and summary records are used */
+		if ((strcmp(fields[FLD_TYPE], "interval") != 0) && (strcmp(fields[FLD_TYPE], "summary") != 0))
+		{
+			continue;
+		}
+
+		secs = my_ato64(fields[FLD_SECS]);
+		msgs = my_ato64(fields[FLD_MSGS]);
+
+		if (strcmp(fields[FLD_TYPE], "summary") == 0)
+		{
+			proc->haveSummary = 1;
+			proc->secs = secs;
+			proc->msgs = msgs;
+			proc->bytes = my_ato64(fields[FLD_BYTES]);
+			proc->latCount = my_ato64(fields[FLD_LAT_COUNT]);
+			proc->latAvg = my_ato64(fields[FLD_LAT_AVG]);
+			proc->p50 = my_ato64(fields[FLD_P50]);
+			proc->p90 = my_ato64(fields[FLD_P90]);
+			proc->p99 = my_ato64(fields[FLD_P99]);
+			proc->p999 = my_ato64(fields[FLD_P999]);
+			proc->p9999 = my_ato64(fields[FLD_P9999]);
+			proc->latMax = my_ato64(fields[FLD_LAT_MAX]);
+			continue;
+		}
+
+		recTime = parseStatsTime(fields[FLD_TIME]);
+		if (0 == recTime)
+		{
+			continue;
+		}
+
+		/* do not add a second interval to a second that has one */
+		if (recTime <= prevTime)
+		{
+			recTime = prevTime + 1;
+		}
+
+		if (secs < 1)
+		{
+			secs = 1;
+		}
+
+		prevTime = recTime;
+		proc->intervalMsgs += msgs;
+
+		/* the record covers the seconds before it was written */
+		last = (int)(recTime - scen->startTime) - 1;
+		first = last - (int)secs + 1;
+		for (sec = first; sec <= last; sec++)
+		{
+			if ((sec >= 0) && (sec < scen->runSecs))
+			{
+				proc->rates[sec] += (double)msgs / (double)secs;
+			}
+		}
+
+		if ((last >= 0) && (last < scen->runSecs) && (my_ato64(fields[FLD_LAT_COUNT]) > 0))
+		{
+			proc->p50s[last] = my_ato64(fields[FLD_P50]);
+			proc->p99s[last] = my_ato64(fields[FLD_P99]);
+		}
+	}
+
+	fclose(in);
+
+	/* without a summary use the interval records */
+	if (0 == proc->haveSummary)
+	{
+		proc->msgs = proc->intervalMsgs;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Merge the statistics files into merged.csv, with a row     */
+/* for each second, and write a summary to the log.           */
+/*                                                            */
+/**************************************************************/
+
+static void mergeResults(SCENARIO *scen)
+
+{
+	int			i;
+	int			sec;
+	int			role;
+	int			steadySecs[ROLE_COUNT];
+	int			lastSec[ROLE_COUNT];
+	int64_t		roleMsgs[ROLE_COUNT];
+	int64_t		p50;
+	int64_t		p99;
+	double		roleRate[ROLE_COUNT];
+	double		peakRate[ROLE_COUNT];
+	double		steadyTotal[ROLE_COUNT];
+	double		avgRate;
+	time_t		secTime;
+	FILE		*out;
+	RUNPROC		*proc;
+	char		timeStr[16];
+	char		msgStr[24];
+	char		secsStr[24];
+	char		fileName[768];
+
+	scen->runSecs = (int)(scen->endTime - scen->startTime) + 2;
+	if (scen->runSecs > MAX_RUN_SECS)
+	{
+		scen->runSecs = MAX_RUN_SECS;
+	}
+
+	for (i = 0; i < scen->procCount; i++)
+	{
+		proc = scen->procs + i;
+		proc->rates = (double *)malloc(scen->runSecs * sizeof(double));
+		proc->p50s = (int64_t *)malloc(scen->runSecs * sizeof(int64_t));
+		proc->p99s = (int64_t *)malloc(scen->runSecs * sizeof(int64_t));
+		if ((NULL == proc->rates) || (NULL == proc->p50s) || (NULL == proc->p99s))
+		{
+			Log("***** unable to allocate storage to merge %d seconds of statistics", scen->runSecs);
+			return;
+		}
+
+		memset(proc->rates, 0, scen->runSecs * sizeof(double));
+		memset(proc->p50s, 0, scen->runSecs * sizeof(int64_t));
+		memset(proc->p99s, 0, scen->runSecs * sizeof(int64_t));
+
+		readStatsFile(scen, proc);
+	}
+
+	/* find the last second each role was active */
+	for (role = 0; role < ROLE_COUNT; role++)
+	{
+		lastSec[role] = -1;
+		roleMsgs[role] = 0;
+		peakRate[role] = 0.0;
+		steadyTotal[role] = 0.0;
+		steadySecs[role] = 0;
+	}
+
+	for (i = 0; i < scen->procCount; i++)
+	{
+		proc = scen->procs + i;
+		roleMsgs[proc->grp->role] += proc->msgs;
+
+		for (sec = 0; sec < scen->runSecs; sec++)
+		{
+			if ((proc->rates[sec] > 0.0) && (sec > lastSec[proc->grp->role]))
+			{
+				lastSec[proc->grp->role] = sec;
+			}
+		}
+	}
+
+	sprintf(fileName, "%s/merged.csv", scen->outDir);
+	out = fopen(fileName, "w");
+	if (NULL == out)
+	{
+		Log("***** unable to open merged statistics file %s", fileName);
+	}
+	else
+	{
+		fprintf(out, "secs,time,producer_rate,consumer_rate,responder_rate,consumer_p50_ns,consumer_p99_ns");
+		for (i = 0; i < scen->procCount; i++)
+		{
+			fprintf(out, ",%s_rate", scen->procs[i].name);
+		}
+
+		fprintf(out, "\n");
+	}
+
+	for (sec = 0; sec < scen->runSecs; sec++)
+	{
+		p50 = 0;
+		p99 = 0;
+		for (role = 0; role < ROLE_COUNT; role++)
+		{
+			roleRate[role] = 0.0;
+		}
+
+		/* the latency is from the slowest consumer */
+		for (i = 0; i < scen->procCount; i++)
+		{
+			proc = scen->procs + i;
+			roleRate[proc->grp->role] += proc->rates[sec];
+
+			if (ROLE_CONSUMER == proc->grp->role)
+			{
+				if (proc->p50s[sec] > p50)
+				{
+					p50 = proc->p50s[sec];
+				}
+
+				if (proc->p99s[sec] > p99)
+				{
+					p99 = proc->p99s[sec];
+				}
+			}
+		}
+
+		/* the steady state is after the warm up until the role ends */
+		for (role = 0; role < ROLE_COUNT; role++)
+		{
+			if (roleRate[role] > peakRate[role])
+			{
+				peakRate[role] = roleRate[role];
+			}
+
+			if ((sec >= (int)(scen->producerTime - scen->startTime) + scen->warmup) && (sec < lastSec[role]))
+			{
+				steadyTotal[role] += roleRate[role];
+				steadySecs[role]++;
+			}
+		}
+
+		if (out != NULL)
+		{
+			secTime = scen->startTime + sec + 1;
+			strftime(timeStr, sizeof(timeStr), "%H:%M:%S", localtime(&secTime));
+			fprintf(out, "%d,%s,%.2f,%.2f,%.2f," FMTI64 "," FMTI64, sec + 1, timeStr,
+					roleRate[ROLE_PRODUCER], roleRate[ROLE_CONSUMER], roleRate[ROLE_RESPONDER], p50, p99);
+
+			for (i = 0; i < scen->procCount; i++)
+			{
+				fprintf(out, ",%.2f", scen->procs[i].rates[sec]);
+			}
+
+			fprintf(out, "\n");
+		}
+	}
+
+	if (out != NULL)
+	{
+		fclose(out);
+		Log("Merged statistics written to %s", fileName);
+	}
+
+	/* summary for each process */
+	Log("\n%-14s %-10s %5s %14s %8s %12s", "process", "program", "rc", "messages", "seconds", "avg rate");
+	for (i = 0; i < scen->procCount; i++)
+	{
+		proc = scen->procs + i;
+		avgRate = 0.0;
+		if (proc->secs > 0)
+		{
+			avgRate = (double)proc->msgs / (double)proc->secs;
+		}
+
+		sprintf(msgStr, FMTI64, proc->msgs);
+		sprintf(secsStr, FMTI64, proc->secs);
+		Log("%-14s %-10.10s %5d %14s %8s %12.0f%s", proc->name, proc->grp->program, proc->exitCode,
+				msgStr, secsStr, avgRate, (0 == proc->haveSummary) ? "  (no summary)" : "");
+	}
+
+	/* totals for each role */
+	Log("\n%-10s %14s %12s %12s", "role", "messages", "steady rate", "peak rate");
+	for (role = 0; role < ROLE_COUNT; role++)
+	{
+		if (lastSec[role] < 0)
+		{
+			continue;
+		}
+
+		avgRate = 0.0;
+		if (steadySecs[role] > 0)
+		{
+			avgRate = steadyTotal[role] / (double)steadySecs[role];
+		}
+
+		sprintf(msgStr, FMTI64, roleMsgs[role]);
+		Log("%-10s %14s %12.0f %12.0f", roleNames[role], msgStr, avgRate, peakRate[role]);
+	}
+
+	if (scen->warmup > 0)
+	{
+		Log("Steady rates leave out the first %d seconds after the producers started", scen->warmup);
+	}
+
+	/* latency from the consumer summary records */
+	for (i = 0; i < scen->procCount; i++)
+	{
+		proc = scen->procs + i;
+		if ((ROLE_CONSUMER == proc->grp->role) && (proc->latCount > 0))
+		{
+			Log("%s latency microseconds avg %.1f p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f p99.99 %.1f max %.1f", proc->name,
+					proc->latAvg / 1000.0, proc->p50 / 1000.0, proc->p90 / 1000.0, proc->p99 / 1000.0,
+					proc->p999 / 1000.0, proc->p9999 / 1000.0, proc->latMax / 1000.0);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+
+{
+	int			i;
+	int			j;
+	int			duration=-1;
+	int			warmup=-1;
+	int			roleCounts[ROLE_COUNT];
+	char		*ptr;
+	RUNGROUP	*grp;
+	RUNPROC		*proc;
+	SCENARIO	*scen;
+	char		outDir[512];
+
+	/* display the program name and version information */
+	Log("%s program start", Level);
+
+	/* print the copyright statement */
+	Log(copyright);
+
+	/* the scenario is too large for the stack */
+	scen = (SCENARIO *)malloc(sizeof(SCENARIO));
+	if (NULL == scen)
+	{
+		Log("***** unable to allocate storage for the scenario");
+		exit(98);
+	}
+
+	memset(scen, 0, sizeof(SCENARIO));
+	memset(outDir, 0, sizeof(outDir));
+	memset(roleCounts, 0, sizeof(roleCounts));
+	scen->startDelay = DEF_START_DELAY;
+	scen->drainTime = DEF_DRAIN_TIME;
+	strcpy(scen->outDir, ".");
+
+	/* check for help request */
+	if ((argc < 2) || (argv[1][0] == '?') || (argv[1][1] == '?'))
+	{
+		printHelp(argv[0]);
+		exit(0);
+	}
+
+	/* process any command line arguments */
+	processRunArgs(argc, argv, scen, outDir, &duration, &warmup);
+
+	if (scen->err != 0)
+	{
+		printHelp(argv[0]);
+		exit(99);
+	}
+
+	readScenario(scen);
+	if (scen->err != 0)
+	{
+		exit(97);
+	}
+
+	/* apply the command line overrides */
+	if (outDir[0] != 0)
+	{
+		strcpy(scen->outDir, outDir);
+	}
+
+	if (duration >= 0)
+	{
+		scen->duration = duration;
+	}
+
+	if (warmup >= 0)
+	{
+		scen->warmup = warmup;
+	}
+
+	/* default to the directory this program was run from */
+	ptr = strrchr(argv[0], '/');
+#ifdef WIN32
+	if (NULL == ptr)
+	{
+		ptr = strrchr(argv[0], '\\');
+	}
+#endif
+	if ((0 == scen->binDir[0]) && (ptr != NULL) && (ptr - argv[0] < (int)sizeof(scen->binDir)))
+	{
+		memcpy(scen->binDir, argv[0], ptr - argv[0]);
+	}
+
+	/* one entry for each process */
+	for (i = 0; (i < scen->groupCount) && (0 == scen->err); i++)
+	{
+		grp = scen->groups + i;
+		for (j = 0; j < grp->count; j++)
+		{
+			if (MAX_PROCS == scen->procCount)
+			{
+				Log("***** more than %d processes in the scenario", MAX_PROCS);
+				scen->err = 1;
+				break;
+			}
+
+			proc = scen->procs + scen->procCount;
+			scen->procCount++;
+			proc->grp = grp;
+			roleCounts[grp->role]++;
+			sprintf(proc->name, "%s%d", roleNames[grp->role], roleCounts[grp->role]);
+			sprintf(proc->logFile, "%s/%s.log", scen->outDir, proc->name);
+			sprintf(proc->statsFile, "%s/%s.csv", scen->outDir, proc->name);
+		}
+	}
+
+	if ((scen->err != 0) || (0 == scen->procCount))
+	{
+		Log("***** no processes to run");
+		exit(97);
+	}
+
+	Log("Scenario %s: %d producers, %d consumers and %d responders", (scen->name[0] != 0) ? scen->name : scen->scenarioFile,
+			roleCounts[ROLE_PRODUCER], roleCounts[ROLE_CONSUMER], roleCounts[ROLE_RESPONDER]);
+	if (scen->duration > 0)
+	{
+		Log("Producers will run for %d seconds", scen->duration);
+	}
+
+	/* set a termination handler */
+	signal(SIGINT, InterruptHandler);
+
+	runScenario(scen);
+	mergeResults(scen);
+
+	if (1 == terminate)
+	{
+		Log("Scenario cancelled");
+	}
+
+	return 0;
+}
@@ -0,0 +1,1813 @@
+/*
+Copyright (c) IBM Corporation 2000, 2019
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributors:
+Jim MacNair - Initial Contribution
+*/
+
+/********************************************************************/
+/*                                                                  */
+/*   mqstub.c - In-memory stand-in for the MQI                      */
+/*                                                                  */
+/*   This file is linked in place of the MQ library by the stub     */
+/*   target in the Makefile.  It allows the mqperf programs to be   */
+/*   run without a queue manager, so that the cost of the programs  */
+/*   themselves and of the common subroutines can be measured.      */
+/*                                                                  */
+/*   MQCONN, MQCONNX, MQDISC, MQOPEN, MQCLOSE, MQPUT, MQPUT1,       */
+/*   MQGET, MQINQ, MQCMIT, MQBACK and MQSUB are supported.  Queues  */
+/*   are created the first time they are opened and only exist in   */
+/*   the current process.  Messages are delivered in priority and   */
+/*   then FIFO order, and can be selected by message id, correl id  */
+/*   or group id.  Browse cursors, syncpoint, wait intervals and    */
+/*   truncated messages work the same way as with a queue manager.  */
+/*                                                                  */
+/*   Since there is no other program to send or receive messages,   */
+/*   the following environment variables can be used to make the   */
+/*   stub act as the other end:                                     */
+/*                                                                  */
+/*    MQSTUB_DISCARD  - list of queues where messages are dropped   */
+/*                      as soon as they are put (used with mqput2)  */
+/*    MQSTUB_SOURCE   - list of queues that never run out of        */
+/*                      messages (used with mqtimes2 and mqtimes3). */
+/*                      The messages carry a time stamp in the      */
+/*                      same form as mqput2 inserts.                */
+/*    MQSTUB_MSGLEN   - length of the generated messages (1024)     */
+/*    MQSTUB_LOOPBACK - set to Y to reply to every message that     */
+/*                      names a reply to queue (used with mqlatency)*/
+/*                                                                  */
+/*   Queue lists are separated by commas.                           */
+/*                                                                  */
+/********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+
+/* includes for MQI */
+#include <cmqc.h>
+
+/* definitions of 64-bit values for platform independence */
+#include "int64defs.h"
+
+/* time stamps in the same form as mqput2 */
+#include "timesubs.h"
+
+#define STUB_QMGR_NAME		"MQSTUB"
+#define STUB_APPL_NAME		"mqstub"
+#define STUB_MAX_CONNS		1024
+#define STUB_MAX_OBJECTS	16384
+#define STUB_PRIORITIES		10
+#define STUB_MAX_MSG_LENGTH	104857600
+#define STUB_MAX_Q_DEPTH	999999999
+#define STUB_DEF_MSGLEN		1024
+
+/* message states */
+#define MSG_AVAILABLE		0
+#define MSG_PUT_PENDING		1			/* put under syncpoint */
+#define MSG_GET_PENDING		2			/* got under syncpoint */
+
+/* object types */
+#define OBJ_QMGR			0
+#define OBJ_QUEUE			1
+#define OBJ_TOPIC			2
+#define OBJ_SUB				3
+
+typedef struct STUBMSG_S {
+	struct STUBMSG_S	*next;
+	struct STUBMSG_S	*prev;
+	struct STUBMSG_S	*uowNext;			/* next message in the unit of work */
+	struct STUBQUEUE_S	*queue;
+	int64_t				seq;				/* order the message was put */
+	int					state;
+	MQLONG				length;
+	MQMD2				md;
+	char				data[1];
+} STUBMSG;
+
+typedef struct {
+	STUBMSG				*head;
+	STUBMSG				*tail;
+} STUBLIST;
+
+typedef struct STUBQUEUE_S {
+	struct STUBQUEUE_S	*next;
+	char				name[MQ_Q_NAME_LENGTH + 1];
+	int					discard;
+	int					source;
+	int64_t				nextSeq;
+	MQLONG				depth;
+	pthread_mutex_t		lock;
+	pthread_cond_t		arrived;
+	STUBLIST			prio[STUB_PRIORITIES];
+} STUBQUEUE;
+
+typedef struct STUBSUB_S {
+	struct STUBSUB_S	*next;
+	char				*topic;
+	STUBQUEUE			*queue;
+} STUBSUB;
+
+typedef struct {
+	int					inUse;
+	MQHCONN				hConn;
+	int					type;
+	MQLONG				options;
+	STUBQUEUE			*queue;
+	char				*topic;				/* topic objects */
+	STUBSUB				*sub;				/* subscription handles */
+	int					browseValid;
+	int					browsePrio;
+	int64_t				browseSeq;
+} STUBOBJECT;
+
+typedef struct {
+	int					inUse;
+	char				qmgrName[MQ_Q_MGR_NAME_LENGTH + 1];
+	STUBMSG				*uow;				/* messages put or got under syncpoint */
+} STUBCONN;
+
+static pthread_mutex_t	stubLock=PTHREAD_MUTEX_INITIALIZER;
+static int				stubInitialized=0;
+static STUBCONN			conns[STUB_MAX_CONNS];
+static STUBOBJECT		objects[STUB_MAX_OBJECTS];
+static STUBQUEUE *		queues=NULL;
+static STUBSUB *		subs=NULL;
+static int64_t			msgIdCount=0;
+static const char *		discardList=NULL;
+static const char *		sourceList=NULL;
+static int				sourceLength=STUB_DEF_MSGLEN;
+static int				loopback=0;
+
+/**************************************************************/
+/*                                                            */
+/* Read the environment variables.  Called with the stub lock */
+/* held.                                                      */
+/*                                                            */
+/**************************************************************/
+
+static void stubInit()
+
+{
+	const char	*ptr;
+
+	if (1 == stubInitialized)
+	{
+		return;
+	}
+
+	discardList = getenv("MQSTUB_DISCARD");
+	sourceList = getenv("MQSTUB_SOURCE");
+
+	ptr = getenv("MQSTUB_MSGLEN");
+	if ((ptr != NULL) && (atoi(ptr) > 0))
+	{
+		sourceLength = atoi(ptr);
+	}
+
+	ptr = getenv("MQSTUB_LOOPBACK");
+	if ((ptr != NULL) && (('Y' == ptr[0]) || ('y' == ptr[0]) || ('1' == ptr[0])))
+	{
+		loopback = 1;
+	}
+
+	stubInitialized = 1;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Copy a blank padded MQ name and remove the trailing blanks.*/
+/*                                                            */
+/**************************************************************/
+
+static void copyName(char *dest, const char *src, int len)
+
+{
+	memcpy(dest, src, len);
+	dest[len] = 0;
+
+	while ((len > 0) && ((' ' == dest[len - 1]) || (0 == dest[len - 1])))
+	{
+		len--;
+		dest[len] = 0;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Copy a name into a blank padded MQ field.                  */
+/*                                                            */
+/**************************************************************/
+
+static void padName(char *dest, const char *src, int len)
+
+{
+	int		srclen=(int)strlen(src);
+
+	if (srclen > len)
+	{
+		srclen = len;
+	}
+
+	memset(dest, ' ', len);
+	memcpy(dest, src, srclen);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if a queue name appears in a comma separated list.   */
+/*                                                            */
+/**************************************************************/
+
+static int inList(const char *list, const char *name)
+
+{
+	size_t		len=strlen(name);
+	const char	*ptr=list;
+
+	while ((ptr != NULL) && (ptr[0] != 0))
+	{
+		if ((strncmp(ptr, name, len) == 0) && ((0 == ptr[len]) || (',' == ptr[len])))
+		{
+			return 1;
+		}
+
+		ptr = strchr(ptr, ',');
+		if (ptr != NULL)
+		{
+			ptr++;
+		}
+	}
+
+	return 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get a string from an MQCHARV field in a structure.  The    */
+/* string is returned in allocated storage.                   */
+/*                                                            */
+/**************************************************************/
+
+static char * getCharV(const void *struc, const MQCHARV *charv)
+
+{
+	const char	*ptr;
+	char		*str;
+	MQLONG		len=charv->VSLength;
+
+	if (charv->VSPtr != NULL)
+	{
+		ptr = (const char *)charv->VSPtr;
+	}
+	else if (charv->VSOffset > 0)
+	{
+		ptr = (const char *)struc + charv->VSOffset;
+	}
+	else
+	{
+		return NULL;
+	}
+
+	if (MQVS_NULL_TERMINATED == len)
+	{
+		len = (MQLONG)strlen(ptr);
+	}
+
+	if (len <= 0)
+	{
+		return NULL;
+	}
+
+	str = (char *)malloc(len + 1);
+	if (str != NULL)
+	{
+		memcpy(str, ptr, len);
+		str[len] = 0;
+	}
+
+	return str;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Get the topic string from an object name and an MQCHARV.   */
+/*                                                            */
+/**************************************************************/
+
+static char * getTopic(const void *struc, const MQCHARV *charv, const char *objectName)
+
+{
+	char	*topic=NULL;
+	char	name[MQ_TOPIC_NAME_LENGTH + 1];
+
+	if (charv != NULL)
+	{
+		topic = getCharV(struc, charv);
+	}
+
+	if (NULL == topic)
+	{
+		/* use the topic object name as the topic string */
+		copyName(name, objectName, MQ_TOPIC_NAME_LENGTH);
+		if (name[0] != 0)
+		{
+			topic = strdup(name);
+		}
+	}
+
+	return topic;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if a topic string matches a subscription.  A '#'     */
+/* level matches any number of levels and a '+' level         */
+/* matches exactly one level.                                 */
+/*                                                            */
+/**************************************************************/
+
+static int topicMatch(const char *sub, const char *topic)
+
+{
+	while (1)
+	{
+		if (('#' == sub[0]) && ((0 == sub[1]) || ('/' == sub[1])))
+		{
+			if (0 == sub[1])
+			{
+				return 1;
+			}
+
+			/* try the rest of the subscription at each level */
+			while (1)
+			{
+				if (topicMatch(sub + 2, topic))
+				{
+					return 1;
+				}
+
+				topic = strchr(topic, '/');
+				if (NULL == topic)
+				{
+					return 0;
+				}
+
+				topic++;
+			}
+		}
+
+		if (('+' == sub[0]) && ((0 == sub[1]) || ('/' == sub[1])))
+		{
+			/* skip one level in the topic */
+			sub++;
+			while ((topic[0] != 0) && (topic[0] != '/'))
+			{
+				topic++;
+			}
+		}
+		else
+		{
+			/* compare one level */
+			while ((sub[0] != 0) && (sub[0] != '/') && (sub[0] == topic[0]))
+			{
+				sub++;
+				topic++;
+			}
+
+			if ((sub[0] != 0) && (sub[0] != '/'))
+			{
+				return 0;
+			}
+
+			if ((topic[0] != 0) && (topic[0] != '/'))
+			{
+				return 0;
+			}
+		}
+
+		if ((0 == sub[0]) || (0 == topic[0]))
+		{
+			return (sub[0] == topic[0]);
+		}
+
+		/* both are at a level separator */
+		sub++;
+		topic++;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Create a queue.  Called with the stub lock held.           */
+/*                                                            */
+/**************************************************************/
+
+static STUBQUEUE * createQueue(const char *name)
+
+{
+	STUBQUEUE	*queue;
+
+	queue = (STUBQUEUE *)malloc(sizeof(STUBQUEUE));
+	if (NULL == queue)
+	{
+		return NULL;
+	}
+
+	memset(queue, 0, sizeof(STUBQUEUE));
+	strcpy(queue->name, name);
+	pthread_mutex_init(&(queue->lock), NULL);
+	pthread_cond_init(&(queue->arrived), NULL);
+
+	if (name[0] != 0)
+	{
+		queue->discard = inList(discardList, name);
+		queue->source = inList(sourceList, name);
+	}
+
+	return queue;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Find a queue, creating it the first time it is used.       */
+/*                                                            */
+/**************************************************************/
+
+static STUBQUEUE * findQueue(const char *name)
+
+{
+	STUBQUEUE	*queue;
+
+	pthread_mutex_lock(&stubLock);
+	stubInit();
+
+	queue = queues;
+	while ((queue != NULL) && (strcmp(queue->name, name) != 0))
+	{
+		queue = queue->next;
+	}
+
+	if (NULL == queue)
+	{
+		queue = createQueue(name);
+		if (queue != NULL)
+		{
+			queue->next = queues;
+			queues = queue;
+		}
+	}
+
+	pthread_mutex_unlock(&stubLock);
+
+	return queue;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Handle validation.                                         */
+/*                                                            */
+/**************************************************************/
+
+static STUBCONN * findConn(MQHCONN hConn)
+
+{
+	if ((hConn < 1) || (hConn > STUB_MAX_CONNS) || (0 == conns[hConn - 1].inUse))
+	{
+		return NULL;
+	}
+
+	return conns + hConn - 1;
+}
+
+static STUBOBJECT * findObject(MQHCONN hConn, MQHOBJ hObj)
+
+{
+	if ((hObj < 1) || (hObj > STUB_MAX_OBJECTS) || (0 == objects[hObj - 1].inUse) || (objects[hObj - 1].hConn != hConn))
+	{
+		return NULL;
+	}
+
+	return objects + hObj - 1;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Allocate an object handle.  Returns 0 if none are left.    */
+/*                                                            */
+/**************************************************************/
+
+static MQHOBJ newObject(MQHCONN hConn, int type, MQLONG options, STUBQUEUE *queue)
+
+{
+	int			i=0;
+	STUBOBJECT	*obj;
+
+	pthread_mutex_lock(&stubLock);
+	while ((i < STUB_MAX_OBJECTS) && (1 == objects[i].inUse))
+	{
+		i++;
+	}
+
+	if (i < STUB_MAX_OBJECTS)
+	{
+		obj = objects + i;
+		memset(obj, 0, sizeof(STUBOBJECT));
+		obj->inUse = 1;
+		obj->hConn = hConn;
+		obj->type = type;
+		obj->options = options;
+		obj->queue = queue;
+	}
+
+	pthread_mutex_unlock(&stubLock);
+
+	return (i < STUB_MAX_OBJECTS) ? i + 1 : 0;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Release an object handle.                                  */
+/*                                                            */
+/**************************************************************/
+
+static void releaseObject(STUBOBJECT *obj)
+
+{
+	STUBSUB		*sub;
+	STUBSUB		*prev=NULL;
+
+	pthread_mutex_lock(&stubLock);
+
+	/* closing a subscription handle removes the subscription */
+	if (obj->sub != NULL)
+	{
+		sub = subs;
+		while ((sub != NULL) && (sub != obj->sub))
+		{
+			prev = sub;
+			sub = sub->next;
+		}
+
+		if (sub != NULL)
+		{
+			if (NULL == prev)
+			{
+				subs = sub->next;
+			}
+			else
+			{
+				prev->next = sub->next;
+			}
+
+			free(sub->topic);
+			free(sub);
+		}
+	}
+
+	if (obj->topic != NULL)
+	{
+		free(obj->topic);
+	}
+
+	obj->inUse = 0;
+	pthread_mutex_unlock(&stubLock);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Queue list handling.  Called with the queue lock held.     */
+/*                                                            */
+/**************************************************************/
+
+static void addMessage(STUBQUEUE *queue, STUBMSG *msg)
+
+{
+	STUBLIST	*list=queue->prio + msg->md.Priority;
+
+	msg->queue = queue;
+	msg->seq = ++(queue->nextSeq);
+	msg->next = NULL;
+	msg->prev = list->tail;
+
+	if (NULL == list->tail)
+	{
+		list->head = msg;
+	}
+	else
+	{
+		list->tail->next = msg;
+	}
+
+	list->tail = msg;
+	queue->depth++;
+}
+
+static void removeMessage(STUBMSG *msg)
+
+{
+	STUBQUEUE	*queue=msg->queue;
+	STUBLIST	*list=queue->prio + msg->md.Priority;
+
+	if (NULL == msg->prev)
+	{
+		list->head = msg->next;
+	}
+	else
+	{
+		msg->prev->next = msg->next;
+	}
+
+	if (NULL == msg->next)
+	{
+		list->tail = msg->prev;
+	}
+	else
+	{
+		msg->next->prev = msg->prev;
+	}
+
+	queue->depth--;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Allocate a message and copy the data.                      */
+/*                                                            */
+/**************************************************************/
+
+static STUBMSG * newMessage(const MQMD2 *md, const void *data, MQLONG length)
+
+{
+	STUBMSG		*msg;
+
+	msg = (STUBMSG *)malloc(sizeof(STUBMSG) + length);
+	if (msg != NULL)
+	{
+		memcpy(&(msg->md), md, sizeof(MQMD2));
+		msg->length = length;
+		msg->state = MSG_AVAILABLE;
+		msg->uowNext = NULL;
+
+		if (length > 0)
+		{
+			memcpy(msg->data, data, length);
+		}
+	}
+
+	return msg;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Create a new message or correlation id.                    */
+/*                                                            */
+/**************************************************************/
+
+static void newMsgId(MQBYTE24 msgId)
+
+{
+	int64_t		count;
+
+	count = __sync_add_and_fetch(&msgIdCount, 1);
+
+	memset(msgId, 0, MQ_MSG_ID_LENGTH);
+	memcpy(msgId, "AMQ " STUB_QMGR_NAME, 4 + sizeof(STUB_QMGR_NAME) - 1);
+	memcpy(msgId + MQ_MSG_ID_LENGTH - sizeof(count), &count, sizeof(count));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Set the put date and time in the MQMD.                     */
+/*                                                            */
+/**************************************************************/
+
+static void setPutTime(MQMD2 *md)
+
+{
+	char			temp[32];
+	struct tm		gmt;
+	struct timespec	now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	gmtime_r(&(now.tv_sec), &gmt);
+
+	sprintf(temp, "%04d%02d%02d", gmt.tm_year + 1900, gmt.tm_mon + 1, gmt.tm_mday);
+	memcpy(md->PutDate, temp, sizeof(md->PutDate));
+	sprintf(temp, "%02d%02d%02d%02d", gmt.tm_hour, gmt.tm_min, gmt.tm_sec, (int)(now.tv_nsec / 10000000));
+	memcpy(md->PutTime, temp, sizeof(md->PutTime));
+}
+
+/**************************************************************/
+/*                                                            */
+/* Copy an MQMD of either version into a version 2 MQMD and   */
+/* back again.                                                */
+/*                                                            */
+/**************************************************************/
+
+static void getMD(MQMD2 *md2, const MQMD2 *md)
+
+{
+	if (md->Version >= MQMD_VERSION_2)
+	{
+		memcpy(md2, md, sizeof(MQMD2));
+	}
+	else
+	{
+		memcpy(md2, md, MQMD_LENGTH_1);
+		memset(md2->GroupId, 0, sizeof(md2->GroupId));
+		md2->MsgSeqNumber = 1;
+		md2->Offset = 0;
+		md2->MsgFlags = 0;
+		md2->OriginalLength = -1;
+	}
+}
+
+static void putMD(MQMD2 *md, const MQMD2 *md2)
+
+{
+	MQLONG		version=md->Version;
+
+	if (version >= MQMD_VERSION_2)
+	{
+		memcpy(md, md2, sizeof(MQMD2));
+	}
+	else
+	{
+		memcpy(md, md2, MQMD_LENGTH_1);
+	}
+
+	/* keep the version the caller passed */
+	md->Version = version;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Build the MQMD of a message that is about to be put.       */
+/*                                                            */
+/**************************************************************/
+
+static void prepareMD(STUBCONN *conn, MQMD2 *md, MQMD2 *md2, const MQPMO *pmo)
+
+{
+	char		msgId[MQ_MSG_ID_LENGTH];
+
+	getMD(md2, md);
+
+	/* create a message id if one was not provided */
+	memset(msgId, 0, sizeof(msgId));
+	if ((pmo->Options & MQPMO_NEW_MSG_ID) || (memcmp(md2->MsgId, msgId, sizeof(msgId)) == 0))
+	{
+		newMsgId(md2->MsgId);
+	}
+
+	if (pmo->Options & MQPMO_NEW_CORREL_ID)
+	{
+		newMsgId(md2->CorrelId);
+	}
+
+	/* set the context fields */
+	if (0 == (pmo->Options & MQPMO_SET_ALL_CONTEXT))
+	{
+		setPutTime(md2);
+		md2->PutApplType = MQAT_DEFAULT;
+		padName(md2->PutApplName, STUB_APPL_NAME, sizeof(md2->PutApplName));
+		memset(md2->ApplOriginData, ' ', sizeof(md2->ApplOriginData));
+
+		if (0 == (pmo->Options & MQPMO_SET_IDENTITY_CONTEXT))
+		{
+			padName(md2->UserIdentifier, STUB_APPL_NAME, sizeof(md2->UserIdentifier));
+			memset(md2->AccountingToken, 0, sizeof(md2->AccountingToken));
+			memset(md2->ApplIdentityData, ' ', sizeof(md2->ApplIdentityData));
+		}
+	}
+
+	/* fill in the reply to queue manager */
+	if ((md2->ReplyToQ[0] != ' ') && (md2->ReplyToQ[0] != 0) && ((' ' == md2->ReplyToQMgr[0]) || (0 == md2->ReplyToQMgr[0])))
+	{
+		padName(md2->ReplyToQMgr, conn->qmgrName, sizeof(md2->ReplyToQMgr));
+	}
+
+	md2->BackoutCount = 0;
+
+	/* the caller gets back the ids and the context */
+	putMD(md, md2);
+
+	/* use the queue defaults */
+	if ((md2->Priority < 0) || (md2->Priority >= STUB_PRIORITIES))
+	{
+		md2->Priority = 0;
+	}
+
+	if (MQPER_PERSISTENCE_AS_Q_DEF == md2->Persistence)
+	{
+		md2->Persistence = MQPER_NOT_PERSISTENT;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Commit or back out the messages in a unit of work.         */
+/*                                                            */
+/**************************************************************/
+
+static void endUOW(STUBCONN *conn, int commit)
+
+{
+	int			release;
+	STUBMSG		*msg;
+	STUBMSG		*next;
+	STUBQUEUE	*queue;
+
+	msg = conn->uow;
+	conn->uow = NULL;
+
+	while (msg != NULL)
+	{
+		next = msg->uowNext;
+		msg->uowNext = NULL;
+		queue = msg->queue;
+		release = 0;
+
+		pthread_mutex_lock(&(queue->lock));
+		if (MSG_PUT_PENDING == msg->state)
+		{
+			if (1 == commit)
+			{
+				msg->state = MSG_AVAILABLE;
+				pthread_cond_broadcast(&(queue->arrived));
+			}
+			else
+			{
+				removeMessage(msg);
+				release = 1;
+			}
+		}
+		else
+		{
+			if (1 == commit)
+			{
+				removeMessage(msg);
+				release = 1;
+			}
+			else
+			{
+				msg->state = MSG_AVAILABLE;
+				msg->md.BackoutCount++;
+				pthread_cond_broadcast(&(queue->arrived));
+			}
+		}
+
+		pthread_mutex_unlock(&(queue->lock));
+
+		if (1 == release)
+		{
+			free(msg);
+		}
+
+		msg = next;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Put a message on a queue.                                  */
+/*                                                            */
+/**************************************************************/
+
+static MQLONG putToQueue(STUBCONN *conn, STUBQUEUE *queue, MQMD2 *md2, MQLONG options, const void *buffer, MQLONG length)
+
+{
+	int			syncpoint=0;
+	STUBMSG		*msg;
+
+	/* drop the message if nobody is going to read it */
+	if (1 == queue->discard)
+	{
+		return MQRC_NONE;
+	}
+
+	if (options & MQPMO_SYNCPOINT)
+	{
+		syncpoint = 1;
+	}
+
+	msg = newMessage(md2, buffer, length);
+	if (NULL == msg)
+	{
+		return MQRC_STORAGE_NOT_AVAILABLE;
+	}
+
+	pthread_mutex_lock(&(queue->lock));
+	if (queue->depth >= STUB_MAX_Q_DEPTH)
+	{
+		pthread_mutex_unlock(&(queue->lock));
+		free(msg);
+		return MQRC_Q_FULL;
+	}
+
+	addMessage(queue, msg);
+	if (1 == syncpoint)
+	{
+		/* the message is not visible until it is committed */
+		msg->state = MSG_PUT_PENDING;
+	}
+	else
+	{
+		pthread_cond_broadcast(&(queue->arrived));
+	}
+
+	pthread_mutex_unlock(&(queue->lock));
+
+	if (1 == syncpoint)
+	{
+		msg->uowNext = conn->uow;
+		conn->uow = msg;
+	}
+
+	return MQRC_NONE;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Reply to a request message on behalf of a server.          */
+/*                                                            */
+/**************************************************************/
+
+static void sendReply(STUBCONN *conn, const MQMD2 *md2, const void *buffer, MQLONG length)
+
+{
+	char		replyQ[MQ_Q_NAME_LENGTH + 1];
+	MQMD2		reply;
+	MQMD2		replyMD;
+	STUBQUEUE	*queue;
+	MQPMO		pmo={MQPMO_DEFAULT};
+
+	/* nothing to do if the message does not want a reply */
+	copyName(replyQ, md2->ReplyToQ, MQ_Q_NAME_LENGTH);
+	if (0 == replyQ[0])
+	{
+		return;
+	}
+
+	queue = findQueue(replyQ);
+	if (NULL == queue)
+	{
+		return;
+	}
+
+	memcpy(&reply, md2, sizeof(MQMD2));
+	reply.MsgType = MQMT_REPLY;
+	memset(reply.ReplyToQ, ' ', sizeof(reply.ReplyToQ));
+	memset(reply.ReplyToQMgr, ' ', sizeof(reply.ReplyToQMgr));
+
+	/* the correl id of the reply is the msg id of the request unless told otherwise */
+	if (0 == (md2->Report & MQRO_PASS_CORREL_ID))
+	{
+		memcpy(reply.CorrelId, md2->MsgId, sizeof(reply.CorrelId));
+	}
+
+	memset(reply.MsgId, 0, sizeof(reply.MsgId));
+	pmo.Options = MQPMO_NO_SYNCPOINT | MQPMO_NEW_MSG_ID;
+	prepareMD(conn, &reply, &replyMD, &pmo);
+
+	putToQueue(conn, queue, &replyMD, pmo.Options, buffer, length);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Check if a message matches the selection criteria.         */
+/*                                                            */
+/**************************************************************/
+
+static int isMatch(const STUBMSG *msg, const MQMD2 *md, MQLONG matchOptions)
+
+{
+	static const char	nullId[MQ_MSG_ID_LENGTH]={0};
+
+	if ((matchOptions & MQMO_MATCH_MSG_ID) && (memcmp(md->MsgId, nullId, MQ_MSG_ID_LENGTH) != 0) && (memcmp(md->MsgId, msg->md.MsgId, MQ_MSG_ID_LENGTH) != 0))
+	{
+		return 0;
+	}
+
+	if ((matchOptions & MQMO_MATCH_CORREL_ID) && (memcmp(md->CorrelId, nullId, MQ_CORREL_ID_LENGTH) != 0) && (memcmp(md->CorrelId, msg->md.CorrelId, MQ_CORREL_ID_LENGTH) != 0))
+	{
+		return 0;
+	}
+
+	if ((matchOptions & MQMO_MATCH_GROUP_ID) && (md->Version >= MQMD_VERSION_2) && (memcmp(md->GroupId, nullId, MQ_GROUP_ID_LENGTH) != 0) && (memcmp(md->GroupId, msg->md.GroupId, MQ_GROUP_ID_LENGTH) != 0))
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Find the next message to return, in priority order and     */
+/* then in the order the messages were put.  Browse requests  */
+/* only look at messages after the browse cursor.  Called     */
+/* with the queue lock held.                                  */
+/*                                                            */
+/**************************************************************/
+
+static STUBMSG * findMessage(STUBQUEUE *queue, STUBOBJECT *obj, const MQMD2 *md, MQLONG matchOptions, int browse)
+
+{
+	int			prio;
+	STUBMSG		*msg;
+
+	for (prio = STUB_PRIORITIES - 1; prio >= 0; prio--)
+	{
+		/* skip the priorities the browse cursor has passed */
+		if ((1 == browse) && (1 == obj->browseValid) && (prio > obj->browsePrio))
+		{
+			continue;
+		}
+
+		msg = queue->prio[prio].head;
+		while (msg != NULL)
+		{
+			if ((MSG_AVAILABLE == msg->state) &&
+				((0 == browse) || (0 == obj->browseValid) || (prio < obj->browsePrio) || (msg->seq > obj->browseSeq)) &&
+				(isMatch(msg, md, matchOptions)))
+			{
+				return msg;
+			}
+
+			msg = msg->next;
+		}
+	}
+
+	return NULL;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Generate a message for a source queue.  The message data   */
+/* starts with a time stamp and the queue manager name, the   */
+/* same as the messages written by mqput2.                    */
+/*                                                            */
+/**************************************************************/
+
+static STUBMSG * sourceMessage(STUBCONN *conn, STUBQUEUE *queue)
+
+{
+	STUBMSG		*msg;
+	MY_TIME_T	now;
+	MQMD2		md2={MQMD2_DEFAULT};
+	MQPMO		pmo={MQPMO_DEFAULT};
+
+	msg = (STUBMSG *)malloc(sizeof(STUBMSG) + sourceLength);
+	if (NULL == msg)
+	{
+		return NULL;
+	}
+
+	md2.Version = MQMD_VERSION_2;
+	memcpy(md2.Format, MQFMT_NONE, sizeof(md2.Format));
+	pmo.Options = MQPMO_NEW_MSG_ID;
+	prepareMD(conn, &md2, &(msg->md), &pmo);
+
+	memset(msg->data, 0, sourceLength);
+	if ((size_t)sourceLength > sizeof(MY_TIME_T) + strlen(conn->qmgrName))
+	{
+		GetTime(&now);
+		memcpy(msg->data, &now, sizeof(MY_TIME_T));
+		strcpy(msg->data + sizeof(MY_TIME_T), conn->qmgrName);
+	}
+
+	msg->length = sourceLength;
+	msg->state = MSG_AVAILABLE;
+	msg->uowNext = NULL;
+	addMessage(queue, msg);
+
+	return msg;
+}
+
+/**************************************************************/
+/*                                                            */
+/* MQI entry points.                                          */
+/*                                                            */
+/**************************************************************/
+
+void MQENTRY MQCONNX(PMQCHAR pName, PMQCNO pConnectOpts, PMQHCONN pHconn, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	int		i=0;
+
+	pthread_mutex_lock(&stubLock);
+	stubInit();
+
+	while ((i < STUB_MAX_CONNS) && (1 == conns[i].inUse))
+	{
+		i++;
+	}
+
+	if (i < STUB_MAX_CONNS)
+	{
+		conns[i].inUse = 1;
+		conns[i].uow = NULL;
+
+		/* use the name the caller asked for */
+		copyName(conns[i].qmgrName, (pName != NULL) ? pName : "", (pName != NULL) ? MQ_Q_MGR_NAME_LENGTH : 0);
+		if (0 == conns[i].qmgrName[0])
+		{
+			strcpy(conns[i].qmgrName, STUB_QMGR_NAME);
+		}
+	}
+
+	pthread_mutex_unlock(&stubLock);
+
+	if (i < STUB_MAX_CONNS)
+	{
+		(*pHconn) = i + 1;
+		(*pCompCode) = MQCC_OK;
+		(*pReason) = MQRC_NONE;
+	}
+	else
+	{
+		(*pHconn) = MQHC_UNUSABLE_HCONN;
+		(*pCompCode) = MQCC_FAILED;
+		(*pReason) = MQRC_MAX_CONNS_LIMIT_REACHED;
+	}
+}
+
+void MQENTRY MQCONN(PMQCHAR pName, PMQHCONN pHconn, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	MQCONNX(pName, NULL, pHconn, pCompCode, pReason);
+}
+
+void MQENTRY MQDISC(PMQHCONN pHconn, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	int			i;
+	STUBCONN	*conn=findConn(*pHconn);
+
+	if (NULL == conn)
+	{
+		(*pCompCode) = MQCC_FAILED;
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	/* a normal disconnect commits the unit of work */
+	endUOW(conn, 1);
+
+	/* close any objects that are still open */
+	for (i = 0; i < STUB_MAX_OBJECTS; i++)
+	{
+		if ((1 == objects[i].inUse) && (objects[i].hConn == *pHconn))
+		{
+			releaseObject(objects + i);
+		}
+	}
+
+	pthread_mutex_lock(&stubLock);
+	conn->inUse = 0;
+	pthread_mutex_unlock(&stubLock);
+
+	(*pHconn) = MQHC_UNUSABLE_HCONN;
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
+
+void MQENTRY MQOPEN(MQHCONN Hconn, PMQVOID pObjDesc, MQLONG Options, PMQHOBJ pHobj, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	int			type;
+	char		name[MQ_Q_NAME_LENGTH + 1];
+	char		*topic=NULL;
+	MQOD		*od=(MQOD *)pObjDesc;
+	MQHOBJ		hObj;
+	STUBQUEUE	*queue=NULL;
+
+	(*pHobj) = MQHO_UNUSABLE_HOBJ;
+	(*pCompCode) = MQCC_FAILED;
+
+	if (NULL == findConn(Hconn))
+	{
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	switch (od->ObjectType)
+	{
+	case MQOT_Q_MGR:
+		{
+			type = OBJ_QMGR;
+			break;
+		}
+	case MQOT_TOPIC:
+		{
+			type = OBJ_TOPIC;
+			topic = getTopic(od, (od->Version >= MQOD_VERSION_4) ? &(od->ObjectString) : NULL, od->ObjectName);
+			if (NULL == topic)
+			{
+				(*pReason) = MQRC_TOPIC_STRING_ERROR;
+				return;
+			}
+
+			break;
+		}
+	case MQOT_Q:
+		{
+			type = OBJ_QUEUE;
+			copyName(name, od->ObjectName, MQ_Q_NAME_LENGTH);
+			queue = findQueue(name);
+			if (NULL == queue)
+			{
+				(*pReason) = MQRC_STORAGE_NOT_AVAILABLE;
+				return;
+			}
+
+			if (od->Version >= MQOD_VERSION_3)
+			{
+				memcpy(od->ResolvedQName, od->ObjectName, MQ_Q_NAME_LENGTH);
+				padName(od->ResolvedQMgrName, conns[Hconn - 1].qmgrName, MQ_Q_MGR_NAME_LENGTH);
+			}
+
+			break;
+		}
+	default:
+		{
+			(*pReason) = MQRC_OBJECT_TYPE_ERROR;
+			return;
+		}
+	}
+
+	hObj = newObject(Hconn, type, Options, queue);
+	if (0 == hObj)
+	{
+		free(topic);
+		(*pReason) = MQRC_HANDLE_NOT_AVAILABLE;
+		return;
+	}
+
+	objects[hObj - 1].topic = topic;
+
+	(*pHobj) = hObj;
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
+
+void MQENTRY MQCLOSE(MQHCONN Hconn, PMQHOBJ pHobj, MQLONG Options, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	STUBOBJECT	*obj=findObject(Hconn, *pHobj);
+
+	if (NULL == obj)
+	{
+		(*pCompCode) = MQCC_FAILED;
+		(*pReason) = (NULL == findConn(Hconn)) ? MQRC_HCONN_ERROR : MQRC_HOBJ_ERROR;
+		return;
+	}
+
+	releaseObject(obj);
+
+	(*pHobj) = MQHO_UNUSABLE_HOBJ;
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
+
+void MQENTRY MQPUT(MQHCONN Hconn, MQHOBJ Hobj, PMQVOID pMsgDesc, PMQVOID pPutMsgOpts, MQLONG BufferLength, PMQVOID pBuffer, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	MQLONG		reason=MQRC_NONE;
+	MQMD2		md2;
+	MQPMO		*pmo=(MQPMO *)pPutMsgOpts;
+	STUBCONN	*conn=findConn(Hconn);
+	STUBOBJECT	*obj=findObject(Hconn, Hobj);
+	STUBSUB		*sub;
+
+	(*pCompCode) = MQCC_FAILED;
+
+	if (NULL == conn)
+	{
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	if (NULL == obj)
+	{
+		(*pReason) = MQRC_HOBJ_ERROR;
+		return;
+	}
+
+	if (0 == (obj->options & MQOO_OUTPUT))
+	{
+		(*pReason) = MQRC_NOT_OPEN_FOR_OUTPUT;
+		return;
+	}
+
+	if (BufferLength < 0)
+	{
+		(*pReason) = MQRC_BUFFER_LENGTH_ERROR;
+		return;
+	}
+
+	if (BufferLength > STUB_MAX_MSG_LENGTH)
+	{
+		(*pReason) = MQRC_MSG_TOO_BIG_FOR_Q;
+		return;
+	}
+
+	prepareMD(conn, (MQMD2 *)pMsgDesc, &md2, pmo);
+
+	if (OBJ_TOPIC == obj->type)
+	{
+		/* give a copy to each matching subscription */
+		pthread_mutex_lock(&stubLock);
+		sub = subs;
+		while ((sub != NULL) && (MQRC_NONE == reason))
+		{
+			if (topicMatch(sub->topic, obj->topic))
+			{
+				reason = putToQueue(conn, sub->queue, &md2, pmo->Options, pBuffer, BufferLength);
+			}
+
+			sub = sub->next;
+		}
+
+		pthread_mutex_unlock(&stubLock);
+	}
+	else
+	{
+		reason = putToQueue(conn, obj->queue, &md2, pmo->Options, pBuffer, BufferLength);
+
+		/* act as the server for messages that expect a reply */
+		if ((MQRC_NONE == reason) && (1 == loopback))
+		{
+			sendReply(conn, &md2, pBuffer, BufferLength);
+		}
+	}
+
+	(*pCompCode) = (MQRC_NONE == reason) ? MQCC_OK : MQCC_FAILED;
+	(*pReason) = reason;
+}
+
+void MQENTRY MQPUT1(MQHCONN Hconn, PMQVOID pObjDesc, PMQVOID pMsgDesc, PMQVOID pPutMsgOpts, MQLONG BufferLength, PMQVOID pBuffer, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	MQLONG		cc;
+	MQLONG		rc;
+	MQHOBJ		hObj;
+
+	MQOPEN(Hconn, pObjDesc, MQOO_OUTPUT, &hObj, pCompCode, pReason);
+	if (*pCompCode != MQCC_OK)
+	{
+		return;
+	}
+
+	MQPUT(Hconn, hObj, pMsgDesc, pPutMsgOpts, BufferLength, pBuffer, pCompCode, pReason);
+	MQCLOSE(Hconn, &hObj, MQCO_NONE, &cc, &rc);
+}
+
+void MQENTRY MQGET(MQHCONN Hconn, MQHOBJ Hobj, PMQVOID pMsgDesc, PMQVOID pGetMsgOpts, MQLONG BufferLength, PMQVOID pBuffer, PMQLONG pDataLength, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	int				browse=0;
+	int				syncpoint=0;
+	int				release=0;
+	int				rc;
+	MQLONG			matchOptions=MQMO_MATCH_MSG_ID | MQMO_MATCH_CORREL_ID;
+	MQLONG			copyLen;
+	MQMD2			*md=(MQMD2 *)pMsgDesc;
+	MQGMO			*gmo=(MQGMO *)pGetMsgOpts;
+	STUBCONN		*conn=findConn(Hconn);
+	STUBOBJECT		*obj=findObject(Hconn, Hobj);
+	STUBQUEUE		*queue;
+	STUBMSG			*msg;
+	struct timespec	deadline;
+
+	(*pCompCode) = MQCC_FAILED;
+
+	if (NULL == conn)
+	{
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	if ((NULL == obj) || (NULL == obj->queue))
+	{
+		(*pReason) = MQRC_HOBJ_ERROR;
+		return;
+	}
+
+	if (BufferLength < 0)
+	{
+		(*pReason) = MQRC_BUFFER_LENGTH_ERROR;
+		return;
+	}
+
+	if (gmo->Options & (MQGMO_BROWSE_FIRST | MQGMO_BROWSE_NEXT))
+	{
+		if (0 == (obj->options & MQOO_BROWSE))
+		{
+			(*pReason) = MQRC_NOT_OPEN_FOR_BROWSE;
+			return;
+		}
+
+		browse = 1;
+		if (gmo->Options & MQGMO_BROWSE_FIRST)
+		{
+			obj->browseValid = 0;
+		}
+	}
+	else
+	{
+		if (0 == (obj->options & (MQOO_INPUT_AS_Q_DEF | MQOO_INPUT_SHARED | MQOO_INPUT_EXCLUSIVE)))
+		{
+			(*pReason) = MQRC_NOT_OPEN_FOR_INPUT;
+			return;
+		}
+	}
+
+	/* version 1 of the MQGMO always matches on the msg id and correl id */
+	if (gmo->Version >= MQGMO_VERSION_2)
+	{
+		matchOptions = gmo->MatchOptions;
+	}
+
+	queue = obj->queue;
+
+	if (gmo->Options & MQGMO_WAIT)
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		if (gmo->WaitInterval > 0)
+		{
+			deadline.tv_sec += gmo->WaitInterval / 1000;
+			deadline.tv_nsec += (long)(gmo->WaitInterval % 1000) * 1000000L;
+			if (deadline.tv_nsec >= 1000000000L)
+			{
+				deadline.tv_sec++;
+				deadline.tv_nsec -= 1000000000L;
+			}
+		}
+	}
+
+	pthread_mutex_lock(&(queue->lock));
+	while (1)
+	{
+		msg = findMessage(queue, obj, md, matchOptions, browse);
+		if (msg != NULL)
+		{
+			break;
+		}
+
+		/* source queues never run out of messages */
+		if (1 == queue->source)
+		{
+			msg = sourceMessage(conn, queue);
+			if (msg != NULL)
+			{
+				break;
+			}
+		}
+
+		if (0 == (gmo->Options & MQGMO_WAIT))
+		{
+			break;
+		}
+
+		/* wait for a new message to arrive */
+		if (MQWI_UNLIMITED == gmo->WaitInterval)
+		{
+			pthread_cond_wait(&(queue->arrived), &(queue->lock));
+		}
+		else
+		{
+			rc = pthread_cond_timedwait(&(queue->arrived), &(queue->lock), &deadline);
+			if (ETIMEDOUT == rc)
+			{
+				/* one last look before giving up */
+				msg = findMessage(queue, obj, md, matchOptions, browse);
+				break;
+			}
+		}
+	}
+
+	if (NULL == msg)
+	{
+		pthread_mutex_unlock(&(queue->lock));
+		(*pReason) = MQRC_NO_MSG_AVAILABLE;
+		return;
+	}
+
+	(*pDataLength) = msg->length;
+	copyLen = (msg->length < BufferLength) ? msg->length : BufferLength;
+	if (copyLen > 0)
+	{
+		memcpy(pBuffer, msg->data, copyLen);
+	}
+
+	putMD(md, &(msg->md));
+
+	if (gmo->Version >= MQGMO_VERSION_2)
+	{
+		memcpy(gmo->ResolvedQName, queue->name, strlen(queue->name));
+		memset(gmo->ResolvedQName + strlen(queue->name), ' ', MQ_Q_NAME_LENGTH - strlen(queue->name));
+	}
+
+	/* the message stays on the queue if it did not fit in the buffer */
+	if ((msg->length > BufferLength) && (0 == (gmo->Options & MQGMO_ACCEPT_TRUNCATED_MSG)))
+	{
+		pthread_mutex_unlock(&(queue->lock));
+		(*pCompCode) = MQCC_WARNING;
+		(*pReason) = MQRC_TRUNCATED_MSG_FAILED;
+		return;
+	}
+
+	if (1 == browse)
+	{
+		/* move the browse cursor */
+		obj->browseValid = 1;
+		obj->browsePrio = msg->md.Priority;
+		obj->browseSeq = msg->seq;
+	}
+	else
+	{
+		if ((gmo->Options & MQGMO_SYNCPOINT) || ((gmo->Options & MQGMO_SYNCPOINT_IF_PERSISTENT) && (MQPER_PERSISTENT == msg->md.Persistence)))
+		{
+			/* the message is removed when the unit of work is committed */
+			syncpoint = 1;
+			msg->state = MSG_GET_PENDING;
+		}
+		else
+		{
+			removeMessage(msg);
+			release = 1;
+		}
+	}
+
+	pthread_mutex_unlock(&(queue->lock));
+
+	if (1 == syncpoint)
+	{
+		msg->uowNext = conn->uow;
+		conn->uow = msg;
+	}
+
+	if (msg->length > BufferLength)
+	{
+		(*pCompCode) = MQCC_WARNING;
+		(*pReason) = MQRC_TRUNCATED_MSG_ACCEPTED;
+	}
+	else
+	{
+		(*pCompCode) = MQCC_OK;
+		(*pReason) = MQRC_NONE;
+	}
+
+	if (1 == release)
+	{
+		free(msg);
+	}
+}
+
+void MQENTRY MQINQ(MQHCONN Hconn, MQHOBJ Hobj, MQLONG SelectorCount, PMQLONG pSelectors, MQLONG IntAttrCount, PMQLONG pIntAttrs, MQLONG CharAttrLength, PMQCHAR pCharAttrs, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	int			i;
+	int			intCount=0;
+	MQLONG		charOfs=0;
+	MQLONG		reason=MQRC_NONE;
+	STUBCONN	*conn=findConn(Hconn);
+	STUBOBJECT	*obj=findObject(Hconn, Hobj);
+	const char	*value;
+
+	(*pCompCode) = MQCC_FAILED;
+
+	if (NULL == conn)
+	{
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	if (NULL == obj)
+	{
+		(*pReason) = MQRC_HOBJ_ERROR;
+		return;
+	}
+
+	if (0 == (obj->options & MQOO_INQUIRE))
+	{
+		(*pReason) = MQRC_NOT_OPEN_FOR_INQUIRE;
+		return;
+	}
+
+	for (i = 0; (i < SelectorCount) && (MQRC_NONE == reason); i++)
+	{
+		switch (pSelectors[i])
+		{
+		case MQIA_CURRENT_Q_DEPTH:
+		case MQIA_MAX_Q_DEPTH:
+		case MQIA_MAX_MSG_LENGTH:
+			{
+				if (intCount >= IntAttrCount)
+				{
+					reason = MQRC_INT_COUNT_TOO_SMALL;
+					break;
+				}
+
+				if (MQIA_MAX_MSG_LENGTH == pSelectors[i])
+				{
+					pIntAttrs[intCount] = STUB_MAX_MSG_LENGTH;
+				}
+				else if (NULL == obj->queue)
+				{
+					reason = MQRC_SELECTOR_ERROR;
+				}
+				else if (MQIA_MAX_Q_DEPTH == pSelectors[i])
+				{
+					pIntAttrs[intCount] = STUB_MAX_Q_DEPTH;
+				}
+				else
+				{
+					pthread_mutex_lock(&(obj->queue->lock));
+					pIntAttrs[intCount] = obj->queue->depth;
+					pthread_mutex_unlock(&(obj->queue->lock));
+				}
+
+				intCount++;
+				break;
+			}
+		case MQCA_Q_MGR_NAME:
+		case MQCA_Q_NAME:
+			{
+				if (MQCA_Q_MGR_NAME == pSelectors[i])
+				{
+					value = conn->qmgrName;
+				}
+				else if (obj->queue != NULL)
+				{
+					value = obj->queue->name;
+				}
+				else
+				{
+					reason = MQRC_SELECTOR_ERROR;
+					break;
+				}
+
+				if (charOfs + MQ_Q_NAME_LENGTH > CharAttrLength)
+				{
+					reason = MQRC_CHAR_ATTRS_TOO_SHORT;
+					break;
+				}
+
+				padName(pCharAttrs + charOfs, value, MQ_Q_NAME_LENGTH);
+				charOfs += MQ_Q_NAME_LENGTH;
+				break;
+			}
+		default:
+			{
+				reason = MQRC_SELECTOR_ERROR;
+				break;
+			}
+		}
+	}
+
+	(*pCompCode) = (MQRC_NONE == reason) ? MQCC_OK : MQCC_FAILED;
+	(*pReason) = reason;
+}
+
+void MQENTRY MQCMIT(MQHCONN Hconn, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	STUBCONN	*conn=findConn(Hconn);
+
+	if (NULL == conn)
+	{
+		(*pCompCode) = MQCC_FAILED;
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	endUOW(conn, 1);
+
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
+
+void MQENTRY MQBACK(MQHCONN Hconn, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	STUBCONN	*conn=findConn(Hconn);
+
+	if (NULL == conn)
+	{
+		(*pCompCode) = MQCC_FAILED;
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	endUOW(conn, 0);
+
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
+
+void MQENTRY MQSUB(MQHCONN Hconn, PMQVOID pSubDesc, PMQHOBJ pHobj, PMQHOBJ pHsub, PMQLONG pCompCode, PMQLONG pReason)
+
+{
+	MQSD		*sd=(MQSD *)pSubDesc;
+	MQHOBJ		hSub;
+	STUBOBJECT	*obj;
+	STUBQUEUE	*queue;
+	STUBSUB		*sub;
+
+	(*pCompCode) = MQCC_FAILED;
+
+	if (NULL == findConn(Hconn))
+	{
+		(*pReason) = MQRC_HCONN_ERROR;
+		return;
+	}
+
+	sub = (STUBSUB *)malloc(sizeof(STUBSUB));
+	if (NULL == sub)
+	{
+		(*pReason) = MQRC_STORAGE_NOT_AVAILABLE;
+		return;
+	}
+
+	sub->topic = getTopic(sd, &(sd->ObjectString), sd->ObjectName);
+	if (NULL == sub->topic)
+	{
+		free(sub);
+		(*pReason) = MQRC_TOPIC_STRING_ERROR;
+		return;
+	}
+
+	if (sd->Options & MQSO_MANAGED)
+	{
+		/* create a queue that only this subscription uses */
+		pthread_mutex_lock(&stubLock);
+		queue = createQueue("");
+		pthread_mutex_unlock(&stubLock);
+
+		if (queue != NULL)
+		{
+			(*pHobj) = newObject(Hconn, OBJ_QUEUE, MQOO_INPUT_SHARED | MQOO_BROWSE | MQOO_INQUIRE, queue);
+		}
+
+		if ((NULL == queue) || (0 == (*pHobj)))
+		{
+			free(sub->topic);
+			free(sub);
+			(*pHobj) = MQHO_UNUSABLE_HOBJ;
+			(*pReason) = MQRC_HANDLE_NOT_AVAILABLE;
+			return;
+		}
+	}
+	else
+	{
+		/* publications go to the queue the caller opened */
+		obj = findObject(Hconn, *pHobj);
+		if ((NULL == obj) || (NULL == obj->queue))
+		{
+			free(sub->topic);
+			free(sub);
+			(*pReason) = MQRC_HOBJ_ERROR;
+			return;
+		}
+
+		queue = obj->queue;
+	}
+
+	sub->queue = queue;
+
+	hSub = newObject(Hconn, OBJ_SUB, 0, NULL);
+	if (0 == hSub)
+	{
+		free(sub->topic);
+		free(sub);
+		(*pReason) = MQRC_HANDLE_NOT_AVAILABLE;
+		return;
+	}
+
+	objects[hSub - 1].sub = sub;
+
+	pthread_mutex_lock(&stubLock);
+	sub->next = subs;
+	subs = sub;
+	pthread_mutex_unlock(&stubLock);
+
+	(*pHsub) = hSub;
+	(*pCompCode) = MQCC_OK;
+	(*pReason) = MQRC_NONE;
+}
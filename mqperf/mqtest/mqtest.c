@@ -59,6 +59,8 @@ Jim MacNair - Initial Contribution
 /* parameter file processing routines */
 #include "parmline.h"
 #include "putparms.h"
+#include "capsubs.h"
+#include "gensubs.h"
 
 /* MQ subroutines include */
 #include "qsubs.h"
@@ -579,36 +581,35 @@ int putMessage(char * msgdata,
 	return compcode;
 }
 
-void processMessageFile(const char * fileName, PUTPARMS * parms)
+/**************************************************************/
+/*                                                            */
+/* Write the messages in a buffer.  The messages are          */
+/* separated by delimiters, or msgEnds gives the offset of    */
+/* the end of each message.  The buffer and the msgEnds area  */
+/* are released.                                              */
+/*                                                            */
+/**************************************************************/
+
+void putMessages(char * filedata, size_t filedatalen, size_t * msgEnds, size_t msgCount, size_t delimLen, PUTPARMS * parms)
 
 {
 	size_t			msglen=0;
-	size_t			filedatalen=0;
+	size_t			nextMsg=0;
 	MQLONG			cc=MQCC_OK;
 	MQLONG			mLen=0;
-	int				rc;
 	char *			mqmdptr=NULL;
 	char *			buffer=NULL;
 	const char *	ptr;
 
 	/* pointer to data file areas */
-	char *	filedata=NULL;
-	char *	filedataOfs=NULL;
 	char *	allocPtr=NULL;
 	char *	mqdata=NULL;
 	char	formTime[16];
 
-	memset(puttime, 0, sizeof(puttime));
-
-	/* process this line as a message data file name */
-	/* read the message data file */
-	rc = readFileData(fileName, &filedatalen, &filedata, parms);
-
 	/* point to the beginning of the data */
 	buffer = filedata;
 
-	/* was the read file successful? */
-	if ((0 == rc) && (filedata != NULL))
+	if (filedata != NULL)
 	{
 		/* check if we have a connection to the queue manager */
 		connectQM(parms);
@@ -616,10 +617,19 @@ void processMessageFile(const char * fileName, PUTPARMS * parms)
 		/* check if the queue has been opened */
 		openQ(parms);
 
-		while ((0 == terminate) && (filedatalen > 0))
+		/* messages found with msgEnds can be empty */
+		while ((0 == terminate) && ((filedatalen > 0) || (nextMsg < msgCount)))
 		{
 			/* check for delimiters in the data */
-			ptr = scanForDelim(buffer, filedatalen, parms);
+			if (msgEnds != NULL)
+			{
+				ptr = (nextMsg + 1 < msgCount) ? filedata + msgEnds[nextMsg] : NULL;
+				nextMsg++;
+			}
+			else
+			{
+				ptr = scanForDelim(buffer, filedatalen, parms);
+			}
 
 			if (ptr != NULL)
 			{
@@ -745,30 +755,88 @@ void processMessageFile(const char * fileName, PUTPARMS * parms)
 
 
 			/* update the data pointer */
-			buffer += (msglen + parms->delimiterLen);
+			buffer += (msglen + delimLen);
 
 			/* decrement the remaining length */
 			filedatalen -= msglen;
 
 			/* check if a delimiter was found */
-			if ((ptr != NULL) && (filedatalen >= parms->delimiterLen))
+			if ((ptr != NULL) && (filedatalen >= delimLen))
 			{
 				/* calculate the remaining bytes */
-				filedatalen -= parms->delimiterLen;
+				filedatalen -= delimLen;
 			}
 		}
 	}
+
+	if (filedata != NULL)
+	{
+		releaseFileData(filedata);
+	}
+
+	if (msgEnds != NULL)
+	{
+		free(msgEnds);
+	}
+}
+
+void processMessageFile(const char * fileName, PUTPARMS * parms)
+
+{
+	size_t			filedatalen=0;
+	size_t			delimLen=parms->delimiterLen;
+	size_t			*msgEnds=NULL;		/* end of each message in an indexed capture file */
+	size_t			msgCount=0;
+	int				rc;
+	char *			filedata=NULL;
+	char *			allocPtr=NULL;
+
+	memset(puttime, 0, sizeof(puttime));
+
+	/* process this line as a message data file name */
+	/* read the message data file */
+	rc = readFileData(fileName, &filedatalen, &filedata, parms);
+
+	/* check for an indexed capture file */
+	if ((0 == rc) && (filedata != NULL) && isCapFile(filedata, filedatalen))
+	{
+		/* expand the file - the index replaces the delimiters */
+		allocPtr = expandCapFile(filedata, filedatalen, &filedatalen, &msgEnds, &msgCount);
+		releaseFileData(filedata);
+		filedata = allocPtr;
+		delimLen = 0;
+	}
+
+	/* was the read file successful? */
+	if (0 == rc)
+	{
+		putMessages(filedata, filedatalen, msgEnds, msgCount, delimLen, parms);
+	}
 	else
 	{
-		if (rc != 0)
-		{
-			Log("Error reading file %s - rc %d", fileName, rc);
-		}
+		Log("Error reading file %s - rc %d", fileName, rc);
 	}
+}
 
-	if (filedata != NULL)
+/**************************************************************/
+/*                                                            */
+/* Write the messages built by the generator, after the      */
+/* messages in the data files.                                */
+/*                                                            */
+/**************************************************************/
+
+void processGeneratedData(PUTPARMS * parms)
+
+{
+	size_t	datalen=0;
+	size_t	*msgEnds=NULL;
+	size_t	msgCount=0;
+	char *	msgdata;
+
+	msgdata = generateData(parms, &datalen, &msgEnds, &msgCount);
+	if (msgdata != NULL)
 	{
-		free(filedata);
+		putMessages(msgdata, datalen, msgEnds, msgCount, 0, parms);
 	}
 }
 
@@ -931,6 +999,12 @@ int main(int argc, char **argv)
 		procParmFile(parmfile, &parms);
 
 		fclose(parmfile);
+
+		/* write any generated messages */
+		if ((parms.genCount > 0) && (0 == terminate))
+		{
+			processGeneratedData(&parms);
+		}
 	}
 	else
 	{
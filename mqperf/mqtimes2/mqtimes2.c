@@ -23,12 +23,39 @@ Jim MacNair - Initial Contribution
 /*      -m queue manager name (optional)                            */
 /*      -b batch size (number of messages in a unit of work)        */
 /*      -p drain queue before starting measurements                 */
+/*      -n number of consumer threads                               */
 /*                                                                  */
 /*    if no queue manager is specified, the default queue manager   */
 /*    is used.                                                      */
 /*                                                                  */
 /********************************************************************/
 
+/********************************************************************/
+/*                                                                  */
+/* Changes in V3.1                                                  */
+/*                                                                  */
+/* 1) Added threads parameter (and -n override) to read messages    */
+/*    with multiple consumer threads.  Each consumer has its own    */
+/*    connection, buffer and unit of work.  The main thread reports */
+/*    the combined rate once a second from per-consumer counters.   */
+/* 2) Replaced the fixed latency range counters with a histogram    */
+/*    and report latency percentiles at the end of the run.         */
+/* 3) Latencies are measured and reported in nanoseconds.           */
+/* 4) Added statsFile parameter to write a CSV or JSON lines record */
+/*    for each reporting interval and a summary record at the end.  */
+/* 5) Added autoBatch parameter to change the batch size while      */
+/*    reading to find the one with the highest rate.                */
+/* 6) The rate and latency are also reported for a steady window,   */
+/*    after the warmupTime and warmupCount parameters have passed   */
+/*    and once the rate varies by less than steadyCov percent over  */
+/*    steadyWindow seconds.                                         */
+/* 7) Added wallClock parameter to use the time of day for the time */
+/*    stamps, so the messages can be written on another machine.    */
+/*    A latency that is negative or more than a day is reported     */
+/*    once, since it means the time stamps came from another clock. */
+/*                                                                  */
+/********************************************************************/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -44,67 +71,1232 @@ Jim MacNair - Initial Contribution
 #include <cmqc.h>
 #include <cmqxc.h>
 
-#ifdef SOLARIS
-#include <sys/types.h>
-#endif
+#ifdef SOLARIS
+#include <sys/types.h>
+#endif
+
+#ifndef WIN32
+#include <unistd.h>
+
+void Sleep(int amount)
+{
+	usleep(amount*1000);
+}
+#endif
+
+#include "int64defs.h"
+#include "comsubs.h"
+#include "timesubs.h"
+#include "parmline.h"
+#include "putparms.h"
+#include "qsubs.h"
+#include "rfhsubs.h"
+#include "thrdsubs.h"
+#include "histsubs.h"
+#include "statsubs.h"
+#include "batchsubs.h"
+#include "steadysubs.h"
+
+/* global error switch */
+	int		err=0;
+
+/* global termination switch */
+	volatile int	terminate=0;
+	volatile int	cancelled=0;
+
+/* number of messages claimed by the consumer threads */
+	volatile int64_t	msgsClaimed=0;
+
+/* set once the user has been told that the time stamps are wrong */
+	volatile int	clockWarned=0;
+
+/* longer latencies mean the time stamp is from a different clock */
+#define MAX_LATENCY_NS	(86400 * (int64_t)1000000000)
+
+static char copyright[] = "(C) Copyright IBM Corp, 2001/2002/2004/2005/2014";
+static char Version[]=\
+"@(#)MQTimes2 V3.1 - MQ Performance results tool  - Jim MacNair ";
+
+#ifdef _DEBUG
+static char Level[]="mqtimes2.c V3.1 Debug version ("__DATE__" "__TIME__")";
+#else
+#ifdef MQCLIENT
+static char Level[]="mqtimes2c.c V3.1 Client version ("__DATE__" "__TIME__")";
+#else
+static char Level[]="mqtimes2.c V3.1 Release version ("__DATE__" "__TIME__")";
+#endif
+#endif
+
+/**************************************************************/
+/*                                                            */
+/* Latency counters.  All times are in nanoseconds.           */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int64_t		currLatency;		/* last observed latency */
+	HISTOGRAM	hist;				/* all latencies observed */
+} LATENCYDATA;
+
+/**************************************************************/
+/*                                                            */
+/* Rate counters used to report each interval.                */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int64_t		maxrate;
+	int64_t		firstsec;
+	int64_t		secondcount;
+	int64_t		last10[10];			/* Average rate of last 10 intervals */
+	int64_t		last10secs[10];		/* time of last 10 intervals */
+	int64_t		lastLatencyCount;
+	int64_t		lastBytes;			/* total bytes at the end of the last interval */
+	HISTOGRAM	lastHist;			/* latencies at the end of the last interval */
+	STATSFILE	*stats;				/* interval statistics file or NULL */
+	STEADYSTATE	steady;				/* steady state window */
+	int			firstInterval;		/* first interval indicator to not report recent average */
+	int			reportCount;
+	time_t		firstTime;
+	time_t		secondTime;
+	time_t		lastTime;
+	time_t		prevLastTime;
+	char		*msgPtr;
+	char		msgArea[10240];
+} INTERVALDATA;
+
+/**************************************************************/
+/*                                                            */
+/* Counters published by a consumer thread.  The seq field    */
+/* is odd while the consumer is updating the counters, so     */
+/* the reporting thread can take a consistent copy without    */
+/* any locks.  The latency histogram is kept separately in    */
+/* the consumer work area, so the copy stays small.           */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	volatile int	seq;
+	int64_t			msgCount;
+	int64_t			byteCount;
+	int64_t			currLatency;		/* last observed latency */
+	int64_t			latCount;
+	int64_t			latTotal;
+	int64_t			latMin;
+	int64_t			latMax;
+} CONSUMERSTATS;
+
+/**************************************************************/
+/*                                                            */
+/* Work area for each consumer thread.                        */
+/*                                                            */
+/**************************************************************/
+
+typedef struct {
+	int				threadNum;			/* thread number, starting with 1  */
+	char			label[16];			/* prefix for thread log messages  */
+	MQHCONN			qm;					/* queue manager connection handle */
+	MQHOBJ			q;					/* input queue handle              */
+	int				rc;					/* return code from the thread     */
+	volatile int	ready;				/* queue is open (and drained)     */
+	volatile int	ended;				/* thread has finished             */
+	MY_TIME_T		firstMsgTime;		/* arrival time of first message   */
+	MY_TIME_T		lastMsgTime;		/* arrival time of last message    */
+	CONSUMERSTATS	stats;
+	volatile int64_t	latCounts[HIST_SIZE];	/* histogram counts, which only ever go up */
+	BATCHTUNE		batchTune;			/* automatic batch size            */
+	PUTPARMS		parms;				/* private copy of the parameters  */
+} CONSUMER;
+
+void InterruptHandler (int sigVal)
+{
+	/* force program to end */
+	terminate = 1;
+
+	/* indicate user cancelled the program */
+	cancelled = 1;
+}
+
+void printHelp(char *pgmName)
+
+{
+	printf("\nformat is:\n");
+	printf("   %s <-c Count> <-q Queue> <-m Queue manager> <-f Parameters file> <-p> <-b nnn> <-n threads> <-j Statistics file>\n", pgmName);
+	printf("    Count is the number of messages to read before stopping.\n");
+	printf("    Queue is the name of the queue to read messages from.\n");
+#ifdef MQCLIENT
+	printf("    Queue manager is the name of the queue manager that holds the input queue\n");
+	printf("     or the format of an MQSERVER variable - channel name/TCP/hostname(port).\n");
+#else
+	printf("    Queue manager is the name of the queue manager that holds the input queue.\n");
+#endif
+	printf("    The -p option will purge the queue before starting the measurement.\n");
+	printf("     Any messages in the queue will be discarded.\n");
+	printf("    The -b option specifies the number of messages in a single unit of work.\n");
+	printf("    The -n option specifies the number of consumer threads.  With more than\n");
+	printf("     one thread the intervals are based on the time the messages are read\n");
+	printf("     rather than the MQMD put time.\n");
+	printf("    The -j option overrides the statsFile parameter.\n");
+	printf("    If the program must respond to either PAN or NAN report options, a file\n");
+	printf("     containing the data to be used for the reply message must be provided\n");
+	printf("     and specified in the parameters file.\n");
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add a latency observation to the counters.                 */
+/*                                                            */
+/**************************************************************/
+
+void recordLatency(LATENCYDATA *lat, int64_t diff)
+
+{
+	lat->currLatency = diff;
+	addToHistogram(&(lat->hist), diff);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Add the latency counters of one consumer to a total.  The  */
+/* histogram counts are read while the consumer is running,   */
+/* so they can include a few messages more than the copy of   */
+/* the other counters.  The count is taken from the histogram */
+/* so the percentiles are consistent.                         */
+/*                                                            */
+/**************************************************************/
+
+void mergeLatency(LATENCYDATA *total, const CONSUMER *cons, const CONSUMERSTATS *snap)
+
+{
+	int		i;
+
+	if (0 == snap->latCount)
+	{
+		return;
+	}
+
+	for (i = 0; i < HIST_SIZE; i++)
+	{
+		total->hist.counts[i] += cons->latCounts[i];
+		total->hist.count += cons->latCounts[i];
+	}
+
+	total->hist.total += snap->latTotal;
+
+	if ((0 == total->hist.min) || (snap->latMin < total->hist.min))
+	{
+		total->hist.min = snap->latMin;
+	}
+
+	if (snap->latMax > total->hist.max)
+	{
+		total->hist.max = snap->latMax;
+	}
+
+	total->currLatency = snap->currLatency;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Calculate the latency of a message that was just read.     */
+/*                                                            */
+/* This assumes that the first 8 bytes of the message plus    */
+/* offset contains a performance counter.  A queue manager    */
+/* name is placed after the counter, which must also match.   */
+/* Otherwise the timestamp is hidden in the MQMD Accounting   */
+/* Token, Correlation ID or Group ID fields or the RFH2 usr   */
+/* folder.  This requires the same setTimeStamp options have  */
+/* been used with MQPUT2.                                     */
+/*                                                            */
+/* Returns zero if no valid start time was found.             */
+/*                                                            */
+/**************************************************************/
+
+int64_t getLatency(PUTPARMS *parms, MQMD2 *msgdesc, char *msgdata, MQLONG datalen, int minSize)
+
+{
+	int64_t		diff=0;
+	char		*userPtr;
+	MY_TIME_T	endTime;			/* high performance counter to measure latency */
+	MY_TIME_T	startTime;			/* high performance counter to measure latency */
+
+	/* zero out the time the message was sent to detect if a valid start time was not found */
+	clearTime(&startTime);
+
+	/* get the current time (time message has arrived) */
+	GetTime(&endTime);
+
+	/* check if we have an RFH header */
+	userPtr = checkForRFH(msgdata, msgdesc);
+
+	/* check if the timestamp is in the MQMD accounting token field */
+	if (1 == parms->timeStampInAccountingToken)
+	{
+		/* get the start time from the MQMD Accounting Token field */
+		memcpy(&startTime, msgdesc->AccountingToken, sizeof(MY_TIME_T));
+	}
+	else if (1 == parms->timeStampInCorrelId)
+	{
+		/* get the start time from the MQMD Correlation ID field */
+		memcpy(&startTime, msgdesc->CorrelId, sizeof(MY_TIME_T));
+	}
+	else if (1 == parms->timeStampInGroupId)
+	{
+		/* get the start time from the MQMD Group ID field */
+		memcpy(&startTime, msgdesc->GroupId, sizeof(MY_TIME_T));
+	}
+	else if (1 == parms->timeStampUserProp)
+	{
+		/* get the start time from the RFH2 usr folder */
+		getRFHUsrTimeStamp(msgdata, datalen, &startTime);
+	}
+	else
+	{
+		/* check if the message is long enough */
+		if (datalen > minSize + parms->timeStampOffset)
+		{
+			/* check if the queue manager name matches */
+			if (strcmp(userPtr + parms->timeStampOffset + sizeof(MY_TIME_T), parms->qmname) == 0)
+			{
+				/* get the start time */
+				memcpy(&startTime, userPtr + parms->timeStampOffset, sizeof(MY_TIME_T));
+			}
+		}
+	}
+
+	/* make sure both counters are not zero */
+	if ((endTime != 0) && (startTime != 0))
+	{
+		diff = DiffTimeNs(startTime, endTime);
+		if ((diff <= 0) || (diff > MAX_LATENCY_NS))
+		{
+			/* every message will be the same, so only tell the user once */
+			if (0 == clockWarned)
+			{
+				clockWarned = 1;
+				Log("***** Invalid latency detected - diff " FMTI64 " ns", diff);
+				Log("***** The time stamps were set on another machine or with a different clock");
+				Log("***** Set wallClock=Y for both programs if the messages are written on another machine");
+			}
+
+			diff = 0;
+		}
+	}
+
+	return diff;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Report the message count for an interval that has ended.   */
+/* The secs parameter is the length of the interval.          */
+/*                                                            */
+/**************************************************************/
+
+void endInterval(INTERVALDATA *intv,
+				 const char *timeLabel,
+				 int64_t msgcount,
+				 int64_t totcount,
+				 int64_t totalbytes,
+				 int64_t secs,
+				 LATENCYDATA *lat,
+				 int reportInterval)
+
+{
+	int64_t		recent10;
+	int64_t		recent10sec;
+	int64_t		tempLatency;
+	double		avgrate;
+	int			i;
+	char		lastLatency[16];
+	char		avgLatency[16];
+	char		minLat[16];
+	char		maxLat[16];
+	char		tempCount[16];
+	char		tempTotal[16];
+	char		tempAvg[32];
+	STATSRECORD	rec;
+	HISTOGRAM	intervalHist;
+
+	/* is this the first interval? */
+	if (0 == intv->firstInterval)
+	{
+		/* get the totals of the last 10 intervals */
+		recent10 = 0;
+		recent10sec = 0;
+		for (i=9; i>0; i--)
+		{
+			/* shift all the counts and times one position */
+			intv->last10secs[i] = intv->last10secs[i - 1];
+			intv->last10[i] = intv->last10[i - 1];
+
+			/* get the total number of messages and seconds */
+			recent10 += intv->last10[i - 1];
+			recent10sec += intv->last10secs[i-1];
+		}
+
+		/* record the number of seconds in this interval */
+		intv->last10secs[0] = secs;
+
+		/* get the most recent count */
+		intv->last10[0] = msgcount;
+		recent10 += msgcount;
+		recent10sec += intv->last10secs[0];
+
+		avgrate = (double)recent10 / recent10sec;
+	}
+	else
+	{
+		/* start reporting the recent average the next time */
+		intv->firstInterval = 0;
+		avgrate = 0.0;
+	}
+
+	/* get the count as a string */
+	sprintf(tempCount, FMTI64, msgcount);
+	sprintf(tempTotal, FMTI64, totcount);
+
+	/* write out the number of messages in this second */
+	if (lat->hist.count > intv->lastLatencyCount)
+	{
+		/* only report if it changes */
+		intv->lastLatencyCount = lat->hist.count;
+
+		/* calculate the average latency */
+		tempLatency = lat->hist.total / lat->hist.count;
+
+		/* get the latencies into printable format */
+		formatTimeDiffNs(lastLatency, lat->currLatency);
+		formatTimeDiffNs(avgLatency, tempLatency);
+		formatTimeDiffNs(minLat, lat->hist.min);
+		formatTimeDiffNs(maxLat, lat->hist.max);
+
+		/* display the results */
+		sprintf(intv->msgPtr,"%s %7.7s msgs - rec avg = %7.2f total msgs %9.9s Latency last %s avg %s min %s max %s latencyCount " FMTI64 " msgCount " FMTI64,
+				timeLabel, tempCount, avgrate, tempTotal, lastLatency, avgLatency, minLat, maxLat, lat->hist.count, totcount);
+	}
+	else
+	{
+		/* check if the average rate is > 0 */
+		if (avgrate > 0.0)
+		{
+			/* get the average rate */
+			sprintf(tempAvg, " - recent average %9.2f", avgrate);
+		}
+		else
+		{
+			/* just create a zero length string */
+			tempAvg[0] = 0;
+		}
+
+		/* create a message to display */
+		sprintf(intv->msgPtr,"%s %7.7s msgs%s total msgs %9.9s", timeLabel, tempCount, tempAvg, tempTotal);
+	}
+
+	intv->msgPtr += strlen(intv->msgPtr);
+
+	intv->reportCount++;
+	if (intv->reportCount >= reportInterval)
+	{
+		Log("%s", intv->msgArea);
+		intv->reportCount = 0;
+		intv->msgPtr = intv->msgArea;
+		intv->msgArea[0] = 0;
+	}
+
+	/* write the interval to the statistics file */
+	if (intv->stats != NULL)
+	{
+		memset(&rec, 0, sizeof(rec));
+		rec.type = "interval";
+		rec.label = timeLabel;
+		rec.secs = secs;
+		rec.msgs = msgcount;
+		rec.bytes = totalbytes - intv->lastBytes;
+		rec.totalMsgs = totcount;
+		rec.avgRate = avgrate;
+		rec.depth = -1;
+
+		if (secs > 0)
+		{
+			rec.rate = (double)msgcount / secs;
+		}
+
+		/* get the latencies for this interval only */
+		subtractHistogram(&intervalHist, &(lat->hist), &(intv->lastHist));
+		setStatsLatency(&rec, &intervalHist);
+		memcpy(&(intv->lastHist), &(lat->hist), sizeof(HISTOGRAM));
+
+		writeStatsRecord(intv->stats, &rec);
+	}
+
+	intv->lastBytes = totalbytes;
+
+	/* is this the first time through? */
+	if (0 == intv->firstsec)
+	{
+		/* remember count in first second */
+		intv->firstsec = msgcount;
+	}
+
+	/* keep track of the maximum message rate */
+	if (msgcount > intv->maxrate)
+	{
+		intv->maxrate = msgcount;
+	}
+
+	/* count the number of individual seconds with at least one message */
+	intv->secondcount++;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Report the last interval at the end of the run, so the     */
+/* statistics file holds every message in the summary.  The   */
+/* last interval can be part of a second.  Any lines held     */
+/* back by the report interval are written as well.           */
+/*                                                            */
+/**************************************************************/
+
+void endLastInterval(INTERVALDATA *intv,
+					 const char *timeLabel,
+					 int64_t msgcount,
+					 int64_t totcount,
+					 int64_t totalbytes,
+					 int64_t secs,
+					 LATENCYDATA *lat)
+
+{
+	if (msgcount > 0)
+	{
+		if (secs < 1)
+		{
+			secs = 1;
+		}
+
+		/* a report interval of 1 writes the lines now */
+		endInterval(intv, timeLabel, msgcount, totcount, totalbytes, secs, lat, 1);
+	}
+	else if (intv->msgPtr != intv->msgArea)
+	{
+		Log("%s", intv->msgArea);
+		intv->reportCount = 0;
+		intv->msgPtr = intv->msgArea;
+		intv->msgArea[0] = 0;
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Display the totals at the end of the run.                  */
+/*                                                            */
+/**************************************************************/
+
+void printResults(INTERVALDATA *intv,
+				  int64_t totcount,
+				  int64_t totalbytes,
+				  int64_t msgcount,
+				  LATENCYDATA *lat,
+				  int setTimeStamp)
+
+{
+	int64_t		avgbytes;
+	int64_t		avgLat;
+	double		avgrate=0.0;
+	int			secs;				/* work variable - number of seconds between first and last interval */
+	char		timeFirst[16];
+	char		timeLast[16];
+	char		avgLatency[16];
+	char		minLat[16];
+	char		maxLat[16];
+	char		percentiles[160];
+	STATSRECORD	rec;
+
+	/* dump out the total message count */
+	Log("\nTotal messages " FMTI64, totcount);
+
+	/* give the total and average message size */
+	if (totcount > 0)
+	{
+		/* calculate the average bytes per message */
+		avgbytes = totalbytes / totcount;
+		Log("total bytes in all messages " FMTI64, totalbytes);
+		Log("average message size " FMTI64, avgbytes);
+	}
+
+	/* indicate the number of seconds with at least one message */
+	Log("Total number of seconds with at least one message " FMTI64, intv->secondcount);
+
+	/* write out the average message rate, ignoring the first and last intervals */
+	if (intv->secondcount > 2)
+	{
+		formatTimeSecs(timeLast, intv->lastTime);
+		formatTimeSecs(timeFirst, intv->firstTime);
+		Log("First time %s Last time %s seconds %d", timeFirst, timeLast, (int)(difftime(intv->lastTime, intv->firstTime)) + 1);
+		secs = (int)(difftime(intv->prevLastTime, intv->secondTime)) - 1;
+
+		/* avoid any divide by zeros */
+		if (secs > 0)
+		{
+			avgrate = (float)(totcount - intv->firstsec - msgcount) / secs;
+			Log("Average message rate except first and last intervals %7.2f", avgrate);
+		}
+	}
+
+	/* print out the maximum rate */
+	Log("Peak message rate " FMTI64, intv->maxrate);
+
+	/* check if latency numbers were requested */
+	if (1 == setTimeStamp)
+	{
+		if (0 == lat->hist.count)
+		{
+			Log("\nLatency was requested but the counter is 0");
+		}
+		else
+		{
+			/* calculate the average latency */
+			avgLat = lat->hist.total / lat->hist.count;
+
+			/* get the latencies into printable format */
+			formatTimeDiffNs(avgLatency, avgLat);
+			formatTimeDiffNs(minLat, lat->hist.min);
+			formatTimeDiffNs(maxLat, lat->hist.max);
+
+			/* display the results */
+			Log("\nAverage Latency %s - min %s max %s number  of msgs " FMTI64, avgLatency, minLat, maxLat, lat->hist.count);
+
+			/* display the latency percentiles */
+			formatPercentiles(percentiles, &(lat->hist));
+			Log("Latency %s", percentiles);
+		}
+	}
+
+	/* write the totals to the statistics file */
+	if (intv->stats != NULL)
+	{
+		memset(&rec, 0, sizeof(rec));
+		rec.type = "summary";
+		rec.label = "total";
+		rec.secs = intv->secondcount;
+		rec.msgs = totcount;
+		rec.bytes = totalbytes;
+		rec.totalMsgs = totcount;
+		rec.rate = avgrate;
+		rec.avgRate = avgrate;
+		rec.depth = -1;
+		setStatsLatency(&rec, &(lat->hist));
+
+		writeStatsRecord(intv->stats, &rec);
+	}
+
+	/* report the rate and latency in the steady window */
+	reportSteadyState(&(intv->steady), intv->stats);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Remove any messages from the queue before the measurement  */
+/* starts.                                                    */
+/*                                                            */
+/**************************************************************/
+
+void drainQueue(MQHCONN qm, MQHOBJ q, char *msgdata, PUTPARMS *parms)
+
+{
+	int			uow=0;
+	int			drainCount=0;
+	MQLONG		datalen=0;
+	MQLONG		compcode;
+	MQLONG		reason;
+	MQMD2		msgdesc = {MQMD2_DEFAULT};
+	MQGMO		mqgmo = {MQGMO_DEFAULT};
+
+	Log("draining queue");
+	compcode = MQCC_OK;
+	while (compcode == MQCC_OK)
+	{
+		if (parms->batchSize > 1)
+		{
+			mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_SYNCPOINT | MQGMO_ACCEPT_TRUNCATED_MSG;
+		}
+		else
+		{
+			mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_ACCEPT_TRUNCATED_MSG;
+		}
+
+		/* reset the msgid and correlid */
+		memcpy(msgdesc.MsgId, MQMI_NONE, sizeof(msgdesc.MsgId));
+		memcpy(msgdesc.CorrelId, MQCI_NONE, sizeof(msgdesc.CorrelId));
+		memcpy(msgdesc.GroupId, MQGI_NONE, sizeof(msgdesc.GroupId));
+
+		/* perform the MQGET */
+		MQGET(qm, q, &msgdesc, &mqgmo, parms->maxmsglen, msgdata, &datalen, &compcode, &reason);
+
+		if ((MQCC_WARNING == compcode) && (reason == 2079))
+		{
+			compcode = MQCC_OK;
+			reason = 0;
+		}
+
+		/* check if we got a message */
+		if (MQCC_OK == compcode)
+		{
+			uow++;
+			drainCount++;
+
+			if ((parms->batchSize > 1) && (uow > parms->batchSize))
+			{
+				MQCMIT(qm, &compcode, &reason);
+				uow = 0;
+			}
+		}
+	}
+
+	if ((parms->batchSize > 1) && (uow > parms->batchSize))
+	{
+		MQCMIT(qm, &compcode, &reason);
+		uow = 0;
+	}
+
+	if (drainCount > 0)
+	{
+		Log("%d messages drained from Q prior to measurement start", drainCount);
+	}
+}
+
+/**************************************************************/
+/*                                                            */
+/* Consumer thread.  Reads messages until the total count     */
+/* has been claimed by all the consumers, the wait time       */
+/* expires or the program is cancelled.                       */
+/*                                                            */
+/**************************************************************/
+
+void consumerThread(void *arg)
+
+{
+	CONSUMER	*cons=(CONSUMER *)arg;
+	PUTPARMS	*parms=&(cons->parms);
+	CONSUMERSTATS	*stats=&(cons->stats);
+	int64_t		diff;
+	MQLONG		datalen=0;
+	int			minSize;
+	int			uow=0;
+	int			remainingTime=0;
+	MQLONG		report;				/* MQ report options */
+	MQLONG		compcode;
+	MQLONG		reason;
+	MQLONG		cc2;
+	MQLONG		rc2;
+	MQOD		objdesc = {MQOD_DEFAULT};
+	MQMD2		msgdesc = {MQMD2_DEFAULT};
+	MQLONG		openopt = 0;
+	MQGMO		mqgmo = {MQGMO_DEFAULT};
+	char		*msgdata;
+
+	/* Connect to the queue manager */
+#ifdef MQCLIENT
+	clientConnect2QM(parms->qmname, &(cons->qm), &(parms->maxmsglen), &compcode, &reason);
+#else
+	/* each thread must have its own connection handle */
+	connectX2QM(parms->qmname, MQCNO_HANDLE_SHARE_NONE, &(cons->qm), &compcode, &reason);
+#endif
+
+	/* check for errors */
+	checkerror("MQCONN", compcode, reason, parms->qmname);
+	if (compcode != MQCC_OK)
+	{
+		cons->rc = 98;
+		terminate = 1;
+		cons->ended = 1;
+		return;
+	}
+
+	/* allocate a buffer for the message */
+	msgdata = (char *)malloc(parms->maxmsglen);
+	if (NULL == msgdata)
+	{
+		Log("%sMemory allocation failed", cons->label);
+		MQDISC(&(cons->qm), &compcode, &reason);
+		cons->rc = 95;
+		terminate = 1;
+		cons->ended = 1;
+		return;
+	}
+
+	memset(msgdata, 0, parms->maxmsglen);
+
+	/* set the queue open options */
+	strncpy(objdesc.ObjectName, parms->qname, MQ_Q_NAME_LENGTH);
+	openopt = MQOO_INPUT_SHARED | MQOO_FAIL_IF_QUIESCING;
+
+	/* open the queue for input */
+	MQOPEN(cons->qm, &objdesc, openopt, &(cons->q), &compcode, &reason);
+
+	/* check for errors */
+	checkerror("MQOPEN", compcode, reason, parms->qname);
+	if (compcode != MQCC_OK)
+	{
+		free(msgdata);
+		MQDISC(&(cons->qm), &compcode, &reason);
+		cons->rc = 97;
+		terminate = 1;
+		cons->ended = 1;
+		return;
+	}
+
+	/* calculate the minimum message size to check for latency calculations */
+	minSize = iStrLen(parms->qmname) + (int)sizeof(MY_TIME_T) + 1;
+
+	/* the first consumer drains the queue before the others start */
+	if ((1 == cons->threadNum) && (parms->drainQ > 0))
+	{
+		drainQueue(cons->qm, cons->q, msgdata, parms);
+	}
+
+	/* get ready to change the batch size if requested */
+	initBatchTune(&(cons->batchTune), parms, &(parms->batchSize), cons->label);
+
+	cons->ready = 1;
+
+	/* enter get message loop */
+	compcode = MQCC_OK;
+	while ((MQCC_OK == compcode) && (0 == terminate))
+	{
+		/* reserve the next message so the total is not exceeded */
+		if (atomicAdd64(&msgsClaimed, 1) > parms->totcount)
+		{
+			break;
+		}
+
+		/* set the get message options */
+		if (parms->batchSize > 1)
+		{
+			mqgmo.Options = MQGMO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_SYNCPOINT | MQGMO_ACCEPT_TRUNCATED_MSG;
+		}
+		else
+		{
+			mqgmo.Options = MQGMO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_NO_SYNCPOINT | MQGMO_ACCEPT_TRUNCATED_MSG;
+		}
+
+		mqgmo.MatchOptions = MQGMO_NONE;
+
+		/* reset the msgid and correlid */
+		memcpy(msgdesc.MsgId, MQMI_NONE, sizeof(msgdesc.MsgId));
+		memcpy(msgdesc.CorrelId, MQCI_NONE, sizeof(msgdesc.CorrelId));
+		memcpy(msgdesc.GroupId, MQGI_NONE, sizeof(msgdesc.GroupId));
+
+		remainingTime = parms->maxtime;
+		do
+		{
+			/* only wait for 1 second */
+			mqgmo.WaitInterval = 1000;
+			remainingTime--;
+
+			/* perform the MQGET */
+			MQGET(cons->qm, cons->q, &msgdesc, &mqgmo, parms->maxmsglen, msgdata, &datalen, &compcode, &reason);
+
+			/* check for time out with unit of work open */
+			if ((MQCC_FAILED == compcode) && (2033 == reason) && (parms->batchSize > 1) && (uow > 0))
+			{
+				/* not busy - avoid long-running unit of work */
+				MQCMIT(cons->qm, &cc2, &rc2);
+				checkerror("MQCMIT2", cc2, rc2, parms->qmname);
+				if (MQCC_OK == cc2)
+				{
+					uow = 0;
+				}
+			}
+		} while ((remainingTime > 0) && (MQCC_FAILED == compcode) && (2033 == reason) && (0 == terminate));
+
+		/* check for truncated message */
+		if ((MQCC_WARNING == compcode) && (reason == 2079))
+		{
+			/* accept truncated messages */
+			compcode = MQCC_OK;
+			reason = 0;
+		}
+
+		if (compcode != MQCC_OK)
+		{
+			/* give back the message that was not read */
+			atomicAdd64(&msgsClaimed, -1);
+
+			/* check for errors, except for no more messages in queue */
+			if (2033 == reason)
+			{
+				/* check that the program was not cancelled */
+				if (0 == terminate)
+				{
+					Log("%stimed out before maximum number of messages were read", cons->label);
+				}
+			}
+			else
+			{
+				checkerror("MQGET", compcode, reason, parms->qname);
+			}
+
+			break;
+		}
+
+		/* increase the uow count */
+		uow++;
+
+		/* check if an acknowledgement is required */
+		report = msgdesc.Report;
+		if ((((report & MQRO_PAN) > 0) && (parms->fileDataPAN != NULL)) ||
+			(((report & MQRO_NAN) > 0) && (parms->fileDataNAN != NULL)))
+		{
+			/* either NAN or PAN is set - therefore, we need to reply */
+			/* get the reply to Q and QM and send the reply           */
+			memcpy(parms->replyQname, msgdesc.ReplyToQ, MQ_Q_NAME_LENGTH);
+			memcpy(parms->replyQMname, msgdesc.ReplyToQMgr, MQ_Q_MGR_NAME_LENGTH);
+			issueReply(cons->qm, report, &uow, (char *)msgdesc.MsgId, parms);
+		}
+
+		/* check if we are at the maximum batch size */
+		if ((parms->batchSize > 1) && (uow > parms->batchSize))
+		{
+			commitBatch(cons->qm, &(cons->batchTune), &compcode, &reason);
+			checkerror("MQCMIT", compcode, reason, parms->qmname);
+			uow = 0;
+		}
+
+		/* check if the batch size is to be changed between units of work */
+		if ((1 == cons->batchTune.active) && ((0 == uow) || (1 == parms->batchSize)))
+		{
+			uow = 0;
+			adjustBatchSize(&(cons->batchTune), &(parms->batchSize), stats->msgCount);
+		}
+
+		/* check if latencies are to be calculated */
+		diff = 0;
+		if (1 == parms->setTimeStamp)
+		{
+			diff = getLatency(parms, &msgdesc, msgdata, datalen, minSize);
+		}
+
+		/* remember when the messages arrived */
+		GetTime(&(cons->lastMsgTime));
+		if (0 == stats->msgCount)
+		{
+			cons->firstMsgTime = cons->lastMsgTime;
+		}
+
+		/* only this thread changes the histogram counts */
+		if (diff > 0)
+		{
+			cons->latCounts[getHistogramSlot(diff)]++;
+		}
+
+		/* publish the new counts to the reporting thread */
+		stats->seq++;
+		WRITE_BARRIER();
+
+		stats->msgCount++;
+		stats->byteCount += datalen;
+		if (diff > 0)
+		{
+			stats->currLatency = diff;
+			stats->latTotal += diff;
+
+			if ((0 == stats->latCount) || (diff < stats->latMin))
+			{
+				stats->latMin = diff;
+			}
+
+			if (diff > stats->latMax)
+			{
+				stats->latMax = diff;
+			}
+
+			stats->latCount++;
+		}
+
+		WRITE_BARRIER();
+		stats->seq++;
+	}
+
+	/* check if we have a uow open */
+	if ((parms->batchSize > 1) && (uow > 0))
+	{
+		MQCMIT(cons->qm, &compcode, &reason);
+		checkerror("MQCMIT", compcode, reason, parms->qmname);
+	}
+
+	/* write out the batch size that was used at the end */
+	reportBatchSize(&(cons->batchTune), parms->batchSize);
+
+	/* close the input queue */
+	MQCLOSE(cons->qm, &(cons->q), MQCO_NONE, &compcode, &reason);
+	checkerror("MQCLOSE", compcode, reason, parms->qname);
+
+	/* Disconnect from the queue manager */
+	MQDISC(&(cons->qm), &compcode, &reason);
+	checkerror("MQDISC", compcode, reason, parms->qmname);
+
+	free(msgdata);
+
+	/* the final counts must be visible before the thread is seen to end */
+	WRITE_BARRIER();
+	cons->ended = 1;
+}
+
+/**************************************************************/
+/*                                                            */
+/* Take a consistent copy of the counters of a consumer.      */
+/*                                                            */
+/**************************************************************/
+
+void getConsumerStats(CONSUMER *cons, CONSUMERSTATS *copy)
+
+{
+	int		seq;
+
+	do
+	{
+		/* wait for any update in progress to complete */
+		while ((seq = cons->stats.seq) & 1)
+		{
+			MEMORY_BARRIER();
+		}
+
+		MEMORY_BARRIER();
+		memcpy(copy, (void *)&(cons->stats), sizeof(CONSUMERSTATS));
+		MEMORY_BARRIER();
+	} while (seq != cons->stats.seq);
+}
+
+/**************************************************************/
+/*                                                            */
+/* Read messages with more than one consumer thread.  The     */
+/* main thread reports the combined rate once a second.       */
+/*                                                            */
+/**************************************************************/
+
+int runConsumers(PUTPARMS *parms, STATSFILE *stats)
+
+{
+	int64_t		msgcount=0;			/* messages in the current interval */
+	int64_t		totcount=0;
+	int64_t		totalbytes=0;
+	int64_t		elapsed;
+	double		rate;
+	double		share;
+	int			threadCount=parms->threads;
+	int			started=0;
+	int			active;
+	int			i;
+	int			rc=0;
+	time_t		prevtime;
+	time_t		currtime;
+	time_t		intervalTime=0;		/* second the current interval started */
+	char		strTime[32];
+	char		elapsedTime[32];
+	CONSUMER	*consTable;
+	CONSUMER	*cons;
+	THREAD_T	*consHandles;
+	CONSUMERSTATS	snap;
+	CONSUMERSTATS	total;
+	LATENCYDATA		totalLat;			/* latency counters of all the consumers */
+	LATENCYDATA		intervalLat;		/* latency counters at the end of the current interval */
+	INTERVALDATA	intv;
+
+	memset(&intv, 0, sizeof(intv));
+	memset(&intervalLat, 0, sizeof(intervalLat));
+	intv.firstInterval = 1;
+	intv.stats = stats;
+	initSteadyState(&(intv.steady), parms, parms->setTimeStamp);
+	intv.msgPtr = intv.msgArea;
+
+	if (parms->totcount < threadCount)
+	{
+		/* no point in having idle consumers */
+		threadCount = (int)parms->totcount;
+	}
+
+	Log("%d threads will be used to read the messages", threadCount);
+
+	/* allocate the thread work areas */
+	consTable = (CONSUMER *)malloc(threadCount * sizeof(CONSUMER));
+	consHandles = (THREAD_T *)malloc(threadCount * sizeof(THREAD_T));
+	if ((NULL == consTable) || (NULL == consHandles))
+	{
+		Log("***** unable to allocate storage for %d threads - program terminating", threadCount);
+		return 93;
+	}
+
+	for (i = 0; i < threadCount; i++)
+	{
+		cons = consTable + i;
+		memset(cons, 0, sizeof(CONSUMER));
+		memcpy(&(cons->parms), parms, sizeof(PUTPARMS));
+
+		cons->threadNum = i + 1;
+		sprintf(cons->label, "thread %d ", i + 1);
+	}
+
+	Log("opening queue %s for input", parms->qname);
+
+	/* start the consumer threads */
+	while ((started < threadCount) && (0 == terminate))
+	{
+		if (startThread(consHandles + started, consumerThread, consTable + started) != 0)
+		{
+			/* stop any threads that were already started */
+			terminate = 1;
+			rc = 92;
+			break;
+		}
+
+		/* let the first consumer drain the queue before starting the others */
+		if (0 == started)
+		{
+			while ((0 == consTable->ready) && (0 == consTable->ended))
+			{
+				Sleep(50);
+			}
+		}
+
+		started++;
+	}
+
+	/* tell what we are doing */
+	Log("Reading " FMTI64 " messages from %s on %s with max wait time of %d secs\n",
+		   parms->totcount, parms->qname, parms->qmname, parms->maxtime);
+
+	/* report the combined counts each time the second changes */
+	prevtime = time(NULL);
+	do
+	{
+		Sleep(50);
+
+		/* check if any consumers are still running */
+		active = 0;
+		for (i = 0; i < started; i++)
+		{
+			if (0 == consTable[i].ended)
+			{
+				active++;
+			}
+		}
+
+		currtime = time(NULL);
+		if ((currtime == prevtime) && (active > 0))
+		{
+			continue;
+		}
+
+		/* add up the counters of all the consumers */
+		memset(&total, 0, sizeof(total));
+		memset(&totalLat, 0, sizeof(totalLat));
+		for (i = 0; i < started; i++)
+		{
+			getConsumerStats(consTable + i, &snap);
+			total.msgCount += snap.msgCount;
+			total.byteCount += snap.byteCount;
+			mergeLatency(&totalLat, consTable + i, &snap);
+		}
+
+		/* were any messages read in the last second? */
+		if (total.msgCount > totcount)
+		{
+			if (msgcount > 0)
+			{
+				/* report the previous interval */
+				formatTimeSecsNoColons(strTime, intervalTime);
+				endInterval(&intv, strTime, msgcount, totcount, totalbytes, prevtime - intervalTime, &intervalLat, parms->reportInterval);
+			}
+			else
+			{
+				/* capture the time of the first interval */
+				intv.firstTime = prevtime;
+				intv.secondTime = prevtime;
+			}
+
+			intv.prevLastTime = prevtime;
+			intv.lastTime = prevtime;
+
+			/* start a new interval */
+			intervalTime = prevtime;
+			msgcount = total.msgCount - totcount;
+			totcount = total.msgCount;
+			totalbytes = total.byteCount;
+			memcpy(&intervalLat, &totalLat, sizeof(LATENCYDATA));
+		}
+
+		/* check for a steady rate */
+		addSteadyCount(&(intv.steady), total.msgCount, &(totalLat.hist));
+
+		prevtime = currtime;
+	} while (active > 0);
+
+	/* wait for all the threads that were started to finish */
+	for (i = 0; i < started; i++)
+	{
+		waitThread(consHandles[i]);
+
+		/* remember the first return code */
+		if ((0 == rc) && (consTable[i].rc != 0))
+		{
+			rc = consTable[i].rc;
+		}
+	}
+
+	/* report the last interval */
+	formatTimeSecsNoColons(strTime, intervalTime);
+	endLastInterval(&intv, strTime, msgcount, totcount, totalbytes, prevtime - intervalTime, &totalLat);
 
-#include "int64defs.h"
-#include "comsubs.h"
-#include "timesubs.h"
-#include "parmline.h"
-#include "putparms.h"
-#include "qsubs.h"
-#include "rfhsubs.h"
+	/* issue message if user cancelled the program */
+	if (1 == terminate)
+	{
+		if (1 == cancelled)
+		{
+			Log("Program cancelled by user");
+		}
+		else
+		{
+			/* error forced termination */
+			Log("Program terminated due to error");
+		}
+	}
 
-/* global error switch */
-	int		err=0;
+	printResults(&intv, totcount, totalbytes, msgcount, &totalLat, parms->setTimeStamp);
 
-/* global termination switch */
-	volatile int	terminate=0;
-	volatile int	cancelled=0;
+	/* display the results of each consumer */
+	Log("");
+	for (i = 0; i < started; i++)
+	{
+		cons = consTable + i;
 
-static char copyright[] = "(C) Copyright IBM Corp, 2001/2002/2004/2005/2014";
-static char Version[]=\
-"@(#)MQTimes2 V3.0 - MQ Performance results tool  - Jim MacNair ";
+		elapsed = 0;
+		rate = 0.0;
+		share = 0.0;
+		if (cons->stats.msgCount > 0)
+		{
+			elapsed = DiffTime(cons->firstMsgTime, cons->lastMsgTime);
+		}
 
-#ifdef _DEBUG
-static char Level[]="mqtimes2.c V3.0 Debug version ("__DATE__" "__TIME__")";
-#else
-#ifdef MQCLIENT
-static char Level[]="mqtimes2c.c V3.0 Client version ("__DATE__" "__TIME__")";
-#else
-static char Level[]="mqtimes2.c V3.0 Release version ("__DATE__" "__TIME__")";
-#endif
-#endif
+		if (elapsed > 0)
+		{
+			rate = (double)(cons->stats.msgCount - 1) * 1000000.0 / (double)elapsed;
+		}
 
-void InterruptHandler (int sigVal) 
-{ 
-	/* force program to end */
-	terminate = 1;
+		if (totcount > 0)
+		{
+			share = (double)cons->stats.msgCount * 100.0 / (double)totcount;
+		}
 
-	/* indicate user cancelled the program */
-	cancelled = 1;
-}
+		formatTimeDiffSecs(elapsedTime, elapsed);
+		Log("Consumer %d messages " FMTI64 " bytes " FMTI64 " seconds %s rate %9.2f msgs/sec share %6.2f%%",
+			cons->threadNum, cons->stats.msgCount, cons->stats.byteCount, elapsedTime, rate, share);
+	}
 
-void printHelp(char *pgmName)
+	free(consTable);
+	free(consHandles);
 
-{
-	printf("\nformat is:\n");
-	printf("   %s <-c Count> <-q Queue> <-m Queue manager> <-f Parameters file> <-p> <-b nnn>\n", pgmName);
-	printf("    Count is the number of messages to read before stopping.\n");
-	printf("    Queue is the name of the queue to read messages from.\n");
-#ifdef MQCLIENT
-	printf("    Queue manager is the name of the queue manager that holds the input queue\n");
-	printf("     or the format of an MQSERVER variable - channel name/TCP/hostname(port).\n");
-#else
-	printf("    Queue manager is the name of the queue manager that holds the input queue.\n");
-#endif
-	printf("    The -p option will purge the queue before starting the measurement.\n");
-	printf("     Any messages in the queue will be discarded.\n");
-	printf("    The -b option specifies the number of messages in a single unit of work.\n");
-	printf("    If the program must respond to either PAN or NAN report options, a file\n");
-	printf("     containing the data to be used for the reply message must be provided\n");
-	printf("     and specified in the parameters file.\n");
+	return rc;
 }
 
 int main(int argc, char **argv)
@@ -112,48 +1304,13 @@ int main(int argc, char **argv)
 	int64_t		msgcount=0;
 	int64_t		totcount=0;
 	int64_t		totalbytes=0;
-	int64_t		avgbytes;
-	int64_t		maxrate=0;
-	int64_t		firstsec=0;
-	int64_t		secondcount=0;
-	int64_t		recent10;
-	int64_t		recent10sec;
-	int64_t		last10[10];			/* Average rate of last 10 intervals */
-	int64_t		last10secs[10];		/* time of last 10 intervals */
-	int64_t		tempLatency=0;		/* latency in milliseconds */
-	int64_t		totalLatency=0;		/* latency in milliseconds */
-	int64_t		currLatency=0;		/* last observed latency in milliseconds */
-	int64_t		minLatency=0;		/* minimum latency observed */
-	int64_t		maxLatency=0;		/* maximum latency observed */
-	int64_t		latency10=0;		/* latency < 10 microseconds */
-	int64_t		latency100=0;		/* latency > 10 microseconds and < 100 microseconds */
-	int64_t		latency500=0;		/* latency > 10 microseconds and < 100 microseconds */
-	int64_t		latency1000=0;		/* latency > 100 microseconds and < 1 milliseconds */
-	int64_t		latency5000=0;		/* latency > 1 millisecond and < 5 milliseconds */
-	int64_t		latency10000=0;		/* latency > 5 milliseconds and < 10 milliseconds */
-	int64_t		latency50000=0;		/* latency > 10 milliseconds and < 50 milliseconds */
-	int64_t		latency100000=0;	/* latency > 50 milliseconds and < 100 milliseconds */
-	int64_t		latency500000=0;	/* latency > 100 milliseconds and < 500 milliseconds */
-	int64_t		latency1000000=0;	/* latency > 500 millioseconds and < 1 second */
-	int64_t		latency10000000=0;	/* latency > 1 second and < 10 seconds */
-	int64_t		latency100000000=0;	/* latency > 10 seconds */
-	int64_t		latencyCount=0;		/* number of results in totalLatency */
-	int64_t		lastLatencyCount=0;
-	double		avgrate;
+	int64_t		diff;
 	size_t		mallocSize;
 	MQLONG		datalen=0;
 	int			minSize;
 	int			uow=0;
-	int			drainCount=0;
-	time_t		firstTime=0;
-	time_t		secondTime=0;
-	time_t		lastTime=0;
-	time_t		prevLastTime=0;
 	int			remainingTime=0;
-	int			firstInterval=1;	/* first interval indicator to not report recent average */
-	int			secs;				/* work variable - number of seconds between first and last interval */
-	int			i;
-	int			reportCount=0;
+	int			rc=0;
 	MQLONG		report;				/* MQ report options */
 	MQHCONN		qm=0;
 	MQHOBJ		q=0;
@@ -165,30 +1322,16 @@ int main(int argc, char **argv)
 	MQMD2		msgdesc = {MQMD2_DEFAULT};
 	MQLONG		openopt = 0;
 	MQGMO		mqgmo = {MQGMO_DEFAULT};
-	MQPMO		mqpmo = {MQPMO_DEFAULT};
-	MQMD2		replyMsg = {MQMD2_DEFAULT};
 	char		*msgdata;
-	char		*userPtr;
 	char		prevtime[9];
 	char		currtime[9];
 	MQLONG		prevtime_secs;
 	MQLONG		currtime_secs;
-	char		*msgPtr;
-	char		timeFirst[16];
-	char		timeLast[16];
-	char		lastLatency[16];
-	char		avgLatency[16];
-	char		minLat[16];
-	char		maxLat[16];
-	char		tempCount[16];
-	char		tempTotal[16];
-	char		tempAvg[32];
-	char		msgArea[10240];
+	LATENCYDATA	lat;
+	INTERVALDATA	intv;
+	BATCHTUNE	batchTune;			/* automatic batch size */
 	PUTPARMS	parms;				/* command line arguments and parameter file values */
 
-	MY_TIME_T	endTime;			/* high performance counter to measure latency */
-	MY_TIME_T	startTime;			/* high performance counter to measure latency */
-
 	/* display the program name and version information */
 	Log("%s program start", Level);
 
@@ -201,13 +1344,9 @@ int main(int argc, char **argv)
 	/* initialize the work areas */
 	memset(prevtime, 0, sizeof(prevtime));
 	memset(currtime, 0, sizeof(currtime));
-	memset(msgArea, 0, sizeof(msgArea));
-
-	for (i=0; i<10; i++)
-	{
-		last10[i] = 0;
-		last10secs[i] = 0;
-	}
+	memset(&lat, 0, sizeof(lat));
+	memset(&intv, 0, sizeof(intv));
+	intv.firstInterval = 1;
 
 	prevtime_secs = currtime_secs = 0;
 
@@ -274,11 +1413,51 @@ int main(int argc, char **argv)
 			/* check if the message is long enough */
 			Log("Latency stored at offset %d", parms.timeStampOffset);
 		}
+
+		/* the clock decides where the messages can be written */
+		if (1 == usingWallClock())
+		{
+			Log("Time stamps are the time of day - the clocks of the machines must be synchronized");
+		}
+		else
+		{
+			Log("Time stamps use the monotonic clock - the messages must be written on this machine");
+		}
+	}
+
+	/* check if interval statistics are to be written to a file */
+	if (parms.statsFilename[0] != 0)
+	{
+		intv.stats = openStatsFile(parms.statsFilename);
 	}
 
 	/* set a termination handler */
 	signal(SIGINT, InterruptHandler);
 
+	/* check if more than one consumer was requested */
+	if ((parms.threads > 1) && (parms.totcount > 1))
+	{
+		rc = runConsumers(&parms, intv.stats);
+		closeStatsFile(intv.stats);
+
+		if (parms.fileDataPAN != NULL)
+		{
+			free(parms.fileDataPAN);
+		}
+
+		if (parms.fileDataNAN != NULL)
+		{
+			free(parms.fileDataNAN);
+		}
+
+		Log("\nMQTIMES2 program ended");
+
+		return rc;
+	}
+
+	/* get ready to find the steady window */
+	initSteadyState(&(intv.steady), &parms, parms.setTimeStamp);
+
 	/* allocate a buffer for the message */
 	/* do this after the command line arguments are processed */
 	mallocSize = (unsigned int)parms.maxmsglen;
@@ -296,7 +1475,7 @@ int main(int argc, char **argv)
 	memset(msgdata, 0, mallocSize);
 
 	/* point to the message area */
-	msgPtr = msgArea;
+	intv.msgPtr = intv.msgArea;
 
 	/* Connect to the queue manager */
 #ifdef MQCLIENT
@@ -341,60 +1520,12 @@ int main(int argc, char **argv)
 	/* check to see if queue is to be drained before run starts */
 	if (parms.drainQ > 0)
 	{
-		Log("draining queue");
-		uow = 0;
-		compcode = MQCC_OK;
-		while (compcode == MQCC_OK)
-		{
-			if (parms.batchSize > 1)
-			{
-				mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_SYNCPOINT | MQGMO_ACCEPT_TRUNCATED_MSG;
-			}
-			else
-			{
-				mqgmo.Options = MQGMO_NO_WAIT | MQGMO_FAIL_IF_QUIESCING | MQGMO_ACCEPT_TRUNCATED_MSG;
-			}
-
-			/* reset the msgid and correlid */
-			memcpy(msgdesc.MsgId, MQMI_NONE, sizeof(msgdesc.MsgId));
-			memcpy(msgdesc.CorrelId, MQCI_NONE, sizeof(msgdesc.CorrelId));
-			memcpy(msgdesc.GroupId, MQGI_NONE, sizeof(msgdesc.GroupId));
-
-			/* perform the MQGET */
-			MQGET(qm, q, &msgdesc, &mqgmo, parms.maxmsglen, msgdata, &datalen, &compcode, &reason);
-			
-			if ((MQCC_WARNING == compcode) && (reason == 2079))
-			{
-				compcode = MQCC_OK;
-				reason = 0;
-			}
-
-			/* check if we got a message */
-			if (MQCC_OK == compcode)
-			{
-				uow++;
-				drainCount++;
-
-				if ((parms.batchSize > 1) && (uow > parms.batchSize))
-				{
-					MQCMIT(qm, &compcode, &reason);
-					uow = 0;
-				}
-			}
-		}
-
-		if ((parms.batchSize > 1) && (uow > parms.batchSize))
-		{
-			MQCMIT(qm, &compcode, &reason);
-			uow = 0;
-		}
-
-		if (drainCount > 0)
-		{
-			Log("%d messages drained from Q prior to measurement start", drainCount);
-		}
+		drainQueue(qm, q, msgdata, &parms);
 	}
 
+	/* get ready to change the batch size if requested */
+	initBatchTune(&batchTune, &parms, &(parms.batchSize), "");
+
 	/* tell what we are doing */
 	Log("Reading " FMTI64 " messages from %s on %s with max wait time of %d secs\n",
 		   parms.totcount, parms.qname, parms.qmname, parms.maxtime);
@@ -489,34 +1620,40 @@ int main(int argc, char **argv)
 			/* check if we are at the maximum batch size */
 			if ((parms.batchSize > 1) && (uow > parms.batchSize))
 			{
-				MQCMIT(qm, &compcode, &reason);
+				commitBatch(qm, &batchTune, &compcode, &reason);
 				checkerror("MQCMIT", compcode, reason, parms.qmname);
 				uow = 0;
 			}
 
+			/* check if the batch size is to be changed between units of work */
+			if ((1 == batchTune.active) && ((0 == uow) || (1 == parms.batchSize)))
+			{
+				uow = 0;
+				adjustBatchSize(&batchTune, &(parms.batchSize), totcount);
+			}
+
 			/* get the message time from the MQMD */
 			memcpy(currtime, msgdesc.PutTime, 8);
 
 			/* check if the time is the same or not */
 			/* only check down to the seconds position */
-			/* if ((prevtime[0] == 0) || (memcmp(prevtime, currtime, 6) == 0))*/
 			currtime_secs = ( atol(currtime) / 100 );
 
 			if (0 == prevtime_secs)
 			{
 				/* capture the time of the first message */
-				firstTime = currtime_secs;
+				intv.firstTime = currtime_secs;
 			}
 			else
 			{
-				if (0 == secondTime)
+				if (0 == intv.secondTime)
 				{
 					/* capture the second time */
-					secondTime = currtime_secs;
+					intv.secondTime = currtime_secs;
 				}
 
-				prevLastTime = lastTime;
-				lastTime = currtime_secs;
+				intv.prevLastTime = intv.lastTime;
+				intv.lastTime = currtime_secs;
 			}
 
 			if ((0 == prevtime_secs) || (currtime_secs <= prevtime_secs ))
@@ -528,121 +1665,10 @@ int main(int argc, char **argv)
 			else
 			{
 				/* time has changed, so report the counts for the previous interval */
-
-				/* is this the first interval? */
-				if (0 == firstInterval)
-				{
-					/* get the totals of the last 10 intervals */
-					recent10 = 0;
-					recent10sec = 0;
-					for (i=9; i>0; i--)
-					{
-						/* shift all the counts and times one position */
-						last10secs[i] = last10secs[i - 1];
-						last10[i] = last10[i - 1];
-
-						/* get the total number of messages and seconds */
-						recent10 += last10[i - 1];
-						recent10sec += last10secs[i-1];
-					}
-
-					/* record the number of seconds in this interval */
-					if (0 == prevtime_secs)
-					{
-						/* force the interval to 1 second */
-						last10secs[0] = 1;
-					}
-					else
-					{
-						/* calculate the interval in seconds */
-						last10secs[0] = getSecs(currtime_secs) - getSecs(prevtime_secs);
-					}
-
-					/* get the most recent count */
-					last10[0] = msgcount;
-					recent10 += msgcount;
-					recent10sec += last10secs[0];
-
-					avgrate = (double)recent10 / recent10sec;
-				}
-				else
-				{
-					/* start reporting the recent average the next time */
-					firstInterval = 0;
-					avgrate = 0.0;
-				}
-
-				/* get the count as a string */
-				sprintf(tempCount, FMTI64, msgcount);
-				sprintf(tempTotal, FMTI64, totcount);
-
-				/* write out the number of messages in this second */
-				if (latencyCount > lastLatencyCount)
-				{
-					/* only report if it changes */
-					lastLatencyCount = latencyCount;
-
-					/* calculate the average latency */
-					tempLatency = totalLatency / latencyCount;
-
-					/* get the latencies into printable format */
-					formatTimeDiff(lastLatency, currLatency);
-					formatTimeDiff(avgLatency, tempLatency);
-					formatTimeDiff(minLat, minLatency);
-					formatTimeDiff(maxLat, maxLatency);
-
-					/* save the last ten latencies */
-					/* display the results */
-					sprintf(msgPtr,"%s %7.7s msgs - rec avg = %7.2f total msgs %9.9s Latency last %s avg %s min %s max %s latencyCount " FMTI64 " msgCount " FMTI64, 
-							prevtime, tempCount, avgrate, tempTotal, lastLatency, avgLatency, minLat, maxLat, latencyCount, totcount);
-				}
-				else
-				{
-					/* check if the average rate is > 0 */
-					if (avgrate > 0.0)
-					{
-						/* get the average rate */
-						sprintf(tempAvg, " - recent average %9.2f", avgrate);
-					}
-					else
-					{
-						/* just create a zero length string */
-						tempAvg[0] = 0;
-					}
-						
-					/* create a message to display */
-					sprintf(msgPtr,"%s %7.7s msgs%s total msgs %9.9s", prevtime, tempCount, tempAvg, tempTotal);
-				}
-
-				msgPtr += strlen(msgPtr);
-
-				reportCount++;
-				if (reportCount >= parms.reportInterval)
-				{
-					Log("%s", msgArea);
-					reportCount = 0;
-					msgPtr = msgArea;
-					msgArea[0] = 0;
-				}
-
-				/* is this the first time through? */
-				if (0 == firstsec)
-				{
-					/* remember count in first second */
-					firstsec = msgcount;
-				}
-
-				/* keep track of the maximum message rate */
-				if (msgcount > maxrate)
-				{
-					maxrate = msgcount;
-				}
+				endInterval(&intv, prevtime, msgcount, totcount, totalbytes, getSecs(currtime_secs) - getSecs(prevtime_secs), &lat, parms.reportInterval);
 
 				/* reset the messages in second counter, automatically counting the first message */
 				msgcount = 1;
-
-				/* count the number of individual seconds with at least one message */
-				secondcount++;
 			}
 
 			if (currtime_secs > prevtime_secs )
@@ -651,6 +1677,9 @@ int main(int argc, char **argv)
 				prevtime_secs = currtime_secs;
 			}
 
+			/* check for a steady rate before counting this message */
+			addSteadyCount(&(intv.steady), totcount, &(lat.hist));
+
 			/* count the total number of messages */
 			totcount++;
 
@@ -658,177 +1687,17 @@ int main(int argc, char **argv)
 			totalbytes += datalen;
 
 			/* check if latencies are to be calculated */
-			/* this assumes that the first 8 bytes of the message plus offset countains a performance counter */
-			/* a queue manager name is placed after the counter, which must also match */
-			/* or that the timestamp is hidden in the MQMD Accounting Token, Correlation ID or Group ID fields */
-			/* this requires the same setTimeStamp options have been used with MQPUT2 */
 			if (1 == parms.setTimeStamp)
 			{
-#ifdef WIN32
-				/* zero out the time the message was sent to detect if a valid start time was not found */
-				startTime = 0;
-#else
-				startTime.tv_usec = 0;
-				startTime.tv_sec = 0;
-#endif
-
-				/* get the current time (time message has arrived) */
-				GetTime(&endTime);
-
-				/* check if we have an RFH header */
-				userPtr = checkForRFH(msgdata, &msgdesc);
-
-				/* check if the timestamp is in the MQMD accounting token field */
-				if (1 == parms.timeStampInAccountingToken)
-				{
-					/* get the start time from the MQMD Accounting Token field */
-					memcpy(&startTime, msgdesc.AccountingToken, sizeof(MY_TIME_T));
-				}
-				else if (1 == parms.timeStampInCorrelId)
-				{
-					/* get the start time from the MQMD Correlation ID field */
-					memcpy(&startTime, msgdesc.CorrelId, sizeof(MY_TIME_T));
-				}
-				else if (1 == parms.timeStampInGroupId)
-				{
-					/* get the start time from the MQMD Group ID field */
-					memcpy(&startTime, msgdesc.GroupId, sizeof(MY_TIME_T));
-				}
-				else if (1 == parms.timeStampUserProp)
-				{
-					/* get the start time from the RFH2 usr folder */
-					getRFHUsrTimeStamp(msgdata, datalen, &startTime);
-				}
-				else
-				{
-					/* check if the message is long enough */
-					if (datalen > minSize + parms.timeStampOffset)
-					{
-						/* check if the queue manager name matches */
-						if (strcmp(userPtr + parms.timeStampOffset + sizeof(MY_TIME_T), parms.qmname) == 0)
-						{
-							/* get the start time */
-							memcpy(&startTime, userPtr + parms.timeStampOffset, sizeof(MY_TIME_T));
-						}
-					}
-					else
-					{
-						/* not long enough - skip this message */
-#ifdef WIN32
-						startTime = 0;
-#else
-						startTime.tv_sec = 0;
-						startTime.tv_usec = 0;
-#endif
-					}
-				}
-
-				/* make sure both counters are not zero */
-#ifdef WIN32
-				if ((endTime != 0) && (startTime != 0))
-#else
-				if (((endTime.tv_sec != 0) || (endTime.tv_usec != 0)) && ((startTime.tv_sec != 0) || (startTime.tv_usec != 0)))
-#endif
+				diff = getLatency(&parms, &msgdesc, msgdata, datalen, minSize);
+				if (diff > 0)
 				{
-					int64_t diff = DiffTime(startTime, endTime);
-					if (diff <= 0)
-					{
-						Log("Invalid latency detected - less than zero - diff %e", diff);
-					}
-					else
-					{
-						/* add to the total latency */
-						currLatency = diff;
-						totalLatency += diff;
-						latencyCount++;
-
-						/* check if this is less than the minimum latency */
-						if ((diff < minLatency) || (1 == latencyCount))
-						{
-							minLatency = diff;
-						}
-
-						/* check if this is more than the maximum latency */
-						if (diff > maxLatency)
-						{
-							maxLatency = diff;
-						}
-					
-						/* keep track of the number of latencies by ranges */
-						/* of microseconds, from less than 10 to over 10 seconds */
-						if (diff < 10)
-						{
-							/* increment counter */
-							latency10++;
-						} 
-						else if (diff < 100)
-						{
-							/* increment counter */
-							latency100++;
-						} 
-						else if (diff < 500)
-						{
-							/* increment counter */
-							latency500++;
-						} 
-						else if (diff < 1000)
-						{
-							/* increment counter */
-							latency1000++;
-						} 
-						else if (diff < 5000)
-						{
-							/* increment counter */
-							latency5000++;
-						} 
-						else if (diff < 10000)
-						{
-							/* increment counter */
-							latency10000++;
-						} 
-						else if (diff < 50000)
-						{
-							/* increment counter */
-							latency50000++;
-						} 
-						else if (diff < 100000)
-						{
-							/* increment counter */
-							latency100000++;
-						} 
-						else if (diff < 500000)
-						{
-							/* increment counter */
-							latency500000++;
-						} 
-						else if (diff < 1000000)
-						{
-							/* increment counter */
-							latency1000000++;
-						} 
-						else if (diff < 10000000)
-						{
-							/* increment counter */
-							latency10000000++;
-						}
-						else
-						{
-							/* increment counter */
-							latency100000000++;
-						}
-					}
+					recordLatency(&lat, diff);
 				}
 			}
 		}
 	}
 
-	/* make sure there was a message in the last interval */
-	if (msgcount > 0)
-	{
-		/* count the last interval */
-		secondcount++;
-	}
-
 	/* check if we have a uow open */
 	if ((parms.batchSize > 1) && (uow > 0))
 	{
@@ -836,15 +1705,11 @@ int main(int argc, char **argv)
 		checkerror("MQCMIT", compcode, reason, parms.qmname);
 	}
 
-	/* dump out the last time interval */
-	sprintf(msgArea, "%6.6s " FMTI64 " msgs", prevtime, msgcount);
-	Log("%s", msgArea);
+	/* write out the batch size that was used at the end */
+	reportBatchSize(&batchTune, parms.batchSize);
 
-	/* keep track of the maximum message rate */
-	if (msgcount > maxrate)
-	{
-		maxrate = msgcount;
-	}
+	/* report the last interval */
+	endLastInterval(&intv, prevtime, msgcount, totcount, totalbytes, 1, &lat);
 
 	/* close the input queue */
 	Log("\nclosing the input queue (%s)", parms.qname);
@@ -872,99 +1737,8 @@ int main(int argc, char **argv)
 		}
 	}
 
-	/* dump out the total message count */
-	Log("\nTotal messages " FMTI64, totcount);
-
-	/* give the total and average message size */
-	if (totcount > 0)
-	{
-		/* calculate the average bytes per message */
-		avgbytes = totalbytes / totcount;
-		Log("total bytes in all messages " FMTI64, totalbytes);
-		Log("average message size " FMTI64, avgbytes);
-	}
-
-	/* indicate the number of seconds with at least one message */
-	Log("Total number of seconds with at least one message " FMTI64, secondcount);
-
-	/* write out the average message rate, ignoring the first and last intervals */
-	if (secondcount > 2)
-	{
-		formatTimeSecs(timeLast, lastTime);
-		formatTimeSecs(timeFirst, firstTime);
-		Log("First time %s Last time %s seconds %d", timeFirst, timeLast, (int)(difftime(lastTime, firstTime)) + 1);
-		secs = (int)(difftime(prevLastTime, secondTime)) - 1;
-
-		/* avoid any divide by zeros */
-		if (secs > 0)
-		{
-			avgrate = (float)(totcount - firstsec - msgcount) / secs;
-			Log("Average message rate except first and last intervals %7.2f", avgrate);
-		}
-	}
-
-	/* print out the maximum rate */
-	Log("Peak message rate " FMTI64, maxrate);
-
-	/* check if latency numbers were requested */
-	if (1 == parms.setTimeStamp)
-	{
-		if (0 == latencyCount)
-		{
-			Log("\nLatency was requested but the counter is 0");
-		}
-		else
-		{
-			/* calculate the average latency */
-			totalLatency = totalLatency / latencyCount;
-
-			/* get the latencies into printable format */
-			formatTimeDiff(avgLatency, totalLatency);
-			formatTimeDiff(minLat, minLatency);
-			formatTimeDiff(maxLat, maxLatency);
-
-			/* display the results */
-			Log("\nAverage Latency %s - min %s max %s number  of msgs " FMTI64, avgLatency, minLat, maxLat, latencyCount);
-
-			/* display the counters */
-			/* Some of the counters are only displayed if there were actually */
-			/* messages that took that amount of time to be processed */
-			if (latency10 > 0)
-			{
-				/* less than 0.01 millsecond */
-				Log("Less than 10 Microseconds   " FMTI64, latency10);
-			}
-
-			if ((latency10 > 0) || (latency100 > 0))
-			{
-				/* less than 0.1 millisecond */
-				Log("Less than 100 Microseconds  " FMTI64, latency100);
-			}
-
-			if ((latency10 > 0) || (latency100 > 0) || (latency500 > 0))
-			{
-				/* less than 0.5 millisecond */
-				Log("Less than 500 Microseconds  " FMTI64, latency500);
-			}
-
-			/* always display these counters */
-			/* range covers 0.5 millsecond to 10 seconds */
-			Log("Less than 1 Millisecond     " FMTI64, latency1000);
-			Log("Less than 5 Milliseconds    " FMTI64, latency5000);
-			Log("Less than 10 Milliseconds   " FMTI64, latency10000);
-			Log("Less than 50 Milliseconds   " FMTI64, latency50000);
-			Log("Less than 100 Milliseconds  " FMTI64, latency100000);
-			Log("Less than 500 Milliseconds  " FMTI64, latency500000);
-			Log("Less than 1 Second          " FMTI64, latency1000000);
-			Log("Less than 10 Seconds        " FMTI64, latency10000000);
-
-			/* check if this counter actually has been used */
-			if (latency100000000 > 0)
-			{
-				Log("Over 10 Seconds             " FMTI64, latency100000000);
-			}
-		}
-	}
+	printResults(&intv, totcount, totalbytes, msgcount, &lat, parms.setTimeStamp);
+	closeStatsFile(intv.stats);
 
 	if (parms.fileDataPAN != NULL)
 	{